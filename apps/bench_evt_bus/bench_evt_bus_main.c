@@ -0,0 +1,312 @@
+/*
+ * bench_evt_bus_main.c — event bus performance sweep (ESP-IDF, linux target or board)
+ *
+ * Sweeps subscribers per event, payload size and publisher task count
+ * against the os_evt_bus dispatcher task; the queue depth is a build
+ * option (see README.md). Every configuration runs two phases:
+ *
+ *   paced      each publisher publishes bursts of BENCH_EVT_BUS_BURST events
+ *              above the dispatcher's priority, then sleeps a tick. Gives
+ *              publish cost, publish -> first callback latency percentiles
+ *              and the DROP_NEW rate once bursts outgrow the queue.
+ *   saturated  publishers at the dispatcher's priority retry a full queue
+ *              after a yield. Gives delivered events per second.
+ *
+ * Results are printed as JSON lines prefixed with "EVTBENCH:" (one meta
+ * object, one object per configuration, then {"done":true}), so a captured
+ * console log can be fed to bench_evt_bus_report.py and compared against a
+ * previous commit.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#if CONFIG_IDF_TARGET_LINUX
+#include <time.h>
+#else
+#include "esp_timer.h"
+#endif
+
+#include "os_evt_bus.h"
+
+#ifndef BENCH_EVT_BUS_EVENTS
+#define BENCH_EVT_BUS_EVENTS 2000u /* per configuration and phase, split across publishers */
+#endif
+
+#ifndef BENCH_EVT_BUS_BURST
+#define BENCH_EVT_BUS_BURST 8u /* paced phase: publishes per publisher between sleeps */
+#endif
+
+#ifndef BENCH_EVT_BUS_MAX_PUBLISHERS
+#define BENCH_EVT_BUS_MAX_PUBLISHERS 4u
+#endif
+
+#ifndef BENCH_EVT_BUS_REV
+#define BENCH_EVT_BUS_REV "unknown"
+#endif
+
+#define BENCH_DISPATCH_PRIO   5
+#define BENCH_DISPATCH_STACK  4096
+#define BENCH_PUB_STACK       3072
+#define BENCH_DRAIN_TIMEOUT_MS 2000u
+#define BENCH_EVT_ID          EVT_IR_SEND_RESULT /* high lane, FIFO */
+
+static const char *TAG = "BENCH_EVT_BUS";
+
+/* =========================
+ * Clock
+ * ========================= */
+/*
+ * Nanoseconds on the linux target. On a board, esp_timer is the one clock
+ * both cores agree on (the cycle counters are per core), so latencies there
+ * have microsecond resolution.
+ */
+static uint64_t bench_now_ns(void)
+{
+#if CONFIG_IDF_TARGET_LINUX
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#else
+  return (uint64_t)esp_timer_get_time() * 1000u;
+#endif
+}
+
+/* Cost of one bench_now_ns(), taken out of the publish time */
+static uint32_t bench_clock_ns(void)
+{
+  uint64_t t0 = bench_now_ns();
+  for (uint32_t i = 0; i < 1000u; i++) {
+    (void)bench_now_ns();
+  }
+  return (uint32_t)((bench_now_ns() - t0) / 1000u);
+}
+
+/* =========================
+ * Run state
+ * ========================= */
+typedef struct {
+  uint32_t subs;
+  uint32_t payload;
+  uint32_t publishers;
+  bool saturate;
+} bench_cfg_t;
+
+typedef struct {
+  uint32_t attempts;
+  uint32_t dropped;
+  uint64_t publish_ns; /* paced: time inside the bursts, payload timestamps included */
+} bench_pub_result_t;
+
+static struct {
+  bench_cfg_t cfg;
+  SemaphoreHandle_t done;
+  bench_pub_result_t pub[BENCH_EVT_BUS_MAX_PUBLISHERS];
+  uint32_t lat_ns[BENCH_EVT_BUS_EVENTS];
+  uint32_t lat_count;
+  uint32_t delivered;  /* events seen by the first subscriber */
+  uint32_t expected;   /* saturated phase: events that will be accepted */
+  uint64_t last_ns;    /* when the first subscriber saw the expected-th event */
+  uint32_t clock_ns;
+  volatile uint32_t sink;
+} s_bench;
+
+/* Payload head (low 32 bits of the publish time); the rest of the payload is filler */
+typedef struct {
+  uint32_t ts_ns;
+} bench_payload_t;
+
+/* =========================
+ * Subscribers
+ * ========================= */
+static void cb_first(const os_evt_t *evt, void *user_ctx)
+{
+  (void)user_ctx;
+  bench_payload_t head;
+  memcpy(&head, os_evt_data(evt), sizeof(head));
+  uint64_t now = bench_now_ns();
+  if (s_bench.lat_count < BENCH_EVT_BUS_EVENTS) {
+    s_bench.lat_ns[s_bench.lat_count++] = (uint32_t)now - head.ts_ns;
+  }
+  if (++s_bench.delivered == s_bench.expected) {
+    s_bench.last_ns = now;
+  }
+}
+
+static void cb_other(const os_evt_t *evt, void *user_ctx)
+{
+  (void)user_ctx;
+  const uint8_t *data = os_evt_data(evt);
+  s_bench.sink += data[evt->len - 1u];
+}
+
+/* =========================
+ * Publishers
+ * ========================= */
+static void publisher_task(void *arg)
+{
+  uint32_t me = (uint32_t)(uintptr_t)arg;
+  const bench_cfg_t *cfg = &s_bench.cfg;
+  bench_pub_result_t *res = &s_bench.pub[me];
+  uint8_t payload[OS_EVT_INLINE_MAX];
+  uint32_t count = BENCH_EVT_BUS_EVENTS / cfg->publishers;
+
+  memset(payload, (int)me, sizeof(payload));
+  for (uint32_t i = 0; i < count;) {
+    uint32_t burst = cfg->saturate ? count - i : BENCH_EVT_BUS_BURST;
+    uint64_t t0 = bench_now_ns();
+    for (uint32_t b = 0; b < burst && i < count; b++, i++) {
+      bench_payload_t head = { .ts_ns = (uint32_t)bench_now_ns() };
+      memcpy(payload, &head, sizeof(head));
+      os_err_t err;
+      while ((err = os_evt_bus_publish(OS_MOD_IR, BENCH_EVT_ID, payload, (uint16_t)cfg->payload)) == OS_EFULL &&
+             cfg->saturate) {
+        taskYIELD();
+      }
+      res->attempts++;
+      res->dropped += err != OS_OK;
+    }
+    if (!cfg->saturate) {
+      res->publish_ns += bench_now_ns() - t0;
+      vTaskDelay(1);
+    }
+  }
+  xSemaphoreGive(s_bench.done);
+  vTaskDelete(NULL);
+}
+
+/* =========================
+ * One configuration
+ * ========================= */
+static int cmp_u32(const void *a, const void *b)
+{
+  uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+  return (x > y) - (x < y);
+}
+
+static uint32_t percentile(const uint32_t *sorted, uint32_t n, uint32_t pct)
+{
+  return n == 0 ? 0 : sorted[(uint64_t)(n - 1u) * pct / 100u];
+}
+
+/* Wait until the dispatcher took everything that was accepted */
+static bool bench_drain(os_evt_bus_stats_t *stats)
+{
+  for (TickType_t waited = 0; waited <= pdMS_TO_TICKS(BENCH_DRAIN_TIMEOUT_MS); waited++) {
+    os_evt_bus_get_stats(stats);
+    if (stats->dispatched == stats->published) {
+      return true;
+    }
+    vTaskDelay(1);
+  }
+  return false;
+}
+
+/* Returns the ns from creating the publishers until the last expected delivery (saturated phase) */
+static uint64_t bench_phase(const bench_cfg_t *cfg, os_evt_bus_stats_t *stats)
+{
+  UBaseType_t prio = cfg->saturate ? BENCH_DISPATCH_PRIO : BENCH_DISPATCH_PRIO + 1;
+
+  os_evt_bus_init();
+  for (uint32_t s = 0; s < cfg->subs; s++) {
+    os_evt_bus_subscribe(BENCH_EVT_ID, s == 0 ? cb_first : cb_other, NULL);
+  }
+  memset(s_bench.pub, 0, sizeof(s_bench.pub));
+  s_bench.lat_count = 0;
+  s_bench.delivered = 0;
+  s_bench.expected = cfg->saturate ? BENCH_EVT_BUS_EVENTS / cfg->publishers * cfg->publishers : 0;
+  s_bench.last_ns = 0;
+  s_bench.cfg = *cfg;
+
+  uint64_t t0 = bench_now_ns();
+  for (uint32_t p = 0; p < cfg->publishers; p++) {
+    xTaskCreate(publisher_task, "bench_pub", BENCH_PUB_STACK, (void *)(uintptr_t)p, prio, NULL);
+  }
+  for (uint32_t p = 0; p < cfg->publishers; p++) {
+    xSemaphoreTake(s_bench.done, portMAX_DELAY);
+  }
+  if (!bench_drain(stats)) {
+    ESP_LOGW(TAG, "dispatcher did not drain: %" PRIu32 " of %" PRIu32, stats->dispatched, stats->published);
+  }
+  return s_bench.last_ns > t0 ? s_bench.last_ns - t0 : 0;
+}
+
+static void bench_config(uint32_t subs, uint32_t payload, uint32_t publishers)
+{
+  bench_cfg_t cfg = { .subs = subs, .payload = payload, .publishers = publishers };
+  os_evt_bus_stats_t stats;
+  uint32_t attempts = 0, dropped = 0, publish_ns = 0;
+  uint64_t busy_ns = 0;
+
+  /* Paced: publish cost, latency, drops */
+  bench_phase(&cfg, &stats);
+  for (uint32_t p = 0; p < publishers; p++) {
+    attempts += s_bench.pub[p].attempts;
+    dropped += s_bench.pub[p].dropped;
+    busy_ns += s_bench.pub[p].publish_ns;
+  }
+  if (attempts > 0) {
+    publish_ns = (uint32_t)(busy_ns / attempts);
+    publish_ns = publish_ns > s_bench.clock_ns ? publish_ns - s_bench.clock_ns : 0;
+  }
+  uint32_t n = s_bench.lat_count;
+  qsort(s_bench.lat_ns, n, sizeof(s_bench.lat_ns[0]), cmp_u32);
+  uint32_t p50 = percentile(s_bench.lat_ns, n, 50), p90 = percentile(s_bench.lat_ns, n, 90);
+  uint32_t p99 = percentile(s_bench.lat_ns, n, 99), max = n ? s_bench.lat_ns[n - 1u] : 0;
+
+  /* Saturated: throughput */
+  cfg.saturate = true;
+  uint64_t elapsed_ns = bench_phase(&cfg, &stats);
+  uint64_t events_per_s = elapsed_ns ? (uint64_t)s_bench.expected * 1000000000u / elapsed_ns : 0;
+
+  printf("EVTBENCH:{\"subs\":%" PRIu32 ",\"payload\":%" PRIu32 ",\"publishers\":%" PRIu32
+         ",\"queue_depth\":%u,\"events\":%" PRIu32 ",\"publish_ns\":%" PRIu32
+         ",\"lat_ns\":{\"p50\":%" PRIu32 ",\"p90\":%" PRIu32 ",\"p99\":%" PRIu32 ",\"max\":%" PRIu32 "}"
+         ",\"events_per_s\":%" PRIu64 ",\"drop_rate\":%.4f}\n",
+         subs, payload, publishers, (unsigned)OS_EVT_BUS_QUEUE_DEPTH, attempts,
+         publish_ns, p50, p90, p99, max, events_per_s, attempts ? (double)dropped / attempts : 0.0);
+}
+
+/* =========================
+ * app_main: sweep, print, exit (linux) or idle (board)
+ * ========================= */
+void app_main(void)
+{
+  s_bench.done = xSemaphoreCreateCounting(BENCH_EVT_BUS_MAX_PUBLISHERS, 0);
+  os_evt_bus_init();
+  if (s_bench.done == NULL || os_evt_bus_start_dispatcher(BENCH_DISPATCH_PRIO, BENCH_DISPATCH_STACK) != OS_OK) {
+    ESP_LOGE(TAG, "setup failed");
+    return;
+  }
+
+  s_bench.clock_ns = bench_clock_ns();
+  printf("EVTBENCH:{\"bench\":\"evt_bus\",\"schema\":1,\"rev\":\"%s\",\"target\":\"%s\",\"queue_depth\":%u,"
+         "\"lanes\":%u,\"max_batch\":%u,\"inline_max\":%u,\"burst\":%u,\"tick_hz\":%u,\"clock_ns\":%" PRIu32 "}\n",
+         BENCH_EVT_BUS_REV, CONFIG_IDF_TARGET, (unsigned)OS_EVT_BUS_QUEUE_DEPTH, (unsigned)OS_EVT_BUS_LANES,
+         (unsigned)OS_EVT_BUS_MAX_BATCH, (unsigned)OS_EVT_INLINE_MAX, (unsigned)BENCH_EVT_BUS_BURST,
+         (unsigned)configTICK_RATE_HZ, s_bench.clock_ns);
+
+  for (uint32_t subs = 1; subs <= OS_EVT_BUS_MAX_SUBS_PER_EVT; subs *= 2u) {
+    for (uint32_t payload = sizeof(bench_payload_t); payload <= OS_EVT_INLINE_MAX; payload *= 2u) {
+      for (uint32_t publishers = 1; publishers <= BENCH_EVT_BUS_MAX_PUBLISHERS; publishers *= 2u) {
+        bench_config(subs, payload, publishers);
+      }
+    }
+  }
+  printf("EVTBENCH:{\"done\":true}\n");
+  fflush(stdout);
+
+#if CONFIG_IDF_TARGET_LINUX
+  exit(0);
+#else
+  while (1) {
+    vTaskDelay(pdMS_TO_TICKS(1000));
+  }
+#endif
+}
@@ -0,0 +1,139 @@
+#!/usr/bin/env python3
+"""Collect bench_evt_bus results from console logs and compare them with a baseline.
+
+Input is one or more captured logs of apps/bench_evt_bus (one per queue
+depth build, typically). Lines tagged "EVTBENCH:" carry one JSON object
+each; ESP log prefixes, timestamps and colour codes around them are
+ignored. The runs are printed as a table and, with -o, written as one JSON
+document:
+
+  {"meta": [<meta object of each log>], "runs": [<one object per configuration>]}
+
+With --baseline (a document written by -o, e.g. from the previous commit),
+every configuration present in both is compared and the script exits 1 if a
+metric got worse by more than the tolerance: publish_ns, lat_ns.p99 and
+drop_rate going up, events_per_s going down.
+"""
+
+import argparse
+import json
+import re
+import sys
+import typing as t
+from pathlib import Path
+
+
+RE_BENCH_LINE = re.compile(r"EVTBENCH:\s*(\{.*\})")
+ANSI_ESCAPE_RE = re.compile(r"\x1B(?:[@-Z\\-_]|\[[0-?]*[ -/]*[@-~])")
+
+KEY = ("queue_depth", "subs", "payload", "publishers")
+
+# (label, getter, higher is worse)
+METRICS: t.List[t.Tuple[str, t.Callable[[dict], float], bool]] = [
+    ("publish_ns", lambda r: r["publish_ns"], True),
+    ("lat_p99_ns", lambda r: r["lat_ns"]["p99"], True),
+    ("events_per_s", lambda r: r["events_per_s"], False),
+    ("drop_rate", lambda r: r["drop_rate"], True),
+]
+
+# Drop rates near zero make relative changes meaningless
+DROP_RATE_SLACK = 0.01
+
+
+def parse_log(text: str) -> t.Tuple[t.List[dict], t.List[dict], bool]:
+    meta, runs, done = [], [], False
+    for line in ANSI_ESCAPE_RE.sub("", text).splitlines():
+        m = RE_BENCH_LINE.search(line)
+        if not m:
+            continue
+        obj = json.loads(m.group(1))
+        if "bench" in obj:
+            meta.append(obj)
+        elif obj.get("done"):
+            done = True
+        else:
+            runs.append(obj)
+    return meta, runs, done
+
+
+def run_key(run: dict) -> t.Tuple[int, ...]:
+    return tuple(int(run[k]) for k in KEY)
+
+
+def print_table(runs: t.List[dict], out: t.TextIO) -> None:
+    out.write(f"{'depth':>5} {'subs':>4} {'bytes':>5} {'pubs':>4}  {'publish':>9}  {'p50':>9} {'p90':>9} "
+              f"{'p99':>9} {'max':>10}  {'events/s':>10}  {'drops':>6}\n")
+    for r in sorted(runs, key=run_key):
+        lat = r["lat_ns"]
+        out.write(f"{r['queue_depth']:>5} {r['subs']:>4} {r['payload']:>5} {r['publishers']:>4}  "
+                  f"{r['publish_ns']:>6} ns  {lat['p50']:>9} {lat['p90']:>9} {lat['p99']:>9} {lat['max']:>10}  "
+                  f"{r['events_per_s']:>10}  {100.0 * r['drop_rate']:>5.1f}%\n")
+
+
+def compare(base: t.List[dict], runs: t.List[dict], tolerance: float, out: t.TextIO) -> int:
+    base_by_key = {run_key(r): r for r in base}
+    regressions = compared = 0
+    for r in sorted(runs, key=run_key):
+        b = base_by_key.get(run_key(r))
+        if b is None:
+            continue
+        compared += 1
+        for label, get, higher_is_worse in METRICS:
+            old, new = float(get(b)), float(get(r))
+            if label == "drop_rate":
+                worse = new > old + DROP_RATE_SLACK
+            elif higher_is_worse:
+                worse = new > old * (1.0 + tolerance)
+            else:
+                worse = new < old * (1.0 - tolerance)
+            if worse:
+                regressions += 1
+                change = f"{100.0 * (new - old) / old:+.0f}%" if old else "new"
+                out.write(f"regression: depth={r['queue_depth']} subs={r['subs']} payload={r['payload']} "
+                          f"publishers={r['publishers']}: {label} {old:g} -> {new:g} ({change})\n")
+    out.write(f"\n{compared} configurations compared, {regressions} regressions "
+              f"(tolerance {100.0 * tolerance:.0f}%)\n")
+    return regressions
+
+
+def main(argv: t.Optional[t.List[str]] = None) -> int:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("logs", nargs="+", type=Path, help="console logs with EVTBENCH: lines")
+    parser.add_argument("-o", "--output", type=Path, help="write the collected results as JSON here")
+    parser.add_argument("--baseline", type=Path, help="results JSON (from -o) to compare against")
+    parser.add_argument("--tolerance", type=float, default=0.10,
+                        help="relative change counted as a regression (default 0.10)")
+    args = parser.parse_args(argv)
+
+    meta: t.List[dict] = []
+    runs: t.List[dict] = []
+    try:
+        for path in args.logs:
+            log_meta, log_runs, done = parse_log(path.read_text(encoding="utf-8", errors="ignore"))
+            if not done:
+                print(f"warning: {path}: no end marker, the sweep may have been cut short", file=sys.stderr)
+            meta += log_meta
+            runs += log_runs
+        base = json.loads(args.baseline.read_text(encoding="utf-8"))["runs"] if args.baseline else None
+    except (OSError, ValueError, KeyError) as err:
+        print(f"error: {err}", file=sys.stderr)
+        return 1
+    if not runs:
+        print("error: no EVTBENCH results found", file=sys.stderr)
+        return 1
+
+    for m in meta:
+        print(f"{m.get('target')} rev {m.get('rev')}: queue depth {m.get('queue_depth')}, "
+              f"{m.get('lanes')} lanes, batch {m.get('max_batch')}, burst {m.get('burst')}")
+    print_table(runs, sys.stdout)
+    if args.output:
+        args.output.write_text(json.dumps({"meta": meta, "runs": runs}, indent=1) + "\n", encoding="utf-8")
+        print(f"\nresults: {args.output}")
+    if base is not None:
+        print()
+        return 1 if compare(base, runs, args.tolerance, sys.stdout) else 0
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
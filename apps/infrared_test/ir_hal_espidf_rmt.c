@@ -0,0 +1,176 @@
+/*
+ * ir_hal_espidf_rmt.c — ir_hal binding for the ESP-IDF RMT driver
+ */
+
+#include <string.h>
+#include "esp_check.h"
+#include "esp_timer.h"
+#include "soc/soc_caps.h"
+#include "ir_hal_espidf_rmt.h"
+
+static const char *TAG = "ir_hal_rmt";
+
+static bool ir_hal_espidf_stream_done(rmt_channel_handle_t channel, const rmt_rx_done_event_data_t *edata, void *user_data)
+{
+    BaseType_t high_task_wakeup = pdFALSE;
+    ir_hal_espidf_stream_t *stream = (ir_hal_espidf_stream_t *)user_data;
+    bool last = edata->flags.is_last;
+
+    // the driver reuses chunk_buf for the next chunk, copy it out now
+    ir_frame_slot_t *slot = ir_frame_ring_write_slot(stream->ring);
+    if (slot != NULL) {
+        size_t n = edata->num_symbols;
+        if (n > IR_FRAME_MAX_SYMBOLS) {
+            n = IR_FRAME_MAX_SYMBOLS;
+        }
+        memcpy(slot->symbols, edata->received_symbols, n * sizeof(rmt_symbol_word_t));
+        slot->flags = last ? IR_FRAME_F_LAST : 0;
+        slot->ts_us = (uint32_t)esp_timer_get_time();
+        ir_frame_ring_commit(stream->ring, edata->num_symbols);
+        vTaskNotifyGiveFromISR(stream->notify_task, &high_task_wakeup);
+    } else {
+        ir_frame_ring_overrun(stream->ring);
+    }
+
+    if (last) {
+        rmt_receive(channel, stream->chunk_buf, sizeof(stream->chunk_buf), &stream->receive_config);
+    }
+    return high_task_wakeup == pdTRUE;
+}
+
+esp_err_t ir_hal_espidf_stream_bind(ir_hal_espidf_stream_t *stream, rmt_channel_handle_t channel,
+                                    const rmt_receive_config_t *receive_config,
+                                    ir_frame_ring_t *ring, TaskHandle_t notify_task)
+{
+    ESP_RETURN_ON_FALSE(stream && channel && receive_config && ring && notify_task, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    stream->channel = channel;
+    stream->receive_config = *receive_config;
+    stream->receive_config.flags.en_partial_rx = true;
+    stream->ring = ring;
+    stream->notify_task = notify_task;
+
+    rmt_rx_event_callbacks_t cbs = {
+        .on_recv_done = ir_hal_espidf_stream_done,
+    };
+    return rmt_rx_register_event_callbacks(channel, &cbs, stream);
+}
+
+esp_err_t ir_hal_espidf_stream_start(ir_hal_espidf_stream_t *stream)
+{
+    return rmt_receive(stream->channel, stream->chunk_buf, sizeof(stream->chunk_buf), &stream->receive_config);
+}
+
+static bool ir_hal_espidf_tx_submit(void *ctx, const ir_slot_tx_payload_t *payload, uint32_t loop_count)
+{
+    ir_hal_espidf_tx_t *hal = (ir_hal_espidf_tx_t *)ctx;
+    rmt_transmit_config_t transmit_config = {
+        .loop_count = (int)loop_count,
+    };
+    // the driver keeps the payload pointer until the transaction is done, ir_tx keeps it alive
+    return rmt_transmit(hal->channel, hal->encoder, payload, sizeof(*payload), &transmit_config) == ESP_OK;
+}
+
+static bool ir_hal_espidf_tx_set_carrier(void *ctx, uint32_t carrier_hz, uint8_t duty_pct)
+{
+    ir_hal_espidf_tx_t *hal = (ir_hal_espidf_tx_t *)ctx;
+    if (carrier_hz == 0) {
+        return rmt_apply_carrier(hal->channel, NULL) == ESP_OK; // unmodulated
+    }
+    rmt_carrier_config_t carrier_cfg = {
+        .frequency_hz = carrier_hz,
+        .duty_cycle = duty_pct / 100.0f,
+    };
+    return rmt_apply_carrier(hal->channel, &carrier_cfg) == ESP_OK;
+}
+
+static const ir_hal_tx_ops_t s_tx_ops = {
+    .submit = ir_hal_espidf_tx_submit,
+    .set_carrier = ir_hal_espidf_tx_set_carrier,
+};
+
+static bool ir_hal_espidf_tx_done(rmt_channel_handle_t channel, const rmt_tx_done_event_data_t *edata, void *user_data)
+{
+    BaseType_t high_task_wakeup = pdFALSE;
+    ir_hal_espidf_tx_t *hal = (ir_hal_espidf_tx_t *)user_data;
+
+    if (ir_tx_on_done(hal->tx)) {
+        vTaskNotifyGiveFromISR(hal->notify_task, &high_task_wakeup);
+    } else if (hal->on_direct_done) {
+        // nothing of the engine's in flight: one of the direct transmissions
+        return hal->on_direct_done(hal->direct_user);
+    }
+    return high_task_wakeup == pdTRUE;
+}
+
+esp_err_t ir_hal_espidf_tx_bind(ir_hal_espidf_tx_t *hal, rmt_channel_handle_t channel, rmt_encoder_handle_t encoder,
+                                uint32_t resolution_hz, size_t mem_block_symbols, size_t queue_depth,
+                                ir_tx_t *tx, TaskHandle_t notify_task)
+{
+    ESP_RETURN_ON_FALSE(hal && channel && encoder && resolution_hz && queue_depth && tx && notify_task,
+                        ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    hal->hal.ops = &s_tx_ops;
+    hal->hal.ctx = hal;
+    hal->hal.resolution_hz = resolution_hz;
+    hal->hal.queue_depth = queue_depth;
+#if SOC_RMT_SUPPORT_TX_LOOP_COUNT
+    hal->hal.loop_max_symbols = mem_block_symbols;
+#else
+    hal->hal.loop_max_symbols = 0;
+#endif
+    hal->channel = channel;
+    hal->encoder = encoder;
+    hal->tx = tx;
+    hal->notify_task = notify_task;
+    hal->on_direct_done = NULL;
+    hal->direct_user = NULL;
+
+    rmt_tx_event_callbacks_t cbs = {
+        .on_trans_done = ir_hal_espidf_tx_done,
+    };
+    return rmt_tx_register_event_callbacks(channel, &cbs, hal);
+}
+
+static bool ir_hal_espidf_carrier_done(rmt_channel_handle_t channel, const rmt_rx_done_event_data_t *edata, void *user_data)
+{
+    BaseType_t high_task_wakeup = pdFALSE;
+    ir_hal_espidf_carrier_t *carrier = (ir_hal_espidf_carrier_t *)user_data;
+
+    if (edata->num_symbols == 0) {
+        rmt_receive(channel, carrier->buf, sizeof(carrier->buf), &carrier->receive_config);
+        return false;
+    }
+    // the buffer is left alone until the task re-arms with ir_hal_espidf_carrier_start()
+    atomic_store_explicit(&carrier->received, edata->num_symbols, memory_order_release);
+    vTaskNotifyGiveFromISR(carrier->notify_task, &high_task_wakeup);
+    return high_task_wakeup == pdTRUE;
+}
+
+esp_err_t ir_hal_espidf_carrier_bind(ir_hal_espidf_carrier_t *carrier, rmt_channel_handle_t channel,
+                                     const rmt_receive_config_t *receive_config, TaskHandle_t notify_task)
+{
+    ESP_RETURN_ON_FALSE(carrier && channel && receive_config && notify_task, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    carrier->channel = channel;
+    carrier->receive_config = *receive_config;
+    carrier->notify_task = notify_task;
+    atomic_store(&carrier->received, 0);
+
+    rmt_rx_event_callbacks_t cbs = {
+        .on_recv_done = ir_hal_espidf_carrier_done,
+    };
+    return rmt_rx_register_event_callbacks(channel, &cbs, carrier);
+}
+
+esp_err_t ir_hal_espidf_carrier_start(ir_hal_espidf_carrier_t *carrier)
+{
+    atomic_store_explicit(&carrier->received, 0, memory_order_relaxed);
+    return rmt_receive(carrier->channel, carrier->buf, sizeof(carrier->buf), &carrier->receive_config);
+}
+
+size_t ir_hal_espidf_carrier_take(ir_hal_espidf_carrier_t *carrier, const rmt_symbol_word_t **symbols)
+{
+    *symbols = carrier->buf;
+    return atomic_load_explicit(&carrier->received, memory_order_acquire);
+}
@@ -0,0 +1,160 @@
+/*
+ * ir_hal_espidf_rmt.h — ir_hal binding for the ESP-IDF RMT driver
+ */
+#pragma once
+
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/rmt_rx.h"
+#include "driver/rmt_tx.h"
+#include "ir_hal.h"
+#include "ir_tx.h"
+#include "ir_frame_ring.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Symbols per partial-receive chunk, the RMT hands over a chunk whenever this many arrived
+ */
+#define IR_HAL_ESPIDF_CHUNK_SYMBOLS 64
+
+/**
+ * @brief Streaming (partial) receive into an ir_frame_ring of chunks
+ *
+ * Frames of any length arrive as a series of chunks. The RX callback copies
+ * each chunk into the next ring slot, tagged with a timestamp and
+ * IR_FRAME_F_LAST on the final chunk, and re-arms the channel from the ISR
+ * after the final one. The task feeds the slots to ir_capture_push().
+ */
+typedef struct {
+    rmt_channel_handle_t channel;        /*!< RMT RX channel */
+    rmt_receive_config_t receive_config; /*!< Receive configuration, en_partial_rx forced on */
+    ir_frame_ring_t *ring;               /*!< Chunk ring, consumed by the task */
+    TaskHandle_t notify_task;            /*!< Task notified once per chunk */
+    rmt_symbol_word_t chunk_buf[IR_HAL_ESPIDF_CHUNK_SYMBOLS]; /*!< Buffer the RMT driver writes into */
+} ir_hal_espidf_stream_t;
+
+/**
+ * @brief Bind an RMT RX channel for streaming receive
+ *
+ * @param[out] stream Binding, must outlive the channel
+ * @param[in] channel RMT RX channel, not yet enabled
+ * @param[in] receive_config Receive configuration (partial receive is enabled here)
+ * @param[in] ring Chunk ring, initialised by the caller
+ * @param[in] notify_task Task to wake per chunk
+ * @return
+ *      - ESP_OK: Bound successfully
+ *      - ESP_ERR_INVALID_ARG: Bad argument
+ */
+esp_err_t ir_hal_espidf_stream_bind(ir_hal_espidf_stream_t *stream, rmt_channel_handle_t channel,
+                                    const rmt_receive_config_t *receive_config,
+                                    ir_frame_ring_t *ring, TaskHandle_t notify_task);
+
+/**
+ * @brief Start the first receive, after rmt_enable()
+ */
+esp_err_t ir_hal_espidf_stream_start(ir_hal_espidf_stream_t *stream);
+
+/**
+ * @brief Called from the TX-done ISR; returns true if a higher priority task was woken
+ */
+typedef bool (*ir_hal_espidf_isr_cb_t)(void *user);
+
+/**
+ * @brief ir_hal transmit binding for an RMT TX channel
+ */
+typedef struct {
+    ir_hal_tx_t hal;              /*!< Pass to ir_tx_init() */
+    rmt_channel_handle_t channel; /*!< RMT TX channel */
+    rmt_encoder_handle_t encoder; /*!< IR slot encoder, consumes ir_slot_tx_payload_t */
+    ir_tx_t *tx;                  /*!< Engine fed by the TX-done callback */
+    TaskHandle_t notify_task;     /*!< Task notified when the engine needs ir_tx_pump() */
+    ir_hal_espidf_isr_cb_t on_direct_done; /*!< Optional, set after bind: a transmission made with
+                                                rmt_transmit() outside the engine has finished */
+    void *direct_user;            /*!< Passed to on_direct_done */
+} ir_hal_espidf_tx_t;
+
+/**
+ * @brief Bind an RMT TX channel to ir_tx
+ *
+ * Registers the TX-done callback, which counts the engine's completions and
+ * wakes the task; the task queues the next transmissions with ir_tx_pump(),
+ * since rmt_transmit() cannot be called from the ISR. Hardware loops are
+ * offered for transmissions that fit mem_block_symbols on targets with
+ * SOC_RMT_SUPPORT_TX_LOOP_COUNT.
+ *
+ * @param[out] hal Binding, must outlive the channel
+ * @param[in] channel RMT TX channel, not yet enabled
+ * @param[in] encoder Encoder from rmt_new_ir_slot_encoder()
+ * @param[in] resolution_hz Channel resolution
+ * @param[in] mem_block_symbols The channel's mem_block_symbols
+ * @param[in] queue_depth The channel's trans_queue_depth
+ * @param[in] tx Engine, initialised afterwards with ir_tx_init(tx, &hal->hal)
+ * @param[in] notify_task Task to wake after each completion
+ * @return
+ *      - ESP_OK: Bound successfully
+ *      - ESP_ERR_INVALID_ARG: Bad argument
+ */
+esp_err_t ir_hal_espidf_tx_bind(ir_hal_espidf_tx_t *hal, rmt_channel_handle_t channel, rmt_encoder_handle_t encoder,
+                                uint32_t resolution_hz, size_t mem_block_symbols, size_t queue_depth,
+                                ir_tx_t *tx, TaskHandle_t notify_task);
+
+/**
+ * @brief Receive buffer of the carrier channel, in symbols (carrier periods)
+ */
+#define IR_HAL_ESPIDF_CARRIER_SYMBOLS 512
+
+/**
+ * @brief Unfiltered receive of the carrier itself, for ir_carrier
+ *
+ * A second RX channel on an unfiltered receiver, at a resolution of at least
+ * ~10 ticks per carrier period. With signal_range_max_ns above the longest
+ * carrier off phase but below the shortest space (e.g. 100 us), every
+ * receive ends after one mark, i.e. one burst of carrier periods. Targets
+ * without RX ping-pong only keep the first mem_block_symbols periods of the
+ * burst, which is still plenty for a measurement.
+ *
+ * The callback hands each burst to the task, which measures it and re-arms
+ * the channel with ir_hal_espidf_carrier_start().
+ */
+typedef struct {
+    rmt_channel_handle_t channel;        /*!< RMT RX channel */
+    rmt_receive_config_t receive_config; /*!< Used for every rmt_receive() */
+    TaskHandle_t notify_task;            /*!< Task notified per burst */
+    _Atomic size_t received;             /*!< Symbols of the finished burst, 0 while receiving */
+    rmt_symbol_word_t buf[IR_HAL_ESPIDF_CARRIER_SYMBOLS]; /*!< Buffer the RMT driver writes into */
+} ir_hal_espidf_carrier_t;
+
+/**
+ * @brief Bind an RMT RX channel for carrier measurement
+ *
+ * @param[out] carrier Binding, must outlive the channel
+ * @param[in] channel RMT RX channel on the unfiltered receiver, not yet enabled
+ * @param[in] receive_config Receive configuration for every rmt_receive()
+ * @param[in] notify_task Task to wake per burst
+ * @return
+ *      - ESP_OK: Bound successfully
+ *      - ESP_ERR_INVALID_ARG: Bad argument
+ */
+esp_err_t ir_hal_espidf_carrier_bind(ir_hal_espidf_carrier_t *carrier, rmt_channel_handle_t channel,
+                                     const rmt_receive_config_t *receive_config, TaskHandle_t notify_task);
+
+/**
+ * @brief Receive the next burst, after rmt_enable() and after every ir_hal_espidf_carrier_take() that returned symbols
+ */
+esp_err_t ir_hal_espidf_carrier_start(ir_hal_espidf_carrier_t *carrier);
+
+/**
+ * @brief Get the finished burst (task)
+ *
+ * @param[out] symbols The burst, valid until ir_hal_espidf_carrier_start()
+ * @return Symbols in the burst, 0 while still receiving
+ */
+size_t ir_hal_espidf_carrier_take(ir_hal_espidf_carrier_t *carrier, const rmt_symbol_word_t **symbols);
+
+#ifdef __cplusplus
+}
+#endif
@@ -6,310 +6,443 @@
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "freertos/queue.h"
 #include "esp_log.h"
 #include "driver/rmt_tx.h"
 #include "driver/rmt_rx.h"
 #include "ir_nec_encoder.h"
-
-#include <string.h>
+#include "ir_slot_encoder.h"
+#include "ir_pd_encoder.h"
+#include "ir_core.h"
+#include "ir_capture.h"
+#include "ir_frame_ring.h"
+#include "ir_slot.h"
+#include "ir_infer.h"
+#include "ir_carrier.h"
+#include "ir_learn.h"
+#include "retrofit_os_types.h"
+#include "os_evt_bus.h"
+#include "ir_hal_espidf_rmt.h"
+#include "esp_timer.h"
+
+#include <inttypes.h>
 #include <stdlib.h>
+#include <string.h>
 
 #define EXAMPLE_IR_RESOLUTION_HZ     1000000 // 1MHz resolution, 1 tick = 1us
 #define EXAMPLE_IR_TX_GPIO_NUM       18
 #define EXAMPLE_IR_RX_GPIO_NUM       17
-#define EXAMPLE_IR_NEC_DECODE_MARGIN 300     // Tolerance for parsing RMT symbols into bit stream
-
-/**
- * @brief NEC timing spec
- */
-#define NEC_LEADING_CODE_DURATION_0  9000
-#define NEC_LEADING_CODE_DURATION_1  4500
-#define NEC_PAYLOAD_ZERO_DURATION_0  560
-#define NEC_PAYLOAD_ZERO_DURATION_1  560
-#define NEC_PAYLOAD_ONE_DURATION_0   560
-#define NEC_PAYLOAD_ONE_DURATION_1   1690
-#define NEC_REPEAT_CODE_DURATION_0   9000
-#define NEC_REPEAT_CODE_DURATION_1   2250
+#define EXAMPLE_IR_RX_IDLE_US        12000   // same as signal_range_max_ns below
+#define EXAMPLE_IR_FRAME_GAP_US      100000  // silence that ends a capture; shorter gaps separate sub-frames
+#define EXAMPLE_IR_CAPTURE_MAX_SYMBOLS 1024  // bound of the growable capture arena
+#define EXAMPLE_IR_SLOT_TOLERANCE_PCT  10    // captures are normalized already, only merge leftover jitter
+#define EXAMPLE_IR_TX_MEM_SYMBOLS    64      // frames that fit are repeated by the hardware loop
+#define EXAMPLE_IR_TX_QUEUE_DEPTH    4       // transmissions queued in the driver at once
+#define EXAMPLE_IR_CARRIER_GPIO_NUM  16      // unfiltered receiver (e.g. TSMP58000), measures the carrier while learning
+#define EXAMPLE_IR_CARRIER_RESOLUTION_HZ 10000000 // 10MHz, ~260 ticks per 38kHz period
+#define EXAMPLE_IR_CARRIER_ON_LEVEL  0       // the unfiltered receiver pulls low while the carrier is on
+#define EXAMPLE_IR_DEFAULT_CARRIER_HZ 38000  // used when no carrier was measured
+#define EXAMPLE_IR_DEFAULT_DUTY_PCT  33
+#define EXAMPLE_IR_LEARN_PRESSES     3       // presses of the button merged into one learned command
+#define EXAMPLE_IR_LEARN_ARENA_SYMBOLS 2048  // all presses of a learn session
+#define EXAMPLE_IR_LEARN_MIN_CONFIDENCE 60   // below this the session is discarded and learning starts over
+#define EXAMPLE_EVT_BUS_TASK_PRIO    5       // dispatcher of the event bus, runs the result subscribers
+#define EXAMPLE_EVT_BUS_STACK_BYTES  3072
 
 static const char *TAG = "IR_main";
 
 /**
  * @brief Saving NEC decode results
  */
-static uint16_t s_nec_code_address;
-static uint16_t s_nec_code_command;
+static ir_nec_frame_t s_nec_code;
+
+/**
+ * @brief Pulse classification table for EXAMPLE_IR_RESOLUTION_HZ, built once in app_main
+ */
+static ir_pulse_lut_t s_pulse_lut;
 
 /**
- * @brief Check whether a duration is within expected range
+ * @brief Decode RMT symbols into NEC scan code
+ *
+ * Runs in the RX drain loop: one debug line per sub-frame, nothing per symbol.
  */
-static inline bool nec_check_in_range(uint32_t signal_duration, uint32_t spec_duration)
+static void example_parse_nec_frame(rmt_symbol_word_t *rmt_nec_symbols, size_t symbol_num)
 {
-    return (signal_duration < (spec_duration + EXAMPLE_IR_NEC_DECODE_MARGIN)) &&
-           (signal_duration > (spec_duration - EXAMPLE_IR_NEC_DECODE_MARGIN));
+    switch (symbol_num) {
+    case NEC_FRAME_SYMBOLS: // NEC normal frame
+        if (nec_parse_frame(&s_pulse_lut, rmt_nec_symbols, &s_nec_code)) {
+            ESP_LOGD(TAG, "NEC Address=%04X, Command=%04X", s_nec_code.address, s_nec_code.command);
+        }
+        break;
+    case NEC_REPEAT_SYMBOLS: // NEC repeat frame
+        if (nec_parse_frame_repeat(&s_pulse_lut, rmt_nec_symbols)) {
+            ESP_LOGD(TAG, "NEC Address=%04X, Command=%04X, repeat", s_nec_code.address, s_nec_code.command);
+        }
+        break;
+    default:
+        ESP_LOGD(TAG, "Unknown NEC frame of %d symbols", symbol_num);
+        break;
+    }
 }
 
 /**
- * @brief Check whether a RMT symbol represents NEC logic zero
+ * @brief Streaming receive: the RMT callback copies each chunk into s_rx_ring, the task assembles s_rx_capture
  */
-static bool nec_parse_logic0(rmt_symbol_word_t *rmt_nec_symbols)
+static ir_frame_ring_t s_rx_ring;
+static ir_hal_espidf_stream_t s_rx_stream;
+static ir_capture_t s_rx_capture;
+
+/**
+ * @brief Carrier of the capture in progress, measured burst by burst on the unfiltered channel
+ */
+static ir_hal_espidf_carrier_t s_carrier_rx;
+static ir_carrier_meter_t s_carrier_meter;
+
+/**
+ * @brief Learn session: the presses of one button, merged once EXAMPLE_IR_LEARN_PRESSES were collected
+ */
+static rmt_symbol_word_t s_learn_arena[EXAMPLE_IR_LEARN_ARENA_SYMBOLS];
+static rmt_symbol_word_t s_learn_out[EXAMPLE_IR_CAPTURE_MAX_SYMBOLS];
+static ir_learn_t s_learn;
+
+/**
+ * @brief Learned command replayed on RX timeout, only touched by the parser task
+ *
+ * A single pulse-distance frame is kept as its data bytes, with a preset or
+ * the timings inferred from the capture; anything else as an ir_slot blob.
+ */
+typedef struct
 {
-    return nec_check_in_range(rmt_nec_symbols->duration0, NEC_PAYLOAD_ZERO_DURATION_0) &&
-           nec_check_in_range(rmt_nec_symbols->duration1, NEC_PAYLOAD_ZERO_DURATION_1);
-}
+    const ir_pd_desc_t *pd;               // protocol of pd_bytes, NULL if the command is a blob
+    ir_pd_desc_t pd_inferred;             // pd points here for a remote without preset
+    uint8_t pd_bytes[IR_PD_MAX_BYTES];
+    size_t pd_len;
+    rmt_encoder_handle_t pd_encoder;
+    uint8_t *blob;
+    size_t len;
+    uint32_t carrier_hz;                  // measured while learning, or the default
+    uint8_t duty_pct;
+} learned_cmd_t;
+
+static learned_cmd_t s_learned_cmd = {0};
+
+static ir_tx_t s_tx;
+static ir_hal_espidf_tx_t s_tx_hal;
+static ir_tx_step_t s_replay_step;
 
 /**
- * @brief Check whether a RMT symbol represents NEC logic one
+ * @brief Report a send on the event bus; the payload is copied, nothing is allocated
  */
-static bool nec_parse_logic1(rmt_symbol_word_t *rmt_nec_symbols)
+static void example_publish_send_result(ir_result_t result)
 {
-    return nec_check_in_range(rmt_nec_symbols->duration0, NEC_PAYLOAD_ONE_DURATION_0) &&
-           nec_check_in_range(rmt_nec_symbols->duration1, NEC_PAYLOAD_ONE_DURATION_1);
+    const evt_ir_send_result_t evt = { .result = result };
+    os_evt_publish_ir_send_result(&evt);
 }
 
 /**
- * @brief Decode RMT symbols into NEC address and command
+ * @brief End of a slot routine, called from ir_tx_pump() once its last transmission has finished
  */
-static bool nec_parse_frame(rmt_symbol_word_t *rmt_nec_symbols)
+static void example_replay_done(void *user, ir_tx_result_t result)
 {
-    rmt_symbol_word_t *cur = rmt_nec_symbols;
-    uint16_t address = 0;
-    uint16_t command = 0;
-    bool valid_leading_code = nec_check_in_range(cur->duration0, NEC_LEADING_CODE_DURATION_0) &&
-                              nec_check_in_range(cur->duration1, NEC_LEADING_CODE_DURATION_1);
-    if (!valid_leading_code) {
-        return false;
-    }
-    cur++;
-    for (int i = 0; i < 16; i++) {
-        if (nec_parse_logic1(cur)) {
-            address |= 1 << i;
-        } else if (nec_parse_logic0(cur)) {
-            address &= ~(1 << i);
-        } else {
-            return false;
-        }
-        cur++;
-    }
-    for (int i = 0; i < 16; i++) {
-        if (nec_parse_logic1(cur)) {
-            command |= 1 << i;
-        } else if (nec_parse_logic0(cur)) {
-            command &= ~(1 << i);
-        } else {
-            return false;
-        }
-        cur++;
-    }
-    // save address and command
-    s_nec_code_address = address;
-    s_nec_code_command = command;
-    return true;
+    (void)user;
+    example_publish_send_result(result == IR_TX_OK ? IR_RES_OK : IR_RES_FAIL);
 }
 
 /**
- * @brief Check whether the RMT symbols represent NEC repeat code
+ * @brief TX-done ISR of the transmissions made directly with rmt_transmit()
  */
-static bool nec_parse_frame_repeat(rmt_symbol_word_t *rmt_nec_symbols)
+static bool example_direct_tx_done(void *user)
 {
-    return nec_check_in_range(rmt_nec_symbols->duration0, NEC_REPEAT_CODE_DURATION_0) &&
-           nec_check_in_range(rmt_nec_symbols->duration1, NEC_REPEAT_CODE_DURATION_1);
+    (void)user;
+    bool woken = false;
+    const evt_ir_send_result_t evt = { .result = IR_RES_OK };
+    os_evt_publish_ir_send_result_from_isr(&evt, &woken);
+    return woken;
 }
 
 /**
- * @brief Decode RMT symbols into NEC scan code and print the result
+ * @brief Subscriber of the IR results, runs in the event bus dispatcher task
  */
-static void example_parse_nec_frame(rmt_symbol_word_t *rmt_nec_symbols, size_t symbol_num)
+static void example_log_ir_result(const os_evt_t *evt, void *user_ctx)
 {
-    printf("NEC frame start---\r\n");
-    for (size_t i = 0; i < symbol_num; i++) {
-        printf("{%d:%d},{%d:%d}\r\n", rmt_nec_symbols[i].level0, rmt_nec_symbols[i].duration0,
-               rmt_nec_symbols[i].level1, rmt_nec_symbols[i].duration1);
-    }
-    printf("---NEC frame end: ");
-    // decode RMT symbols
-    switch (symbol_num) {
-    case 34: // NEC normal frame
-        if (nec_parse_frame(rmt_nec_symbols)) {
-            printf("Address=%04X, Command=%04X\r\n\r\n", s_nec_code_address, s_nec_code_command);
+    (void)user_ctx;
+    if (evt->id == EVT_IR_LEARN_RESULT) {
+        evt_ir_learn_result_t res;
+        os_evt_read_ir_learn_result(evt, &res);
+        ESP_LOGI(TAG, "Learn result %d: %d of %d presses agree, confidence %d%%",
+                 res.result, res.used, res.presses, res.confidence_pct);
+    } else if (evt->id == EVT_IR_SEND_RESULT) {
+        evt_ir_send_result_t res;
+        os_evt_read_ir_send_result(evt, &res);
+        if (res.result != IR_RES_OK) {
+            ESP_LOGE(TAG, "Send failed at %"PRIu32" ms", evt->ts_ms);
         }
-        break;
-    case 2: // NEC repeat frame
-        if (nec_parse_frame_repeat(rmt_nec_symbols)) {
-            printf("Address=%04X, Command=%04X, repeat\r\n\r\n", s_nec_code_address, s_nec_code_command);
-        }
-        break;
-    default:
-        printf("Unknown NEC frame\r\n\r\n");
-        break;
     }
 }
 
-static bool example_rmt_rx_done_callback(rmt_channel_handle_t channel, const rmt_rx_done_event_data_t *edata, void *user_data)
-{
-    BaseType_t high_task_wakeup = pdFALSE;
-    QueueHandle_t receive_queue = (QueueHandle_t)user_data;
-    // send the received RMT symbols to the parser task
-    xQueueSendFromISR(receive_queue, edata, &high_task_wakeup);
-    return high_task_wakeup == pdTRUE;
-}
-
-//TODO: Add circular buffer here
-#define MAX_FRAME_SIZE 64
-typedef struct 
+/**
+ * @brief Store a learned waveform: as data bytes if it is one frame of a known protocol, else as a normalized ir_slot blob with sub-frames and gaps
+ */
+static bool store_rmt_waveform(const rmt_symbol_word_t *raw_symbols, size_t symbol_num,
+                               const ir_capture_seg_t *segs, size_t seg_num)
 {
-    rmt_symbol_word_t rmt_frame_data[MAX_FRAME_SIZE];
-    size_t symbol_num;
-}rmt_frame_obj_t;
-
-rmt_frame_obj_t ir_cmd = {0};
-
+    ir_carrier_t carrier = {
+        .freq_hz = EXAMPLE_IR_DEFAULT_CARRIER_HZ,
+        .duty_pct = EXAMPLE_IR_DEFAULT_DUTY_PCT,
+    };
+    if (ir_carrier_meter_result(&s_carrier_meter, &carrier))
+    {
+        ESP_LOGI(TAG, "Carrier %"PRIu32" Hz, %d%% duty from %"PRIu32" periods", carrier.freq_hz, carrier.duty_pct, carrier.periods);
+    }
+    s_learned_cmd.carrier_hz = carrier.freq_hz;
+    s_learned_cmd.duty_pct = carrier.duty_pct;
 
-static void invert_rmt_levels(const rmt_symbol_word_t *input, 
-                              rmt_symbol_word_t *output, 
-                              size_t symbol_num)
-{
-    for (size_t i = 0; i < symbol_num; i++) {
-        output[i].level0 = !input[i].level0;
-        output[i].level1 = !input[i].level1;
-        output[i].duration0 = input[i].duration0;
-        output[i].duration1 = input[i].duration1;
+    // levels are ignored, the raw capture decodes as-is
+    ir_infer_template_t tpl;
+    if (seg_num == 1)
+    {
+        const ir_pd_desc_t *pd = ir_pd_identify(EXAMPLE_IR_RESOLUTION_HZ, raw_symbols, symbol_num,
+                                                s_learned_cmd.pd_bytes, sizeof(s_learned_cmd.pd_bytes), &s_learned_cmd.pd_len);
+        if (pd == NULL && ir_infer(raw_symbols, symbol_num, EXAMPLE_IR_RESOLUTION_HZ, &tpl,
+                                   s_learned_cmd.pd_bytes, sizeof(s_learned_cmd.pd_bytes)) &&
+                tpl.pd && tpl.bit_num % 8 == 0)
+        {
+            s_learned_cmd.pd_inferred = tpl.desc;
+            s_learned_cmd.pd_len = tpl.desc.byte_num;
+            pd = &s_learned_cmd.pd_inferred;
+        }
+        const ir_pd_encoder_config_t pd_encoder_cfg = {
+            .resolution = EXAMPLE_IR_RESOLUTION_HZ,
+            .desc = pd,
+        };
+        if (pd != NULL && rmt_new_ir_pd_encoder(&pd_encoder_cfg, &s_learned_cmd.pd_encoder) == ESP_OK)
+        {
+            ESP_LOGI(TAG, "Stored %d symbols as %d %s bytes", symbol_num, s_learned_cmd.pd_len, pd->name);
+            s_learned_cmd.pd = pd;
+            return true;
+        }
     }
-}
 
-static void normalize_rmt_durations(rmt_symbol_word_t *frame, size_t symbol_num)
-{
-    for (size_t i = 0; i < symbol_num; i++) {
-        uint32_t d0 = frame[i].duration0;
-        uint32_t d1 = frame[i].duration1;
-
-        // Try to match NEC known pulse durations first
-        if (abs((int)d0 - NEC_PAYLOAD_ZERO_DURATION_0) < 200 && abs((int)d1 - NEC_PAYLOAD_ZERO_DURATION_1) < 200) {
-            frame[i].duration0 = NEC_PAYLOAD_ZERO_DURATION_0;
-            frame[i].duration1 = NEC_PAYLOAD_ZERO_DURATION_1;
-        } else if (abs((int)d0 - NEC_PAYLOAD_ONE_DURATION_0) < 200 && abs((int)d1 - NEC_PAYLOAD_ONE_DURATION_1) < 300) {
-            frame[i].duration0 = NEC_PAYLOAD_ONE_DURATION_0;
-            frame[i].duration1 = NEC_PAYLOAD_ONE_DURATION_1;
-        } else if (abs((int)d0 - NEC_LEADING_CODE_DURATION_0) < 1000 && abs((int)d1 - NEC_LEADING_CODE_DURATION_1) < 1000) {
-            frame[i].duration0 = NEC_LEADING_CODE_DURATION_0;
-            frame[i].duration1 = NEC_LEADING_CODE_DURATION_1;
-        } else if (abs((int)d0 - NEC_REPEAT_CODE_DURATION_0) < 1000 && abs((int)d1 - NEC_REPEAT_CODE_DURATION_1) < 1000) {
-            frame[i].duration0 = NEC_REPEAT_CODE_DURATION_0;
-            frame[i].duration1 = NEC_REPEAT_CODE_DURATION_1;
-        } else {
-            // Fallback: crude k-means with 2 clusters (short, long) on the fly
-            static uint32_t short_avg = 560;
-            static uint32_t long_avg = 1690;
-
-            // Normalize duration0
-            if (abs((int)d0 - (int)short_avg) < abs((int)d0 - (int)long_avg)) {
-                frame[i].duration0 = short_avg;
-            } else {
-                frame[i].duration0 = long_avg;
-            }
+    rmt_symbol_word_t *symbols = malloc(symbol_num * sizeof(rmt_symbol_word_t));
+    if (symbols == NULL)
+    {
+        ESP_LOGE(TAG, "Failure to store capture, no memory for %d symbols", symbol_num);
+        return false;
+    }
+    // snap every duration to the canonical timing clustered from this capture
+    ir_infer(raw_symbols, symbol_num, EXAMPLE_IR_RESOLUTION_HZ, &tpl, NULL, 0);
+    invert_rmt_levels(raw_symbols, symbols, symbol_num);
+    ir_infer_normalize(&tpl, symbols, symbols, symbol_num);
 
-            // Normalize duration1
-            if (abs((int)d1 - (int)short_avg) < abs((int)d1 - (int)long_avg)) {
-                frame[i].duration1 = short_avg;
-            } else {
-                frame[i].duration1 = long_avg;
-            }
-        }
+    const ir_slot_encode_cfg_t slot_cfg = {
+        .resolution_hz = EXAMPLE_IR_RESOLUTION_HZ,
+        .tolerance_pct = EXAMPLE_IR_SLOT_TOLERANCE_PCT,
+    };
+    const ir_slot_meta_t slot_meta = {
+        .carrier_hz = s_learned_cmd.carrier_hz,
+        .duty_pct = s_learned_cmd.duty_pct,
+    };
+    size_t len = 0;
+    uint8_t *blob = NULL;
+    ir_slot_err_t err = ir_slot_encode(&slot_cfg, &slot_meta, symbols, symbol_num, segs, seg_num, NULL, 0, &len);
+    if (err == IR_SLOT_ERR_NO_SPACE && (blob = malloc(len)) != NULL)
+    {
+        err = ir_slot_encode(&slot_cfg, &slot_meta, symbols, symbol_num, segs, seg_num, blob, len, &len);
+    }
+    free(symbols);
+    if (blob == NULL || err != IR_SLOT_OK)
+    {
+        ESP_LOGE(TAG, "Failure to store capture, slot encode error %d", err);
+        free(blob);
+        return false;
     }
-}
 
-static void normalize_rmt_frame(const rmt_symbol_word_t *input_frame, 
-                                rmt_symbol_word_t *output_frame,
-                                size_t symbol_num)
-{
-    invert_rmt_levels(input_frame, output_frame, symbol_num);
-    normalize_rmt_durations(output_frame, symbol_num);
+    ESP_LOGI(TAG, "Stored %d symbols as a %d byte slot", symbol_num, len);
+    s_learned_cmd.blob = blob;
+    s_learned_cmd.len = len;
+    return true;
 }
 
-
 /**
- * @brief Store the rmt frame
- * 
- * @param rmt_nec_symbols 
- * @param symbol_num 
+ * @brief Add a complete capture to the learn session; after the last press store the consensus and report it
  */
-static void store_rmt_frame(rmt_symbol_word_t *rmt_nec_symbols, size_t symbol_num)
+static void learn_rmt_capture(const ir_capture_t *cap)
 {
-    //TODO: Remove the static counter when button is implemented
-    static uint8_t cnt = 0;
-    if (cnt > 0 )
+    //TODO: Start a session per learn request when the button / command channel is implemented
+    if (s_learned_cmd.pd != NULL || s_learned_cmd.len != 0)
     {
         return;
     }
 
-    // TODO: Add concurrency safety in the form of a circular buffer
-    if (symbol_num > MAX_FRAME_SIZE)
+    size_t symbol_num;
+    const rmt_symbol_word_t *symbols = ir_capture_symbols(cap, &symbol_num);
+    ir_learn_err_t err = ir_learn_add(&s_learn, symbols, symbol_num, cap->segs, cap->seg_num);
+    if (err == IR_LEARN_OK && ir_learn_press_num(&s_learn) < EXAMPLE_IR_LEARN_PRESSES)
+    {
+        ESP_LOGD(TAG, "Learn: press %d of %d", ir_learn_press_num(&s_learn), EXAMPLE_IR_LEARN_PRESSES);
+        return;
+    }
+    if (err != IR_LEARN_OK && ir_learn_press_num(&s_learn) == 0)
     {
-        ESP_LOGE(TAG, "Failure to store frame, symbol num (%d) > MAX_FRAME_SIZE (%d)", symbol_num, MAX_FRAME_SIZE);
+        ESP_LOGW(TAG, "Learn: capture of %d symbols does not fit the session", symbol_num);
         return;
     }
-    
 
-    memcpy(ir_cmd.rmt_frame_data, rmt_nec_symbols, symbol_num * sizeof(rmt_symbol_word_t));
-    ir_cmd.symbol_num = symbol_num;
+    // enough presses, or the arena is full: merge what was collected
+    ir_learn_result_t res;
+    evt_ir_learn_result_t evt = {
+        .result = IR_RES_FAIL,
+        .slot = 0,
+    };
+    err = ir_learn_consensus(&s_learn, s_learn_out, EXAMPLE_IR_CAPTURE_MAX_SYMBOLS, &res);
+    evt.presses = res.presses;
+    evt.used = res.used;
+    evt.confidence_pct = res.confidence_pct;
+    if (err == IR_LEARN_OK && res.confidence_pct >= EXAMPLE_IR_LEARN_MIN_CONFIDENCE &&
+            store_rmt_waveform(s_learn_out, res.symbol_num, res.segs, res.seg_num))
+    {
+        evt.result = IR_RES_OK;
+    }
+    // the consensus is too long for the RX-done ISR; the result is published from here, the capture task
+    os_evt_publish_ir_learn_result(&evt);
 
+    ir_learn_reset(&s_learn);
+    ir_carrier_meter_init(&s_carrier_meter, EXAMPLE_IR_CARRIER_RESOLUTION_HZ, EXAMPLE_IR_CARRIER_ON_LEVEL);
+}
 
-    cnt++;
+/**
+ * @brief Handle a complete capture: decode every sub-frame and keep the first capture
+ */
+static void example_handle_capture(const ir_capture_t *cap)
+{
+    size_t symbol_num;
+    rmt_symbol_word_t *symbols = (rmt_symbol_word_t *)ir_capture_symbols(cap, &symbol_num);
+
+    ESP_LOGD(TAG, "capture: %d symbols in %d sub-frames, %"PRIu32" clipped", symbol_num, cap->seg_num, cap->clipped_symbols);
+    for (size_t i = 0; i < cap->seg_num; i++) {
+        example_parse_nec_frame(&symbols[cap->segs[i].offset], cap->segs[i].symbol_num);
+    }
+    learn_rmt_capture(cap);
 }
 
-static void save_rmt_cmd(rmt_symbol_word_t *raw_symbols, size_t symbol_num)
+/**
+ * @brief Measure a finished carrier burst and listen for the next one
+ */
+static void example_drain_carrier(void)
 {
-    rmt_symbol_word_t normalized[MAX_FRAME_SIZE] = {0};
-    normalize_rmt_frame(raw_symbols, normalized, symbol_num);
-    store_rmt_frame(normalized, symbol_num);
+    const rmt_symbol_word_t *symbols;
+    size_t symbol_num = ir_hal_espidf_carrier_take(&s_carrier_rx, &symbols);
+
+    if (symbol_num == 0) {
+        return;
+    }
+    ir_carrier_meter_push(&s_carrier_meter, symbols, symbol_num);
+    ESP_ERROR_CHECK(ir_hal_espidf_carrier_start(&s_carrier_rx));
 }
 
+/**
+ * @brief Feed pending RX chunks into s_rx_capture
+ */
+static void example_drain_rx_chunks(void)
+{
+    static uint32_t expected_seq = 0;
+    static bool resync = false;
+    ir_frame_slot_t *chunk;
+
+    while ((chunk = ir_frame_ring_peek(&s_rx_ring)) != NULL) {
+        bool last = chunk->flags & IR_FRAME_F_LAST;
+
+        if (chunk->seq != expected_seq) {
+            // chunks were dropped, the receive they belonged to is unusable
+            ESP_LOGW(TAG, "lost %"PRIu32" RX chunks", chunk->seq - expected_seq);
+            ir_capture_reset(&s_rx_capture);
+            resync = true;
+        }
+        expected_seq = chunk->seq + 1;
+
+        if (resync) {
+            resync = !last;
+        } else if (ir_capture_push(&s_rx_capture, chunk->symbols, chunk->symbol_num, last, chunk->ts_us) == IR_CAPTURE_NEW_FRAME) {
+            example_handle_capture(&s_rx_capture);
+            ir_capture_reset(&s_rx_capture);
+            ir_capture_push(&s_rx_capture, chunk->symbols, chunk->symbol_num, last, chunk->ts_us);
+        }
+        ir_frame_ring_release(&s_rx_ring);
+    }
+}
 
 void app_main(void)
 {
+    ir_pulse_lut_init(&s_pulse_lut, EXAMPLE_IR_RESOLUTION_HZ);
+    ir_frame_ring_init(&s_rx_ring);
+    ir_capture_config_t capture_cfg = {
+        .resolution_hz = EXAMPLE_IR_RESOLUTION_HZ,
+        .idle_us = EXAMPLE_IR_RX_IDLE_US,
+        .frame_gap_us = EXAMPLE_IR_FRAME_GAP_US,
+        .max_symbols = EXAMPLE_IR_CAPTURE_MAX_SYMBOLS,
+    };
+    ESP_ERROR_CHECK(ir_capture_init(&s_rx_capture, &capture_cfg) ? ESP_OK : ESP_ERR_NO_MEM);
+    ir_learn_config_t learn_cfg = {
+        .resolution_hz = EXAMPLE_IR_RESOLUTION_HZ,
+        .arena = s_learn_arena,
+        .arena_symbols = EXAMPLE_IR_LEARN_ARENA_SYMBOLS,
+    };
+    ESP_ERROR_CHECK(ir_learn_init(&s_learn, &learn_cfg) == IR_LEARN_OK ? ESP_OK : ESP_ERR_INVALID_ARG);
+
+    ESP_LOGI(TAG, "start event bus");
+    os_evt_bus_init();
+    ESP_ERROR_CHECK(os_evt_bus_start_dispatcher(EXAMPLE_EVT_BUS_TASK_PRIO, EXAMPLE_EVT_BUS_STACK_BYTES) == OS_OK ? ESP_OK : ESP_ERR_NO_MEM);
+    os_evt_subscribe_ir_learn_result(example_log_ir_result, NULL);
+    os_evt_subscribe_ir_send_result(example_log_ir_result, NULL);
+
     ESP_LOGI(TAG, "create RMT RX channel");
     rmt_rx_channel_config_t rx_channel_cfg = {
         .clk_src = RMT_CLK_SRC_DEFAULT,
         .resolution_hz = EXAMPLE_IR_RESOLUTION_HZ,
-        .mem_block_symbols = 64, // amount of RMT symbols that the channel can store at a time
+        .mem_block_symbols = IR_HAL_ESPIDF_CHUNK_SYMBOLS, // amount of RMT symbols that the channel can store at a time, longer frames arrive in chunks
         .gpio_num = EXAMPLE_IR_RX_GPIO_NUM,
     };
     rmt_channel_handle_t rx_channel = NULL;
     ESP_ERROR_CHECK(rmt_new_rx_channel(&rx_channel_cfg, &rx_channel));
 
-    ESP_LOGI(TAG, "register RX done callback");
-    QueueHandle_t receive_queue = xQueueCreate(1, sizeof(rmt_rx_done_event_data_t));
-    assert(receive_queue);
-    rmt_rx_event_callbacks_t cbs = {
-        .on_recv_done = example_rmt_rx_done_callback,
-    };
-    ESP_ERROR_CHECK(rmt_rx_register_event_callbacks(rx_channel, &cbs, receive_queue));
-
     // the following timing requirement is based on NEC protocol
     rmt_receive_config_t receive_config = {
         .signal_range_min_ns = 1250,     // the shortest duration for NEC signal is 560us, 1250ns < 560us, valid signal won't be treated as noise
         .signal_range_max_ns = 12000000, // the longest duration for NEC signal is 9000us, 12000000ns > 9000us, the receive won't stop early
     };
 
+    ESP_LOGI(TAG, "register RX done callback");
+    ESP_ERROR_CHECK(ir_hal_espidf_stream_bind(&s_rx_stream, rx_channel, &receive_config, &s_rx_ring, xTaskGetCurrentTaskHandle()));
+
+    ESP_LOGI(TAG, "create RMT RX channel for carrier measurement");
+    ir_carrier_meter_init(&s_carrier_meter, EXAMPLE_IR_CARRIER_RESOLUTION_HZ, EXAMPLE_IR_CARRIER_ON_LEVEL);
+    rmt_rx_channel_config_t carrier_channel_cfg = {
+        .clk_src = RMT_CLK_SRC_DEFAULT,
+        .resolution_hz = EXAMPLE_IR_CARRIER_RESOLUTION_HZ,
+        .mem_block_symbols = IR_HAL_ESPIDF_CHUNK_SYMBOLS,
+        .gpio_num = EXAMPLE_IR_CARRIER_GPIO_NUM,
+    };
+    rmt_channel_handle_t carrier_channel = NULL;
+    ESP_ERROR_CHECK(rmt_new_rx_channel(&carrier_channel_cfg, &carrier_channel));
+
+    // one receive per mark: the carrier's off phases are shorter than 100us, the spaces between marks longer
+    rmt_receive_config_t carrier_receive_config = {
+        .signal_range_min_ns = 100,
+        .signal_range_max_ns = 100000,
+    };
+    ESP_ERROR_CHECK(ir_hal_espidf_carrier_bind(&s_carrier_rx, carrier_channel, &carrier_receive_config, xTaskGetCurrentTaskHandle()));
+
     ESP_LOGI(TAG, "create RMT TX channel");
     rmt_tx_channel_config_t tx_channel_cfg = {
         .clk_src = RMT_CLK_SRC_DEFAULT,
         .resolution_hz = EXAMPLE_IR_RESOLUTION_HZ,
-        .mem_block_symbols = 64, // amount of RMT symbols that the channel can store at a time
-        .trans_queue_depth = 4,  // number of transactions that allowed to pending in the background, this example won't queue multiple transactions, so queue depth > 1 is sufficient
+        .mem_block_symbols = EXAMPLE_IR_TX_MEM_SYMBOLS, // amount of RMT symbols that the channel can store at a time
+        .trans_queue_depth = EXAMPLE_IR_TX_QUEUE_DEPTH, // ir_tx keeps up to this many transmissions pending in the background
         .gpio_num = EXAMPLE_IR_TX_GPIO_NUM,
         //.flags.invert_out = true,        // <-- Enable output inversion
     };
     rmt_channel_handle_t tx_channel = NULL;
     ESP_ERROR_CHECK(rmt_new_tx_channel(&tx_channel_cfg, &tx_channel));
 
-    ESP_LOGI(TAG, "modulate carrier to TX channel");
-    rmt_carrier_config_t carrier_cfg = {
-        .duty_cycle = 0.33,
-        .frequency_hz = 38000, // 38KHz
-    };
-    ESP_ERROR_CHECK(rmt_apply_carrier(tx_channel, &carrier_cfg));
-
     // this example won't send NEC frames in a loop
     rmt_transmit_config_t transmit_config = {
         .loop_count = 0, // no loop
@@ -322,20 +455,32 @@ void app_main(void)
     rmt_encoder_handle_t nec_encoder = NULL;
     ESP_ERROR_CHECK(rmt_new_ir_nec_encoder(&nec_encoder_cfg, &nec_encoder));
 
-    rmt_encoder_handle_t copy_encoder;
-    rmt_copy_encoder_config_t copy_enc_config = {};
-    ESP_ERROR_CHECK(rmt_new_copy_encoder(&copy_enc_config, &copy_encoder));
+    ESP_LOGI(TAG, "install IR slot encoder");
+    ir_slot_encoder_config_t slot_encoder_cfg = {
+        .resolution = EXAMPLE_IR_RESOLUTION_HZ,
+    };
+    rmt_encoder_handle_t slot_encoder = NULL;
+    ESP_ERROR_CHECK(rmt_new_ir_slot_encoder(&slot_encoder_cfg, &slot_encoder));
 
+    ESP_LOGI(TAG, "register TX done callback");
+    ESP_ERROR_CHECK(ir_hal_espidf_tx_bind(&s_tx_hal, tx_channel, slot_encoder, EXAMPLE_IR_RESOLUTION_HZ,
+                                          EXAMPLE_IR_TX_MEM_SYMBOLS, EXAMPLE_IR_TX_QUEUE_DEPTH,
+                                          &s_tx, xTaskGetCurrentTaskHandle()));
+    ir_tx_init(&s_tx, &s_tx_hal.hal);
+    s_tx_hal.on_direct_done = example_direct_tx_done;
+
+    // slots carry their own carrier, ir_tx switches per step; this one is for the direct transmissions
+    ESP_LOGI(TAG, "modulate carrier to TX channel");
+    ESP_ERROR_CHECK(ir_tx_apply_carrier(&s_tx, EXAMPLE_IR_DEFAULT_CARRIER_HZ, EXAMPLE_IR_DEFAULT_DUTY_PCT) ? ESP_OK : ESP_FAIL);
 
     ESP_LOGI(TAG, "enable RMT TX and RX channels");
     ESP_ERROR_CHECK(rmt_enable(tx_channel));
     ESP_ERROR_CHECK(rmt_enable(rx_channel));
+    ESP_ERROR_CHECK(rmt_enable(carrier_channel));
 
-    // save the received RMT symbols
-    rmt_symbol_word_t raw_symbols[64]; // 64 symbols should be sufficient for a standard NEC frame
-    rmt_rx_done_event_data_t rx_data;
-    // ready to receive
-    ESP_ERROR_CHECK(rmt_receive(rx_channel, raw_symbols, sizeof(raw_symbols), &receive_config));
+    // ready to receive, the RX callback re-arms after every receive
+    ESP_ERROR_CHECK(ir_hal_espidf_stream_start(&s_rx_stream));
+    ESP_ERROR_CHECK(ir_hal_espidf_carrier_start(&s_carrier_rx));
 
     const ir_nec_scan_code_t scan_code = {
             .address = 0xFE01,
@@ -343,49 +488,70 @@ void app_main(void)
     };
     ESP_ERROR_CHECK(rmt_transmit(tx_channel, nec_encoder, &scan_code, sizeof(scan_code), &transmit_config));
     while (1) {
-        // wait for RX done signal
-        if (xQueueReceive(receive_queue, &rx_data, pdMS_TO_TICKS(1000)) == pdPASS) {
-            // parse the receive symbols and print the result
-            save_rmt_cmd(rx_data.received_symbols, rx_data.num_symbols);
-            example_parse_nec_frame(rx_data.received_symbols, rx_data.num_symbols);
-            // start receive again
-            ESP_ERROR_CHECK(rmt_receive(rx_channel, raw_symbols, sizeof(raw_symbols), &receive_config));
-        } else {
-            //timeout, transmit predefined IR NEC packets
-            // const ir_nec_scan_code_t scan_code = {
-            //     .address = 0xFE01,
-            //     .command = 0x748B,
-            // };
-            // ESP_ERROR_CHECK(rmt_transmit(tx_channel, nec_encoder, &scan_code, sizeof(scan_code), &transmit_config));
-            // continue;
-
-            if (ir_cmd.symbol_num == 0)
-            {
-                continue;
-            }
-
-            /* Buffer data */
-            rmt_frame_obj_t cmd;
-            memcpy(&cmd.rmt_frame_data, ir_cmd.rmt_frame_data, ir_cmd.symbol_num * sizeof(rmt_symbol_word_t));
-            cmd.symbol_num = ir_cmd.symbol_num;
+        // wait for RX chunks; while a capture is open, wake up to check whether it has ended
+        TickType_t wait = s_rx_capture.seg_num ? pdMS_TO_TICKS(EXAMPLE_IR_FRAME_GAP_US / 1000) : pdMS_TO_TICKS(1000);
+        bool woken = ulTaskNotifyTake(pdTRUE, wait) > 0;
+        example_drain_carrier();
+        example_drain_rx_chunks();
+        ir_tx_pump(&s_tx);
+        if (ir_capture_is_complete(&s_rx_capture, (uint32_t)esp_timer_get_time())) {
+            example_handle_capture(&s_rx_capture);
+            ir_capture_reset(&s_rx_capture);
+            continue;
+        }
+        if (woken || s_rx_capture.seg_num) {
+            continue;
+        }
 
-            /* Replace the first element with the configured leading pulse */
-            cmd.rmt_frame_data[0] = (rmt_symbol_word_t) {
-                .level0 = 1,
-                .duration0 = 9000ULL * EXAMPLE_IR_RESOLUTION_HZ / 1000000,
-                .level1 = 0,
-                .duration1 = 4500ULL * EXAMPLE_IR_RESOLUTION_HZ / 1000000,
-            };
+        //timeout, transmit predefined IR NEC packets
+        // const ir_nec_scan_code_t scan_code = {
+        //     .address = 0xFE01,
+        //     .command = 0x748B,
+        // };
+        // ESP_ERROR_CHECK(rmt_transmit(tx_channel, nec_encoder, &scan_code, sizeof(scan_code), &transmit_config));
+        // continue;
+
+        ir_frame_ring_stats_t rx_stats;
+        ir_frame_ring_get_stats(&s_rx_ring, &rx_stats);
+        if (rx_stats.overruns || rx_stats.truncated) {
+            ESP_LOGW(TAG, "RX: %"PRIu32" chunks, %"PRIu32" overruns, %"PRIu32" truncated, high water %"PRIu32,
+                     rx_stats.committed, rx_stats.overruns, rx_stats.truncated, rx_stats.high_water);
+        }
 
-            ESP_LOGI(TAG, "Replaying stored NEC frame with %d symbols", cmd.symbol_num);
+        if ((s_learned_cmd.pd == NULL && s_learned_cmd.len == 0) || ir_tx_busy(&s_tx))
+        {
+            continue;
+        }
 
-            /* rmt_transmit is blocking */
-            esp_err_t tx_err = rmt_transmit(tx_channel, copy_encoder, cmd.rmt_frame_data, cmd.symbol_num * sizeof(rmt_symbol_word_t), &transmit_config);
+        if (s_learned_cmd.pd != NULL)
+        {
+            ESP_LOGI(TAG, "Replaying stored %s frame", s_learned_cmd.pd->name);
+            // cached, a no-op unless the carrier differs from the last transmission's
+            if (!ir_tx_apply_carrier(&s_tx, s_learned_cmd.carrier_hz, s_learned_cmd.duty_pct))
+            {
+                ESP_LOGE(TAG, "Failure to apply the %"PRIu32" Hz carrier", s_learned_cmd.carrier_hz);
+            }
+            esp_err_t tx_err = rmt_transmit(tx_channel, s_learned_cmd.pd_encoder, s_learned_cmd.pd_bytes,
+                                            s_learned_cmd.pd_len, &transmit_config);
             if (tx_err != ESP_OK)
             {
-                ESP_LOGE(TAG,"TX Failed with %d", tx_err);
+                // a successful one is reported by example_direct_tx_done()
+                example_publish_send_result(IR_RES_FAIL);
             }
+            continue;
+        }
 
+        ESP_LOGI(TAG, "Replaying stored slot of %d bytes", s_learned_cmd.len);
+
+        // repeats and gaps come from the slot; the transmissions are queued and refilled from the TX-done callback
+        const ir_tx_routine_t replay = {
+            .steps = &s_replay_step,
+            .step_num = 1,
+            .on_done = example_replay_done,
+        };
+        if (!ir_tx_step_from_slot(&s_replay_step, s_learned_cmd.blob, s_learned_cmd.len) || !ir_tx_send(&s_tx, &replay))
+        {
+            example_publish_send_result(IR_RES_FAIL);
         }
     }
 }
@@ -0,0 +1,132 @@
+/*
+ * ir_pd_encoder.c — RMT encoder for descriptor-driven pulse-distance protocols
+ *
+ * rmt_ir_nec_encoder_t with the timings taken from an ir_pd_desc_t: the copy
+ * encoder sends the leader and trailer, a bytes encoder configured with the
+ * descriptor's bit0/bit1 symbols and bit order sends the data.
+ */
+
+#include <stdlib.h>
+#include "esp_check.h"
+#include "ir_pd_encoder.h"
+
+static const char *TAG = "pd_encoder";
+
+typedef struct {
+    rmt_encoder_t base;           // the base "class", declares the standard encoder interface
+    rmt_encoder_t *copy_encoder;  // use the copy_encoder to encode the leader and trailer
+    rmt_encoder_t *bytes_encoder; // use the bytes_encoder to encode the data bytes
+    ir_pd_symbols_t symbols;      // descriptor timings with RMT representation
+    bool has_leader;
+    bool has_trailer;
+    int state;
+} rmt_ir_pd_encoder_t;
+
+static size_t rmt_encode_ir_pd(rmt_encoder_t *encoder, rmt_channel_handle_t channel, const void *primary_data, size_t data_size, rmt_encode_state_t *ret_state)
+{
+    rmt_ir_pd_encoder_t *pd_encoder = __containerof(encoder, rmt_ir_pd_encoder_t, base);
+    rmt_encode_state_t session_state = RMT_ENCODING_RESET;
+    rmt_encode_state_t state = RMT_ENCODING_RESET;
+    size_t encoded_symbols = 0;
+    rmt_encoder_handle_t copy_encoder = pd_encoder->copy_encoder;
+    rmt_encoder_handle_t bytes_encoder = pd_encoder->bytes_encoder;
+    switch (pd_encoder->state) {
+    case 0: // send leader
+        if (pd_encoder->has_leader) {
+            encoded_symbols += copy_encoder->encode(copy_encoder, channel, &pd_encoder->symbols.leader,
+                                                    sizeof(rmt_symbol_word_t), &session_state);
+            if (session_state & RMT_ENCODING_COMPLETE) {
+                pd_encoder->state = 1; // we can only switch to next state when current encoder finished
+            }
+            if (session_state & RMT_ENCODING_MEM_FULL) {
+                state |= RMT_ENCODING_MEM_FULL;
+                goto out; // yield if there's no free space to put other encoding artifacts
+            }
+        }
+    // fall-through
+    case 1: // send data bytes
+        encoded_symbols += bytes_encoder->encode(bytes_encoder, channel, primary_data, data_size, &session_state);
+        if (session_state & RMT_ENCODING_COMPLETE) {
+            pd_encoder->state = 2; // we can only switch to next state when current encoder finished
+        }
+        if (session_state & RMT_ENCODING_MEM_FULL) {
+            state |= RMT_ENCODING_MEM_FULL;
+            goto out; // yield if there's no free space to put other encoding artifacts
+        }
+    // fall-through
+    case 2: // send trailer
+        if (pd_encoder->has_trailer) {
+            encoded_symbols += copy_encoder->encode(copy_encoder, channel, &pd_encoder->symbols.trailer,
+                                                    sizeof(rmt_symbol_word_t), &session_state);
+            if (session_state & RMT_ENCODING_MEM_FULL) {
+                state |= RMT_ENCODING_MEM_FULL;
+            }
+            if (!(session_state & RMT_ENCODING_COMPLETE)) {
+                goto out; // yield, the trailer goes out after the refill
+            }
+        }
+        pd_encoder->state = RMT_ENCODING_RESET; // back to the initial encoding session
+        state |= RMT_ENCODING_COMPLETE;
+    }
+out:
+    *ret_state = state;
+    return encoded_symbols;
+}
+
+static esp_err_t rmt_del_ir_pd_encoder(rmt_encoder_t *encoder)
+{
+    rmt_ir_pd_encoder_t *pd_encoder = __containerof(encoder, rmt_ir_pd_encoder_t, base);
+    rmt_del_encoder(pd_encoder->copy_encoder);
+    rmt_del_encoder(pd_encoder->bytes_encoder);
+    free(pd_encoder);
+    return ESP_OK;
+}
+
+static esp_err_t rmt_ir_pd_encoder_reset(rmt_encoder_t *encoder)
+{
+    rmt_ir_pd_encoder_t *pd_encoder = __containerof(encoder, rmt_ir_pd_encoder_t, base);
+    rmt_encoder_reset(pd_encoder->copy_encoder);
+    rmt_encoder_reset(pd_encoder->bytes_encoder);
+    pd_encoder->state = RMT_ENCODING_RESET;
+    return ESP_OK;
+}
+
+esp_err_t rmt_new_ir_pd_encoder(const ir_pd_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder)
+{
+    esp_err_t ret = ESP_OK;
+    rmt_ir_pd_encoder_t *pd_encoder = NULL;
+    ESP_GOTO_ON_FALSE(config && ret_encoder && config->desc && config->resolution, ESP_ERR_INVALID_ARG, err, TAG, "invalid argument");
+    pd_encoder = rmt_alloc_encoder_mem(sizeof(rmt_ir_pd_encoder_t));
+    ESP_GOTO_ON_FALSE(pd_encoder, ESP_ERR_NO_MEM, err, TAG, "no mem for ir pd encoder");
+    pd_encoder->base.encode = rmt_encode_ir_pd;
+    pd_encoder->base.del = rmt_del_ir_pd_encoder;
+    pd_encoder->base.reset = rmt_ir_pd_encoder_reset;
+    pd_encoder->has_leader = config->desc->leader.mark_us != 0;
+    pd_encoder->has_trailer = config->desc->trailer.mark_us != 0;
+    pd_encoder->state = RMT_ENCODING_RESET;
+    ir_pd_symbols(config->desc, config->resolution, &pd_encoder->symbols);
+
+    rmt_copy_encoder_config_t copy_encoder_config = {};
+    ESP_GOTO_ON_ERROR(rmt_new_copy_encoder(&copy_encoder_config, &pd_encoder->copy_encoder), err, TAG, "create copy encoder failed");
+
+    rmt_bytes_encoder_config_t bytes_encoder_config = {
+        .bit0 = pd_encoder->symbols.zero,
+        .bit1 = pd_encoder->symbols.one,
+        .flags.msb_first = config->desc->msb_first,
+    };
+    ESP_GOTO_ON_ERROR(rmt_new_bytes_encoder(&bytes_encoder_config, &pd_encoder->bytes_encoder), err, TAG, "create bytes encoder failed");
+
+    *ret_encoder = &pd_encoder->base;
+    return ESP_OK;
+err:
+    if (pd_encoder) {
+        if (pd_encoder->bytes_encoder) {
+            rmt_del_encoder(pd_encoder->bytes_encoder);
+        }
+        if (pd_encoder->copy_encoder) {
+            rmt_del_encoder(pd_encoder->copy_encoder);
+        }
+        free(pd_encoder);
+    }
+    return ret;
+}
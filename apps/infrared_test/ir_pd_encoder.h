@@ -0,0 +1,40 @@
+/*
+ * ir_pd_encoder.h — RMT encoder for descriptor-driven pulse-distance protocols
+ */
+#pragma once
+
+#include <stdint.h>
+#include "driver/rmt_encoder.h"
+#include "ir_pd.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Type of IR pulse-distance encoder configuration
+ */
+typedef struct {
+    uint32_t resolution;      /*!< Encoder resolution, in Hz */
+    const ir_pd_desc_t *desc; /*!< Protocol, e.g. one of ir_pd_presets[]; must outlive the encoder */
+} ir_pd_encoder_config_t;
+
+/**
+ * @brief Create RMT encoder for any ir_pd_desc_t protocol
+ *
+ * Pass the frame's data bytes as rmt_transmit()'s payload; the encoder
+ * sends the leader, the bytes in the descriptor's bit order and the
+ * trailer, the same waveform ir_pd_expand() produces.
+ *
+ * @param[in] config Encoder configuration
+ * @param[out] ret_encoder Returned encoder handle
+ * @return
+ *      - ESP_ERR_INVALID_ARG for any invalid arguments
+ *      - ESP_ERR_NO_MEM out of memory when creating the encoder
+ *      - ESP_OK if creating encoder successfully
+ */
+esp_err_t rmt_new_ir_pd_encoder(const ir_pd_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,113 @@
+/*
+ * ir_slot_encoder.c — RMT encoder that expands ir_slot blobs on the fly
+ *
+ * Same structure as rmt_ir_nec_encoder_t: a state machine around a copy
+ * encoder that yields whenever the channel memory is full. Instead of a fixed
+ * leading/ending symbol it feeds the copy encoder from a small staging buffer
+ * that ir_slot_stream refills, so the expanded waveform never exists in RAM
+ * as a whole. The staging buffer is only refilled after the copy encoder has
+ * consumed all of it, since a MEM_FULL yield resumes from the same data.
+ */
+
+#include <stdlib.h>
+#include "esp_check.h"
+#include "ir_slot_encoder.h"
+#include "ir_slot_stream.h"
+
+static const char *TAG = "slot_encoder";
+
+typedef struct {
+    rmt_encoder_t base;           // the base "class", declares the standard encoder interface
+    rmt_encoder_t *copy_encoder;  // copies the staged symbols into RMT memory
+    uint32_t resolution;
+    ir_slot_stream_t stream;      // read position in the payload's blob
+    rmt_symbol_word_t stage[IR_SLOT_ENCODER_STAGE_SYMBOLS];
+    size_t stage_num;             // staged symbols not yet accepted by the copy encoder
+    int state;
+} rmt_ir_slot_encoder_t;
+
+static size_t rmt_encode_ir_slot(rmt_encoder_t *encoder, rmt_channel_handle_t channel, const void *primary_data, size_t data_size, rmt_encode_state_t *ret_state)
+{
+    rmt_ir_slot_encoder_t *slot_encoder = __containerof(encoder, rmt_ir_slot_encoder_t, base);
+    rmt_encode_state_t session_state = RMT_ENCODING_RESET;
+    rmt_encode_state_t state = RMT_ENCODING_RESET;
+    size_t encoded_symbols = 0;
+    rmt_encoder_handle_t copy_encoder = slot_encoder->copy_encoder;
+    switch (slot_encoder->state) {
+    case 0: // open the blob
+        slot_encoder->stage_num = 0;
+        if (data_size != sizeof(ir_slot_tx_payload_t) ||
+                ir_slot_stream_init(&slot_encoder->stream, primary_data, slot_encoder->resolution) != IR_SLOT_OK) {
+            state |= RMT_ENCODING_COMPLETE; // nothing to send
+            goto out;
+        }
+        slot_encoder->state = 1;
+    // fall-through
+    case 1: // send the waveform, one staging buffer at a time
+        for (;;) {
+            if (slot_encoder->stage_num == 0) {
+                slot_encoder->stage_num = ir_slot_stream_fill(&slot_encoder->stream, slot_encoder->stage, IR_SLOT_ENCODER_STAGE_SYMBOLS);
+                if (slot_encoder->stage_num == 0) {
+                    slot_encoder->state = RMT_ENCODING_RESET; // back to the initial encoding session
+                    state |= RMT_ENCODING_COMPLETE;
+                    break;
+                }
+            }
+            encoded_symbols += copy_encoder->encode(copy_encoder, channel, slot_encoder->stage,
+                                                    slot_encoder->stage_num * sizeof(rmt_symbol_word_t), &session_state);
+            if (session_state & RMT_ENCODING_COMPLETE) {
+                slot_encoder->stage_num = 0; // staging buffer consumed, refill on the next pass
+            }
+            if (session_state & RMT_ENCODING_MEM_FULL) {
+                state |= RMT_ENCODING_MEM_FULL;
+                goto out; // yield if there's no free space to put other encoding artifacts
+            }
+        }
+    }
+out:
+    *ret_state = state;
+    return encoded_symbols;
+}
+
+static esp_err_t rmt_del_ir_slot_encoder(rmt_encoder_t *encoder)
+{
+    rmt_ir_slot_encoder_t *slot_encoder = __containerof(encoder, rmt_ir_slot_encoder_t, base);
+    rmt_del_encoder(slot_encoder->copy_encoder);
+    free(slot_encoder);
+    return ESP_OK;
+}
+
+static esp_err_t rmt_ir_slot_encoder_reset(rmt_encoder_t *encoder)
+{
+    rmt_ir_slot_encoder_t *slot_encoder = __containerof(encoder, rmt_ir_slot_encoder_t, base);
+    rmt_encoder_reset(slot_encoder->copy_encoder);
+    slot_encoder->stage_num = 0;
+    slot_encoder->state = RMT_ENCODING_RESET;
+    return ESP_OK;
+}
+
+esp_err_t rmt_new_ir_slot_encoder(const ir_slot_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder)
+{
+    esp_err_t ret = ESP_OK;
+    rmt_ir_slot_encoder_t *slot_encoder = NULL;
+    ESP_GOTO_ON_FALSE(config && ret_encoder && config->resolution, ESP_ERR_INVALID_ARG, err, TAG, "invalid argument");
+    slot_encoder = rmt_alloc_encoder_mem(sizeof(rmt_ir_slot_encoder_t));
+    ESP_GOTO_ON_FALSE(slot_encoder, ESP_ERR_NO_MEM, err, TAG, "no mem for ir slot encoder");
+    slot_encoder->base.encode = rmt_encode_ir_slot;
+    slot_encoder->base.del = rmt_del_ir_slot_encoder;
+    slot_encoder->base.reset = rmt_ir_slot_encoder_reset;
+    slot_encoder->resolution = config->resolution;
+    slot_encoder->stage_num = 0;
+    slot_encoder->state = RMT_ENCODING_RESET;
+
+    rmt_copy_encoder_config_t copy_encoder_config = {};
+    ESP_GOTO_ON_ERROR(rmt_new_copy_encoder(&copy_encoder_config, &slot_encoder->copy_encoder), err, TAG, "create copy encoder failed");
+
+    *ret_encoder = &slot_encoder->base;
+    return ESP_OK;
+err:
+    if (slot_encoder) {
+        free(slot_encoder);
+    }
+    return ret;
+}
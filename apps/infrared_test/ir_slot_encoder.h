@@ -0,0 +1,48 @@
+/*
+ * ir_slot_encoder.h — RMT encoder that expands ir_slot blobs on the fly
+ */
+#pragma once
+
+#include <stdint.h>
+#include "driver/rmt_encoder.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Symbols expanded per copy-encoder call, the only waveform RAM the encoder holds
+ */
+#ifndef IR_SLOT_ENCODER_STAGE_SYMBOLS
+#define IR_SLOT_ENCODER_STAGE_SYMBOLS 16
+#endif
+
+/**
+ * @brief Type of IR slot encoder configuration
+ */
+typedef struct {
+    uint32_t resolution; /*!< Encoder resolution, in Hz */
+} ir_slot_encoder_config_t;
+
+/**
+ * @brief Create RMT encoder for transmitting an ir_slot blob
+ *
+ * Pass an ir_slot_tx_payload_t as rmt_transmit()'s payload. All sub-frames
+ * go out as one transaction, with the stored gaps between them and the
+ * payload's tail gap after the last one. The payload and its blob are read in
+ * place while the transaction runs and must stay valid until it is done;
+ * validate the blob with ir_slot_parse_header() first, an invalid blob
+ * transmits nothing.
+ *
+ * @param[in] config Encoder configuration
+ * @param[out] ret_encoder Returned encoder handle
+ * @return
+ *      - ESP_ERR_INVALID_ARG for any invalid arguments
+ *      - ESP_ERR_NO_MEM out of memory when creating the encoder
+ *      - ESP_OK if creating encoder successfully
+ */
+esp_err_t rmt_new_ir_slot_encoder(const ir_slot_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,16 +1,24 @@
-/* mocks.c — Sprint 0 wiring mocks (no real HW, no real bus)
+/* mocks.c — Sprint 0 wiring mocks (no real HW; events go through os_evt_bus)
  *
  * Goal: let app_main/orchestrator skeleton compile + run, and emit fake events.
  */
 
+#include <stdio.h>
 #include <string.h>
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
 #include "retrofit_os_types.h"   /* EVT_* / payload structs / os_evt_t */
+#include "os_evt_bus.h"
+#include "os_evt_trace.h"
+#include "os_sched.h"
 #include "mocks.h"
 
+#define MOCK_EVT_BUS_TASK_PRIO    5
+#define MOCK_EVT_BUS_STACK_BYTES  3072
+#define MOCK_TRACE_DUMP_STEPS     60u  /* dump the bus trace to the console this often */
+
 static const char *TAG = "MOCKS";
 
 /* -------------------------------------------------------------------------- */
@@ -28,33 +36,46 @@ static mock_wifi_t  g_wifi;
 static mock_power_t g_pwr;
 
 /* -------------------------------------------------------------------------- */
-/* Fake “event bus deliver” for Sprint 0.
- * Replace with real event_bus_publish() later.
- * For now we just log the event and (optionally) call orchestrator hook.
+/* Event delivery for Sprint 0: publish through os_evt_bus; one logging
+ * subscriber per id stands in for the orchestrator. Payloads above
+ * OS_EVT_INLINE_MAX travel in a bus pool block.
  * -------------------------------------------------------------------------- */
 
+static void mock_log_evt(const os_evt_t *evt, void *user_ctx)
+{
+  (void)user_ctx;
+  ESP_LOGI(TAG, "EVT id=%u src=%u len=%u", (unsigned)evt->id, (unsigned)evt->src, (unsigned)evt->len);
+
+  /* TODO Sprint 0: if you have an orchestrator_process(evt) stub, call it here:
+   * mock_orch_process(evt);
+   */
+}
+
 static void mock_publish(os_mod_id_t src, os_evt_id_t id, const void *payload, uint16_t len)
 {
-  os_evt_t evt = {
-    .id = id,
-    .src = src,
-    .ts_ms = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS),
-    .len = len,
-  };
-
-  if (len > OS_EVT_INLINE_MAX) {
-    ESP_LOGE(TAG, "publish drop: len=%u > OS_EVT_INLINE_MAX=%u", (unsigned)len, (unsigned)OS_EVT_INLINE_MAX);
-    return;
-  }
-  if (payload && len){
-    memcpy(evt.payload, payload, len);
+  os_err_t err = os_evt_bus_publish(src, id, payload, len);
+  if (err != OS_OK) {
+    ESP_LOGE(TAG, "publish drop: id=%u len=%u err=%d", (unsigned)id, (unsigned)len, (int)err);
   }
+}
 
-  ESP_LOGI(TAG, "EVT id=%u src=%u len=%u", (unsigned)evt.id, (unsigned)evt.src, (unsigned)evt.len);
+/* Bus trace over the console, one hex line per chunk; decode the captured log
+ * with components/retrofit_os/tools/os_evt_trace_decode.py */
+static void mock_trace_write(const void *data, size_t len, void *user_ctx)
+{
+  const uint8_t *p = data;
+  (void)user_ctx;
+  printf("EVTRACE:");
+  for (size_t i = 0; i < len; i++) {
+    printf("%02x", p[i]);
+  }
+  printf("\n");
+}
 
-  /* TODO Sprint 0: if you have an orchestrator_process(evt) stub, call it here:
-   * mock_orch_process(&evt);
-   */
+static void mock_trace_dump(void)
+{
+  size_t n = os_evt_trace_dump(mock_trace_write, NULL);
+  ESP_LOGI(TAG, "event bus trace: %u records", (unsigned)n);
 }
 
 /* -------------------------------------------------------------------------- */
@@ -90,13 +111,34 @@ os_err_t mock_power_init(void)
 }
 
 os_err_t mock_ir_init(void)      { ESP_LOGI(TAG, "mock_ir_init"); return OS_OK; }
-os_err_t mock_sched_init(void)   { ESP_LOGI(TAG, "mock_sched_init"); return OS_OK; }
 os_err_t mock_storage_init(void) { ESP_LOGI(TAG, "mock_storage_init"); return OS_OK; }
 os_err_t mock_clock_init(void)   { ESP_LOGI(TAG, "mock_clock_init"); return OS_OK; }
 os_err_t mock_cmd_init(void)     { ESP_LOGI(TAG, "mock_cmd_init"); return OS_OK; }
 os_err_t mock_orch_init(void)    { ESP_LOGI(TAG, "mock_orch_init"); return OS_OK; }
 os_err_t mock_errmgr_init(void)  { ESP_LOGI(TAG, "mock_errmgr_init"); return OS_OK; }
-os_err_t mock_event_bus_init(void) { ESP_LOGI(TAG, "mock_event_bus_init"); return OS_OK; }
+
+/* Real engine, empty table: nothing is due until a schedule is set and applied */
+os_err_t mock_sched_init(void)
+{
+  os_err_t err = os_sched_start();
+  ESP_LOGI(TAG, "mock_sched_init err=%d", (int)err);
+  return err;
+}
+
+os_err_t mock_event_bus_init(void)
+{
+  os_err_t err = os_evt_bus_init();
+  if (err == OS_OK) {
+    err = os_evt_bus_start_dispatcher(MOCK_EVT_BUS_TASK_PRIO, MOCK_EVT_BUS_STACK_BYTES);
+  }
+  for (os_evt_id_t id = EVT_NONE + 1; id < EVT__MAX && err == OS_OK; id++) {
+    if (!os_evt_bus_handle_valid(os_evt_bus_subscribe(id, mock_log_evt, NULL))) {
+      err = OS_ENOMEM;
+    }
+  }
+  ESP_LOGI(TAG, "mock_event_bus_init err=%d", (int)err);
+  return err;
+}
 
 /* -------------------------------------------------------------------------- */
 /* Mock “tick/process” to generate realistic events                            */
@@ -105,6 +147,10 @@ os_err_t mock_event_bus_init(void) { ESP_LOGI(TAG, "mock_event_bus_init"); retur
 
 void mock_system_step(uint32_t step)
 {
+  if ((step % MOCK_TRACE_DUMP_STEPS) == MOCK_TRACE_DUMP_STEPS - 1u) {
+    mock_trace_dump();
+  }
+
   if (step == 0) {
     mock_publish(OS_MOD_ORCH, EVT_HEALTH_TICK, NULL, 0);
     return;
@@ -0,0 +1,147 @@
+/*
+ * os_cmd.h — synchronous command/response channel (CMD/RSP path)
+ *
+ * The other half of DESIGN_TRADEOFFS.md §3: user-initiated commands go
+ * point to point to one target module and block for its answer, instead of
+ * going out as events that every subscriber filters. See
+ * docs/components/cmd_channel.md.
+ *
+ *   - a command is one of OS_CMD_SLOTS static slots, each with its own
+ *     OS_CMD_DATA_MAX-byte block of a static pool; the caller writes the
+ *     request into it, the target reads it and writes the response over it,
+ *     the caller reads the response there: no copy, no heap
+ *   - every target module has a bounded queue of OS_CMD_QUEUE_DEPTH pending
+ *     commands; os_cmd_call() fails with OS_EFULL instead of waiting for room
+ *   - a command's correlation id is its slot index and a generation, so a
+ *     response belongs to exactly one call and a stale id is detectable:
+ *     os_cmd_respond() and os_cmd_release() take the id and refuse one that
+ *     is not the slot's current use
+ *   - the response wakes the calling task with a direct task notification;
+ *     nothing is broadcast
+ *   - a call that times out gives its slot back to the channel; a response
+ *     that arrives later is dropped and counted
+ *
+ * Task context only. The port (port/os_cmd_port.h) supplies the lock, the
+ * notification and the clock. Wake-ups are sent after the lock is dropped,
+ * so one can land just after the woken side's call returned (timed out, or
+ * found its work without waiting): a task that calls os_cmd_call() or
+ * os_cmd_recv() must outlive those calls and not be deleted right after one.
+ */
+#ifndef OS_CMD_H
+#define OS_CMD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "retrofit_os_types.h"
+
+/* ==========================================================================
+ * Limits (compile time)
+ * ========================================================================== */
+
+#ifndef OS_CMD_SLOTS
+#define OS_CMD_SLOTS 8u /* commands in flight, all targets together; 1..255 */
+#endif
+
+#ifndef OS_CMD_QUEUE_DEPTH
+#define OS_CMD_QUEUE_DEPTH 4u /* pending commands per target; power of two, <= 128 */
+#endif
+
+#ifndef OS_CMD_DATA_MAX
+#define OS_CMD_DATA_MAX 64u /* request and response bytes of one command */
+#endif
+
+/* os_cmd_call() / os_cmd_recv(): block until it happens */
+#define OS_CMD_WAIT_FOREVER UINT32_MAX
+
+/* ==========================================================================
+ * Types
+ * ========================================================================== */
+
+/* (generation << 8) | (slot index + 1); 0 is never a live command */
+typedef uint16_t os_cmd_corr_t;
+
+typedef struct {
+  os_cmd_corr_t corr;
+  os_mod_id_t   src;
+  os_mod_id_t   target;
+  uint16_t      op;     /* command code, defined by the target */
+  uint16_t      len;    /* bytes in data: the request, then the response */
+  os_err_t      status; /* the target's result, set by os_cmd_respond() */
+  uint8_t      *data;   /* OS_CMD_DATA_MAX bytes of the static pool */
+} os_cmd_t;
+
+typedef struct {
+  uint32_t calls;      /* queued to a target */
+  uint32_t completed;  /* answered while the caller waited */
+  uint32_t timeouts;   /* os_cmd_call() gave up */
+  uint32_t late;       /* answered or taken after the caller gave up */
+  uint32_t full;       /* refused: target queue full */
+  uint32_t no_slot;    /* os_cmd_alloc() found every slot in use */
+  uint32_t in_flight;  /* slots in use now */
+  uint32_t high_water; /* most slots in use at once */
+  uint32_t mem_bytes;  /* static RAM of the channel: slots, pool and queues */
+} os_cmd_stats_t;
+
+/* ==========================================================================
+ * API
+ * ========================================================================== */
+
+/* Free every slot and empty every queue; not safe while commands are in flight */
+void os_cmd_init(void);
+
+/*
+ * Take a free slot for a command from src to target. The caller fills
+ * data/len, then calls os_cmd_call(). NULL when every slot is in use or
+ * target is not a module.
+ */
+os_cmd_t *os_cmd_alloc(os_mod_id_t src, os_mod_id_t target, uint16_t op);
+
+/*
+ * Queue cmd to its target and block until it responds or timeout_ms
+ * passes (0: do not wait). OS_OK: cmd->status, cmd->len and cmd->data hold
+ * the response. OS_EFULL: the target queue was full, nothing was sent.
+ * OS_ETIMEOUT: no response in time; the target may still see the command.
+ * OS_ESTATE: cmd was already called. Release cmd afterwards in every case.
+ */
+os_err_t os_cmd_call(os_cmd_t *cmd, uint32_t timeout_ms);
+
+/*
+ * Give cmd back; corr is the cmd->corr os_cmd_alloc() handed out (keep a
+ * copy: the field is reused with the slot). After a timeout the slot stays
+ * with the target until it responds or takes the command off its queue; do
+ * not touch cmd after this. A response that arrived after the timeout is
+ * counted late here. OS_ESTATE: corr is not the slot's current use
+ * (released twice, or the slot already serves another call).
+ */
+os_err_t os_cmd_release(os_cmd_t *cmd, os_cmd_corr_t corr);
+
+/*
+ * Target side: the oldest command queued for target, waiting up to
+ * timeout_ms for one (0: poll). NULL on timeout. One receiving task per
+ * target; that task is the one the caller wakes.
+ */
+os_cmd_t *os_cmd_recv(os_mod_id_t target, uint32_t timeout_ms);
+
+/*
+ * Target side: answer a command taken with os_cmd_recv(); corr is the
+ * cmd->corr it had when taken. The response is already in cmd->data /
+ * cmd->len; wakes the caller. The target may answer from another task,
+ * later. OS_ESTATE if cmd is not taken under corr: answered already, or
+ * the slot was freed and went to another call.
+ */
+os_err_t os_cmd_respond(os_cmd_t *cmd, os_cmd_corr_t corr, os_err_t status);
+
+/* Not safe from ISRs. mem_bytes is a constant of the build. */
+void os_cmd_get_stats(os_cmd_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OS_CMD_H */
@@ -0,0 +1,416 @@
+/*
+ * os_evt_bus.h — bounded publish/subscribe bus for os_evt_t
+ *
+ * Implements the contract in docs/components/evt_bus.md on the envelope of
+ * retrofit_os_types.h:
+ *
+ *   - publish = copy-in enqueue of an os_evt_t, never runs callbacks, never
+ *     allocates from the heap; DROP_NEW when the queue is full
+ *   - payloads up to OS_EVT_INLINE_MAX live in the queue entry; larger ones
+ *     (up to OS_EVT_BUS_POOL_BLOCK_SIZE) are copied once into a refcounted
+ *     block of a static pool, shared by every subscriber and released after
+ *     the last one ran (or released its own reference)
+ *   - state-style events (progress, battery, health, link state) may instead
+ *     coalesce: at most one pending entry per id, overwritten in place by
+ *     newer publishes, dispatched at the position of its first publish
+ *   - every id belongs to a priority lane (OS_EVT_TABLE in
+ *     retrofit_os_types.h); each lane has its own queue and counters, and the
+ *     dispatcher picks lanes strictly by priority or weighted, both with
+ *     bounded starvation of the lower lanes
+ *   - dispatch = one context (the port's dispatcher task, or a polling loop
+ *     calling os_evt_bus_dispatch_all()) runs every callback, in order
+ *     within a lane; it takes events in batches, one critical section per
+ *     batch rather than per event and callback
+ *   - a subscriber takes one id, or a bitmask of ids with one handle and one
+ *     entry (modules that follow a dozen events); dispatch tests one bit per
+ *     mask subscriber after running the event's own list
+ *   - handles are { id, index + generation }; unsubscribe is O(1) and stale
+ *     entries are cleaned lazily on dispatch and subscribe
+ *   - contention mode (os_evt_bus_set_staging()): publishers write lock-free
+ *     staging rings, one per core (per thread on the host), and the
+ *     dispatcher merges them into the lanes by stamp, so producers on both
+ *     cores stop serializing on the bus lock
+ *   - a slow subscriber may be deferred (os_evt_bus_subscribe_deferred()):
+ *     the dispatcher only copies the event into a bounded worker queue owned
+ *     by the subscribing module, and that module's worker runs the callback;
+ *     every callback is timed against its subscriber's budget
+ *
+ * The core is platform-agnostic. The port (FreeRTOS on ESP-IDF, pthreads on
+ * the host build) provides the critical section that makes publish safe from
+ * any task or ISR, the dispatcher wake-up and the timestamp clock.
+ */
+#ifndef OS_EVT_BUS_H
+#define OS_EVT_BUS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "retrofit_os_types.h"
+
+/* ==========================================================================
+ * Limits (compile time)
+ * ========================================================================== */
+
+#ifndef OS_EVT_BUS_QUEUE_DEPTH
+#define OS_EVT_BUS_QUEUE_DEPTH 16u /* per lane; power of two */
+#endif
+
+#ifndef OS_EVT_BUS_LANES
+#define OS_EVT_BUS_LANES 3u /* 2..4; classes beyond the last lane share it */
+#endif
+
+/* Dispatches per weighted round, highest lane first (OS_EVT_SCHED_WEIGHTED) */
+#ifndef OS_EVT_BUS_LANE_WEIGHTS
+#define OS_EVT_BUS_LANE_WEIGHTS { 8u, 4u, 2u, 1u }
+#endif
+
+/* OS_EVT_SCHED_STRICT: a waiting lane is served after being passed over this many times */
+#ifndef OS_EVT_BUS_STARVE_LIMIT
+#define OS_EVT_BUS_STARVE_LIMIT 16u
+#endif
+
+#ifndef OS_EVT_BUS_SCHED_DEFAULT
+#define OS_EVT_BUS_SCHED_DEFAULT OS_EVT_SCHED_STRICT
+#endif
+
+#ifndef OS_EVT_BUS_MAX_HANDLES
+#define OS_EVT_BUS_MAX_HANDLES 32u /* <= 255 */
+#endif
+
+#ifndef OS_EVT_BUS_MAX_SUBS_PER_EVT
+#define OS_EVT_BUS_MAX_SUBS_PER_EVT 4u
+#endif
+
+#ifndef OS_EVT_BUS_MAX_MASK_SUBS
+#define OS_EVT_BUS_MAX_MASK_SUBS 8u /* bitmask subscribers, bus-wide */
+#endif
+
+#ifndef OS_EVT_BUS_MAX_COALESCE
+#define OS_EVT_BUS_MAX_COALESCE 8u /* ids with OS_EVT_POLICY_COALESCE at once; power of two */
+#endif
+
+/*
+ * Events the dispatcher takes off the queues per lock (os_evt_bus_dispatch_all()).
+ * Bounds how long a newly published high-lane event waits behind a batch
+ * already taken; 1 restores per-event dispatch. Costs the dispatcher stack
+ * one os_evt_t per event plus the batch's subscriber snapshot.
+ */
+#ifndef OS_EVT_BUS_MAX_BATCH
+#define OS_EVT_BUS_MAX_BATCH 8u /* 1..255 */
+#endif
+
+#ifndef OS_EVT_BUS_POOL_BLOCKS
+#define OS_EVT_BUS_POOL_BLOCKS 8u /* large payloads in flight at once; 1..255 */
+#endif
+
+#ifndef OS_EVT_BUS_POOL_BLOCK_SIZE
+#define OS_EVT_BUS_POOL_BLOCK_SIZE 128u /* largest payload; multiple of 8 */
+#endif
+
+/*
+ * Contention mode: staging rings and entries per ring (os_evt_bus_set_staging()).
+ * A ring is picked by os_evt_bus_port_stage_index() modulo the count, so 2
+ * gives each S3 core its own.
+ */
+#ifndef OS_EVT_BUS_STAGE_RINGS
+#define OS_EVT_BUS_STAGE_RINGS 2u /* 0 compiles staging out */
+#endif
+
+#ifndef OS_EVT_BUS_STAGE_DEPTH
+#define OS_EVT_BUS_STAGE_DEPTH 16u /* power of two */
+#endif
+
+#ifndef OS_EVT_BUS_STAGING_DEFAULT
+#define OS_EVT_BUS_STAGING_DEFAULT false
+#endif
+
+/*
+ * Deferred subscribers: worker queues (one per owning module) and events per
+ * queue. A full queue drops the handoff, not the event for other subscribers.
+ */
+#ifndef OS_EVT_BUS_MAX_WORKERS
+#define OS_EVT_BUS_MAX_WORKERS 2u /* 1..8 */
+#endif
+
+#ifndef OS_EVT_BUS_WORKER_DEPTH
+#define OS_EVT_BUS_WORKER_DEPTH 8u /* power of two */
+#endif
+
+/* Callback run time above which a subscriber counts an overrun; os_evt_bus_set_budget() per handle */
+#ifndef OS_EVT_BUS_CB_BUDGET_US
+#define OS_EVT_BUS_CB_BUDGET_US 1000u /* 0: not checked */
+#endif
+
+typedef enum {
+  OS_EVT_POLICY_FIFO = 0,  /* every publish queued; DROP_NEW when full */
+  OS_EVT_POLICY_COALESCE,  /* one pending entry per id, latest payload wins; never dropped */
+} os_evt_policy_t;
+
+typedef enum {
+  OS_EVT_SCHED_STRICT = 0, /* highest non-empty lane, lower lanes promoted after OS_EVT_BUS_STARVE_LIMIT */
+  OS_EVT_SCHED_WEIGHTED,   /* OS_EVT_BUS_LANE_WEIGHTS dispatches per lane and round */
+  OS_EVT_SCHED_FIFO,       /* arrival order across lanes (no priority), for comparison */
+} os_evt_sched_t;
+
+/* OS_EVT_TABLE rows indexed by id; [EVT_NONE] is a blank row */
+extern const os_evt_meta_t os_evt_meta[EVT__MAX];
+
+/* Set of ids for os_evt_bus_subscribe_mask(); bit n = id n */
+typedef uint32_t os_evt_mask_t;
+#define OS_EVT_BIT(id) ((os_evt_mask_t)1u << (id))
+
+/* .id of a handle returned by os_evt_bus_subscribe_mask() */
+#define OS_EVT_MASK_HANDLE_ID ((os_evt_id_t)EVT__MAX)
+
+/* Returned by a failed subscribe */
+#define OS_EVT_SUB_HANDLE_INVALID ((os_evt_sub_handle_t){ .id = EVT_NONE, .slot = 0 })
+
+typedef struct {
+  uint32_t published;   /* events accepted into the queue */
+  uint32_t dropped;     /* publishes refused: queue full (DROP_NEW) */
+  uint32_t coalesced;   /* publishes merged into an already pending entry */
+  uint32_t rejected;    /* publishes refused: bad id or len > OS_EVT_BUS_POOL_BLOCK_SIZE */
+  uint32_t dispatched;  /* events taken off the queue */
+  uint32_t delivered;   /* callbacks run */
+  uint32_t healed;      /* stale subscription entries cleaned */
+  uint32_t high_water;  /* deepest lane queue seen */
+  uint32_t pool_used;   /* pool blocks referenced now */
+  uint32_t pool_high_water;
+  uint32_t pool_empty;  /* large publishes refused: no free block */
+  uint32_t staged;      /* publishes taken by a staging ring (counted in published once merged) */
+  uint32_t stage_full;  /* staged publishes that found their ring full and merged it themselves */
+  uint32_t deferred;    /* callbacks handed to a worker queue */
+  uint32_t defer_dropped; /* handoffs refused: worker queue full */
+  uint32_t overruns;    /* callbacks that ran longer than their subscriber's budget */
+  struct {
+    uint32_t published;
+    uint32_t dropped;
+    uint32_t dispatched;
+    uint32_t depth;      /* queued now (FIFO + pending coalesced) */
+    uint32_t high_water;
+    uint32_t promoted;   /* served ahead of a higher lane to bound starvation */
+  } lane[OS_EVT_BUS_LANES];
+  struct {
+    os_mod_id_t owner;   /* OS_MOD_NONE: queue not claimed */
+    uint32_t depth;      /* handoffs waiting now */
+    uint32_t high_water;
+  } worker[OS_EVT_BUS_MAX_WORKERS];
+} os_evt_bus_stats_t;
+
+/* Per subscriber (os_evt_bus_get_sub_stats()) */
+typedef struct {
+  uint32_t calls;      /* callbacks run, on the dispatcher or the worker */
+  uint32_t max_us;     /* longest callback */
+  uint32_t overruns;   /* callbacks longer than budget_us */
+  uint32_t budget_us;  /* 0: not checked */
+  uint32_t deferred;   /* events handed to the worker queue */
+  uint32_t dropped;    /* events lost to a full worker queue */
+} os_evt_sub_stats_t;
+
+/* ==========================================================================
+ * Core API
+ * ========================================================================== */
+
+/* Reset subscriptions, queue and stats. Not thread-safe; call before publishing. */
+os_err_t os_evt_bus_init(void);
+
+/*
+ * Not ISR-safe. Queue policy of one id (the table's coalesce column after init).
+ * OS_EBUSY while an entry of the id is pending, OS_EFULL when
+ * OS_EVT_BUS_MAX_COALESCE ids already coalesce.
+ */
+os_err_t os_evt_bus_set_policy(os_evt_id_t id, os_evt_policy_t policy);
+
+/*
+ * Not ISR-safe. Contention mode on or off (OS_EVT_BUS_STAGING_DEFAULT after
+ * init). On, a publish copies the event into the caller's staging ring with
+ * one atomic claim instead of taking the bus lock; the dispatcher merges the
+ * rings into the lanes, oldest stamp first, before each batch. Events of one
+ * publisher keep their order. A FIFO event waits in its ring while its lane
+ * is full (later events of that ring wait behind it); OS_EFULL means the
+ * ring was still full after the publisher merged it. Large payloads still
+ * take the lock for their pool block. OS_ENOTSUP when OS_EVT_BUS_STAGE_RINGS is 0.
+ */
+os_err_t os_evt_bus_set_staging(bool on);
+
+/* Not ISR-safe. Lane selection between dispatches; OS_EVT_BUS_SCHED_DEFAULT after init. */
+os_err_t os_evt_bus_set_sched(os_evt_sched_t sched);
+
+/* Lane an id is queued in: its table lane, capped at OS_EVT_BUS_LANES - 1 */
+uint32_t os_evt_bus_lane_of(os_evt_id_t id);
+
+/* Not ISR-safe. Returns OS_EVT_SUB_HANDLE_INVALID when the handle table or the event's list is full. */
+os_evt_sub_handle_t os_evt_bus_subscribe(os_evt_id_t id, os_evt_cb_t cb, void *user_ctx);
+
+/*
+ * Not ISR-safe. One handle for every id in mask (OS_EVT_BIT(EVT_x) | ...).
+ * Called after the event's per-id subscribers, in subscription order.
+ * Returns OS_EVT_SUB_HANDLE_INVALID for an empty mask, bits outside
+ * EVT_NONE < id < EVT__MAX, or when OS_EVT_BUS_MAX_MASK_SUBS are taken.
+ */
+os_evt_sub_handle_t os_evt_bus_subscribe_mask(os_evt_mask_t mask, os_evt_cb_t cb, void *user_ctx);
+
+/*
+ * Not ISR-safe. Like os_evt_bus_subscribe(), but the dispatcher does not run
+ * cb: it copies the event (and takes a reference on a pool payload) into the
+ * worker queue of module worker, which runs the callbacks of its queue in
+ * order (os_evt_bus_start_worker() or os_evt_bus_worker_run()). For handlers
+ * that may block (flash writes, BLE notifications) and would otherwise hold
+ * up every event behind them. A handoff that finds the queue full is dropped
+ * and counted. The first deferred subscription of a module claims its queue;
+ * OS_EVT_SUB_HANDLE_INVALID when OS_EVT_BUS_MAX_WORKERS modules hold one.
+ */
+os_evt_sub_handle_t os_evt_bus_subscribe_deferred(os_evt_id_t id, os_evt_cb_t cb, void *user_ctx,
+                                                  os_mod_id_t worker);
+
+/* Not ISR-safe. O(1); stale or already released handles are ignored. Queued deferred calls are skipped. */
+void os_evt_bus_unsubscribe(os_evt_sub_handle_t handle);
+
+/* Not ISR-safe. Run time above which a callback of handle counts as an overrun; 0 stops checking. */
+os_err_t os_evt_bus_set_budget(os_evt_sub_handle_t handle, uint32_t budget_us);
+
+/* Not ISR-safe. Call counts and timing of one subscriber; OS_EINVAL for a stale handle. */
+os_err_t os_evt_bus_get_sub_stats(os_evt_sub_handle_t handle, os_evt_sub_stats_t *out);
+
+static inline bool os_evt_bus_handle_valid(os_evt_sub_handle_t handle)
+{
+  return handle.id != EVT_NONE && handle.slot != 0;
+}
+
+/*
+ * Copy the event into the queue and wake the dispatcher. Task context. O(1)
+ * for both policies. OS_EINVAL: unknown id or len > OS_EVT_BUS_POOL_BLOCK_SIZE;
+ * OS_EFULL: queue full (FIFO ids only); OS_ENOMEM: len > OS_EVT_INLINE_MAX
+ * and no free pool block.
+ */
+os_err_t os_evt_bus_publish(os_mod_id_t src, os_evt_id_t id, const void *payload, uint16_t len);
+
+/*
+ * Same as os_evt_bus_publish() from an ISR (e.g. an RMT done callback).
+ * *woken is set when the dispatcher should run before the ISR returns to its
+ * task (yield / return true from the driver callback); it is never cleared.
+ */
+os_err_t os_evt_bus_publish_from_isr(os_mod_id_t src, os_evt_id_t id, const void *payload, uint16_t len,
+                                     bool *woken);
+
+/* Not ISR-safe. Batch size of os_evt_bus_dispatch_all(), 1..OS_EVT_BUS_MAX_BATCH (the default). */
+os_err_t os_evt_bus_set_batch(uint32_t max);
+
+/* Run the callbacks of the next event (lane picked by the sched mode); false if all lanes were empty */
+bool os_evt_bus_dispatch_one(void);
+
+/*
+ * Take up to max events (capped at OS_EVT_BUS_MAX_BATCH) and their
+ * subscriber lists in one critical section, then run their callbacks in
+ * that order. Callbacks run without the lock; an entry is checked again
+ * only if something unsubscribed since the batch was taken. Returns the
+ * number of events, 0 if all lanes were empty.
+ */
+size_t os_evt_bus_dispatch_batch(size_t max);
+
+/* Dispatch in batches until the queue is empty; returns the number of events */
+size_t os_evt_bus_dispatch_all(void);
+
+/*
+ * Run the deferred callbacks queued for module worker, oldest first, until
+ * its queue is empty; returns the number of handoffs taken. One context per
+ * worker (its task, or a polling loop).
+ */
+size_t os_evt_bus_worker_run(os_mod_id_t worker);
+
+void os_evt_bus_get_stats(os_evt_bus_stats_t *out);
+
+/*
+ * Keep the pool block of a large-payload event past the callback (e.g. to
+ * hand it to a worker without copying). Returns the payload, or NULL for an
+ * inline event (copy it instead). Pair with os_evt_bus_payload_release().
+ * Any context.
+ */
+const void *os_evt_bus_payload_retain(const os_evt_t *evt);
+
+void os_evt_bus_payload_release(const void *payload);
+
+/* ==========================================================================
+ * Typed wrappers (generated from OS_EVT_TABLE)
+ *
+ *   os_evt_publish_<name>(&payload)            source module from the table
+ *   os_evt_publish_<name>_from_isr(&payload, &woken)
+ *   os_evt_subscribe_<name>(cb, user_ctx)
+ *   os_evt_read_<name>(evt, &payload)          copy out of the envelope (its
+ *                                              payload bytes are unaligned)
+ *
+ * Events without a payload drop the payload argument and have no reader.
+ * ========================================================================== */
+
+#define OS_EVT_WRAPPERS_(ID, name, type, src, lane, coalesce)                                  \
+  static inline os_err_t os_evt_publish_##name(const type *payload)                            \
+  {                                                                                            \
+    return os_evt_bus_publish(src, EVT_##ID, payload, (uint16_t)sizeof(type));                 \
+  }                                                                                            \
+  static inline os_err_t os_evt_publish_##name##_from_isr(const type *payload, bool *woken)    \
+  {                                                                                            \
+    return os_evt_bus_publish_from_isr(src, EVT_##ID, payload, (uint16_t)sizeof(type), woken); \
+  }                                                                                            \
+  static inline os_evt_sub_handle_t os_evt_subscribe_##name(os_evt_cb_t cb, void *user_ctx)    \
+  {                                                                                            \
+    return os_evt_bus_subscribe(EVT_##ID, cb, user_ctx);                                       \
+  }                                                                                            \
+  static inline void os_evt_read_##name(const os_evt_t *evt, type *out)                        \
+  {                                                                                            \
+    memset(out, 0, sizeof(*out));                                                              \
+    memcpy(out, os_evt_data(evt), evt->len < sizeof(*out) ? evt->len : sizeof(*out));          \
+  }
+
+#define OS_EVT_WRAPPERS_EMPTY_(ID, name, src, lane, coalesce)                               \
+  static inline os_err_t os_evt_publish_##name(void)                                        \
+  {                                                                                         \
+    return os_evt_bus_publish(src, EVT_##ID, NULL, 0);                                      \
+  }                                                                                         \
+  static inline os_err_t os_evt_publish_##name##_from_isr(bool *woken)                      \
+  {                                                                                         \
+    return os_evt_bus_publish_from_isr(src, EVT_##ID, NULL, 0, woken);                      \
+  }                                                                                         \
+  static inline os_evt_sub_handle_t os_evt_subscribe_##name(os_evt_cb_t cb, void *user_ctx) \
+  {                                                                                         \
+    return os_evt_bus_subscribe(EVT_##ID, cb, user_ctx);                                    \
+  }
+
+OS_EVT_TABLE(OS_EVT_WRAPPERS_, OS_EVT_WRAPPERS_EMPTY_)
+
+#undef OS_EVT_WRAPPERS_
+#undef OS_EVT_WRAPPERS_EMPTY_
+
+/* ==========================================================================
+ * Dispatcher and workers (implemented by the port)
+ * ========================================================================== */
+
+/*
+ * Start the task/thread that blocks until something is published and calls
+ * os_evt_bus_dispatch_all(). Without it, the application polls instead.
+ */
+os_err_t os_evt_bus_start_dispatcher(uint32_t priority, uint32_t stack_bytes);
+
+/* Stop the dispatcher; queued events stay queued */
+void os_evt_bus_stop_dispatcher(void);
+
+/*
+ * Start the task/thread that blocks until the dispatcher hands module worker
+ * a deferred call and runs os_evt_bus_worker_run(worker). OS_ESTATE if it
+ * runs already.
+ */
+os_err_t os_evt_bus_start_worker(os_mod_id_t worker, uint32_t priority, uint32_t stack_bytes);
+
+/* Stop a worker; queued handoffs stay queued */
+void os_evt_bus_stop_worker(os_mod_id_t worker);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OS_EVT_BUS_H */
@@ -0,0 +1,107 @@
+/*
+ * os_evt_trace.h — always-on binary trace of event bus traffic
+ *
+ * The bus records every publish, merge, refusal and dispatch into a fixed
+ * ring of OS_EVT_TRACE_RECORDS 16-byte records: type, event id, source
+ * module, a port timestamp (the CPU cycle counter on target), the lane depth
+ * and the sequence stamp of the queue entry, which pairs a publish with its
+ * dispatch. A writer claims its slot with one atomic add and never waits, so
+ * any task, ISR or core can record; the oldest records are overwritten.
+ *
+ * os_evt_trace_dump() streams a snapshot to a byte sink (UART, BLE
+ * notifications, a file on the host). tools/os_evt_trace_decode.py turns
+ * dumps into per-event latency histograms and a Chrome trace / Perfetto
+ * timeline.
+ */
+#ifndef OS_EVT_TRACE_H
+#define OS_EVT_TRACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef OS_EVT_TRACE_RECORDS
+#define OS_EVT_TRACE_RECORDS 256u /* power of two; 0 compiles tracing out */
+#endif
+
+#define OS_EVT_TRACE_MAGIC   0x52545645u /* "EVTR" little-endian */
+#define OS_EVT_TRACE_VERSION 1u
+
+typedef enum {
+  OS_EVT_TRACE_PUBLISH = 1,     /* queued as a new entry; info = lane depth after */
+  OS_EVT_TRACE_COALESCE,        /* merged into the pending entry ref; info = lane depth */
+  OS_EVT_TRACE_DROP,            /* refused, lane full (DROP_NEW); info = lane depth */
+  OS_EVT_TRACE_NOMEM,           /* refused, no free pool block */
+  OS_EVT_TRACE_REJECT,          /* refused, bad id or length */
+  OS_EVT_TRACE_DISPATCH_START,  /* taken off the queue, first callback next; info = lane depth left */
+  OS_EVT_TRACE_DISPATCH_END,    /* last callback returned; info = callbacks run */
+} os_evt_trace_type_t;
+
+/* Set in os_evt_trace_rec_t::type when recorded on core 1 (cycle counters are per core) */
+#define OS_EVT_TRACE_CORE1 0x80u
+
+typedef struct {
+  uint32_t stamp;  /* claim index + 1, written last; 0 = invalid (overwritten during the dump) */
+  uint32_t ts;     /* os_evt_bus_port_trace_ts(), wraps */
+  uint32_t ref;    /* bus sequence stamp of the queue entry; 0 for refusals */
+  uint8_t  type;   /* os_evt_trace_type_t | OS_EVT_TRACE_CORE1 */
+  uint8_t  id;     /* os_evt_id_t */
+  uint8_t  src;    /* os_mod_id_t */
+  uint8_t  info;
+} os_evt_trace_rec_t;
+
+/* Dump layout: this header, then count records, oldest first; all little-endian */
+typedef struct {
+  uint32_t magic;    /* OS_EVT_TRACE_MAGIC */
+  uint16_t version;  /* OS_EVT_TRACE_VERSION */
+  uint16_t rec_size; /* sizeof(os_evt_trace_rec_t) */
+  uint32_t ts_hz;    /* timestamp ticks per second */
+  uint32_t count;    /* records that follow */
+  uint32_t lost;     /* records overwritten before they could be dumped */
+} os_evt_trace_hdr_t;
+
+#ifdef __cplusplus
+static_assert(sizeof(os_evt_trace_rec_t) == 16, "trace records are 16 bytes on every target");
+static_assert(sizeof(os_evt_trace_hdr_t) == 20, "trace header is 20 bytes on every target");
+#else
+_Static_assert(sizeof(os_evt_trace_rec_t) == 16, "trace records are 16 bytes on every target");
+_Static_assert(sizeof(os_evt_trace_hdr_t) == 20, "trace header is 20 bytes on every target");
+#endif
+
+/* Byte sink for os_evt_trace_dump(); called once for the header and once per record */
+typedef void (*os_evt_trace_write_t)(const void *data, size_t len, void *user_ctx);
+
+#if OS_EVT_TRACE_RECORDS
+/* Append one record. Any context; lock-free. */
+void os_evt_trace_record(os_evt_trace_type_t type, uint32_t id, uint32_t src, uint32_t ref, uint32_t info);
+#else
+static inline void os_evt_trace_record(os_evt_trace_type_t type, uint32_t id, uint32_t src, uint32_t ref,
+                                       uint32_t info)
+{
+  (void)type;
+  (void)id;
+  (void)src;
+  (void)ref;
+  (void)info;
+}
+#endif
+
+/* Forget every record (os_evt_bus_init() calls it). Not thread-safe. */
+void os_evt_trace_reset(void);
+
+/*
+ * Write a snapshot of the ring to write(): the header, then the last
+ * min(recorded, OS_EVT_TRACE_RECORDS) records. Recording goes on meanwhile;
+ * a record overwritten before it was copied is sent with stamp 0. Task
+ * context. Returns the number of valid records sent.
+ */
+size_t os_evt_trace_dump(os_evt_trace_write_t write, void *user_ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OS_EVT_TRACE_H */
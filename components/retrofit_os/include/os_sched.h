@@ -0,0 +1,141 @@
+/*
+ * os_sched.h — next-deadline schedule engine
+ *
+ * Replaces coarse polling of the schedule table (DESIGN_TRADEOFFS.md §4)
+ * with one one-shot timer armed for the earliest run:
+ *
+ *   - the table has OS_SCHED_MAX rows; a schedule's id is its row, and the
+ *     schedule_id of its EVT_SCHEDULE_DUE
+ *   - active rows sit in a fixed-capacity binary min-heap keyed by the epoch
+ *     of their next run; the timer is armed for the heap's head only and
+ *     re-armed only when the head's deadline changes
+ *   - os_sched_set() / os_sched_remove() stage a row; os_sched_apply() (on
+ *     EVT_SCHEDULE_TABLE_UPDATED) recomputes the staged rows and nothing else
+ *   - a forward time jump recomputes only the rows that became due; a
+ *     backward one only re-arms the timer, since deadlines are absolute
+ *   - last_run guards against double fire: a run at or before an entry's
+ *     last_run never fires, whatever the clock does
+ *   - missed runs are skipped (SKIP_MISSED): of the runs due at once only the
+ *     latest fires, and only if it is at most OS_SCHED_GRACE_S old
+ *
+ * Epoch times are seconds. The engine itself is clock-free: the caller
+ * passes "now" and gets the next deadline through an arm hook, which lets
+ * host tests drive it from a virtual clock. os_sched_start() binds it to the
+ * port's clock and timer and to the bus events.
+ */
+#ifndef OS_SCHED_H
+#define OS_SCHED_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "retrofit_os_types.h"
+
+/* ==========================================================================
+ * Limits (compile time)
+ * ========================================================================== */
+
+#ifndef OS_SCHED_MAX
+#define OS_SCHED_MAX 32u /* schedule table rows; 1..65535 */
+#endif
+
+/* A due run this many seconds late still fires; older ones are skipped */
+#ifndef OS_SCHED_GRACE_S
+#define OS_SCHED_GRACE_S 60u
+#endif
+
+/* Retry delay when the due hook refuses a run (bus lane full) */
+#ifndef OS_SCHED_RETRY_S
+#define OS_SCHED_RETRY_S 1u
+#endif
+
+/* No run / timer disarmed */
+#define OS_SCHED_NEVER UINT32_MAX
+
+/* ==========================================================================
+ * Types
+ * ========================================================================== */
+
+typedef struct {
+  uint32_t start;    /* epoch of the first run */
+  uint32_t period_s; /* 0: one-shot */
+  uint32_t last_run; /* epoch of the latest run fired or skipped, 0: none; persist with the table */
+} os_sched_entry_t;
+
+/* Arm the one-shot timer for epoch deadline; OS_SCHED_NEVER: disarm */
+typedef void (*os_sched_arm_fn_t)(uint32_t deadline, void *ctx);
+
+/* Deliver the run of schedule id at epoch run; anything but OS_OK retries OS_SCHED_RETRY_S later */
+typedef os_err_t (*os_sched_due_fn_t)(uint32_t id, uint32_t run, void *ctx);
+
+typedef struct {
+  uint32_t active;     /* rows in the heap */
+  uint32_t fired;      /* runs delivered */
+  uint32_t skipped;    /* runs missed by more than OS_SCHED_GRACE_S, or overtaken by a later due run */
+  uint32_t retries;    /* runs the due hook refused */
+  uint32_t recomputed; /* rows whose next run was recomputed (apply, expire, time jump) */
+  uint32_t armed;      /* arm hook calls */
+} os_sched_stats_t;
+
+/* ==========================================================================
+ * Engine
+ * ========================================================================== */
+
+/*
+ * Empty the table. arm gets every change of the head deadline. due NULL
+ * publishes EVT_SCHEDULE_DUE { id } on the bus. Not safe while the timer
+ * or os_sched_start()'s subscribers run.
+ */
+void os_sched_init(os_sched_arm_fn_t arm, os_sched_due_fn_t due, void *ctx);
+
+/* Stage row id; it takes effect at the next os_sched_apply(). OS_EINVAL: id or period out of range. */
+os_err_t os_sched_set(uint32_t id, const os_sched_entry_t *entry);
+
+/* Stage removal of row id; OS_EINVAL: id out of range */
+os_err_t os_sched_remove(uint32_t id);
+
+/*
+ * Recompute the staged rows only: next run = first run after last_run.
+ * Runs of them already due at now then fire or are skipped like after a
+ * time jump (SKIP_MISSED, OS_SCHED_GRACE_S). O(staged * log OS_SCHED_MAX).
+ * Returns the rows applied.
+ */
+size_t os_sched_apply(uint32_t now);
+
+/* The timer fired: deliver the runs due at now, advance those rows, re-arm. Returns the runs delivered. */
+size_t os_sched_expire(uint32_t now);
+
+/* The clock moved to now (EVT_TIME_JUMPED): deliver or skip what became due, re-arm in any case */
+size_t os_sched_time_jumped(uint32_t now);
+
+/* Row id as applied, with last_run as the engine advanced it; *next is its next run (may be NULL) */
+os_err_t os_sched_get(uint32_t id, os_sched_entry_t *out, uint32_t *next);
+
+/* Epoch of the earliest run, OS_SCHED_NEVER if none */
+uint32_t os_sched_next(void);
+
+void os_sched_get_stats(os_sched_stats_t *out);
+
+/* ==========================================================================
+ * Service (port)
+ * ========================================================================== */
+
+/*
+ * os_sched_init() with the port's one-shot timer as arm hook and bus
+ * delivery, and subscribe to EVT_TIME_SYNCED and EVT_TIME_JUMPED
+ * (os_sched_time_jumped()) and EVT_SCHEDULE_TABLE_UPDATED (os_sched_apply()).
+ * The port's clock reads 0 until the wall clock is set; the timer stays
+ * disarmed until then, so nothing fires before time is valid.
+ */
+os_err_t os_sched_start(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OS_SCHED_H */
@@ -7,6 +7,7 @@ extern "C" {
 
 #include <stdint.h>
 #include <stddef.h>
+#include <string.h>
 
 /* ==========================================================================
  * Core shared contracts (public, stable)
@@ -53,66 +54,82 @@ typedef enum {
 } os_module_id_t;
 
 /* ==========================================================================
- * Global Event IDs (from EVT table)
- * NOTE: Once you ship logs/protocols, treat enum ordering as ABI-stable.
+ * Global Event Table
+ * NOTE: Once you ship logs/protocols, treat row ordering as ABI-stable.
+ *
+ * One row per event; everything per-id is generated from it: the EVT_*
+ * enum, payload size checks, the bus's constant metadata array and the
+ * typed publish/subscribe wrappers in os_evt_bus.h.
+ *
+ *   X(ID, name, payload type, source module, priority lane, coalesce)
+ *   X_EMPTY(ID, name, source module, priority lane, coalesce)  -- no payload
+ *
+ * coalesce = 1: only the latest pending value matters to subscribers
+ * (OS_EVT_POLICY_COALESCE after os_evt_bus_init()).
  * ========================================================================== */
 
 typedef uint16_t os_evt_id_t;
 
+/* Priority classes, highest first; the bus folds classes beyond its last lane into it */
 typedef enum {
-  EVT_NONE = 0,
-
-  /* Auth */
-  EVT_AUTH_STATE_CHANGED,
-
-  /* Comms */
-  EVT_BLE_CONN_CHANGED,
-  EVT_BLE_SEC_CHANGED,
-  EVT_WIFI_STATE_CHANGED,
-  EVT_MQTT_STATE_CHANGED,
-
-  /* Time */
-  EVT_TIME_SYNCED,
-  EVT_TIME_JUMPED,
-
-  /* Scheduler */
-  EVT_SCHEDULE_TABLE_UPDATED,
-  EVT_SCHEDULE_DUE,
-
-  /* IR */
-  EVT_IR_LEARN_STARTED,
-  EVT_IR_LEARN_RESULT,
-  EVT_IR_SLOT_WRITTEN,
-  EVT_IR_SEND_STARTED,
-  EVT_IR_SEND_RESULT,
-
-  /* Storage */
-  EVT_STORAGE_CORRUPT,
-  EVT_STORAGE_FULL,
-  EVT_FACTORY_RESET_DONE,
-
-  /* Power */
-  EVT_POWER_MODE_CHANGED,
-  EVT_BATTERY_STATE,
-
-  /* OTA */
-  EVT_OTA_AVAILABLE,
-  EVT_OTA_START,
-  EVT_OTA_PROGRESS,
-  EVT_OTA_DONE,
-
-  /* Command */
-  EVT_CMD_REJECTED,
-
-  /* Health */
-  EVT_WATCHDOG_WARNING,
-  EVT_HEALTH_TICK,
+  OS_EVT_LANE_HIGH = 0,   /* watchdog, schedule due, storage faults, IR results */
+  OS_EVT_LANE_NORMAL,     /* default */
+  OS_EVT_LANE_LOW,        /* periodic state */
+  OS_EVT_LANE_BULK,       /* progress streams */
+} os_evt_lane_t;
+
+#define OS_EVT_TABLE(X, X_EMPTY)                                                                                            \
+  /* Auth */                                                                                                                \
+  X_EMPTY(AUTH_STATE_CHANGED,     auth_state_changed,                                OS_MOD_AUTH,    OS_EVT_LANE_NORMAL, 0) \
+  /* Comms */                                                                                                               \
+  X(BLE_CONN_CHANGED,             ble_conn_changed,     evt_ble_conn_changed_t,      OS_MOD_BLE,     OS_EVT_LANE_NORMAL, 0) \
+  X(BLE_SEC_CHANGED,              ble_sec_changed,      evt_ble_sec_changed_t,       OS_MOD_BLE,     OS_EVT_LANE_NORMAL, 0) \
+  X(WIFI_STATE_CHANGED,           wifi_state_changed,   evt_wifi_state_changed_t,    OS_MOD_WIFI,    OS_EVT_LANE_NORMAL, 1) \
+  X_EMPTY(MQTT_STATE_CHANGED,     mqtt_state_changed,                                OS_MOD_MQTT,    OS_EVT_LANE_NORMAL, 0) \
+  /* Time */                                                                                                                \
+  X_EMPTY(TIME_SYNCED,            time_synced,                                       OS_MOD_CLOCK,   OS_EVT_LANE_NORMAL, 0) \
+  X(TIME_JUMPED,                  time_jumped,          evt_time_jumped_t,           OS_MOD_CLOCK,   OS_EVT_LANE_HIGH,   0) \
+  /* Scheduler */                                                                                                           \
+  X_EMPTY(SCHEDULE_TABLE_UPDATED, schedule_table_updated,                            OS_MOD_SCHED,   OS_EVT_LANE_NORMAL, 0) \
+  X(SCHEDULE_DUE,                 schedule_due,         evt_schedule_due_t,          OS_MOD_SCHED,   OS_EVT_LANE_HIGH,   0) \
+  /* IR */                                                                                                                  \
+  X_EMPTY(IR_LEARN_STARTED,       ir_learn_started,                                  OS_MOD_IR,      OS_EVT_LANE_NORMAL, 0) \
+  X(IR_LEARN_RESULT,              ir_learn_result,      evt_ir_learn_result_t,       OS_MOD_IR,      OS_EVT_LANE_HIGH,   0) \
+  X(IR_SLOT_WRITTEN,              ir_slot_written,      evt_ir_slot_written_t,       OS_MOD_IR,      OS_EVT_LANE_NORMAL, 0) \
+  X_EMPTY(IR_SEND_STARTED,        ir_send_started,                                   OS_MOD_IR,      OS_EVT_LANE_NORMAL, 0) \
+  X(IR_SEND_RESULT,               ir_send_result,       evt_ir_send_result_t,        OS_MOD_IR,      OS_EVT_LANE_HIGH,   0) \
+  /* Storage */                                                                                                             \
+  X_EMPTY(STORAGE_CORRUPT,        storage_corrupt,                                   OS_MOD_STORAGE, OS_EVT_LANE_HIGH,   0) \
+  X_EMPTY(STORAGE_FULL,           storage_full,                                      OS_MOD_STORAGE, OS_EVT_LANE_HIGH,   0) \
+  X_EMPTY(FACTORY_RESET_DONE,     factory_reset_done,                                OS_MOD_STORAGE, OS_EVT_LANE_NORMAL, 0) \
+  /* Power */                                                                                                               \
+  X(POWER_MODE_CHANGED,           power_mode_changed,   evt_power_mode_changed_t,    OS_MOD_POWER,   OS_EVT_LANE_NORMAL, 0) \
+  X_EMPTY(BATTERY_STATE,          battery_state,                                     OS_MOD_POWER,   OS_EVT_LANE_LOW,    1) \
+  /* OTA */                                                                                                                 \
+  X_EMPTY(OTA_AVAILABLE,          ota_available,                                     OS_MOD_OTA,     OS_EVT_LANE_NORMAL, 0) \
+  X_EMPTY(OTA_START,              ota_start,                                         OS_MOD_OTA,     OS_EVT_LANE_NORMAL, 0) \
+  X_EMPTY(OTA_PROGRESS,           ota_progress,                                      OS_MOD_OTA,     OS_EVT_LANE_BULK,   1) \
+  X_EMPTY(OTA_DONE,               ota_done,                                          OS_MOD_OTA,     OS_EVT_LANE_NORMAL, 0) \
+  /* Command */                                                                                                             \
+  X(CMD_REJECTED,                 cmd_rejected,         evt_cmd_rejected_t,          OS_MOD_CMD,     OS_EVT_LANE_NORMAL, 0) \
+  /* Health */                                                                                                              \
+  X_EMPTY(WATCHDOG_WARNING,       watchdog_warning,                                  OS_MOD_MONITOR, OS_EVT_LANE_HIGH,   0) \
+  X_EMPTY(HEALTH_TICK,            health_tick,                                       OS_MOD_MONITOR, OS_EVT_LANE_LOW,    1)
+
+#define OS_EVT_ENUM_(ID, name, type, src, lane, coalesce) EVT_##ID,
+#define OS_EVT_ENUM_EMPTY_(ID, name, src, lane, coalesce) EVT_##ID,
 
+typedef enum {
+  EVT_NONE = 0,
+  OS_EVT_TABLE(OS_EVT_ENUM_, OS_EVT_ENUM_EMPTY_)
   EVT__MAX
 } os_event_id_t;
 
+#undef OS_EVT_ENUM_
+#undef OS_EVT_ENUM_EMPTY_
+
 /* ==========================================================================
- * Event Bus Envelope (no pointer payloads; always copied)
+ * Event Bus Envelope (small payloads copied inline; larger ones in a bus pool block)
  *
  * POLICY:
  * - Delivery: callbacks execute on event-bus task context (serialized, in-order)
@@ -127,10 +144,32 @@ typedef struct {
   os_evt_id_t id;        /* EVT_* */
   os_mod_id_t src;       /* OS_MOD_* */
   uint32_t    ts_ms;     /* optional: 0 if unknown */
-  uint16_t    len;       /* bytes; must be <= OS_EVT_INLINE_MAX */
-  uint8_t     payload[OS_EVT_INLINE_MAX]; /* event-specific POD bytes */
+  uint16_t    len;       /* bytes; > OS_EVT_INLINE_MAX: payload holds a pool block pointer */
+  uint8_t     payload[OS_EVT_INLINE_MAX]; /* event-specific POD bytes; read through os_evt_data() */
 } os_evt_t;
 
+#ifdef __cplusplus
+static_assert(sizeof(void *) <= OS_EVT_INLINE_MAX, "OS_EVT_INLINE_MAX must hold a pool block pointer");
+#else
+_Static_assert(sizeof(void *) <= OS_EVT_INLINE_MAX, "OS_EVT_INLINE_MAX must hold a pool block pointer");
+#endif
+
+/*
+ * Payload bytes of an event, inline or pool-backed; valid for the duration of
+ * the callback. No alignment guarantee: inline payloads are only 2-byte
+ * aligned, so do not cast to a payload struct. memcpy out of it, or use
+ * os_evt_read_<name>().
+ */
+static inline const void *os_evt_data(const os_evt_t *evt)
+{
+  const void *block;
+  if (evt->len <= OS_EVT_INLINE_MAX) {
+    return evt->payload;
+  }
+  memcpy(&block, evt->payload, sizeof(block));
+  return block;
+}
+
 /* Callback signature for subscribers (stored alongside user_ctx in bus table) */
 typedef void (*os_evt_cb_t)(const os_evt_t *evt, void *user_ctx);
 
@@ -164,7 +203,13 @@ typedef struct { int32_t delta_seconds; } evt_time_jumped_t;
 typedef struct { uint32_t schedule_id; } evt_schedule_due_t;
 
 typedef enum { IR_RES_OK = 0, IR_RES_FAIL = 1 } ir_result_t;
-typedef struct { ir_result_t result; uint16_t slot; } evt_ir_learn_result_t;
+typedef struct {
+  ir_result_t result;
+  uint16_t    slot;
+  uint8_t     presses;        /* presses collected in the learn session */
+  uint8_t     used;           /* presses that agree with the stored consensus */
+  uint8_t     confidence_pct; /* collected durations within tolerance of it */
+} evt_ir_learn_result_t;
 typedef struct { uint16_t slot; uint32_t crc32; } evt_ir_slot_written_t;
 typedef struct { ir_result_t result; } evt_ir_send_result_t;
 
@@ -174,6 +219,28 @@ typedef struct { os_power_mode_t mode; } evt_power_mode_changed_t;
 typedef enum { CMD_REJ_AUTH = 0, CMD_REJ_STATE = 1, CMD_REJ_PARAM = 2, CMD_REJ_BUSY = 3 } os_cmd_reject_reason_t;
 typedef struct { os_cmd_reject_reason_t reason; } evt_cmd_rejected_t;
 
+/* Payloads are copied into the envelope; a struct that outgrows it fails the build */
+#ifdef __cplusplus
+#define OS_EVT_PAYLOAD_FITS(type) static_assert(sizeof(type) <= OS_EVT_INLINE_MAX, #type " > OS_EVT_INLINE_MAX")
+#else
+#define OS_EVT_PAYLOAD_FITS(type) _Static_assert(sizeof(type) <= OS_EVT_INLINE_MAX, #type " > OS_EVT_INLINE_MAX")
+#endif
+
+#define OS_EVT_FITS_(ID, name, type, src, lane, coalesce) OS_EVT_PAYLOAD_FITS(type);
+#define OS_EVT_FITS_EMPTY_(ID, name, src, lane, coalesce)
+OS_EVT_TABLE(OS_EVT_FITS_, OS_EVT_FITS_EMPTY_)
+#undef OS_EVT_FITS_
+#undef OS_EVT_FITS_EMPTY_
+
+/* Per-id row of OS_EVT_TABLE, as the bus reads it (os_evt_meta[] in os_evt_bus.h) */
+typedef struct {
+  const char *name;
+  uint16_t    payload_len; /* sizeof the payload type; 0 = no payload */
+  os_mod_id_t src;
+  uint8_t     lane;        /* os_evt_lane_t */
+  uint8_t     coalesce;
+} os_evt_meta_t;
+
 /* ==========================================================================
  * Optional contracts for “init/process” style modules
  * ========================================================================== */
@@ -0,0 +1,295 @@
+/*
+ * os_cmd.c — synchronous command/response channel (platform-agnostic core)
+ */
+
+#include <string.h>
+
+#include "os_cmd.h"
+#include "os_cmd_port.h"
+
+#define CMD_QUEUE_MASK (OS_CMD_QUEUE_DEPTH - 1u)
+
+_Static_assert(OS_CMD_SLOTS >= 1u && OS_CMD_SLOTS <= 255u, "slot index must fit the low byte of the correlation id");
+_Static_assert((OS_CMD_QUEUE_DEPTH & CMD_QUEUE_MASK) == 0 && OS_CMD_QUEUE_DEPTH <= 128u,
+               "OS_CMD_QUEUE_DEPTH must be a power of two up to 128");
+_Static_assert(OS_CMD_DATA_MAX >= 8u && OS_CMD_DATA_MAX <= UINT16_MAX && OS_CMD_DATA_MAX % 8u == 0,
+               "OS_CMD_DATA_MAX must be a multiple of 8");
+
+/* ==========================================================================
+ * State
+ *
+ * A slot goes FREE -> ALLOC (caller fills it) -> QUEUED (in its target's
+ * queue) -> TAKEN (target has it) -> DONE (response written) -> FREE. Slot i
+ * always uses pool block i, so a command moves between tasks as one index.
+ * The generation in the correlation id is bumped on every free; the slot
+ * keeps its own copy of the id, since cmd->corr is writable by whoever
+ * holds the pointer, and respond/release must present the id they got.
+ *
+ * A caller that gives up and releases a QUEUED or TAKEN command marks it
+ * abandoned instead of freeing it: the target still holds the index (or the
+ * pointer). os_cmd_recv() frees abandoned commands as it pops them,
+ * os_cmd_respond() frees them instead of answering.
+ *
+ * Wake-ups are counting notifications that may arrive late (a response to a
+ * call that already timed out, a command queued just as the receiver
+ * returned), so every waiter rechecks slot or queue state after waking.
+ * ========================================================================== */
+
+typedef enum {
+  CMD_FREE = 0,
+  CMD_ALLOC,
+  CMD_QUEUED,
+  CMD_TAKEN,
+  CMD_DONE,
+} cmd_state_t;
+
+typedef struct {
+  os_cmd_t      cmd;       /* first: a command pointer is its slot pointer */
+  os_cmd_corr_t corr;      /* authoritative id of the current use */
+  uint8_t       state;     /* cmd_state_t */
+  uint8_t       gen;
+  bool          abandoned; /* released by the caller while QUEUED or TAKEN */
+  bool          timed_out; /* os_cmd_call() returned OS_ETIMEOUT */
+  void         *waiter;    /* calling task, woken by the response */
+} cmd_slot_t;
+
+typedef struct {
+  uint8_t head;     /* free-running */
+  uint8_t tail;
+  uint8_t index[OS_CMD_QUEUE_DEPTH];
+  void   *receiver; /* task inside os_cmd_recv(), NULL otherwise */
+} cmd_queue_t;
+
+static struct {
+  cmd_slot_t  slots[OS_CMD_SLOTS];
+  cmd_queue_t queues[OS_MOD_MAX];
+  _Alignas(8) uint8_t pool[OS_CMD_SLOTS][OS_CMD_DATA_MAX];
+  os_cmd_stats_t stats;
+} s_cmd;
+
+/* ==========================================================================
+ * Helpers
+ * ========================================================================== */
+
+/* Slot of a command pointer handed out by os_cmd_alloc(), or NULL; says nothing about which use of it */
+static cmd_slot_t *slot_of(os_cmd_t *cmd)
+{
+  uintptr_t off = (uintptr_t)cmd - (uintptr_t)&s_cmd.slots[0];
+  if (cmd == NULL || off % sizeof(cmd_slot_t) != 0 || off / sizeof(cmd_slot_t) >= OS_CMD_SLOTS) {
+    return NULL;
+  }
+  return &s_cmd.slots[off / sizeof(cmd_slot_t)];
+}
+
+/* Lock held */
+static void slot_free(cmd_slot_t *slot)
+{
+  slot->state = CMD_FREE;
+  slot->abandoned = false;
+  slot->timed_out = false;
+  slot->waiter = NULL;
+  slot->gen++;
+  s_cmd.stats.in_flight--;
+}
+
+/* Milliseconds left of timeout_ms since start; OS_CMD_WAIT_FOREVER stays forever */
+static uint32_t time_left(uint32_t start, uint32_t timeout_ms)
+{
+  if (timeout_ms == OS_CMD_WAIT_FOREVER) {
+    return OS_CMD_WAIT_FOREVER;
+  }
+  uint32_t elapsed = os_cmd_port_now_ms() - start;
+  return elapsed >= timeout_ms ? 0 : timeout_ms - elapsed;
+}
+
+/* ==========================================================================
+ * Public API
+ * ========================================================================== */
+
+void os_cmd_init(void)
+{
+  os_cmd_port_lock();
+  memset(&s_cmd, 0, sizeof(s_cmd));
+  os_cmd_port_unlock();
+}
+
+os_cmd_t *os_cmd_alloc(os_mod_id_t src, os_mod_id_t target, uint16_t op)
+{
+  if (target == OS_MOD_NONE || target >= OS_MOD_MAX) {
+    return NULL;
+  }
+  cmd_slot_t *slot = NULL;
+  os_cmd_port_lock();
+  for (uint32_t i = 0; i < OS_CMD_SLOTS; i++) {
+    if (s_cmd.slots[i].state == CMD_FREE) {
+      slot = &s_cmd.slots[i];
+      slot->state = CMD_ALLOC;
+      slot->corr = (os_cmd_corr_t)(((uint32_t)slot->gen << 8) | (i + 1u));
+      slot->cmd = (os_cmd_t){
+        .corr = slot->corr,
+        .src = src,
+        .target = target,
+        .op = op,
+        .status = OS_OK,
+        .data = s_cmd.pool[i],
+      };
+      break;
+    }
+  }
+  if (slot == NULL) {
+    s_cmd.stats.no_slot++;
+  } else if (++s_cmd.stats.in_flight > s_cmd.stats.high_water) {
+    s_cmd.stats.high_water = s_cmd.stats.in_flight;
+  }
+  os_cmd_port_unlock();
+  return slot != NULL ? &slot->cmd : NULL;
+}
+
+os_err_t os_cmd_call(os_cmd_t *cmd, uint32_t timeout_ms)
+{
+  cmd_slot_t *slot = slot_of(cmd);
+  if (slot == NULL || cmd->len > OS_CMD_DATA_MAX) {
+    return OS_EINVAL;
+  }
+  void *self = os_cmd_port_self();
+
+  os_cmd_port_lock();
+  if (slot->state != CMD_ALLOC) {
+    os_cmd_port_unlock();
+    return OS_ESTATE;
+  }
+  cmd_queue_t *q = &s_cmd.queues[cmd->target];
+  if ((uint8_t)(q->tail - q->head) == OS_CMD_QUEUE_DEPTH) {
+    s_cmd.stats.full++;
+    os_cmd_port_unlock();
+    return OS_EFULL;
+  }
+  q->index[q->tail++ & CMD_QUEUE_MASK] = (uint8_t)(slot - s_cmd.slots);
+  slot->state = CMD_QUEUED;
+  slot->waiter = self;
+  s_cmd.stats.calls++;
+  void *receiver = q->receiver;
+  os_cmd_port_unlock();
+  if (receiver != NULL) {
+    os_cmd_port_wake(receiver);
+  }
+
+  uint32_t start = os_cmd_port_now_ms();
+  uint32_t left = timeout_ms;
+  for (;;) {
+    os_cmd_port_lock();
+    bool done = slot->state == CMD_DONE;
+    s_cmd.stats.completed += done;
+    s_cmd.stats.timeouts += !done && left == 0;
+    slot->timed_out = !done && left == 0;
+    os_cmd_port_unlock();
+    if (done) {
+      return OS_OK;
+    }
+    if (left == 0) {
+      return OS_ETIMEOUT;
+    }
+    os_cmd_port_wait(left);
+    left = time_left(start, timeout_ms);
+  }
+}
+
+os_err_t os_cmd_release(os_cmd_t *cmd, os_cmd_corr_t corr)
+{
+  cmd_slot_t *slot = slot_of(cmd);
+  if (slot == NULL) {
+    return OS_EINVAL;
+  }
+  os_err_t err = OS_OK;
+  os_cmd_port_lock();
+  if (slot->state == CMD_FREE || slot->corr != corr || slot->abandoned) {
+    err = OS_ESTATE; /* released twice, or the slot went on to another call */
+  } else if (slot->state == CMD_QUEUED || slot->state == CMD_TAKEN) {
+    slot->abandoned = true;
+    slot->waiter = NULL;
+  } else {
+    /* Answered between the timeout and this release: the call already failed */
+    s_cmd.stats.late += slot->state == CMD_DONE && slot->timed_out;
+    slot_free(slot);
+  }
+  os_cmd_port_unlock();
+  return err;
+}
+
+os_cmd_t *os_cmd_recv(os_mod_id_t target, uint32_t timeout_ms)
+{
+  if (target == OS_MOD_NONE || target >= OS_MOD_MAX) {
+    return NULL;
+  }
+  cmd_queue_t *q = &s_cmd.queues[target];
+  void *self = os_cmd_port_self();
+  uint32_t start = os_cmd_port_now_ms();
+  uint32_t left = timeout_ms;
+
+  for (;;) {
+    cmd_slot_t *slot = NULL;
+    os_cmd_port_lock();
+    while (slot == NULL && q->head != q->tail) {
+      cmd_slot_t *next = &s_cmd.slots[q->index[q->head++ & CMD_QUEUE_MASK]];
+      if (next->abandoned) {
+        s_cmd.stats.late++;
+        slot_free(next);
+      } else {
+        next->state = CMD_TAKEN;
+        slot = next;
+      }
+    }
+    /*
+     * Registered only while waiting here. A caller that read it just before
+     * this returns still wakes this task afterwards (see os_cmd.h).
+     */
+    q->receiver = (slot == NULL && left != 0) ? self : NULL;
+    os_cmd_port_unlock();
+    if (slot != NULL) {
+      return &slot->cmd;
+    }
+    if (left == 0) {
+      return NULL;
+    }
+    os_cmd_port_wait(left);
+    left = time_left(start, timeout_ms);
+  }
+}
+
+os_err_t os_cmd_respond(os_cmd_t *cmd, os_cmd_corr_t corr, os_err_t status)
+{
+  cmd_slot_t *slot = slot_of(cmd);
+  if (slot == NULL || cmd->len > OS_CMD_DATA_MAX) {
+    return OS_EINVAL;
+  }
+  void *waiter = NULL;
+  os_cmd_port_lock();
+  if (slot->state != CMD_TAKEN || slot->corr != corr) {
+    os_cmd_port_unlock();
+    return OS_ESTATE;
+  }
+  if (slot->abandoned) {
+    s_cmd.stats.late++;
+    slot_free(slot);
+  } else {
+    cmd->status = status;
+    slot->state = CMD_DONE;
+    waiter = slot->waiter;
+  }
+  os_cmd_port_unlock();
+  if (waiter != NULL) {
+    os_cmd_port_wake(waiter);
+  }
+  return OS_OK;
+}
+
+void os_cmd_get_stats(os_cmd_stats_t *out)
+{
+  if (out == NULL) {
+    return;
+  }
+  os_cmd_port_lock();
+  *out = s_cmd.stats;
+  os_cmd_port_unlock();
+  out->mem_bytes = sizeof(s_cmd);
+}
@@ -0,0 +1,1240 @@
+/*
+ * os_evt_bus.c — bounded publish/subscribe bus for os_evt_t (platform-agnostic core)
+ */
+
+#include <stdatomic.h>
+#include <string.h>
+
+#include "os_evt_bus.h"
+#include "os_evt_bus_port.h"
+#include "os_evt_trace.h"
+
+#define BUS_QUEUE_MASK (OS_EVT_BUS_QUEUE_DEPTH - 1u)
+#define BUS_WORKER_MASK (OS_EVT_BUS_WORKER_DEPTH - 1u)
+#define BUS_ORDER_MASK (OS_EVT_BUS_MAX_COALESCE - 1u)
+#define BUS_EVT_CALLS  (OS_EVT_BUS_MAX_SUBS_PER_EVT + OS_EVT_BUS_MAX_MASK_SUBS)
+/* Snapshot of one batch: room for the worst case of one event, four per-id subscribers on average after that */
+#define BUS_BATCH_CALLS (OS_EVT_BUS_MAX_BATCH * OS_EVT_BUS_MAX_SUBS_PER_EVT + OS_EVT_BUS_MAX_MASK_SUBS)
+
+_Static_assert((OS_EVT_BUS_QUEUE_DEPTH & BUS_QUEUE_MASK) == 0, "OS_EVT_BUS_QUEUE_DEPTH must be a power of two");
+_Static_assert(OS_EVT_BUS_MAX_HANDLES <= 255u, "handle index must fit the low byte of the slot");
+_Static_assert((OS_EVT_BUS_MAX_COALESCE & (OS_EVT_BUS_MAX_COALESCE - 1u)) == 0 && OS_EVT_BUS_MAX_COALESCE <= 255u,
+               "OS_EVT_BUS_MAX_COALESCE must be a power of two below 256");
+_Static_assert(OS_EVT_BUS_POOL_BLOCKS >= 1u && OS_EVT_BUS_POOL_BLOCKS <= 255u, "OS_EVT_BUS_POOL_BLOCKS must be 1..255");
+_Static_assert(OS_EVT_BUS_POOL_BLOCK_SIZE > OS_EVT_INLINE_MAX && OS_EVT_BUS_POOL_BLOCK_SIZE <= UINT16_MAX &&
+               OS_EVT_BUS_POOL_BLOCK_SIZE % 8u == 0, "OS_EVT_BUS_POOL_BLOCK_SIZE must be a multiple of 8 above OS_EVT_INLINE_MAX");
+_Static_assert(EVT__MAX <= 32u, "os_evt_mask_t has one bit per id");
+_Static_assert(OS_EVT_BUS_LANES >= 2u && OS_EVT_BUS_LANES <= 4u, "OS_EVT_BUS_LANES must be 2..4");
+_Static_assert(OS_EVT_BUS_MAX_BATCH >= 1u && OS_EVT_BUS_MAX_BATCH <= 255u, "OS_EVT_BUS_MAX_BATCH must be 1..255");
+_Static_assert((OS_EVT_BUS_STAGE_DEPTH & (OS_EVT_BUS_STAGE_DEPTH - 1u)) == 0 && OS_EVT_BUS_STAGE_DEPTH >= 2u,
+               "OS_EVT_BUS_STAGE_DEPTH must be a power of two");
+_Static_assert(OS_EVT_BUS_MAX_WORKERS >= 1u && OS_EVT_BUS_MAX_WORKERS <= 8u, "OS_EVT_BUS_MAX_WORKERS must be 1..8");
+_Static_assert((OS_EVT_BUS_WORKER_DEPTH & (OS_EVT_BUS_WORKER_DEPTH - 1u)) == 0,
+               "OS_EVT_BUS_WORKER_DEPTH must be a power of two");
+
+/* ==========================================================================
+ * State
+ *
+ * A subscription slot packs (generation << 8) | (index + 1), so 0 is free.
+ *
+ * Every id is queued in the lane os_evt_meta[] gives it. Every accepted entry
+ * gets a bus-wide sequence stamp. FIFO entries carry it in the lane's
+ * queue_seq[]; a coalesced id keeps one entry in coalesce[] stamped at its
+ * first pending publish, and the pending ones are listed in that order in
+ * their lane's order[]. Within a lane, dispatch takes whichever head has the
+ * older stamp, so coalescing changes what is delivered but not where.
+ *
+ * A payload above OS_EVT_INLINE_MAX is copied into a pool block; the queue
+ * entry holds the block pointer (os_evt_data()) and one reference. Dispatch
+ * drops that reference after the last callback; a pending coalesced entry
+ * drops it when a newer publish replaces it. Free blocks are a stack of
+ * indices.
+ *
+ * Dispatch takes a batch of events and copies the cb/user_ctx of their live
+ * subscribers under one lock. Unsubscribe bumps s_sub_epoch; while it is
+ * unchanged the copies are still exact and callbacks run without the lock,
+ * otherwise each remaining entry is checked against its handle first.
+ *
+ * Every outcome of a publish is traced under the lock, so trace order
+ * matches queue order; a record's ref is the entry's sequence stamp.
+ *
+ * In contention mode a publish claims a cell of its staging ring with one
+ * CAS (bounded MPMC ring: each cell's seq says whether it is free or
+ * filled for the current lap) and takes a stamp from one atomic counter;
+ * nothing else is shared between producers. Whoever holds the lock merges
+ * the rings (stage_merge(): the dispatcher before each batch, a publisher
+ * whose ring is full, get_stats): it repeatedly takes the ready ring head
+ * with the oldest stamp and runs it through the normal accept path, so
+ * lanes, coalescing, stats and trace see staged events as if they had just
+ * been published. A FIFO head whose lane is full stays put. The dispatcher
+ * is notified once until a merge finds the rings empty (s_stage.kick), not
+ * once per publish.
+ *
+ * A deferred subscriber's call is not run by dispatch: the event, cb,
+ * user_ctx, slot and the batch's epoch go into its module's worker ring
+ * (single producer: the dispatch context, single consumer: the worker),
+ * without the lock. A pool payload gets one more reference per handoff,
+ * taken with the snapshot, given back by the worker (or at the end of the
+ * batch if the ring was full). The worker checks the handle like dispatch
+ * does: unchanged epoch, still live. Every callback is timed with the
+ * trace clock; the times are added to the handles' stats under the lock
+ * dispatch (or the worker) takes anyway afterwards.
+ * ========================================================================== */
+
+#define OS_EVT_META_(ID, name, type, src, lane, coalesce) \
+  [EVT_##ID] = { #name, (uint16_t)sizeof(type), src, lane, coalesce },
+#define OS_EVT_META_EMPTY_(ID, name, src, lane, coalesce) \
+  [EVT_##ID] = { #name, 0, src, lane, coalesce },
+
+const os_evt_meta_t os_evt_meta[EVT__MAX] = {
+  [EVT_NONE] = { "none", 0, OS_MOD_NONE, OS_EVT_LANE_NORMAL, 0 },
+  OS_EVT_TABLE(OS_EVT_META_, OS_EVT_META_EMPTY_)
+};
+
+static const uint32_t s_lane_weight[4] = OS_EVT_BUS_LANE_WEIGHTS;
+
+typedef struct {
+  os_evt_cb_t cb;
+  void       *user_ctx;
+  os_evt_id_t id;
+  uint8_t     gen;
+  bool        active;
+  uint8_t     worker; /* s_workers[] index + 1; 0 = runs on the dispatcher */
+  os_evt_sub_stats_t stats;
+} bus_handle_t;
+
+typedef struct {
+  os_evt_t evt;
+  uint32_t seq;
+  bool     pending;
+} bus_coalesce_t;
+
+typedef enum {
+  BUS_CALL_SKIPPED = 0, /* unsubscribed since the snapshot */
+  BUS_CALL_RAN,
+  BUS_CALL_DEFERRED,
+  BUS_CALL_DEFER_FULL,
+} bus_call_outcome_t;
+
+typedef struct {
+  os_evt_cb_t cb;
+  void       *user_ctx;
+  uint16_t    slot;
+  uint8_t     worker;  /* as bus_handle_t */
+  uint8_t     outcome; /* bus_call_outcome_t */
+  uint32_t    ticks;   /* run time, trace clock */
+} bus_call_t;
+
+/* One deferred call */
+typedef struct {
+  os_evt_t    evt;
+  os_evt_cb_t cb;
+  void       *user_ctx;
+  uint16_t    slot;
+  unsigned    epoch; /* s_sub_epoch of the snapshot that validated slot */
+} bus_work_t;
+
+typedef struct {
+  _Atomic uint32_t head; /* worker */
+  _Atomic uint32_t tail; /* dispatch */
+  bus_work_t items[OS_EVT_BUS_WORKER_DEPTH];
+} bus_worker_t;
+
+typedef struct {
+  os_evt_t queue[OS_EVT_BUS_QUEUE_DEPTH];
+  uint32_t queue_seq[OS_EVT_BUS_QUEUE_DEPTH];
+  uint32_t head;  /* free-running; next event to dispatch */
+  uint32_t tail;  /* free-running; next free entry */
+  uint8_t  order[OS_EVT_BUS_MAX_COALESCE]; /* pending coalesce[] entries of this lane */
+  uint32_t order_head;
+  uint32_t order_tail;
+  uint32_t credit;  /* OS_EVT_SCHED_WEIGHTED: dispatches left this round */
+  uint32_t skipped; /* OS_EVT_SCHED_STRICT: dispatches given to higher lanes while waiting */
+} bus_lane_t;
+
+typedef struct {
+  bus_handle_t handles[OS_EVT_BUS_MAX_HANDLES];
+  uint16_t     subs[EVT__MAX][OS_EVT_BUS_MAX_SUBS_PER_EVT];
+  uint16_t     mask_subs[OS_EVT_BUS_MAX_MASK_SUBS];
+  os_evt_mask_t mask_bits[OS_EVT_BUS_MAX_MASK_SUBS]; /* copy of each entry's mask: dispatch tests one bit */
+  bus_lane_t   lanes[OS_EVT_BUS_LANES];
+  uint32_t     seq;   /* stamp of the next accepted entry */
+  os_evt_sched_t sched;
+  uint32_t     batch; /* os_evt_bus_dispatch_all() batch size */
+
+  uint8_t        coalesce_of[EVT__MAX];  /* coalesce[] index + 1, 0 = FIFO */
+  bus_coalesce_t coalesce[OS_EVT_BUS_MAX_COALESCE];
+
+  _Alignas(8) uint8_t pool[OS_EVT_BUS_POOL_BLOCKS][OS_EVT_BUS_POOL_BLOCK_SIZE];
+  uint8_t      pool_ref[OS_EVT_BUS_POOL_BLOCKS];
+  uint8_t      pool_free[OS_EVT_BUS_POOL_BLOCKS]; /* stack of free block indices */
+  uint32_t     pool_free_num;
+
+  uint8_t      worker_of[OS_MOD_MAX];  /* s_workers[] index + 1, 0 = no queue */
+  uint32_t     ticks_per_us;           /* trace clock */
+  os_evt_bus_stats_t stats;
+} bus_t;
+
+static bus_t s_bus;
+static atomic_uint s_sub_epoch; /* bumped by every unsubscribe */
+static bus_worker_t s_workers[OS_EVT_BUS_MAX_WORKERS];
+
+#if OS_EVT_BUS_STAGE_RINGS
+#define BUS_STAGE_MASK (OS_EVT_BUS_STAGE_DEPTH - 1u)
+
+typedef struct {
+  _Atomic uint32_t seq; /* lap position when free, position + 1 when filled */
+  uint32_t stamp;
+  os_evt_t evt;
+} bus_stage_cell_t;
+
+/* Producers touch tail and the cells, the merge head and the cells: keep them on separate cache lines */
+typedef struct {
+  _Alignas(64) _Atomic uint32_t tail;
+  _Alignas(64) uint32_t head;
+  bus_stage_cell_t cells[OS_EVT_BUS_STAGE_DEPTH];
+} bus_stage_ring_t;
+
+static struct {
+  _Alignas(64) _Atomic uint32_t stamp; /* order across rings */
+  atomic_bool kick;                    /* dispatcher notified, rings not found empty since */
+  atomic_bool on;
+  bus_stage_ring_t rings[OS_EVT_BUS_STAGE_RINGS];
+} s_stage;
+#endif
+
+/* ==========================================================================
+ * Helpers (called with the port lock held)
+ * ========================================================================== */
+
+static uint16_t make_slot(uint32_t index, uint8_t gen)
+{
+  return (uint16_t)(((uint32_t)gen << 8) | (index + 1u));
+}
+
+static bus_handle_t *live_handle(uint16_t slot)
+{
+  uint32_t index = (slot & 0xFFu) - 1u;
+  if (slot == 0 || index >= OS_EVT_BUS_MAX_HANDLES) {
+    return NULL;
+  }
+  bus_handle_t *h = &s_bus.handles[index];
+  return (h->active && h->gen == (uint8_t)(slot >> 8)) ? h : NULL;
+}
+
+/* Block index of a pool payload pointer, or -1 */
+static int pool_index(const void *payload)
+{
+  uintptr_t off = (uintptr_t)payload - (uintptr_t)s_bus.pool[0];
+  if ((uintptr_t)payload < (uintptr_t)s_bus.pool[0] || off >= sizeof(s_bus.pool) ||
+      off % OS_EVT_BUS_POOL_BLOCK_SIZE != 0) {
+    return -1;
+  }
+  return (int)(off / OS_EVT_BUS_POOL_BLOCK_SIZE);
+}
+
+static uint8_t *pool_alloc(void)
+{
+  if (s_bus.pool_free_num == 0) {
+    s_bus.stats.pool_empty++;
+    return NULL;
+  }
+  uint8_t i = s_bus.pool_free[--s_bus.pool_free_num];
+  s_bus.pool_ref[i] = 1;
+  s_bus.stats.pool_used++;
+  if (s_bus.stats.pool_used > s_bus.stats.pool_high_water) {
+    s_bus.stats.pool_high_water = s_bus.stats.pool_used;
+  }
+  return s_bus.pool[i];
+}
+
+static void pool_release(const void *payload)
+{
+  int i = pool_index(payload);
+  if (i < 0 || s_bus.pool_ref[i] == 0) {
+    return;
+  }
+  if (--s_bus.pool_ref[i] == 0) {
+    s_bus.pool_free[s_bus.pool_free_num++] = (uint8_t)i;
+    s_bus.stats.pool_used--;
+  }
+}
+
+/* block != NULL: payload already copied there, the entry takes the caller's reference */
+static void fill_evt(os_evt_t *evt, os_mod_id_t src, os_evt_id_t id, uint32_t ts_ms, const void *payload, uint16_t len,
+                     const uint8_t *block)
+{
+  evt->id = id;
+  evt->src = src;
+  evt->ts_ms = ts_ms;
+  evt->len = len;
+  if (block != NULL) {
+    memcpy(evt->payload, &block, sizeof(block));
+  } else if (len) {
+    memcpy(evt->payload, payload, len);
+  }
+}
+
+static uint32_t lane_of(os_evt_id_t id)
+{
+  uint32_t cls = os_evt_meta[id].lane;
+  return cls < OS_EVT_BUS_LANES ? cls : OS_EVT_BUS_LANES - 1u;
+}
+
+static uint32_t lane_depth(const bus_lane_t *lane)
+{
+  return (lane->tail - lane->head) + (lane->order_tail - lane->order_head);
+}
+
+static void lane_refill(void)
+{
+  for (uint32_t l = 0; l < OS_EVT_BUS_LANES; l++) {
+    s_bus.lanes[l].credit = s_lane_weight[l] ? s_lane_weight[l] : 1u;
+  }
+}
+
+/* Stamp of the lane's next entry; false when the lane is empty */
+static bool lane_next_seq(const bus_lane_t *lane, uint32_t *seq)
+{
+  bool fifo = lane->head != lane->tail;
+  bool coalesced = lane->order_head != lane->order_tail;
+  if (!fifo && !coalesced) {
+    return false;
+  }
+  uint32_t fifo_seq = fifo ? lane->queue_seq[lane->head & BUS_QUEUE_MASK] : 0;
+  uint32_t c_seq = coalesced ? s_bus.coalesce[lane->order[lane->order_head & BUS_ORDER_MASK]].seq : 0;
+  *seq = (!coalesced || (fifo && (int32_t)(fifo_seq - c_seq) < 0)) ? fifo_seq : c_seq;
+  return true;
+}
+
+/* Returns the entry's sequence stamp */
+static uint32_t lane_pop(bus_lane_t *lane, os_evt_t *evt)
+{
+  bool fifo = lane->head != lane->tail;
+  bool coalesced = lane->order_head != lane->order_tail;
+  bus_coalesce_t *entry = coalesced ? &s_bus.coalesce[lane->order[lane->order_head & BUS_ORDER_MASK]] : NULL;
+  if (entry != NULL && (!fifo || (int32_t)(entry->seq - lane->queue_seq[lane->head & BUS_QUEUE_MASK]) < 0)) {
+    *evt = entry->evt;
+    entry->pending = false;
+    lane->order_head++;
+    return entry->seq;
+  }
+  *evt = lane->queue[lane->head & BUS_QUEUE_MASK];
+  return lane->queue_seq[lane->head++ & BUS_QUEUE_MASK];
+}
+
+/*
+ * Lane to dispatch from, or -1 when every lane is empty. Both priority modes
+ * bound how long a non-empty lane waits: STRICT serves it once it has been
+ * passed over OS_EVT_BUS_STARVE_LIMIT times, WEIGHTED within one round
+ * (the sum of the weights).
+ */
+static int pick_lane(void)
+{
+  uint32_t seq[OS_EVT_BUS_LANES];
+  bool ready[OS_EVT_BUS_LANES];
+  int top = -1;
+  int pick = -1;
+
+  for (uint32_t l = 0; l < OS_EVT_BUS_LANES; l++) {
+    ready[l] = lane_next_seq(&s_bus.lanes[l], &seq[l]);
+    if (ready[l] && top < 0) {
+      top = (int)l;
+    }
+  }
+  if (top < 0) {
+    return -1;
+  }
+
+  switch (s_bus.sched) {
+  case OS_EVT_SCHED_FIFO:
+    pick = top;
+    for (uint32_t l = (uint32_t)top + 1u; l < OS_EVT_BUS_LANES; l++) {
+      if (ready[l] && (int32_t)(seq[l] - seq[pick]) < 0) {
+        pick = (int)l;
+      }
+    }
+    return pick;
+
+  case OS_EVT_SCHED_WEIGHTED:
+    for (int round = 0; round < 2 && pick < 0; round++) {
+      for (uint32_t l = 0; l < OS_EVT_BUS_LANES && pick < 0; l++) {
+        if (ready[l] && s_bus.lanes[l].credit > 0) {
+          pick = (int)l;
+        }
+      }
+      if (pick < 0) {
+        lane_refill();
+      }
+    }
+    s_bus.lanes[pick].credit--;
+    break;
+
+  case OS_EVT_SCHED_STRICT:
+  default:
+    pick = top;
+    for (uint32_t l = (uint32_t)top + 1u; l < OS_EVT_BUS_LANES; l++) {
+      if (ready[l] && s_bus.lanes[l].skipped >= OS_EVT_BUS_STARVE_LIMIT) {
+        pick = (int)l;
+        break;
+      }
+    }
+    for (uint32_t l = 0; l < OS_EVT_BUS_LANES; l++) {
+      if (!ready[l] || (int)l == pick) {
+        s_bus.lanes[l].skipped = 0;
+      } else if ((int)l > pick) {
+        s_bus.lanes[l].skipped++;
+      }
+    }
+    break;
+  }
+  if (pick != top) {
+    s_bus.stats.lane[pick].promoted++;
+  }
+  return pick;
+}
+
+/* Live subscribers of id into calls[], per-id list first; stale entries are repaired on the way */
+static uint32_t snapshot_calls(os_evt_id_t id, bus_call_t *calls)
+{
+  uint32_t n = 0;
+  for (uint32_t i = 0; i < OS_EVT_BUS_MAX_SUBS_PER_EVT; i++) {
+    uint16_t slot = s_bus.subs[id][i];
+    if (slot == 0) {
+      continue;
+    }
+    bus_handle_t *h = live_handle(slot);
+    if (h == NULL) {
+      s_bus.subs[id][i] = 0;
+      s_bus.stats.healed++;
+      continue;
+    }
+    calls[n++] = (bus_call_t){ h->cb, h->user_ctx, slot, h->worker, BUS_CALL_SKIPPED, 0 };
+  }
+  /* One bit test per mask subscriber */
+  for (uint32_t m = 0; m < OS_EVT_BUS_MAX_MASK_SUBS; m++) {
+    if (!(s_bus.mask_bits[m] & OS_EVT_BIT(id))) {
+      continue;
+    }
+    bus_handle_t *h = live_handle(s_bus.mask_subs[m]);
+    if (h == NULL) {
+      s_bus.mask_subs[m] = 0;
+      s_bus.mask_bits[m] = 0;
+      s_bus.stats.healed++;
+      continue;
+    }
+    calls[n++] = (bus_call_t){ h->cb, h->user_ctx, s_bus.mask_subs[m], 0, BUS_CALL_SKIPPED, 0 };
+  }
+  return n;
+}
+
+/* Add one callback's run time to its subscriber (lock held; h NULL if it unsubscribed meanwhile) */
+static void sub_account(bus_handle_t *h, uint32_t ticks)
+{
+  if (h == NULL) {
+    return;
+  }
+  uint32_t us = ticks / s_bus.ticks_per_us;
+  h->stats.calls++;
+  if (us > h->stats.max_us) {
+    h->stats.max_us = us;
+  }
+  if (h->stats.budget_us != 0 && us > h->stats.budget_us) {
+    h->stats.overruns++;
+    s_bus.stats.overruns++;
+  }
+}
+
+/* Count what became of one snapshot entry once its batch ran, give back an unused handoff reference */
+static void call_settle(const os_evt_t *evt, const bus_call_t *call)
+{
+  bus_handle_t *h = live_handle(call->slot);
+  switch ((bus_call_outcome_t)call->outcome) {
+  case BUS_CALL_RAN:
+    sub_account(h, call->ticks);
+    return;
+  case BUS_CALL_DEFERRED:
+    s_bus.stats.deferred++;
+    if (h != NULL) {
+      h->stats.deferred++;
+    }
+    return;
+  case BUS_CALL_DEFER_FULL:
+    s_bus.stats.defer_dropped++;
+    if (h != NULL) {
+      h->stats.dropped++;
+    }
+    break;
+  case BUS_CALL_SKIPPED:
+  default:
+    break;
+  }
+  if (call->worker != 0 && evt->len > OS_EVT_INLINE_MAX) {
+    pool_release(os_evt_data(evt));
+  }
+}
+
+/* s_workers[] index + 1 of the module's queue, claimed on first use; 0 when every queue is taken */
+static uint8_t worker_claim(os_mod_id_t owner)
+{
+  for (uint32_t w = 0; w < OS_EVT_BUS_MAX_WORKERS && s_bus.worker_of[owner] == 0; w++) {
+    if (s_bus.stats.worker[w].owner == OS_MOD_NONE) {
+      s_bus.stats.worker[w].owner = owner;
+      s_bus.worker_of[owner] = (uint8_t)(w + 1u);
+    }
+  }
+  return s_bus.worker_of[owner];
+}
+
+static os_err_t bus_set_policy(os_evt_id_t id, os_evt_policy_t policy)
+{
+  uint8_t c = s_bus.coalesce_of[id];
+  if (c != 0 && s_bus.coalesce[c - 1u].pending) {
+    return OS_EBUSY;
+  }
+  if (policy == OS_EVT_POLICY_FIFO) {
+    s_bus.coalesce_of[id] = 0;
+    return OS_OK;
+  }
+  if (c != 0) {
+    return OS_OK;
+  }
+  for (uint32_t i = 0; i < OS_EVT_BUS_MAX_COALESCE; i++) {
+    bool used = false;
+    for (uint32_t e = 0; e < EVT__MAX && !used; e++) {
+      used = s_bus.coalesce_of[e] == i + 1u;
+    }
+    if (!used) {
+      s_bus.coalesce_of[id] = (uint8_t)(i + 1u);
+      return OS_OK;
+    }
+  }
+  return OS_EFULL;
+}
+
+/* Queue a filled event (lock held); a refused event's pool block is released */
+static os_err_t bus_accept(const os_evt_t *evt)
+{
+  os_evt_id_t id = evt->id;
+  uint32_t l = lane_of(id);
+  bus_lane_t *lane = &s_bus.lanes[l];
+  uint8_t c = s_bus.coalesce_of[id];
+
+  if (c != 0) {
+    /* Coalesced: overwrite the pending entry in place, or start one */
+    bus_coalesce_t *entry = &s_bus.coalesce[c - 1u];
+    bool merged = entry->pending;
+    if (merged) {
+      s_bus.stats.coalesced++;
+      if (entry->evt.len > OS_EVT_INLINE_MAX) {
+        pool_release(os_evt_data(&entry->evt));
+      }
+    } else {
+      entry->pending = true;
+      entry->seq = s_bus.seq++;
+      lane->order[lane->order_tail++ & BUS_ORDER_MASK] = (uint8_t)(c - 1u);
+    }
+    entry->evt = *evt;
+    os_evt_trace_record(merged ? OS_EVT_TRACE_COALESCE : OS_EVT_TRACE_PUBLISH, id, evt->src, entry->seq,
+                        lane_depth(lane));
+  } else {
+    uint32_t depth = lane->tail - lane->head;
+    if (depth == OS_EVT_BUS_QUEUE_DEPTH) {
+      s_bus.stats.dropped++;
+      s_bus.stats.lane[l].dropped++;
+      os_evt_trace_record(OS_EVT_TRACE_DROP, id, evt->src, 0, lane_depth(lane));
+      if (evt->len > OS_EVT_INLINE_MAX) {
+        pool_release(os_evt_data(evt));
+      }
+      return OS_EFULL;
+    }
+    lane->queue[lane->tail & BUS_QUEUE_MASK] = *evt;
+    lane->queue_seq[lane->tail & BUS_QUEUE_MASK] = s_bus.seq++;
+    lane->tail++;
+    os_evt_trace_record(OS_EVT_TRACE_PUBLISH, id, evt->src, s_bus.seq - 1u, lane_depth(lane));
+    if (depth + 1u > s_bus.stats.high_water) {
+      s_bus.stats.high_water = depth + 1u;
+    }
+  }
+  s_bus.stats.published++;
+  s_bus.stats.lane[l].published++;
+  uint32_t queued = lane_depth(lane);
+  if (queued > s_bus.stats.lane[l].high_water) {
+    s_bus.stats.lane[l].high_water = queued;
+  }
+  return OS_OK;
+}
+
+/* ==========================================================================
+ * Staging rings (contention mode)
+ * ========================================================================== */
+
+#if OS_EVT_BUS_STAGE_RINGS
+static void stage_reset(void)
+{
+  for (uint32_t r = 0; r < OS_EVT_BUS_STAGE_RINGS; r++) {
+    bus_stage_ring_t *ring = &s_stage.rings[r];
+    for (uint32_t i = 0; i < OS_EVT_BUS_STAGE_DEPTH; i++) {
+      atomic_store_explicit(&ring->cells[i].seq, i, memory_order_relaxed);
+    }
+    atomic_store_explicit(&ring->tail, 0, memory_order_relaxed);
+    ring->head = 0;
+  }
+  atomic_store_explicit(&s_stage.stamp, 0, memory_order_relaxed);
+  atomic_store_explicit(&s_stage.kick, false, memory_order_relaxed);
+  atomic_store_explicit(&s_stage.on, OS_EVT_BUS_STAGING_DEFAULT, memory_order_relaxed);
+}
+
+/* Any context, no lock; false when the ring is full */
+static bool stage_push(bus_stage_ring_t *ring, const os_evt_t *evt)
+{
+  bus_stage_cell_t *cell;
+  uint32_t pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+  for (;;) {
+    cell = &ring->cells[pos & BUS_STAGE_MASK];
+    int32_t lap = (int32_t)(atomic_load_explicit(&cell->seq, memory_order_acquire) - pos);
+    if (lap == 0) {
+      if (atomic_compare_exchange_weak_explicit(&ring->tail, &pos, pos + 1u, memory_order_relaxed,
+                                                memory_order_relaxed)) {
+        break;
+      }
+    } else if (lap < 0) {
+      return false; /* the merge has not taken this cell's previous lap */
+    } else {
+      pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    }
+  }
+  cell->evt = *evt;
+  cell->stamp = atomic_fetch_add_explicit(&s_stage.stamp, 1u, memory_order_relaxed);
+  atomic_store_explicit(&cell->seq, pos + 1u, memory_order_release);
+  return true;
+}
+
+/* Filled head cell the merge may take now (lock held): not a FIFO event whose lane is full */
+static bus_stage_cell_t *stage_head(bus_stage_ring_t *ring)
+{
+  bus_stage_cell_t *cell = &ring->cells[ring->head & BUS_STAGE_MASK];
+  if (atomic_load_explicit(&cell->seq, memory_order_acquire) != ring->head + 1u) {
+    return NULL;
+  }
+  const bus_lane_t *lane = &s_bus.lanes[lane_of(cell->evt.id)];
+  if (s_bus.coalesce_of[cell->evt.id] == 0 && lane->tail - lane->head == OS_EVT_BUS_QUEUE_DEPTH) {
+    return NULL;
+  }
+  return cell;
+}
+
+/* No ring has a filled head cell (lock held) */
+static bool stage_idle(void)
+{
+  for (uint32_t r = 0; r < OS_EVT_BUS_STAGE_RINGS; r++) {
+    const bus_stage_ring_t *ring = &s_stage.rings[r];
+    if (atomic_load_explicit(&ring->cells[ring->head & BUS_STAGE_MASK].seq, memory_order_acquire) == ring->head + 1u) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * Move staged events into the lanes, oldest stamp first (lock held). The
+ * scan repeats until it finds nothing older: an event seen filled
+ * guarantees that everything its publisher staged before it is visible
+ * too, even in another ring. Bounded to one pass over every cell. Once
+ * the rings are empty the kick is cleared and they are scanned once more.
+ */
+static void stage_merge(void)
+{
+  bool cleared = false;
+  for (uint32_t budget = OS_EVT_BUS_STAGE_RINGS * OS_EVT_BUS_STAGE_DEPTH; budget > 0; budget--) {
+    bus_stage_ring_t *best = NULL;
+    bus_stage_cell_t *best_cell = NULL;
+    bool changed;
+    do {
+      changed = false;
+      for (uint32_t r = 0; r < OS_EVT_BUS_STAGE_RINGS; r++) {
+        bus_stage_cell_t *cell = stage_head(&s_stage.rings[r]);
+        if (cell != NULL && (best_cell == NULL || (int32_t)(cell->stamp - best_cell->stamp) < 0)) {
+          best = &s_stage.rings[r];
+          best_cell = cell;
+          changed = true;
+        }
+      }
+    } while (changed);
+    if (best == NULL) {
+      if (cleared || !stage_idle()) {
+        return; /* held behind a full lane: the dispatcher comes back for it */
+      }
+      atomic_store_explicit(&s_stage.kick, false, memory_order_relaxed);
+      atomic_thread_fence(memory_order_seq_cst); /* pairs with stage_publish(): no publish is missed and not woken for */
+      cleared = true;
+      continue;
+    }
+    os_evt_t evt = best_cell->evt;
+    atomic_store_explicit(&best_cell->seq, best->head + OS_EVT_BUS_STAGE_DEPTH, memory_order_release);
+    best->head++;
+    s_bus.stats.staged++;
+    bus_accept(&evt); /* cannot be refused: stage_head() checked the lane */
+  }
+}
+
+static os_err_t stage_publish(const os_evt_t *evt, bool *wake)
+{
+  bus_stage_ring_t *ring = &s_stage.rings[os_evt_bus_port_stage_index() % OS_EVT_BUS_STAGE_RINGS];
+  if (stage_push(ring, evt)) {
+    /* Notify once until a merge finds the rings empty */
+    atomic_thread_fence(memory_order_seq_cst);
+    *wake = !atomic_load_explicit(&s_stage.kick, memory_order_relaxed) &&
+            !atomic_exchange_explicit(&s_stage.kick, true, memory_order_relaxed);
+    return OS_OK;
+  }
+
+  /* Ring full: merge it ourselves, then retry once */
+  os_err_t err = OS_OK;
+  os_evt_bus_port_lock();
+  s_bus.stats.stage_full++;
+  stage_merge();
+  if (!stage_push(ring, evt)) {
+    if (s_bus.coalesce_of[evt->id] != 0) {
+      err = bus_accept(evt); /* coalesced ids are never refused */
+    } else {
+      uint32_t l = lane_of(evt->id);
+      s_bus.stats.dropped++;
+      s_bus.stats.lane[l].dropped++;
+      os_evt_trace_record(OS_EVT_TRACE_DROP, evt->id, evt->src, 0, lane_depth(&s_bus.lanes[l]));
+      if (evt->len > OS_EVT_INLINE_MAX) {
+        pool_release(os_evt_data(evt));
+      }
+      err = OS_EFULL;
+    }
+  }
+  os_evt_bus_port_unlock();
+  *wake = err == OS_OK;
+  return err;
+}
+#else
+static void stage_reset(void)
+{
+}
+
+static void stage_merge(void)
+{
+}
+#endif
+
+/* *wake: the dispatcher should be notified */
+static os_err_t bus_enqueue(os_mod_id_t src, os_evt_id_t id, const void *payload, uint16_t len, bool *wake)
+{
+  *wake = false;
+  if (id == EVT_NONE || id >= EVT__MAX || len > OS_EVT_BUS_POOL_BLOCK_SIZE || (len && payload == NULL)) {
+    os_evt_bus_port_lock();
+    s_bus.stats.rejected++;
+    os_evt_trace_record(OS_EVT_TRACE_REJECT, id, src, 0, 0);
+    os_evt_bus_port_unlock();
+    return OS_EINVAL;
+  }
+  uint8_t *block = NULL;
+  os_evt_t evt;
+
+  if (len > OS_EVT_INLINE_MAX) {
+    /* Copy outside the lock; the block is ours until it is queued */
+    os_evt_bus_port_lock();
+    block = pool_alloc();
+    if (block == NULL) {
+      os_evt_trace_record(OS_EVT_TRACE_NOMEM, id, src, 0, lane_depth(&s_bus.lanes[lane_of(id)]));
+    }
+    os_evt_bus_port_unlock();
+    if (block == NULL) {
+      return OS_ENOMEM;
+    }
+    memcpy(block, payload, len);
+  }
+  fill_evt(&evt, src, id, os_evt_bus_port_now_ms(), payload, len, block);
+
+#if OS_EVT_BUS_STAGE_RINGS
+  if (atomic_load_explicit(&s_stage.on, memory_order_relaxed)) {
+    return stage_publish(&evt, wake);
+  }
+#endif
+  os_evt_bus_port_lock();
+  os_err_t err = bus_accept(&evt);
+  os_evt_bus_port_unlock();
+  *wake = err == OS_OK;
+  return err;
+}
+
+/* ==========================================================================
+ * Worker queues (deferred subscribers)
+ * ========================================================================== */
+
+/* Dispatch context, no lock; false when the queue is full */
+static bool worker_push(bus_worker_t *w, const os_evt_t *evt, const bus_call_t *call, unsigned epoch)
+{
+  uint32_t tail = atomic_load_explicit(&w->tail, memory_order_relaxed);
+  if (tail - atomic_load_explicit(&w->head, memory_order_acquire) == OS_EVT_BUS_WORKER_DEPTH) {
+    return false;
+  }
+  w->items[tail & BUS_WORKER_MASK] = (bus_work_t){ *evt, call->cb, call->user_ctx, call->slot, epoch };
+  atomic_store_explicit(&w->tail, tail + 1u, memory_order_release);
+  return true;
+}
+
+static void worker_reset(void)
+{
+  for (uint32_t w = 0; w < OS_EVT_BUS_MAX_WORKERS; w++) {
+    atomic_store_explicit(&s_workers[w].head, 0, memory_order_relaxed);
+    atomic_store_explicit(&s_workers[w].tail, 0, memory_order_relaxed);
+  }
+}
+
+/* ==========================================================================
+ * Public API
+ * ========================================================================== */
+
+os_err_t os_evt_bus_init(void)
+{
+  os_evt_bus_port_init();
+  memset(&s_bus, 0, sizeof(s_bus));
+  stage_reset();
+  worker_reset();
+  os_evt_trace_reset();
+  s_bus.sched = OS_EVT_BUS_SCHED_DEFAULT;
+  s_bus.batch = OS_EVT_BUS_MAX_BATCH;
+  s_bus.ticks_per_us = os_evt_bus_port_trace_hz() / 1000000u;
+  if (s_bus.ticks_per_us == 0) {
+    s_bus.ticks_per_us = 1;
+  }
+  atomic_store_explicit(&s_sub_epoch, 0, memory_order_relaxed);
+  lane_refill();
+  for (uint32_t i = 0; i < OS_EVT_BUS_POOL_BLOCKS; i++) {
+    s_bus.pool_free[i] = (uint8_t)(OS_EVT_BUS_POOL_BLOCKS - 1u - i);
+  }
+  s_bus.pool_free_num = OS_EVT_BUS_POOL_BLOCKS;
+  for (os_evt_id_t id = EVT_NONE + 1; id < EVT__MAX; id++) {
+    os_err_t err = os_evt_meta[id].coalesce ? bus_set_policy(id, OS_EVT_POLICY_COALESCE) : OS_OK;
+    if (err != OS_OK) {
+      return err;
+    }
+  }
+  return OS_OK;
+}
+
+os_err_t os_evt_bus_set_policy(os_evt_id_t id, os_evt_policy_t policy)
+{
+  if (id == EVT_NONE || id >= EVT__MAX || (policy != OS_EVT_POLICY_FIFO && policy != OS_EVT_POLICY_COALESCE)) {
+    return OS_EINVAL;
+  }
+  os_evt_bus_port_lock();
+  os_err_t err = bus_set_policy(id, policy);
+  os_evt_bus_port_unlock();
+  return err;
+}
+
+os_err_t os_evt_bus_set_staging(bool on)
+{
+#if OS_EVT_BUS_STAGE_RINGS
+  os_evt_bus_port_lock();
+  stage_merge();
+  atomic_store_explicit(&s_stage.on, on, memory_order_relaxed);
+  os_evt_bus_port_unlock();
+  return OS_OK;
+#else
+  return on ? OS_ENOTSUP : OS_OK;
+#endif
+}
+
+os_err_t os_evt_bus_set_sched(os_evt_sched_t sched)
+{
+  if (sched != OS_EVT_SCHED_STRICT && sched != OS_EVT_SCHED_WEIGHTED && sched != OS_EVT_SCHED_FIFO) {
+    return OS_EINVAL;
+  }
+  os_evt_bus_port_lock();
+  s_bus.sched = sched;
+  lane_refill();
+  for (uint32_t l = 0; l < OS_EVT_BUS_LANES; l++) {
+    s_bus.lanes[l].skipped = 0;
+  }
+  os_evt_bus_port_unlock();
+  return OS_OK;
+}
+
+os_err_t os_evt_bus_set_batch(uint32_t max)
+{
+  if (max == 0 || max > OS_EVT_BUS_MAX_BATCH) {
+    return OS_EINVAL;
+  }
+  os_evt_bus_port_lock();
+  s_bus.batch = max;
+  os_evt_bus_port_unlock();
+  return OS_OK;
+}
+
+uint32_t os_evt_bus_lane_of(os_evt_id_t id)
+{
+  return (id == EVT_NONE || id >= EVT__MAX) ? (uint32_t)OS_EVT_LANE_NORMAL : lane_of(id);
+}
+
+/* Claim a free handle into list[]: stale entries are repaired first so they never block a new subscriber */
+static os_evt_sub_handle_t bus_subscribe(uint16_t *list, uint32_t len, os_evt_id_t id, os_evt_cb_t cb,
+                                         void *user_ctx, int *pos_out)
+{
+  int pos = -1;
+  for (uint32_t i = 0; i < len; i++) {
+    if (list[i] != 0 && live_handle(list[i]) == NULL) {
+      list[i] = 0;
+      s_bus.stats.healed++;
+    }
+    if (list[i] == 0 && pos < 0) {
+      pos = (int)i;
+    }
+  }
+  if (pos < 0) {
+    return OS_EVT_SUB_HANDLE_INVALID;
+  }
+  for (uint32_t index = 0; index < OS_EVT_BUS_MAX_HANDLES; index++) {
+    bus_handle_t *h = &s_bus.handles[index];
+    if (h->active) {
+      continue;
+    }
+    h->cb = cb;
+    h->user_ctx = user_ctx;
+    h->id = id;
+    h->active = true;
+    h->worker = 0;
+    h->stats = (os_evt_sub_stats_t){ .budget_us = OS_EVT_BUS_CB_BUDGET_US };
+    list[pos] = make_slot(index, h->gen);
+    *pos_out = pos;
+    return (os_evt_sub_handle_t){ .id = id, .slot = list[pos] };
+  }
+  return OS_EVT_SUB_HANDLE_INVALID;
+}
+
+os_evt_sub_handle_t os_evt_bus_subscribe(os_evt_id_t id, os_evt_cb_t cb, void *user_ctx)
+{
+  if (id == EVT_NONE || id >= EVT__MAX || cb == NULL) {
+    return OS_EVT_SUB_HANDLE_INVALID;
+  }
+  int pos;
+  os_evt_bus_port_lock();
+  os_evt_sub_handle_t handle = bus_subscribe(s_bus.subs[id], OS_EVT_BUS_MAX_SUBS_PER_EVT, id, cb, user_ctx, &pos);
+  os_evt_bus_port_unlock();
+  return handle;
+}
+
+os_evt_sub_handle_t os_evt_bus_subscribe_deferred(os_evt_id_t id, os_evt_cb_t cb, void *user_ctx,
+                                                  os_mod_id_t worker)
+{
+  if (id == EVT_NONE || id >= EVT__MAX || cb == NULL || worker == OS_MOD_NONE || worker >= OS_MOD_MAX) {
+    return OS_EVT_SUB_HANDLE_INVALID;
+  }
+  int pos;
+  os_evt_sub_handle_t handle = OS_EVT_SUB_HANDLE_INVALID;
+  os_evt_bus_port_lock();
+  uint8_t w = worker_claim(worker);
+  if (w != 0) {
+    handle = bus_subscribe(s_bus.subs[id], OS_EVT_BUS_MAX_SUBS_PER_EVT, id, cb, user_ctx, &pos);
+  }
+  if (os_evt_bus_handle_valid(handle)) {
+    s_bus.handles[(handle.slot & 0xFFu) - 1u].worker = w;
+  }
+  os_evt_bus_port_unlock();
+  return handle;
+}
+
+os_evt_sub_handle_t os_evt_bus_subscribe_mask(os_evt_mask_t mask, os_evt_cb_t cb, void *user_ctx)
+{
+  const os_evt_mask_t valid = (os_evt_mask_t)((((uint64_t)1u << EVT__MAX) - 1u) & ~(uint64_t)OS_EVT_BIT(EVT_NONE));
+  if (mask == 0 || (mask & ~valid) != 0 || cb == NULL) {
+    return OS_EVT_SUB_HANDLE_INVALID;
+  }
+  int pos;
+  os_evt_bus_port_lock();
+  os_evt_sub_handle_t handle =
+    bus_subscribe(s_bus.mask_subs, OS_EVT_BUS_MAX_MASK_SUBS, OS_EVT_MASK_HANDLE_ID, cb, user_ctx, &pos);
+  for (uint32_t i = 0; i < OS_EVT_BUS_MAX_MASK_SUBS; i++) {
+    if (s_bus.mask_subs[i] == 0) {
+      s_bus.mask_bits[i] = 0; /* repaired by bus_subscribe() */
+    }
+  }
+  if (os_evt_bus_handle_valid(handle)) {
+    s_bus.mask_bits[pos] = mask;
+  }
+  os_evt_bus_port_unlock();
+  return handle;
+}
+
+void os_evt_bus_unsubscribe(os_evt_sub_handle_t handle)
+{
+  os_evt_bus_port_lock();
+  bus_handle_t *h = live_handle(handle.slot);
+  if (h != NULL && h->id == handle.id) {
+    /* Lazy: the event's list entry goes stale and is cleaned on the next pass */
+    h->active = false;
+    h->gen++;
+    atomic_fetch_add_explicit(&s_sub_epoch, 1u, memory_order_release);
+  }
+  os_evt_bus_port_unlock();
+}
+
+os_err_t os_evt_bus_set_budget(os_evt_sub_handle_t handle, uint32_t budget_us)
+{
+  os_err_t err = OS_EINVAL;
+  os_evt_bus_port_lock();
+  bus_handle_t *h = live_handle(handle.slot);
+  if (h != NULL && h->id == handle.id) {
+    h->stats.budget_us = budget_us;
+    err = OS_OK;
+  }
+  os_evt_bus_port_unlock();
+  return err;
+}
+
+os_err_t os_evt_bus_get_sub_stats(os_evt_sub_handle_t handle, os_evt_sub_stats_t *out)
+{
+  os_err_t err = OS_EINVAL;
+  os_evt_bus_port_lock();
+  bus_handle_t *h = live_handle(handle.slot);
+  if (h != NULL && h->id == handle.id) {
+    *out = h->stats;
+    err = OS_OK;
+  }
+  os_evt_bus_port_unlock();
+  return err;
+}
+
+os_err_t os_evt_bus_publish(os_mod_id_t src, os_evt_id_t id, const void *payload, uint16_t len)
+{
+  bool wake;
+  os_err_t err = bus_enqueue(src, id, payload, len, &wake);
+  if (wake) {
+    os_evt_bus_port_notify(false, NULL);
+  }
+  return err;
+}
+
+os_err_t os_evt_bus_publish_from_isr(os_mod_id_t src, os_evt_id_t id, const void *payload, uint16_t len,
+                                     bool *woken)
+{
+  bool wake;
+  os_err_t err = bus_enqueue(src, id, payload, len, &wake);
+  if (wake) {
+    os_evt_bus_port_notify(true, woken);
+  }
+  return err;
+}
+
+bool os_evt_bus_dispatch_one(void)
+{
+  return os_evt_bus_dispatch_batch(1) == 1;
+}
+
+size_t os_evt_bus_dispatch_batch(size_t max)
+{
+  os_evt_t evts[OS_EVT_BUS_MAX_BATCH];
+  uint32_t refs[OS_EVT_BUS_MAX_BATCH];
+  uint8_t depths[OS_EVT_BUS_MAX_BATCH];
+  uint8_t ncalls[OS_EVT_BUS_MAX_BATCH];
+  bus_call_t calls[BUS_BATCH_CALLS];
+  uint32_t used = 0;
+  uint32_t delivered = 0;
+  uint32_t kick = 0; /* workers handed a call */
+  size_t n = 0;
+
+  if (max > OS_EVT_BUS_MAX_BATCH) {
+    max = OS_EVT_BUS_MAX_BATCH;
+  }
+  os_evt_bus_port_lock();
+  stage_merge();
+  while (n < max && BUS_BATCH_CALLS - used >= BUS_EVT_CALLS) {
+    int l = pick_lane();
+    if (l < 0) {
+      break;
+    }
+    refs[n] = lane_pop(&s_bus.lanes[l], &evts[n]);
+    depths[n] = (uint8_t)lane_depth(&s_bus.lanes[l]);
+    s_bus.stats.dispatched++;
+    s_bus.stats.lane[l].dispatched++;
+    ncalls[n] = (uint8_t)snapshot_calls(evts[n].id, &calls[used]);
+    if (evts[n].len > OS_EVT_INLINE_MAX) {
+      int block = pool_index(os_evt_data(&evts[n]));
+      for (uint32_t i = used; i < used + ncalls[n] && block >= 0; i++) {
+        s_bus.pool_ref[block] += calls[i].worker != 0; /* the handoff's own reference */
+      }
+    }
+    used += ncalls[n];
+    n++;
+  }
+  unsigned epoch = atomic_load_explicit(&s_sub_epoch, memory_order_relaxed);
+  os_evt_bus_port_unlock();
+  if (n == 0) {
+    return 0;
+  }
+
+  used = 0;
+  for (size_t e = 0; e < n; e++) {
+    uint32_t ran = 0;
+    uint32_t t = 0;
+    bool timing = false; /* t is the end of the previous callback */
+    os_evt_trace_record(OS_EVT_TRACE_DISPATCH_START, evts[e].id, evts[e].src, refs[e], depths[e]);
+    for (uint32_t i = used; i < used + ncalls[e]; i++) {
+      /* A callback (or another task) unsubscribed since the snapshot: recheck before calling */
+      if (atomic_load_explicit(&s_sub_epoch, memory_order_acquire) != epoch) {
+        timing = false;
+        os_evt_bus_port_lock();
+        bool live = live_handle(calls[i].slot) != NULL;
+        os_evt_bus_port_unlock();
+        if (!live) {
+          continue;
+        }
+      }
+      if (calls[i].worker != 0) {
+        bool queued = worker_push(&s_workers[calls[i].worker - 1u], &evts[e], &calls[i], epoch);
+        calls[i].outcome = queued ? BUS_CALL_DEFERRED : BUS_CALL_DEFER_FULL;
+        kick |= queued ? 1u << (calls[i].worker - 1u) : 0u;
+        timing = false;
+        continue;
+      }
+      if (!timing) {
+        t = os_evt_bus_port_trace_ts();
+        timing = true;
+      }
+      calls[i].cb(&evts[e], calls[i].user_ctx);
+      uint32_t end = os_evt_bus_port_trace_ts();
+      calls[i].ticks = end - t;
+      t = end;
+      calls[i].outcome = BUS_CALL_RAN;
+      ran++;
+    }
+    os_evt_trace_record(OS_EVT_TRACE_DISPATCH_END, evts[e].id, evts[e].src, refs[e], ran);
+    delivered += ran;
+    used += ncalls[e];
+  }
+
+  os_mod_id_t owners[OS_EVT_BUS_MAX_WORKERS];
+  os_evt_bus_port_lock();
+  s_bus.stats.delivered += delivered;
+  used = 0;
+  for (size_t e = 0; e < n; e++) {
+    for (uint32_t i = used; i < used + ncalls[e]; i++) {
+      call_settle(&evts[e], &calls[i]);
+    }
+    used += ncalls[e];
+    if (evts[e].len > OS_EVT_INLINE_MAX) {
+      pool_release(os_evt_data(&evts[e]));
+    }
+  }
+  for (uint32_t w = 0; w < OS_EVT_BUS_MAX_WORKERS && kick != 0; w++) {
+    uint32_t depth = atomic_load_explicit(&s_workers[w].tail, memory_order_relaxed) -
+                     atomic_load_explicit(&s_workers[w].head, memory_order_relaxed);
+    if (depth > s_bus.stats.worker[w].high_water) {
+      s_bus.stats.worker[w].high_water = depth;
+    }
+    owners[w] = s_bus.stats.worker[w].owner;
+  }
+  os_evt_bus_port_unlock();
+
+  for (uint32_t w = 0; w < OS_EVT_BUS_MAX_WORKERS; w++) {
+    if (kick & (1u << w)) {
+      os_evt_bus_port_worker_notify(owners[w]);
+    }
+  }
+  return n;
+}
+
+size_t os_evt_bus_dispatch_all(void)
+{
+  size_t n = 0;
+  size_t taken;
+
+  os_evt_bus_port_lock();
+  uint32_t batch = s_bus.batch;
+  os_evt_bus_port_unlock();
+  while ((taken = os_evt_bus_dispatch_batch(batch)) > 0) {
+    n += taken;
+  }
+  return n;
+}
+
+size_t os_evt_bus_worker_run(os_mod_id_t worker)
+{
+  if (worker >= OS_MOD_MAX) {
+    return 0;
+  }
+  os_evt_bus_port_lock();
+  uint8_t index = s_bus.worker_of[worker];
+  os_evt_bus_port_unlock();
+  if (index == 0) {
+    return 0;
+  }
+
+  bus_worker_t *w = &s_workers[index - 1u];
+  uint32_t head = atomic_load_explicit(&w->head, memory_order_relaxed);
+  size_t n = 0;
+  while (head != atomic_load_explicit(&w->tail, memory_order_acquire)) {
+    const bus_work_t *item = &w->items[head & BUS_WORKER_MASK];
+    bool live = atomic_load_explicit(&s_sub_epoch, memory_order_acquire) == item->epoch;
+    if (!live) {
+      os_evt_bus_port_lock();
+      live = live_handle(item->slot) != NULL;
+      os_evt_bus_port_unlock();
+    }
+    uint32_t ticks = 0;
+    if (live) {
+      uint32_t t0 = os_evt_bus_port_trace_ts();
+      item->cb(&item->evt, item->user_ctx);
+      ticks = os_evt_bus_port_trace_ts() - t0;
+    }
+    os_evt_bus_port_lock();
+    if (live) {
+      s_bus.stats.delivered++;
+      sub_account(live_handle(item->slot), ticks);
+    }
+    if (item->evt.len > OS_EVT_INLINE_MAX) {
+      pool_release(os_evt_data(&item->evt));
+    }
+    os_evt_bus_port_unlock();
+    atomic_store_explicit(&w->head, ++head, memory_order_release);
+    n++;
+  }
+  return n;
+}
+
+void os_evt_bus_get_stats(os_evt_bus_stats_t *out)
+{
+  os_evt_bus_port_lock();
+  stage_merge();
+  *out = s_bus.stats;
+  for (uint32_t l = 0; l < OS_EVT_BUS_LANES; l++) {
+    out->lane[l].depth = lane_depth(&s_bus.lanes[l]);
+  }
+  for (uint32_t w = 0; w < OS_EVT_BUS_MAX_WORKERS; w++) {
+    out->worker[w].depth = atomic_load_explicit(&s_workers[w].tail, memory_order_relaxed) -
+                           atomic_load_explicit(&s_workers[w].head, memory_order_relaxed);
+  }
+  os_evt_bus_port_unlock();
+}
+
+const void *os_evt_bus_payload_retain(const os_evt_t *evt)
+{
+  if (evt == NULL || evt->len <= OS_EVT_INLINE_MAX) {
+    return NULL;
+  }
+  const void *payload = os_evt_data(evt);
+  int i = pool_index(payload);
+
+  os_evt_bus_port_lock();
+  if (i < 0 || s_bus.pool_ref[i] == 0 || s_bus.pool_ref[i] == UINT8_MAX) {
+    payload = NULL;
+  } else {
+    s_bus.pool_ref[i]++;
+  }
+  os_evt_bus_port_unlock();
+  return payload;
+}
+
+void os_evt_bus_payload_release(const void *payload)
+{
+  os_evt_bus_port_lock();
+  pool_release(payload);
+  os_evt_bus_port_unlock();
+}
@@ -0,0 +1,126 @@
+/*
+ * os_evt_trace.c — lock-free trace ring of event bus records
+ */
+
+#include <stdatomic.h>
+#include <string.h>
+
+#include "os_evt_trace.h"
+#include "os_evt_bus_port.h"
+
+#if OS_EVT_TRACE_RECORDS
+
+#define TRACE_MASK (OS_EVT_TRACE_RECORDS - 1u)
+
+_Static_assert((OS_EVT_TRACE_RECORDS & TRACE_MASK) == 0, "OS_EVT_TRACE_RECORDS must be a power of two");
+
+/*
+ * Each record's stamp works as a sequence lock: the writer clears it, fills
+ * the record and stores claim index + 1 last; the dump accepts a copy only
+ * if the stamp was that value both before and after copying. The payload
+ * words are relaxed atomics, so a copy that races a writer is discarded
+ * rather than being a data race.
+ *
+ * Limit: two writers can share a slot only if one of them is held between
+ * its two stamp stores while OS_EVT_TRACE_RECORDS more records are claimed
+ * (a long preemption in the middle of a record). Their field stores may
+ * then interleave, and a dump taken before the held writer's final stamp
+ * store can accept the mixed record under the other writer's stamp. The
+ * ring is sized so that does not happen in practice; it is not detected.
+ */
+typedef struct {
+  _Atomic uint32_t stamp;
+  _Atomic uint32_t ts;
+  _Atomic uint32_t ref;
+  _Atomic uint32_t meta; /* type | id << 8 | src << 16 | info << 24: the record's byte order on little-endian cores */
+} trace_slot_t;
+
+_Static_assert(sizeof(trace_slot_t) == sizeof(os_evt_trace_rec_t), "slot and record layouts must match");
+
+static struct {
+  _Atomic uint32_t head; /* free-running claim index */
+  trace_slot_t ring[OS_EVT_TRACE_RECORDS];
+} s_trace;
+
+void os_evt_trace_record(os_evt_trace_type_t type, uint32_t id, uint32_t src, uint32_t ref, uint32_t info)
+{
+  uint32_t ts = os_evt_bus_port_trace_ts();
+  uint32_t n = atomic_fetch_add_explicit(&s_trace.head, 1u, memory_order_relaxed);
+  trace_slot_t *slot = &s_trace.ring[n & TRACE_MASK];
+
+  uint32_t meta = (uint32_t)(type | (os_evt_bus_port_core() ? OS_EVT_TRACE_CORE1 : 0u)) | (id & 0xFFu) << 8 |
+                  (src & 0xFFu) << 16 | (info > UINT8_MAX ? UINT8_MAX : info) << 24;
+
+  atomic_store_explicit(&slot->stamp, 0, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+  atomic_store_explicit(&slot->ts, ts, memory_order_relaxed);
+  atomic_store_explicit(&slot->ref, ref, memory_order_relaxed);
+  atomic_store_explicit(&slot->meta, meta, memory_order_relaxed);
+  atomic_store_explicit(&slot->stamp, n + 1u, memory_order_release);
+}
+
+void os_evt_trace_reset(void)
+{
+  memset(s_trace.ring, 0, sizeof(s_trace.ring));
+  atomic_store_explicit(&s_trace.head, 0, memory_order_relaxed);
+}
+
+size_t os_evt_trace_dump(os_evt_trace_write_t write, void *user_ctx)
+{
+  uint32_t head = atomic_load_explicit(&s_trace.head, memory_order_acquire);
+  uint32_t count = head < OS_EVT_TRACE_RECORDS ? head : OS_EVT_TRACE_RECORDS;
+  os_evt_trace_hdr_t hdr = {
+    .magic = OS_EVT_TRACE_MAGIC,
+    .version = OS_EVT_TRACE_VERSION,
+    .rec_size = sizeof(os_evt_trace_rec_t),
+    .ts_hz = os_evt_bus_port_trace_hz(),
+    .count = count,
+    .lost = head - count,
+  };
+  size_t valid = 0;
+
+  write(&hdr, sizeof(hdr), user_ctx);
+  for (uint32_t n = head - count; n != head; n++) {
+    const trace_slot_t *slot = &s_trace.ring[n & TRACE_MASK];
+    os_evt_trace_rec_t rec;
+
+    uint32_t before = atomic_load_explicit(&slot->stamp, memory_order_acquire);
+    rec.ts = atomic_load_explicit(&slot->ts, memory_order_relaxed);
+    rec.ref = atomic_load_explicit(&slot->ref, memory_order_relaxed);
+    uint32_t meta = atomic_load_explicit(&slot->meta, memory_order_relaxed);
+    rec.type = (uint8_t)meta;
+    rec.id = (uint8_t)(meta >> 8);
+    rec.src = (uint8_t)(meta >> 16);
+    rec.info = (uint8_t)(meta >> 24);
+    atomic_thread_fence(memory_order_acquire);
+    uint32_t after = atomic_load_explicit(&slot->stamp, memory_order_relaxed);
+    if (before == n + 1u && after == before) {
+      rec.stamp = before;
+      valid++;
+    } else {
+      memset(&rec, 0, sizeof(rec));
+    }
+    write(&rec, sizeof(rec), user_ctx);
+  }
+  return valid;
+}
+
+#else /* !OS_EVT_TRACE_RECORDS */
+
+void os_evt_trace_reset(void)
+{
+}
+
+size_t os_evt_trace_dump(os_evt_trace_write_t write, void *user_ctx)
+{
+  os_evt_trace_hdr_t hdr = {
+    .magic = OS_EVT_TRACE_MAGIC,
+    .version = OS_EVT_TRACE_VERSION,
+    .rec_size = sizeof(os_evt_trace_rec_t),
+    .ts_hz = os_evt_bus_port_trace_hz(),
+  };
+  write(&hdr, sizeof(hdr), user_ctx);
+  return 0;
+}
+
+#endif
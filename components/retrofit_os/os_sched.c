@@ -0,0 +1,397 @@
+/*
+ * os_sched.c — next-deadline schedule engine (platform-agnostic core)
+ */
+
+#include <string.h>
+
+#include "os_sched.h"
+#include "os_sched_port.h"
+#include "os_evt_bus.h"
+
+_Static_assert(OS_SCHED_MAX >= 1u && OS_SCHED_MAX <= UINT16_MAX, "row ids are kept in 16-bit heap slots");
+
+/* ==========================================================================
+ * State
+ *
+ * A row holds the applied entry and, between os_sched_set()/remove() and
+ * os_sched_apply(), a staged one; staged rows are listed once in dirty[].
+ *
+ * heap[] holds the ids of the rows with a next run, ordered by (next, id);
+ * each row knows its heap position, so moving one row is O(log n). The arm
+ * hook sees the head deadline, or the retry time after the due hook
+ * refused a run, and is called only when that value changes, or after the
+ * timer fired or the clock jumped.
+ * ========================================================================== */
+
+#define SCHED_ROW_APPLIED 0x01u /* entry is valid */
+#define SCHED_ROW_STAGED  0x02u /* listed in dirty[] */
+#define SCHED_ROW_SET     0x04u /* staged holds the new entry; clear: staged removal */
+
+typedef struct {
+  os_sched_entry_t entry;
+  os_sched_entry_t staged;
+  uint32_t next; /* OS_SCHED_NEVER: not in the heap */
+  uint16_t pos;
+  uint8_t  flags;
+} sched_row_t;
+
+static struct {
+  sched_row_t rows[OS_SCHED_MAX];
+  uint16_t heap[OS_SCHED_MAX];
+  uint32_t n;
+  uint16_t dirty[OS_SCHED_MAX];
+  uint32_t n_dirty;
+  uint32_t armed;    /* deadline the arm hook last got */
+  uint32_t retry_at; /* OS_SCHED_NEVER unless the due hook refused a run */
+  os_sched_arm_fn_t arm;
+  os_sched_due_fn_t due;
+  void *ctx;
+  os_sched_stats_t stats;
+} s_sched;
+
+/* ==========================================================================
+ * Heap (lock held)
+ * ========================================================================== */
+
+static bool heap_less(uint16_t a, uint16_t b)
+{
+  uint32_t na = s_sched.rows[a].next, nb = s_sched.rows[b].next;
+  return na < nb || (na == nb && a < b);
+}
+
+static void heap_place(uint32_t i, uint16_t id)
+{
+  s_sched.heap[i] = id;
+  s_sched.rows[id].pos = (uint16_t)i;
+}
+
+static void sift_up(uint32_t i)
+{
+  uint16_t id = s_sched.heap[i];
+  while (i > 0) {
+    uint32_t parent = (i - 1u) / 2u;
+    if (!heap_less(id, s_sched.heap[parent])) {
+      break;
+    }
+    heap_place(i, s_sched.heap[parent]);
+    i = parent;
+  }
+  heap_place(i, id);
+}
+
+static void sift_down(uint32_t i)
+{
+  uint16_t id = s_sched.heap[i];
+  for (;;) {
+    uint32_t child = 2u * i + 1u;
+    if (child >= s_sched.n) {
+      break;
+    }
+    if (child + 1u < s_sched.n && heap_less(s_sched.heap[child + 1u], s_sched.heap[child])) {
+      child++;
+    }
+    if (!heap_less(s_sched.heap[child], id)) {
+      break;
+    }
+    heap_place(i, s_sched.heap[child]);
+    i = child;
+  }
+  heap_place(i, id);
+}
+
+/* Give row id the next run next, moving it into, within or out of the heap */
+static void heap_set(uint16_t id, uint32_t next)
+{
+  sched_row_t *row = &s_sched.rows[id];
+  bool was_in = row->next != OS_SCHED_NEVER;
+  uint32_t old = row->next;
+  row->next = next;
+
+  if (!was_in && next != OS_SCHED_NEVER) {
+    heap_place(s_sched.n, id);
+    sift_up(s_sched.n++);
+  } else if (was_in && next == OS_SCHED_NEVER) {
+    uint32_t i = row->pos;
+    uint16_t last = s_sched.heap[--s_sched.n];
+    if (i < s_sched.n) {
+      heap_place(i, last);
+      sift_up(i);
+      sift_down(s_sched.rows[last].pos);
+    }
+  } else if (was_in) {
+    if (next < old) {
+      sift_up(row->pos);
+    } else {
+      sift_down(row->pos);
+    }
+  }
+  s_sched.stats.active = s_sched.n;
+}
+
+/* ==========================================================================
+ * Runs (lock held)
+ * ========================================================================== */
+
+/*
+ * First run after last_run; OS_SCHED_NEVER if there is none. It may be in
+ * the past: run_due() then fires or skips it by the grace policy.
+ */
+static uint32_t first_run_after(const os_sched_entry_t *e)
+{
+  uint64_t from = e->last_run != 0 ? (uint64_t)e->last_run + 1u : 0;
+  if (e->start >= from) {
+    return e->start;
+  }
+  if (e->period_s == 0) {
+    return OS_SCHED_NEVER;
+  }
+  uint64_t k = (from - e->start + e->period_s - 1u) / e->period_s;
+  uint64_t t = e->start + k * e->period_s;
+  return t >= OS_SCHED_NEVER ? OS_SCHED_NEVER : (uint32_t)t;
+}
+
+/* Latest run of a row due at next that is not after now */
+static uint32_t latest_run(const os_sched_entry_t *e, uint32_t next, uint32_t now)
+{
+  if (e->period_s == 0) {
+    return next;
+  }
+  return next + (now - next) / e->period_s * e->period_s;
+}
+
+static void arm_head(bool force)
+{
+  uint32_t deadline = s_sched.retry_at;
+  if (deadline == OS_SCHED_NEVER && s_sched.n > 0) {
+    deadline = s_sched.rows[s_sched.heap[0]].next;
+  }
+  if (!force && deadline == s_sched.armed) {
+    return;
+  }
+  s_sched.armed = deadline;
+  s_sched.stats.armed++;
+  if (s_sched.arm != NULL) {
+    s_sched.arm(deadline, s_sched.ctx);
+  }
+}
+
+/* Deliver or skip every row due at now, then advance it past now */
+static size_t run_due(uint32_t now)
+{
+  size_t fired = 0;
+  s_sched.retry_at = OS_SCHED_NEVER;
+  while (s_sched.n > 0) {
+    uint16_t id = s_sched.heap[0];
+    sched_row_t *row = &s_sched.rows[id];
+    if (row->next > now) {
+      break;
+    }
+    /* SKIP_MISSED: only the latest due run can fire */
+    uint32_t run = latest_run(&row->entry, row->next, now);
+    uint32_t skipped = row->entry.period_s != 0 ? (run - row->next) / row->entry.period_s : 0;
+    if (now - run > OS_SCHED_GRACE_S) {
+      skipped++;
+    } else if (s_sched.due(id, run, s_sched.ctx) != OS_OK) {
+      s_sched.stats.retries++;
+      s_sched.retry_at = now + OS_SCHED_RETRY_S;
+      break;
+    } else {
+      fired++;
+    }
+    s_sched.stats.skipped += skipped;
+    s_sched.stats.recomputed++;
+    row->entry.last_run = run;
+    heap_set(id, first_run_after(&row->entry));
+  }
+  s_sched.stats.fired += fired;
+  return fired;
+}
+
+static os_err_t due_publish(uint32_t id, uint32_t run, void *ctx)
+{
+  (void)run;
+  (void)ctx;
+  evt_schedule_due_t due = { .schedule_id = id };
+  return os_evt_publish_schedule_due(&due);
+}
+
+/* ==========================================================================
+ * Public API
+ * ========================================================================== */
+
+void os_sched_init(os_sched_arm_fn_t arm, os_sched_due_fn_t due, void *ctx)
+{
+  os_sched_port_init();
+  os_sched_port_lock();
+  memset(&s_sched, 0, sizeof(s_sched));
+  for (uint32_t i = 0; i < OS_SCHED_MAX; i++) {
+    s_sched.rows[i].next = OS_SCHED_NEVER;
+  }
+  s_sched.armed = OS_SCHED_NEVER;
+  s_sched.retry_at = OS_SCHED_NEVER;
+  s_sched.arm = arm;
+  s_sched.due = due != NULL ? due : due_publish;
+  s_sched.ctx = ctx;
+  os_sched_port_unlock();
+}
+
+/* Lock held */
+static void stage(uint32_t id, const os_sched_entry_t *entry)
+{
+  sched_row_t *row = &s_sched.rows[id];
+  if (!(row->flags & SCHED_ROW_STAGED)) {
+    s_sched.dirty[s_sched.n_dirty++] = (uint16_t)id;
+  }
+  row->flags |= SCHED_ROW_STAGED;
+  if (entry != NULL) {
+    row->staged = *entry;
+    row->flags |= SCHED_ROW_SET;
+  } else {
+    row->flags &= (uint8_t)~SCHED_ROW_SET;
+  }
+}
+
+os_err_t os_sched_set(uint32_t id, const os_sched_entry_t *entry)
+{
+  if (id >= OS_SCHED_MAX || entry == NULL || entry->start == 0 || entry->period_s >= OS_SCHED_NEVER / 2u) {
+    return OS_EINVAL;
+  }
+  os_sched_port_lock();
+  stage(id, entry);
+  os_sched_port_unlock();
+  return OS_OK;
+}
+
+os_err_t os_sched_remove(uint32_t id)
+{
+  if (id >= OS_SCHED_MAX) {
+    return OS_EINVAL;
+  }
+  os_sched_port_lock();
+  stage(id, NULL);
+  os_sched_port_unlock();
+  return OS_OK;
+}
+
+size_t os_sched_apply(uint32_t now)
+{
+  os_sched_port_lock();
+  size_t n = s_sched.n_dirty;
+  for (uint32_t i = 0; i < n; i++) {
+    uint16_t id = s_sched.dirty[i];
+    sched_row_t *row = &s_sched.rows[id];
+    uint32_t next = OS_SCHED_NEVER;
+    if (row->flags & SCHED_ROW_SET) {
+      row->entry = row->staged;
+      row->flags = SCHED_ROW_APPLIED;
+      next = first_run_after(&row->entry);
+    } else {
+      row->flags = 0;
+    }
+    heap_set(id, next);
+  }
+  s_sched.n_dirty = 0;
+  s_sched.stats.recomputed += (uint32_t)n;
+  run_due(now); /* rows applied with runs already due: fire or skip, as after a time jump */
+  arm_head(false);
+  os_sched_port_unlock();
+  return n;
+}
+
+size_t os_sched_expire(uint32_t now)
+{
+  os_sched_port_lock();
+  size_t fired = run_due(now);
+  arm_head(true); /* the one-shot timer is spent */
+  os_sched_port_unlock();
+  return fired;
+}
+
+size_t os_sched_time_jumped(uint32_t now)
+{
+  os_sched_port_lock();
+  size_t fired = run_due(now);
+  arm_head(true); /* same deadline, different distance to it */
+  os_sched_port_unlock();
+  return fired;
+}
+
+os_err_t os_sched_get(uint32_t id, os_sched_entry_t *out, uint32_t *next)
+{
+  if (id >= OS_SCHED_MAX || out == NULL) {
+    return OS_EINVAL;
+  }
+  os_sched_port_lock();
+  const sched_row_t *row = &s_sched.rows[id];
+  bool applied = (row->flags & SCHED_ROW_APPLIED) != 0;
+  if (applied) {
+    *out = row->entry;
+    if (next != NULL) {
+      *next = row->next;
+    }
+  }
+  os_sched_port_unlock();
+  return applied ? OS_OK : OS_ESTATE;
+}
+
+uint32_t os_sched_next(void)
+{
+  os_sched_port_lock();
+  uint32_t next = s_sched.n > 0 ? s_sched.rows[s_sched.heap[0]].next : OS_SCHED_NEVER;
+  os_sched_port_unlock();
+  return next;
+}
+
+void os_sched_get_stats(os_sched_stats_t *out)
+{
+  if (out == NULL) {
+    return;
+  }
+  os_sched_port_lock();
+  *out = s_sched.stats;
+  os_sched_port_unlock();
+}
+
+/* ==========================================================================
+ * Service
+ * ========================================================================== */
+
+static void service_arm(uint32_t deadline, void *ctx)
+{
+  (void)ctx;
+  uint32_t now = os_sched_port_now();
+  if (deadline == OS_SCHED_NEVER || now == 0) {
+    os_sched_port_timer_arm(OS_SCHED_NEVER); /* re-armed by EVT_TIME_SYNCED */
+    return;
+  }
+  os_sched_port_timer_arm(deadline > now ? deadline - now : 0);
+}
+
+static void cb_clock(const os_evt_t *evt, void *user_ctx)
+{
+  (void)evt;
+  (void)user_ctx;
+  os_sched_time_jumped(os_sched_port_now());
+}
+
+static void cb_table_updated(const os_evt_t *evt, void *user_ctx)
+{
+  (void)evt;
+  (void)user_ctx;
+  os_sched_apply(os_sched_port_now());
+}
+
+os_err_t os_sched_start(void)
+{
+  os_err_t err = os_sched_port_timer_create();
+  if (err != OS_OK) {
+    return err;
+  }
+  os_sched_init(service_arm, NULL, NULL);
+  if (!os_evt_bus_handle_valid(os_evt_subscribe_time_synced(cb_clock, NULL)) ||
+      !os_evt_bus_handle_valid(os_evt_subscribe_time_jumped(cb_clock, NULL)) ||
+      !os_evt_bus_handle_valid(os_evt_subscribe_schedule_table_updated(cb_table_updated, NULL))) {
+    return OS_ENOMEM;
+  }
+  return OS_OK;
+}
@@ -0,0 +1,29 @@
+/*
+ * os_cmd_port.h — what the command channel needs from the platform
+ *
+ * One implementation is linked per build: os_cmd_port_freertos.c under
+ * ESP-IDF, os_cmd_port_posix.c on the host.
+ */
+#ifndef OS_CMD_PORT_H
+#define OS_CMD_PORT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Short critical section around slot and queue accesses; task context */
+void os_cmd_port_lock(void);
+void os_cmd_port_unlock(void);
+
+/* The calling task, as something os_cmd_port_wake() can wake */
+void *os_cmd_port_self(void);
+
+/* Wake task from os_cmd_port_wait(); a wake with nobody waiting is kept for the next wait */
+void os_cmd_port_wake(void *task);
+
+/* Block the calling task until woken or timeout_ms passes (OS_CMD_WAIT_FOREVER: no limit); false on timeout */
+bool os_cmd_port_wait(uint32_t timeout_ms);
+
+/* Millisecond clock for call and receive deadlines */
+uint32_t os_cmd_port_now_ms(void);
+
+#endif /* OS_CMD_PORT_H */
@@ -0,0 +1,58 @@
+/*
+ * os_cmd_port_freertos.c — FreeRTOS binding of the command channel (ESP-IDF)
+ *
+ * The critical section is a spinlock (task context only). Callers and
+ * receivers block on a direct-to-task notification: by default the last
+ * entry of the notification array, so with
+ * CONFIG_FREERTOS_TASK_NOTIFICATION_ARRAY_ENTRIES >= 2 a task can also be
+ * an event bus dispatcher or worker, which use entry 0.
+ */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+
+#include "os_cmd.h"
+#include "os_cmd_port.h"
+
+#ifndef OS_CMD_NOTIFY_INDEX
+#define OS_CMD_NOTIFY_INDEX (configTASK_NOTIFICATION_ARRAY_ENTRIES - 1)
+#endif
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+void os_cmd_port_lock(void)
+{
+  taskENTER_CRITICAL(&s_lock);
+}
+
+void os_cmd_port_unlock(void)
+{
+  taskEXIT_CRITICAL(&s_lock);
+}
+
+void *os_cmd_port_self(void)
+{
+  return xTaskGetCurrentTaskHandle();
+}
+
+void os_cmd_port_wake(void *task)
+{
+  xTaskNotifyGiveIndexed((TaskHandle_t)task, OS_CMD_NOTIFY_INDEX);
+}
+
+bool os_cmd_port_wait(uint32_t timeout_ms)
+{
+  TickType_t ticks = portMAX_DELAY;
+  if (timeout_ms != OS_CMD_WAIT_FOREVER) {
+    /* Round up: a 1 ms timeout still blocks until the next tick */
+    uint64_t t = ((uint64_t)timeout_ms * configTICK_RATE_HZ + 999u) / 1000u;
+    ticks = t < portMAX_DELAY ? (TickType_t)t : portMAX_DELAY - 1u;
+  }
+  return ulTaskNotifyTakeIndexed(OS_CMD_NOTIFY_INDEX, pdTRUE, ticks) != 0;
+}
+
+uint32_t os_cmd_port_now_ms(void)
+{
+  return (uint32_t)(esp_timer_get_time() / 1000);
+}
@@ -0,0 +1,80 @@
+/*
+ * os_cmd_port_posix.c — pthread binding of the command channel (host build)
+ *
+ * A mutex is the critical section. Each thread has its own wake count and
+ * condition variable, created with the thread, standing in for the task
+ * notification of the FreeRTOS port.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "os_cmd.h"
+#include "os_cmd_port.h"
+
+typedef struct {
+  pthread_mutex_t lock;
+  pthread_cond_t  cond;
+  uint32_t        count;
+} port_waiter_t;
+
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static _Thread_local port_waiter_t s_self = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0 };
+
+void os_cmd_port_lock(void)
+{
+  pthread_mutex_lock(&s_lock);
+}
+
+void os_cmd_port_unlock(void)
+{
+  pthread_mutex_unlock(&s_lock);
+}
+
+void *os_cmd_port_self(void)
+{
+  return &s_self;
+}
+
+void os_cmd_port_wake(void *task)
+{
+  port_waiter_t *w = task;
+  pthread_mutex_lock(&w->lock);
+  w->count++;
+  pthread_cond_signal(&w->cond);
+  pthread_mutex_unlock(&w->lock);
+}
+
+bool os_cmd_port_wait(uint32_t timeout_ms)
+{
+  port_waiter_t *w = &s_self;
+  struct timespec deadline;
+  /* The static condition variable waits on CLOCK_REALTIME */
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  deadline.tv_sec += timeout_ms / 1000u;
+  deadline.tv_nsec += (long)(timeout_ms % 1000u) * 1000000L;
+  if (deadline.tv_nsec >= 1000000000L) {
+    deadline.tv_sec++;
+    deadline.tv_nsec -= 1000000000L;
+  }
+
+  pthread_mutex_lock(&w->lock);
+  int err = 0;
+  while (w->count == 0 && err != ETIMEDOUT) {
+    err = timeout_ms == OS_CMD_WAIT_FOREVER ? pthread_cond_wait(&w->cond, &w->lock)
+                                            : pthread_cond_timedwait(&w->cond, &w->lock, &deadline);
+  }
+  bool woken = w->count != 0;
+  w->count = 0;
+  pthread_mutex_unlock(&w->lock);
+  return woken;
+}
+
+uint32_t os_cmd_port_now_ms(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)((uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u);
+}
@@ -0,0 +1,45 @@
+/*
+ * os_evt_bus_port.h — what the event bus core needs from the platform
+ *
+ * One implementation is linked per build: os_evt_bus_port_freertos.c under
+ * ESP-IDF, os_evt_bus_port_posix.c on the host. The port also implements
+ * os_evt_bus_start_dispatcher() / os_evt_bus_stop_dispatcher() and
+ * os_evt_bus_start_worker() / os_evt_bus_stop_worker().
+ */
+#ifndef OS_EVT_BUS_PORT_H
+#define OS_EVT_BUS_PORT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "retrofit_os_types.h"
+
+/* Called from os_evt_bus_init() */
+void os_evt_bus_port_init(void);
+
+/* Short critical section around queue and table accesses; usable from tasks and ISRs */
+void os_evt_bus_port_lock(void);
+void os_evt_bus_port_unlock(void);
+
+/* Wake the dispatcher if one runs. from_isr: set *woken if it should run before the ISR returns. */
+void os_evt_bus_port_notify(bool from_isr, bool *woken);
+
+/* Wake the worker of module worker if one runs; called from the dispatcher */
+void os_evt_bus_port_worker_notify(os_mod_id_t worker);
+
+/* Timestamp for os_evt_t::ts_ms; usable from ISRs */
+uint32_t os_evt_bus_port_now_ms(void);
+
+/* Trace timestamp (os_evt_trace.h): free-running, wraps, as cheap as the target allows; usable from ISRs */
+uint32_t os_evt_bus_port_trace_ts(void);
+
+/* Ticks per second of os_evt_bus_port_trace_ts() */
+uint32_t os_evt_bus_port_trace_hz(void);
+
+/* Core the caller runs on; 0 on single-core targets */
+uint32_t os_evt_bus_port_core(void);
+
+/* Staging ring hint of the caller (os_evt_bus_set_staging()): the core on target, one index per thread on the host */
+uint32_t os_evt_bus_port_stage_index(void);
+
+#endif /* OS_EVT_BUS_PORT_H */
@@ -0,0 +1,190 @@
+/*
+ * os_evt_bus_port_freertos.c — FreeRTOS binding of the event bus (ESP-IDF)
+ *
+ * The critical section is a spinlock taken with portENTER_CRITICAL_SAFE, so
+ * the same publish path works from tasks and from driver ISR callbacks. The
+ * dispatcher and each module's worker are tasks woken by a direct-to-task
+ * notification. Trace
+ * timestamps are the CPU cycle counter of the recording core; the linux
+ * target (FreeRTOS POSIX simulator) has none and uses CLOCK_MONOTONIC.
+ * Staging rings (contention mode) are picked by core.
+ */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#if CONFIG_IDF_TARGET_LINUX
+#include <time.h>
+#else
+#include "esp_cpu.h"
+#include "esp_rom_sys.h"
+#endif
+
+#include "os_evt_bus.h"
+#include "os_evt_bus_port.h"
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t s_dispatcher;
+static TaskHandle_t s_workers[OS_MOD_MAX];
+
+void os_evt_bus_port_init(void)
+{
+  /* The dispatcher, if already running, keeps running across a re-init */
+}
+
+void os_evt_bus_port_lock(void)
+{
+  portENTER_CRITICAL_SAFE(&s_lock);
+}
+
+void os_evt_bus_port_unlock(void)
+{
+  portEXIT_CRITICAL_SAFE(&s_lock);
+}
+
+void os_evt_bus_port_notify(bool from_isr, bool *woken)
+{
+  TaskHandle_t task = s_dispatcher;
+  if (task == NULL) {
+    return; /* polled */
+  }
+  if (!from_isr) {
+    xTaskNotifyGive(task);
+    return;
+  }
+  BaseType_t high_task_wakeup = pdFALSE;
+  vTaskNotifyGiveFromISR(task, &high_task_wakeup);
+  if (woken != NULL && high_task_wakeup == pdTRUE) {
+    *woken = true;
+  }
+}
+
+void os_evt_bus_port_worker_notify(os_mod_id_t worker)
+{
+  TaskHandle_t task = worker < OS_MOD_MAX ? s_workers[worker] : NULL;
+  if (task != NULL) {
+    xTaskNotifyGive(task);
+  }
+}
+
+uint32_t os_evt_bus_port_now_ms(void)
+{
+  return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+#if CONFIG_IDF_TARGET_LINUX
+uint32_t os_evt_bus_port_trace_ts(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec);
+}
+
+uint32_t os_evt_bus_port_trace_hz(void)
+{
+  return 1000000000u;
+}
+
+uint32_t os_evt_bus_port_core(void)
+{
+  return 0;
+}
+
+uint32_t os_evt_bus_port_stage_index(void)
+{
+  return 0;
+}
+#else
+uint32_t os_evt_bus_port_trace_ts(void)
+{
+  return (uint32_t)esp_cpu_get_cycle_count();
+}
+
+uint32_t os_evt_bus_port_trace_hz(void)
+{
+  return esp_rom_get_cpu_ticks_per_us() * 1000000u;
+}
+
+uint32_t os_evt_bus_port_core(void)
+{
+  return (uint32_t)esp_cpu_get_core_id();
+}
+
+uint32_t os_evt_bus_port_stage_index(void)
+{
+  /* A task preempted and moved mid-publish still writes the ring it picked; the ring is multi-producer */
+  return (uint32_t)esp_cpu_get_core_id();
+}
+#endif
+
+static void dispatcher_task(void *arg)
+{
+  (void)arg;
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    os_evt_bus_dispatch_all();
+  }
+}
+
+os_err_t os_evt_bus_start_dispatcher(uint32_t priority, uint32_t stack_bytes)
+{
+  if (s_dispatcher != NULL) {
+    return OS_ESTATE;
+  }
+  TaskHandle_t task = NULL;
+  if (xTaskCreate(dispatcher_task, "os_evt_bus", stack_bytes, NULL, (UBaseType_t)priority, &task) != pdPASS) {
+    return OS_ENOMEM;
+  }
+  s_dispatcher = task;
+  /* Events published before the task existed */
+  xTaskNotifyGive(task);
+  return OS_OK;
+}
+
+void os_evt_bus_stop_dispatcher(void)
+{
+  TaskHandle_t task = s_dispatcher;
+  if (task == NULL) {
+    return;
+  }
+  s_dispatcher = NULL;
+  vTaskDelete(task);
+}
+
+static void worker_task(void *arg)
+{
+  os_mod_id_t worker = (os_mod_id_t)(uintptr_t)arg;
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    os_evt_bus_worker_run(worker);
+  }
+}
+
+os_err_t os_evt_bus_start_worker(os_mod_id_t worker, uint32_t priority, uint32_t stack_bytes)
+{
+  if (worker == OS_MOD_NONE || worker >= OS_MOD_MAX) {
+    return OS_EINVAL;
+  }
+  if (s_workers[worker] != NULL) {
+    return OS_ESTATE;
+  }
+  TaskHandle_t task = NULL;
+  if (xTaskCreate(worker_task, "os_evt_worker", stack_bytes, (void *)(uintptr_t)worker, (UBaseType_t)priority,
+                  &task) != pdPASS) {
+    return OS_ENOMEM;
+  }
+  s_workers[worker] = task;
+  /* Handoffs queued before the task existed */
+  xTaskNotifyGive(task);
+  return OS_OK;
+}
+
+void os_evt_bus_stop_worker(os_mod_id_t worker)
+{
+  TaskHandle_t task = worker < OS_MOD_MAX ? s_workers[worker] : NULL;
+  if (task == NULL) {
+    return;
+  }
+  s_workers[worker] = NULL;
+  vTaskDelete(task);
+}
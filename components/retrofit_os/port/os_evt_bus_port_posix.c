@@ -0,0 +1,207 @@
+/*
+ * os_evt_bus_port_posix.c — pthread binding of the event bus (host build)
+ *
+ * Stands in for the FreeRTOS port in host tests and benchmarks: a mutex is
+ * the critical section, "ISR" publishers are plain threads, and the
+ * dispatcher and the workers are threads sleeping on one condition
+ * variable, each with its own wake count. Trace
+ * timestamps are CLOCK_MONOTONIC nanoseconds. Threads stand in for cores
+ * when picking a staging ring: each gets its own index on first publish.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "os_evt_bus.h"
+#include "os_evt_bus_port.h"
+
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* The dispatcher or one module's worker */
+typedef struct {
+  uint32_t  wake_count;
+  bool      running;
+  bool      stop;
+  pthread_t thread;
+} port_thread_t;
+
+static pthread_mutex_t s_wake_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  s_wake = PTHREAD_COND_INITIALIZER; /* broadcast: every thread checks its own count */
+static port_thread_t   s_dispatcher;
+static port_thread_t   s_workers[OS_MOD_MAX];
+
+static atomic_uint s_stage_next;
+static _Thread_local uint32_t s_stage_index = UINT32_MAX;
+
+void os_evt_bus_port_init(void)
+{
+}
+
+void os_evt_bus_port_lock(void)
+{
+  pthread_mutex_lock(&s_lock);
+}
+
+void os_evt_bus_port_unlock(void)
+{
+  pthread_mutex_unlock(&s_lock);
+}
+
+/* False if t has no thread */
+static bool thread_notify(port_thread_t *t)
+{
+  pthread_mutex_lock(&s_wake_lock);
+  bool running = t->running;
+  if (running) {
+    t->wake_count++;
+    pthread_cond_broadcast(&s_wake);
+  }
+  pthread_mutex_unlock(&s_wake_lock);
+  return running;
+}
+
+void os_evt_bus_port_notify(bool from_isr, bool *woken)
+{
+  if (thread_notify(&s_dispatcher) && from_isr && woken != NULL) {
+    *woken = true;
+  }
+}
+
+void os_evt_bus_port_worker_notify(os_mod_id_t worker)
+{
+  if (worker < OS_MOD_MAX) {
+    thread_notify(&s_workers[worker]);
+  }
+}
+
+uint32_t os_evt_bus_port_now_ms(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)((uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u);
+}
+
+uint32_t os_evt_bus_port_trace_ts(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec);
+}
+
+uint32_t os_evt_bus_port_trace_hz(void)
+{
+  return 1000000000u;
+}
+
+uint32_t os_evt_bus_port_core(void)
+{
+  return 0;
+}
+
+uint32_t os_evt_bus_port_stage_index(void)
+{
+  if (s_stage_index == UINT32_MAX) {
+    s_stage_index = atomic_fetch_add_explicit(&s_stage_next, 1u, memory_order_relaxed);
+  }
+  return s_stage_index;
+}
+
+static void thread_loop(port_thread_t *t, os_mod_id_t worker)
+{
+  pthread_mutex_lock(&s_wake_lock);
+  while (!t->stop) {
+    if (t->wake_count == 0) {
+      pthread_cond_wait(&s_wake, &s_wake_lock);
+      continue;
+    }
+    t->wake_count = 0;
+    pthread_mutex_unlock(&s_wake_lock);
+    if (t == &s_dispatcher) {
+      os_evt_bus_dispatch_all();
+    } else {
+      os_evt_bus_worker_run(worker);
+    }
+    pthread_mutex_lock(&s_wake_lock);
+  }
+  pthread_mutex_unlock(&s_wake_lock);
+}
+
+static void *dispatcher_thread(void *arg)
+{
+  (void)arg;
+  thread_loop(&s_dispatcher, OS_MOD_NONE);
+  return NULL;
+}
+
+static void *worker_thread(void *arg)
+{
+  os_mod_id_t worker = (os_mod_id_t)(uintptr_t)arg;
+  thread_loop(&s_workers[worker], worker);
+  return NULL;
+}
+
+static os_err_t thread_start(port_thread_t *t, void *(*fn)(void *), void *arg)
+{
+  pthread_mutex_lock(&s_wake_lock);
+  if (t->running) {
+    pthread_mutex_unlock(&s_wake_lock);
+    return OS_ESTATE;
+  }
+  t->running = true;
+  t->stop = false;
+  t->wake_count = 1; /* work queued before the thread existed */
+  pthread_mutex_unlock(&s_wake_lock);
+
+  if (pthread_create(&t->thread, NULL, fn, arg) != 0) {
+    pthread_mutex_lock(&s_wake_lock);
+    t->running = false;
+    pthread_mutex_unlock(&s_wake_lock);
+    return OS_ENOMEM;
+  }
+  return OS_OK;
+}
+
+static void thread_stop(port_thread_t *t)
+{
+  pthread_mutex_lock(&s_wake_lock);
+  if (!t->running) {
+    pthread_mutex_unlock(&s_wake_lock);
+    return;
+  }
+  t->stop = true;
+  t->running = false;
+  pthread_cond_broadcast(&s_wake);
+  pthread_mutex_unlock(&s_wake_lock);
+  pthread_join(t->thread, NULL);
+}
+
+os_err_t os_evt_bus_start_dispatcher(uint32_t priority, uint32_t stack_bytes)
+{
+  (void)priority;
+  (void)stack_bytes;
+  return thread_start(&s_dispatcher, dispatcher_thread, NULL);
+}
+
+void os_evt_bus_stop_dispatcher(void)
+{
+  thread_stop(&s_dispatcher);
+}
+
+os_err_t os_evt_bus_start_worker(os_mod_id_t worker, uint32_t priority, uint32_t stack_bytes)
+{
+  (void)priority;
+  (void)stack_bytes;
+  if (worker == OS_MOD_NONE || worker >= OS_MOD_MAX) {
+    return OS_EINVAL;
+  }
+  return thread_start(&s_workers[worker], worker_thread, (void *)(uintptr_t)worker);
+}
+
+void os_evt_bus_stop_worker(os_mod_id_t worker)
+{
+  if (worker < OS_MOD_MAX) {
+    thread_stop(&s_workers[worker]);
+  }
+}
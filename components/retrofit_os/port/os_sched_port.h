@@ -0,0 +1,30 @@
+/*
+ * os_sched_port.h — what the schedule engine needs from the platform
+ *
+ * One implementation is linked per build: os_sched_port_freertos.c under
+ * ESP-IDF, os_sched_port_posix.c on the host.
+ */
+#ifndef OS_SCHED_PORT_H
+#define OS_SCHED_PORT_H
+
+#include <stdint.h>
+
+#include "retrofit_os_types.h"
+
+/* Called from os_sched_init() */
+void os_sched_port_init(void);
+
+/* Lock around table and heap accesses; task context, may block */
+void os_sched_port_lock(void);
+void os_sched_port_unlock(void);
+
+/* Wall clock, epoch seconds; 0 while it has not been set */
+uint32_t os_sched_port_now(void);
+
+/* Create the one-shot timer; its expiry calls os_sched_expire(os_sched_port_now()) */
+os_err_t os_sched_port_timer_create(void);
+
+/* (Re)arm the timer to expire in delay_s seconds; OS_SCHED_NEVER stops it */
+void os_sched_port_timer_arm(uint32_t delay_s);
+
+#endif /* OS_SCHED_PORT_H */
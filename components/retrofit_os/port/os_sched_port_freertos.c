@@ -0,0 +1,76 @@
+/*
+ * os_sched_port_freertos.c — FreeRTOS binding of the schedule engine (ESP-IDF)
+ *
+ * The lock is a mutex: the due hook publishes on the bus and the arm hook
+ * restarts an esp_timer, neither of which belongs in a critical section.
+ * The timer is a one-shot esp_timer whose callback runs in the esp_timer
+ * task, so it may take the mutex.
+ */
+
+#include <time.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+
+#include "os_sched.h"
+#include "os_sched_port.h"
+
+/* Anything earlier is the RTC default, not a synced clock (2020-01-01) */
+#define SCHED_PORT_EPOCH_MIN 1577836800L
+
+static StaticSemaphore_t s_lock_buf;
+static SemaphoreHandle_t s_lock;
+static esp_timer_handle_t s_timer;
+
+void os_sched_port_init(void)
+{
+  if (s_lock == NULL) {
+    s_lock = xSemaphoreCreateMutexStatic(&s_lock_buf);
+  }
+}
+
+void os_sched_port_lock(void)
+{
+  xSemaphoreTake(s_lock, portMAX_DELAY);
+}
+
+void os_sched_port_unlock(void)
+{
+  xSemaphoreGive(s_lock);
+}
+
+uint32_t os_sched_port_now(void)
+{
+  time_t now = time(NULL);
+  return now < SCHED_PORT_EPOCH_MIN ? 0u : (uint32_t)now;
+}
+
+static void timer_cb(void *arg)
+{
+  (void)arg;
+  os_sched_expire(os_sched_port_now());
+}
+
+os_err_t os_sched_port_timer_create(void)
+{
+  if (s_timer != NULL) {
+    return OS_OK;
+  }
+  const esp_timer_create_args_t args = {
+    .callback = timer_cb,
+    .name = "os_sched",
+  };
+  return esp_timer_create(&args, &s_timer) == ESP_OK ? OS_OK : OS_ENOMEM;
+}
+
+void os_sched_port_timer_arm(uint32_t delay_s)
+{
+  esp_timer_stop(s_timer); /* ESP_ERR_INVALID_STATE when idle */
+  if (delay_s == OS_SCHED_NEVER) {
+    return;
+  }
+  /* A due deadline still goes through the timer, never a direct call under the lock */
+  uint64_t us = delay_s == 0 ? 1000u : (uint64_t)delay_s * 1000000u;
+  esp_timer_start_once(s_timer, us);
+}
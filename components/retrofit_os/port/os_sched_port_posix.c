@@ -0,0 +1,92 @@
+/*
+ * os_sched_port_posix.c — pthread binding of the schedule engine (host build)
+ *
+ * A mutex is the lock. The one-shot timer is a thread that waits on a
+ * condition variable until the armed deadline, then calls os_sched_expire().
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "os_sched.h"
+#include "os_sched_port.h"
+
+/* Anything earlier is not a set clock (2020-01-01) */
+#define SCHED_PORT_EPOCH_MIN 1577836800L
+
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_mutex_t s_timer_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  s_timer_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t       s_timer;
+static bool            s_timer_created;
+static bool            s_timer_armed;
+static struct timespec s_timer_deadline; /* CLOCK_REALTIME, as the static condition variable */
+
+void os_sched_port_init(void)
+{
+}
+
+void os_sched_port_lock(void)
+{
+  pthread_mutex_lock(&s_lock);
+}
+
+void os_sched_port_unlock(void)
+{
+  pthread_mutex_unlock(&s_lock);
+}
+
+uint32_t os_sched_port_now(void)
+{
+  time_t now = time(NULL);
+  return now < SCHED_PORT_EPOCH_MIN ? 0u : (uint32_t)now;
+}
+
+static void *timer_thread(void *arg)
+{
+  (void)arg;
+  pthread_mutex_lock(&s_timer_lock);
+  for (;;) {
+    if (!s_timer_armed) {
+      pthread_cond_wait(&s_timer_cond, &s_timer_lock);
+      continue;
+    }
+    if (pthread_cond_timedwait(&s_timer_cond, &s_timer_lock, &s_timer_deadline) != ETIMEDOUT || !s_timer_armed) {
+      continue; /* re-armed or stopped */
+    }
+    s_timer_armed = false;
+    pthread_mutex_unlock(&s_timer_lock);
+    os_sched_expire(os_sched_port_now());
+    pthread_mutex_lock(&s_timer_lock);
+  }
+  return NULL;
+}
+
+os_err_t os_sched_port_timer_create(void)
+{
+  pthread_mutex_lock(&s_timer_lock);
+  if (!s_timer_created) {
+    s_timer_created = pthread_create(&s_timer, NULL, timer_thread, NULL) == 0;
+    if (s_timer_created) {
+      pthread_detach(s_timer);
+    }
+  }
+  bool ok = s_timer_created;
+  pthread_mutex_unlock(&s_timer_lock);
+  return ok ? OS_OK : OS_ENOMEM;
+}
+
+void os_sched_port_timer_arm(uint32_t delay_s)
+{
+  pthread_mutex_lock(&s_timer_lock);
+  s_timer_armed = delay_s != OS_SCHED_NEVER;
+  if (s_timer_armed) {
+    clock_gettime(CLOCK_REALTIME, &s_timer_deadline);
+    s_timer_deadline.tv_sec += delay_s;
+  }
+  pthread_cond_signal(&s_timer_cond);
+  pthread_mutex_unlock(&s_timer_lock);
+}
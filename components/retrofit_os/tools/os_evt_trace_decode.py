@@ -0,0 +1,357 @@
+#!/usr/bin/env python3
+"""Decode event bus trace dumps (os_evt_trace.h) into latency reports and a timeline.
+
+Input is one or more files holding dumps from os_evt_trace_dump():
+
+  - raw binary, as written by a host tool or tests/benchmarks/os_evt_trace_bench
+  - a console log with the dump as hex on lines tagged "EVTRACE:" (what
+    apps/system_demo prints), ESP log prefixes and timestamps allowed
+
+Overlapping dumps of one session are merged by record stamp. The report
+gives per event id the publishes, merges, refusals and dispatches, the
+publish -> dispatch latency (age of the delivered value for coalesced ids)
+as p50/p99/max and a log2 histogram, and the callback time. --chrome writes
+a Chrome trace / Perfetto JSON timeline: publishes on one track per source
+module, dispatches on the dispatcher track, flows from publish to dispatch,
+and lane depth counters.
+
+Event and module names come from retrofit_os_types.h (OS_EVT_TABLE and the
+OS_MOD_* enum), so the tool follows the table as it grows.
+"""
+
+import argparse
+import json
+import re
+import struct
+import sys
+import typing as t
+from dataclasses import dataclass, field
+from pathlib import Path
+
+
+DEFAULT_TYPES_H = Path(__file__).resolve().parent.parent / "include" / "retrofit_os_types.h"
+
+TRACE_MAGIC = 0x52545645
+TRACE_VERSION = 1
+HDR = struct.Struct("<IHHIII")
+REC = struct.Struct("<IIIBBBB")
+
+PUBLISH, COALESCE, DROP, NOMEM, REJECT, DISPATCH_START, DISPATCH_END = range(1, 8)
+TYPE_NAMES = {
+    PUBLISH: "publish",
+    COALESCE: "coalesce",
+    DROP: "drop",
+    NOMEM: "nomem",
+    REJECT: "reject",
+    DISPATCH_START: "dispatch_start",
+    DISPATCH_END: "dispatch_end",
+}
+CORE1 = 0x80
+
+RE_HEX_LINE = re.compile(r"EVTRACE:\s*([0-9A-Fa-f]+)")
+
+
+# ---- Names from retrofit_os_types.h -------------------------------------------
+
+@dataclass
+class EventInfo:
+    name: str
+    lane: str
+
+
+def load_names(types_h: Path) -> t.Tuple[t.Dict[int, EventInfo], t.Dict[int, str]]:
+    """Event rows of OS_EVT_TABLE (ids from 1, in row order) and OS_MOD_* values."""
+    events: t.Dict[int, EventInfo] = {}
+    modules: t.Dict[int, str] = {}
+    if not types_h.is_file():
+        return events, modules
+    text = types_h.read_text(encoding="utf-8", errors="ignore")
+
+    table = re.search(r"#define\s+OS_EVT_TABLE\(X,\s*X_EMPTY\)(.*?)\n\s*\n", text, re.S)
+    if table:
+        rows = re.finditer(r"\bX(?:_EMPTY)?\(\s*(\w+)\s*,\s*(\w+)\s*,(?:[^,()]*,)*\s*OS_EVT_LANE_(\w+)\s*,\s*\d+\s*\)",
+                           table.group(1))
+        for evt_id, row in enumerate(rows, start=1):
+            events[evt_id] = EventInfo(name=row.group(2), lane=row.group(3).lower())
+
+    mods = re.search(r"typedef\s+enum\s*\{(.*?)\}\s*os_module_id_t\s*;", text, re.S)
+    if mods:
+        value = -1
+        for entry in re.finditer(r"OS_MOD_(\w+)\s*(?:=\s*(\d+))?", mods.group(1)):
+            value = int(entry.group(2)) if entry.group(2) else value + 1
+            modules[value] = entry.group(1).lower()
+    return events, modules
+
+
+# ---- Dump parsing --------------------------------------------------------------
+
+@dataclass
+class Record:
+    stamp: int
+    ts: int
+    ref: int
+    kind: int
+    core: int
+    evt: int
+    src: int
+    info: int
+    time_us: float = 0.0
+
+
+@dataclass
+class Trace:
+    ts_hz: int = 0
+    dumps: int = 0
+    torn: int = 0
+    records: t.Dict[int, Record] = field(default_factory=dict)
+
+
+def read_dump_bytes(path: Path) -> bytes:
+    raw = path.read_bytes()
+    if len(raw) >= 4 and struct.unpack_from("<I", raw)[0] == TRACE_MAGIC:
+        return raw
+    text = raw.decode("utf-8", errors="ignore")
+    return bytes.fromhex("".join(m.group(1) for m in RE_HEX_LINE.finditer(text)))
+
+
+def parse_dumps(data: bytes, trace: Trace) -> None:
+    pos = 0
+    while pos + HDR.size <= len(data):
+        magic, version, rec_size, ts_hz, count, _lost = HDR.unpack_from(data, pos)
+        if magic != TRACE_MAGIC:
+            raise ValueError(f"bad magic 0x{magic:08x} at byte {pos}")
+        if version != TRACE_VERSION or rec_size != REC.size:
+            raise ValueError(f"unsupported dump: version {version}, {rec_size}-byte records")
+        pos += HDR.size
+        if pos + count * rec_size > len(data):
+            raise ValueError(f"truncated dump at byte {pos}: {count} records announced")
+        if trace.ts_hz and ts_hz != trace.ts_hz:
+            raise ValueError("dumps with different timestamp clocks")
+        trace.ts_hz = ts_hz
+        trace.dumps += 1
+        for _ in range(count):
+            stamp, ts, ref, kind, evt, src, info = REC.unpack_from(data, pos)
+            pos += rec_size
+            if stamp == 0:
+                trace.torn += 1
+                continue
+            trace.records[stamp] = Record(stamp=stamp, ts=ts, ref=ref, kind=kind & ~CORE1 & 0xFF,
+                                          core=1 if kind & CORE1 else 0, evt=evt, src=src, info=info)
+    if pos != len(data):
+        raise ValueError(f"{len(data) - pos} trailing bytes")
+
+
+def timeline(trace: Trace) -> t.Tuple[t.List[Record], int]:
+    """Records in stamp order with unwrapped times in microseconds; also the stamps never seen."""
+    ordered = [trace.records[s] for s in sorted(trace.records)]
+    last: t.Dict[int, t.Tuple[int, int]] = {}
+    for rec in ordered:
+        # Cycle counters are per core: unwrap each on its own
+        prev_ts, prev_abs = last.get(rec.core, (rec.ts, rec.ts))
+        delta = (rec.ts - prev_ts) & 0xFFFFFFFF
+        if delta >= 1 << 31:
+            delta -= 1 << 32
+        now = prev_abs + delta
+        last[rec.core] = (rec.ts, now)
+        rec.time_us = now * 1e6 / trace.ts_hz
+    missing = (ordered[-1].stamp - ordered[0].stamp + 1 - len(ordered)) if ordered else 0
+    return ordered, missing
+
+
+# ---- Analysis ------------------------------------------------------------------
+
+@dataclass
+class EventStats:
+    published: int = 0
+    merged: int = 0
+    refused: int = 0
+    dispatched: int = 0
+    latency_us: t.List[float] = field(default_factory=list)
+    callback_us: t.List[float] = field(default_factory=list)
+
+
+def percentile(values: t.List[float], p: int) -> float:
+    if not values:
+        return 0.0
+    ordered = sorted(values)
+    return ordered[(len(ordered) - 1) * p // 100]
+
+
+def log2_buckets(values: t.List[float]) -> t.List[int]:
+    """Counts for <1, 1-2, 2-4, ... us; the last bucket takes everything above."""
+    buckets = [0] * 16
+    for v in values:
+        b = 0
+        while b < len(buckets) - 1 and v >= (1 << b):
+            b += 1
+        buckets[b] += 1
+    return buckets
+
+
+def analyse(records: t.List[Record]) -> t.Tuple[t.Dict[int, EventStats], int, int]:
+    stats: t.Dict[int, EventStats] = {}
+    last_value: t.Dict[int, Record] = {}  # ref -> latest publish/coalesce
+    started: t.Dict[int, Record] = {}
+    unmatched = 0
+    cross_core = 0
+    for rec in records:
+        st = stats.setdefault(rec.evt, EventStats())
+        if rec.kind in (PUBLISH, COALESCE):
+            if rec.kind == PUBLISH:
+                st.published += 1
+            else:
+                st.merged += 1
+            last_value[rec.ref] = rec
+        elif rec.kind in (DROP, NOMEM, REJECT):
+            st.refused += 1
+        elif rec.kind == DISPATCH_START:
+            st.dispatched += 1
+            pub = last_value.pop(rec.ref, None)
+            if pub is None:
+                unmatched += 1  # published before the oldest record we have
+            else:
+                st.latency_us.append(rec.time_us - pub.time_us)
+                cross_core += pub.core != rec.core
+            started[rec.ref] = rec
+        elif rec.kind == DISPATCH_END:
+            start = started.pop(rec.ref, None)
+            if start is not None:
+                st.callback_us.append(rec.time_us - start.time_us)
+    return stats, unmatched, cross_core
+
+
+def event_name(events: t.Dict[int, EventInfo], evt: int) -> str:
+    return events[evt].name if evt in events else f"evt_{evt}"
+
+
+def module_name(modules: t.Dict[int, str], src: int) -> str:
+    return modules.get(src, f"mod_{src}")
+
+
+def print_report(trace: Trace, records: t.List[Record], missing: int, events: t.Dict[int, EventInfo],
+                 out: t.TextIO) -> None:
+    stats, unmatched, cross_core = analyse(records)
+    span = (records[-1].time_us - records[0].time_us) if records else 0.0
+    out.write(f"{trace.dumps} dumps, {len(records)} records over {span:.0f} us "
+              f"(clock {trace.ts_hz} Hz); {missing} records overwritten between dumps, "
+              f"{trace.torn} torn\n")
+    if unmatched:
+        out.write(f"{unmatched} dispatches of events published before the first record (no latency)\n")
+    if cross_core:
+        out.write(f"{cross_core} latencies span two cores: they include the offset between the cores' counters\n")
+    out.write("\n")
+    header = (f"{'event':<24} {'lane':<7} {'pub':>6} {'merged':>6} {'refused':>7} {'disp':>6}"
+              f" {'lat p50':>8} {'p99':>8} {'max':>8} {'cb p50':>7} {'max':>7}  (us)\n")
+    out.write(header)
+    for evt in sorted(stats):
+        st = stats[evt]
+        lane = events[evt].lane if evt in events else "?"
+        out.write(f"{event_name(events, evt):<24} {lane:<7} {st.published:>6} {st.merged:>6} {st.refused:>7}"
+                  f" {st.dispatched:>6} {percentile(st.latency_us, 50):>8.1f} {percentile(st.latency_us, 99):>8.1f}"
+                  f" {percentile(st.latency_us, 100):>8.1f} {percentile(st.callback_us, 50):>7.1f}"
+                  f" {percentile(st.callback_us, 100):>7.1f}\n")
+
+    out.write("\npublish -> dispatch latency histogram (us, log2 buckets: <1 1-2 2-4 4-8 ...)\n")
+    for evt in sorted(stats):
+        lat = stats[evt].latency_us
+        if not lat:
+            continue
+        buckets = log2_buckets(lat)
+        top = max(i for i, n in enumerate(buckets) if n) + 1
+        out.write(f"{event_name(events, evt):<24} " + " ".join(f"{n:>5}" for n in buckets[:top]) + "\n")
+
+
+# ---- Chrome trace / Perfetto -------------------------------------------------------
+
+DISPATCH_TID = 1
+MODULE_TID_BASE = 100
+
+
+def chrome_trace(records: t.List[Record], events: t.Dict[int, EventInfo],
+                 modules: t.Dict[int, str]) -> t.Dict[str, t.Any]:
+    out: t.List[t.Dict[str, t.Any]] = [
+        {"ph": "M", "name": "process_name", "pid": 1, "args": {"name": "os_evt_bus"}},
+    ]
+    threads: t.Dict[int, str] = {}
+    started: t.Dict[int, Record] = {}
+    flows: t.Set[int] = set()
+
+    def thread(tid: int, name: str) -> int:
+        if tid not in threads:
+            threads[tid] = name
+            out.append({"ph": "M", "name": "thread_name", "pid": 1, "tid": tid, "args": {"name": name}})
+        return tid
+
+    for rec in records:
+        name = event_name(events, rec.evt)
+        pub_tid = thread(MODULE_TID_BASE + rec.src, f"publish: {module_name(modules, rec.src)}")
+        lane = events[rec.evt].lane if rec.evt in events else "?"
+        if rec.kind in (PUBLISH, COALESCE):
+            label = name if rec.kind == PUBLISH else f"{name} (merged)"
+            out.append({"ph": "X", "name": label, "cat": "publish", "pid": 1, "tid": pub_tid, "ts": rec.time_us,
+                        "dur": 0, "args": {"ref": rec.ref, "lane_depth": rec.info}})
+            if rec.kind == PUBLISH:
+                out.append({"ph": "s", "name": "queued", "cat": "flow", "id": rec.ref, "pid": 1, "tid": pub_tid,
+                            "ts": rec.time_us})
+                flows.add(rec.ref)
+            out.append({"ph": "C", "name": f"lane {lane}", "pid": 1, "ts": rec.time_us, "args": {"depth": rec.info}})
+        elif rec.kind in (DROP, NOMEM, REJECT):
+            out.append({"ph": "i", "name": f"{TYPE_NAMES[rec.kind]} {name}", "cat": "refused", "s": "t", "pid": 1,
+                        "tid": pub_tid, "ts": rec.time_us, "args": {"lane_depth": rec.info}})
+        elif rec.kind == DISPATCH_START:
+            started[rec.ref] = rec
+            out.append({"ph": "C", "name": f"lane {lane}", "pid": 1, "ts": rec.time_us, "args": {"depth": rec.info}})
+        elif rec.kind == DISPATCH_END:
+            start = started.pop(rec.ref, None)
+            if start is None:
+                continue
+            tid = thread(DISPATCH_TID + start.core, f"dispatcher (core {start.core})")
+            out.append({"ph": "X", "name": name, "cat": "dispatch", "pid": 1, "tid": tid, "ts": start.time_us,
+                        "dur": rec.time_us - start.time_us, "args": {"ref": rec.ref, "callbacks": rec.info}})
+            if rec.ref in flows:
+                out.append({"ph": "f", "bp": "e", "name": "queued", "cat": "flow", "id": rec.ref, "pid": 1,
+                            "tid": tid, "ts": start.time_us})
+                flows.discard(rec.ref)
+    return {"traceEvents": out, "displayTimeUnit": "ns"}
+
+
+# ---- Main --------------------------------------------------------------------------
+
+def main(argv: t.Optional[t.List[str]] = None) -> int:
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("dumps", nargs="+", type=Path, help="binary dumps or console logs with EVTRACE: lines")
+    parser.add_argument("--types-h", type=Path, default=DEFAULT_TYPES_H,
+                        help="retrofit_os_types.h for event and module names")
+    parser.add_argument("--chrome", type=Path, help="write a Chrome trace / Perfetto JSON timeline here")
+    parser.add_argument("--records", action="store_true", help="also list every record")
+    args = parser.parse_args(argv)
+
+    events, modules = load_names(args.types_h)
+    trace = Trace()
+    try:
+        for path in args.dumps:
+            parse_dumps(read_dump_bytes(path), trace)
+    except (OSError, ValueError) as err:
+        print(f"error: {err}", file=sys.stderr)
+        return 1
+    if not trace.records:
+        print("error: no trace records found", file=sys.stderr)
+        return 1
+
+    records, missing = timeline(trace)
+    if args.records:
+        for rec in records:
+            print(f"{rec.stamp:>10} {rec.time_us:>14.3f} us  core {rec.core}  {TYPE_NAMES.get(rec.kind, rec.kind):<14}"
+                  f" {event_name(events, rec.evt):<24} src={module_name(modules, rec.src):<8} ref={rec.ref:<8}"
+                  f" info={rec.info}")
+        print()
+    print_report(trace, records, missing, events, sys.stdout)
+
+    if args.chrome:
+        args.chrome.write_text(json.dumps(chrome_trace(records, events, modules)), encoding="utf-8")
+        print(f"\ntimeline: {args.chrome} (open in ui.perfetto.dev or chrome://tracing)")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
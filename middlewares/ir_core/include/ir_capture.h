@@ -0,0 +1,137 @@
+/*
+ * ir_capture.h — streaming assembly of long IR captures
+ *
+ * Minisplit remotes send frames of 140-300+ symbols, often as several
+ * sub-frames separated by 20-40 ms of silence. The RMT delivers them as a
+ * sequence of chunks (partial receive); ir_capture appends those chunks into
+ * one arena and records where each sub-frame (segment) starts and how long the
+ * line was idle before it. A capture is complete once the line has been idle
+ * for frame_gap_us after its last segment.
+ *
+ * Timing is reconstructed from the chunk timestamps: a chunk's timestamp is
+ * taken when the RMT hands it over, i.e. at its last edge, or idle_us after
+ * it for the final chunk of a receive.
+ *
+ * Single writer: call from one task (or one ISR) only.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ir_rmt_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Maximum number of sub-frames per capture
+ */
+#ifndef IR_CAPTURE_MAX_SEGS
+#define IR_CAPTURE_MAX_SEGS 8
+#endif
+
+/**
+ * @brief First allocation of a heap-backed arena, in symbols
+ */
+#ifndef IR_CAPTURE_INITIAL_SYMBOLS
+#define IR_CAPTURE_INITIAL_SYMBOLS 128
+#endif
+
+/**
+ * @brief One sub-frame of a capture
+ */
+typedef struct {
+    uint32_t offset;     /*!< Index of the first symbol in the arena */
+    uint32_t symbol_num; /*!< Symbols in this sub-frame */
+    uint32_t gap_us;     /*!< Idle time before this sub-frame, 0 for the first */
+} ir_capture_seg_t;
+
+/**
+ * @brief Capture configuration
+ */
+typedef struct {
+    uint32_t resolution_hz;   /*!< RMT tick rate */
+    uint32_t idle_us;         /*!< RMT end-of-receive idle threshold (signal_range_max) */
+    uint32_t frame_gap_us;    /*!< Idle time that ends a capture; shorter gaps separate sub-frames */
+    rmt_symbol_word_t *arena; /*!< Caller storage, or NULL for a heap arena grown on demand */
+    size_t arena_symbols;     /*!< Size of @c arena (ignored for a heap arena) */
+    size_t max_symbols;       /*!< Upper bound of a heap arena */
+} ir_capture_config_t;
+
+/**
+ * @brief Result of ir_capture_push()
+ */
+typedef enum {
+    IR_CAPTURE_OK = 0,     /*!< Chunk appended */
+    IR_CAPTURE_NEW_FRAME,  /*!< Chunk starts a new capture: consume this one, reset, push again */
+    IR_CAPTURE_CLIPPED,    /*!< Arena or segment table full, chunk (partly) dropped */
+} ir_capture_status_t;
+
+typedef struct {
+    ir_capture_config_t cfg;
+    rmt_symbol_word_t *arena;
+    size_t arena_cap;
+    bool heap;
+
+    size_t used;
+    ir_capture_seg_t segs[IR_CAPTURE_MAX_SEGS];
+    size_t seg_num;
+    bool seg_open;
+    uint32_t last_end_us;
+
+    uint32_t clipped_symbols; /*!< Symbols dropped by the bound, since reset */
+} ir_capture_t;
+
+/**
+ * @brief Initialise an empty capture
+ *
+ * @return false if a heap arena could not be allocated
+ */
+bool ir_capture_init(ir_capture_t *cap, const ir_capture_config_t *cfg);
+
+/**
+ * @brief Free a heap arena
+ */
+void ir_capture_deinit(ir_capture_t *cap);
+
+/**
+ * @brief Drop the current capture, keep the arena
+ */
+void ir_capture_reset(ir_capture_t *cap);
+
+/**
+ * @brief Append one received chunk
+ *
+ * @param chunk Symbols of this chunk
+ * @param symbol_num Number of symbols
+ * @param last true for the final chunk of an RMT receive (ends a sub-frame)
+ * @param ts_us Timestamp of the chunk hand-over, microseconds (free running)
+ */
+ir_capture_status_t ir_capture_push(ir_capture_t *cap, const rmt_symbol_word_t *chunk,
+                                    size_t symbol_num, bool last, uint32_t ts_us);
+
+/**
+ * @brief Whether the capture has ended (line idle for frame_gap_us at @p now_us)
+ */
+bool ir_capture_is_complete(const ir_capture_t *cap, uint32_t now_us);
+
+/**
+ * @brief All captured symbols, sub-frames back to back
+ */
+static inline const rmt_symbol_word_t *ir_capture_symbols(const ir_capture_t *cap, size_t *symbol_num)
+{
+    *symbol_num = cap->used;
+    return cap->arena;
+}
+
+/**
+ * @brief Duration of @p symbol_num symbols, in microseconds
+ */
+uint32_t ir_capture_duration_us(const ir_capture_t *cap, const rmt_symbol_word_t *symbols, size_t symbol_num);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,104 @@
+/*
+ * ir_carrier.h — carrier frequency and duty measurement from unfiltered edges
+ *
+ * The learn receiver demodulates, so its captures carry no carrier. A second
+ * input (a photodiode or TSMP-style unfiltered receiver on its own RMT
+ * channel, at a resolution of at least ~10 ticks per carrier period) sees the
+ * carrier itself: inside a mark every symbol is one carrier period, an on
+ * phase and an off phase. The meter sums the symbols whose period lies in the
+ * carrier band, skipping the mark/space boundaries and anything else outside
+ * it, and rejects periods far from the running mean once that has settled.
+ *
+ * Chunks of one receive can be pushed as they arrive. Single writer.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ir_rmt_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Lowest carrier the meter accepts
+ */
+#define IR_CARRIER_MIN_HZ       20000
+
+/**
+ * @brief Highest carrier the meter accepts (B&O style 455 kHz included)
+ */
+#define IR_CARRIER_MAX_HZ       500000
+
+/**
+ * @brief Periods needed before a result is reported
+ */
+#define IR_CARRIER_MIN_PERIODS  16
+
+/**
+ * @brief Periods further than this from the running mean are glitches
+ */
+#define IR_CARRIER_TOLERANCE_PCT 20
+
+/**
+ * @brief Reported frequencies are rounded to this step, so that slots learned
+ *        from the same remote share one carrier setting
+ */
+#define IR_CARRIER_ROUND_HZ     100
+
+/**
+ * @brief Measured carrier
+ */
+typedef struct {
+    uint32_t freq_hz;  /*!< Carrier frequency, rounded to IR_CARRIER_ROUND_HZ */
+    uint8_t duty_pct;  /*!< On time per period, percent */
+    uint32_t periods;  /*!< Periods the result is based on */
+} ir_carrier_t;
+
+/**
+ * @brief Running measurement
+ */
+typedef struct {
+    uint32_t resolution_hz;  /*!< Tick rate of the pushed symbols */
+    uint8_t on_level;        /*!< Level of the carrier's on phase at the input */
+    uint32_t min_ticks;      /*!< Shortest accepted period */
+    uint32_t max_ticks;      /*!< Longest accepted period */
+    uint64_t period_ticks;   /*!< Sum of accepted periods */
+    uint64_t on_ticks;       /*!< Sum of their on phases */
+    uint32_t periods;        /*!< Accepted periods */
+    uint32_t rejected;       /*!< In-band periods dropped as glitches */
+} ir_carrier_meter_t;
+
+/**
+ * @brief Start a measurement
+ *
+ * @param[in] resolution_hz Tick rate of the symbols
+ * @param[in] on_level      Input level while the carrier is on (0 for active-low receivers)
+ */
+void ir_carrier_meter_init(ir_carrier_meter_t *m, uint32_t resolution_hz, uint8_t on_level);
+
+/**
+ * @brief Add captured symbols
+ */
+void ir_carrier_meter_push(ir_carrier_meter_t *m, const rmt_symbol_word_t *symbols, size_t symbol_num);
+
+/**
+ * @brief Read the result
+ *
+ * @return false if fewer than IR_CARRIER_MIN_PERIODS carrier periods were seen
+ *         (e.g. the input is demodulated)
+ */
+bool ir_carrier_meter_result(const ir_carrier_meter_t *m, ir_carrier_t *out);
+
+/**
+ * @brief Measure one capture: init, push and result in one call
+ */
+bool ir_carrier_measure(const rmt_symbol_word_t *symbols, size_t symbol_num, uint32_t resolution_hz,
+                        uint8_t on_level, ir_carrier_t *out);
+
+#ifdef __cplusplus
+}
+#endif
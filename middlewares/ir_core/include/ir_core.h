@@ -0,0 +1,193 @@
+/*
+ * ir_core.h — platform-agnostic IR waveform utilities
+ *
+ * Decode/normalize helpers split out of the infrared_test app so that the RX
+ * pipeline can be built and measured without RMT hardware (ESP-IDF linux
+ * target or plain host CMake). Timing constants are in microseconds; pulse
+ * classification converts them to ticks once per RMT resolution.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ir_rmt_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Tolerance for parsing RMT symbols into bit stream
+ */
+#define IR_NEC_DECODE_MARGIN 300
+
+/**
+ * @brief NEC timing spec
+ */
+#define NEC_LEADING_CODE_DURATION_0  9000
+#define NEC_LEADING_CODE_DURATION_1  4500
+#define NEC_PAYLOAD_ZERO_DURATION_0  560
+#define NEC_PAYLOAD_ZERO_DURATION_1  560
+#define NEC_PAYLOAD_ONE_DURATION_0   560
+#define NEC_PAYLOAD_ONE_DURATION_1   1690
+#define NEC_REPEAT_CODE_DURATION_0   9000
+#define NEC_REPEAT_CODE_DURATION_1   2250
+
+/**
+ * @brief Number of RMT symbols in a NEC normal frame (leading + 32 bits + ending)
+ */
+#define NEC_FRAME_SYMBOLS  34
+
+/**
+ * @brief Number of RMT symbols in a NEC repeat frame (repeat + ending)
+ */
+#define NEC_REPEAT_SYMBOLS 2
+
+/**
+ * @brief Decoded NEC address and command
+ */
+typedef struct {
+    uint16_t address;
+    uint16_t command;
+} ir_nec_frame_t;
+
+/**
+ * @brief Pulse class of a single mark or space duration
+ */
+typedef enum {
+    IR_PULSE_END = 0,      /*!< Zero duration, RMT end-of-frame marker */
+    IR_PULSE_SHORT,        /*!< NEC mark / logic 0 space (560us) */
+    IR_PULSE_LONG,         /*!< NEC logic 1 space (1690us) */
+    IR_PULSE_REPEAT_SPACE, /*!< NEC repeat space (2250us) */
+    IR_PULSE_LEAD_SPACE,   /*!< NEC leading space (4500us) */
+    IR_PULSE_LEAD_MARK,    /*!< NEC leading / repeat mark (9000us) */
+    IR_PULSE_OTHER,        /*!< Anything else, left untouched by normalization */
+    IR_PULSE__COUNT
+} ir_pulse_class_t;
+
+/**
+ * @brief Duration quantisation: one LUT bucket per 2^IR_PULSE_LUT_SHIFT ticks
+ *
+ * The table covers the full 15-bit RMT duration range, so indexing never needs
+ * a bounds check.
+ */
+#define IR_PULSE_LUT_SHIFT 4
+#define IR_PULSE_LUT_SIZE  (0x8000u >> IR_PULSE_LUT_SHIFT)
+
+/**
+ * @brief Duration bucket -> pulse class lookup table
+ *
+ * Built once per RMT resolution with ir_pulse_lut_init(), then shared
+ * read-only by normalization and decoding.
+ */
+typedef struct {
+    uint32_t resolution_hz;                /*!< Resolution the table was built for */
+    uint16_t canonical[IR_PULSE__COUNT];   /*!< Canonical duration per class, in ticks */
+    uint8_t  cls[IR_PULSE_LUT_SIZE];       /*!< ir_pulse_class_t per duration bucket */
+} ir_pulse_lut_t;
+
+/**
+ * @brief NEC decode result of ir_core_process_frame()
+ */
+typedef enum {
+    IR_NEC_DECODE_NONE = 0, /*!< Not a valid NEC frame */
+    IR_NEC_DECODE_FRAME,    /*!< Normal frame, address/command valid */
+    IR_NEC_DECODE_REPEAT,   /*!< Repeat code */
+} ir_nec_decode_kind_t;
+
+typedef struct {
+    ir_nec_decode_kind_t kind;
+    ir_nec_frame_t       frame;
+} ir_nec_decode_t;
+
+/**
+ * @brief Build the duration bucket table for an RMT resolution
+ *
+ * @param[out] lut           Table to fill
+ * @param[in]  resolution_hz RMT channel resolution (e.g. 1000000 for 1 tick = 1us)
+ */
+void ir_pulse_lut_init(ir_pulse_lut_t *lut, uint32_t resolution_hz);
+
+/**
+ * @brief Classify a single duration
+ */
+static inline ir_pulse_class_t ir_pulse_classify(const ir_pulse_lut_t *lut, uint32_t duration)
+{
+    return (ir_pulse_class_t)lut->cls[(duration & 0x7FFFu) >> IR_PULSE_LUT_SHIFT];
+}
+
+/**
+ * @brief Copy a frame while inverting both levels of every symbol
+ *
+ * The IR receiver output is active low, so captured marks have level 0.
+ * Replaying through the TX channel requires marks at level 1.
+ *
+ * @param[in]  input      Captured symbols
+ * @param[out] output     Destination, may alias @p input
+ * @param[in]  symbol_num Number of symbols
+ */
+void invert_rmt_levels(const rmt_symbol_word_t *input,
+                       rmt_symbol_word_t *output,
+                       size_t symbol_num);
+
+/**
+ * @brief Snap durations in place to canonical NEC timings
+ *
+ * Symbols matching a NEC symbol (leading, repeat, logic 0/1) get the
+ * canonical pair; other durations are snapped per class, and durations of
+ * class IR_PULSE_OTHER are kept as captured.
+ *
+ * @param[in]     lut        Table for the capture resolution
+ * @param[in,out] frame      Symbols to normalize
+ * @param[in]     symbol_num Number of symbols
+ */
+void normalize_rmt_durations(const ir_pulse_lut_t *lut, rmt_symbol_word_t *frame, size_t symbol_num);
+
+/**
+ * @brief Invert levels and normalize durations in one call
+ *
+ * @param[in]  lut          Table for the capture resolution
+ * @param[in]  input_frame  Captured symbols
+ * @param[out] output_frame Normalized symbols, may alias @p input_frame
+ * @param[in]  symbol_num   Number of symbols
+ */
+void normalize_rmt_frame(const ir_pulse_lut_t *lut,
+                         const rmt_symbol_word_t *input_frame,
+                         rmt_symbol_word_t *output_frame,
+                         size_t symbol_num);
+
+/**
+ * @brief Invert, normalize and NEC-decode a captured frame in a single pass
+ *
+ * @param[in]  lut          Table for the capture resolution
+ * @param[in]  input_frame  Captured symbols
+ * @param[out] output_frame Normalized symbols, may alias @p input_frame
+ * @param[in]  symbol_num   Number of symbols
+ * @param[out] decode       Decode result, may be NULL
+ */
+void ir_core_process_frame(const ir_pulse_lut_t *lut,
+                           const rmt_symbol_word_t *input_frame,
+                           rmt_symbol_word_t *output_frame,
+                           size_t symbol_num,
+                           ir_nec_decode_t *decode);
+
+/**
+ * @brief Decode RMT symbols into NEC address and command
+ *
+ * @param[in]  lut             Table for the capture resolution
+ * @param[in]  rmt_nec_symbols At least NEC_FRAME_SYMBOLS - 1 symbols
+ * @param[out] out             Decoded frame, only written on success
+ * @return true if the leading code and all 32 bits are valid
+ */
+bool nec_parse_frame(const ir_pulse_lut_t *lut, const rmt_symbol_word_t *rmt_nec_symbols, ir_nec_frame_t *out);
+
+/**
+ * @brief Check whether the RMT symbols represent NEC repeat code
+ */
+bool nec_parse_frame_repeat(const ir_pulse_lut_t *lut, const rmt_symbol_word_t *rmt_nec_symbols);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,146 @@
+/*
+ * ir_frame_ring.h — lock-free SPSC ring of RMT RX frame buffers
+ *
+ * The producer is the RMT RX-done callback (ISR context), the consumer is the
+ * IR task. On the device (ir_hal_espidf_stream_t) the driver receives into its
+ * own chunk buffer and the callback copies each chunk into the write slot
+ * before committing it; no free slot counts an overrun. Only the host ir_rx
+ * path receives zero-copy, straight into the armed write slot. head and tail
+ * live on separate cache lines so the ISR and the task never write the same
+ * line.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include "ir_rmt_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Number of frame slots, must be a power of two
+ */
+#ifndef IR_FRAME_RING_SLOTS
+#define IR_FRAME_RING_SLOTS 4
+#endif
+
+/**
+ * @brief Capacity of one slot, in RMT symbols
+ */
+#ifndef IR_FRAME_MAX_SYMBOLS
+#define IR_FRAME_MAX_SYMBOLS 64
+#endif
+
+/**
+ * @brief Alignment of the producer/consumer indices and of every slot
+ */
+#ifndef IR_FRAME_RING_ALIGN
+#define IR_FRAME_RING_ALIGN 64
+#endif
+
+_Static_assert((IR_FRAME_RING_SLOTS & (IR_FRAME_RING_SLOTS - 1)) == 0, "IR_FRAME_RING_SLOTS must be a power of two");
+
+/**
+ * @brief Slot flag: final chunk of an RMT receive (always set for whole frames)
+ */
+#define IR_FRAME_F_LAST (1u << 0)
+
+/**
+ * @brief One received frame, or one chunk of a partial (streaming) receive
+ */
+typedef struct {
+    _Alignas(IR_FRAME_RING_ALIGN) rmt_symbol_word_t symbols[IR_FRAME_MAX_SYMBOLS];
+    size_t symbol_num;   /*!< Valid symbols, set on commit */
+    uint32_t seq;        /*!< Commit sequence number, gaps mean dropped frames */
+    uint32_t flags;      /*!< IR_FRAME_F_*, written by the producer before commit */
+    uint32_t ts_us;      /*!< Hand-over timestamp, written by the producer before commit */
+} ir_frame_slot_t;
+
+/**
+ * @brief Ring counters (snapshot)
+ */
+typedef struct {
+    uint32_t committed;  /*!< Frames published by the producer */
+    uint32_t overruns;   /*!< Frames dropped because every slot was in use */
+    uint32_t truncated;  /*!< Frames committed with more symbols than a slot holds */
+    uint32_t high_water; /*!< Maximum number of frames pending at once */
+} ir_frame_ring_stats_t;
+
+typedef struct {
+    /* Producer-owned line */
+    _Alignas(IR_FRAME_RING_ALIGN) _Atomic uint32_t head;
+    /* Written by the producer only; atomic so get_stats() may read them from any context */
+    _Atomic uint32_t committed;
+    _Atomic uint32_t overruns;
+    _Atomic uint32_t truncated;
+    _Atomic uint32_t high_water;
+
+    /* Consumer-owned line */
+    _Alignas(IR_FRAME_RING_ALIGN) _Atomic uint32_t tail;
+
+    ir_frame_slot_t slots[IR_FRAME_RING_SLOTS];
+} ir_frame_ring_t;
+
+/**
+ * @brief Reset indices and counters
+ */
+void ir_frame_ring_init(ir_frame_ring_t *ring);
+
+/* --------------------------------------------------------------------------
+ * Producer side (RMT RX-done callback / ISR)
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Slot the next frame should be received into
+ *
+ * @return Free slot, or NULL if the consumer still holds every slot
+ */
+ir_frame_slot_t *ir_frame_ring_write_slot(ir_frame_ring_t *ring);
+
+/**
+ * @brief Publish the current write slot with @p symbol_num received symbols
+ *
+ * @return false if there was no write slot (frame counted as overrun)
+ */
+bool ir_frame_ring_commit(ir_frame_ring_t *ring, size_t symbol_num);
+
+/**
+ * @brief Count a frame the producer had to drop
+ */
+void ir_frame_ring_overrun(ir_frame_ring_t *ring);
+
+/* --------------------------------------------------------------------------
+ * Consumer side (IR task)
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Oldest committed frame, or NULL if the ring is empty
+ *
+ * The slot is owned by the consumer (and may be modified in place) until
+ * ir_frame_ring_release().
+ */
+ir_frame_slot_t *ir_frame_ring_peek(ir_frame_ring_t *ring);
+
+/**
+ * @brief Hand the oldest frame's slot back to the producer
+ */
+void ir_frame_ring_release(ir_frame_ring_t *ring);
+
+/**
+ * @brief Frames currently pending for the consumer
+ */
+size_t ir_frame_ring_count(const ir_frame_ring_t *ring);
+
+/**
+ * @brief Read the counters (any context)
+ */
+void ir_frame_ring_get_stats(const ir_frame_ring_t *ring, ir_frame_ring_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,84 @@
+/*
+ * ir_hal.h — IR peripheral abstraction used by the ir_core RX/TX engines
+ *
+ * ir_core never calls a driver directly. The firmware binds these ops to the
+ * ESP-IDF RMT driver (apps/infrared_test/ir_hal_espidf_rmt.c); host tests bind
+ * them to a simulator that injects edge streams (tests/common/ir_sim_rx.c).
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "ir_rmt_types.h"
+#include "ir_slot_stream.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Receive side operations
+ */
+typedef struct {
+    /**
+     * @brief Start one receive into @p buf
+     *
+     * Completion is reported by the binding calling ir_rx_on_done(). Must be
+     * callable from the RX-done callback (ISR context).
+     *
+     * @return false if the receive could not be started
+     */
+    bool (*arm)(void *ctx, rmt_symbol_word_t *buf, size_t symbol_cap);
+} ir_hal_rx_ops_t;
+
+/**
+ * @brief Bound receive HAL: ops table plus binding context
+ */
+typedef struct {
+    const ir_hal_rx_ops_t *ops;
+    void *ctx;
+} ir_hal_rx_t;
+
+/**
+ * @brief Transmit side operations
+ */
+typedef struct {
+    /**
+     * @brief Queue one transmission of @p payload, sent @p loop_count more times by the hardware
+     *
+     * Completion of each queued transmission (after its last loop) is reported
+     * by the binding calling ir_tx_on_done(). Only called from the task that
+     * runs ir_tx_pump(), and only while fewer than queue_depth transmissions
+     * are pending, so it must not need to block.
+     *
+     * @return false if the transmission could not be queued
+     */
+    bool (*submit)(void *ctx, const ir_slot_tx_payload_t *payload, uint32_t loop_count);
+
+    /**
+     * @brief Modulate the following transmissions with a new carrier, optional
+     *
+     * Only called from the task, with no transmission pending.
+     *
+     * @param carrier_hz Carrier frequency, 0 = unmodulated
+     * @param duty_pct Carrier duty cycle, percent
+     * @return false if the carrier could not be applied
+     */
+    bool (*set_carrier)(void *ctx, uint32_t carrier_hz, uint8_t duty_pct);
+} ir_hal_tx_ops_t;
+
+/**
+ * @brief Bound transmit HAL: ops table, binding context and channel limits
+ */
+typedef struct {
+    const ir_hal_tx_ops_t *ops;
+    void *ctx;
+    uint32_t resolution_hz;    /*!< Channel tick rate */
+    size_t queue_depth;        /*!< Transmissions the driver accepts at once */
+    size_t loop_max_symbols;   /*!< Longest transmission the hardware can loop, 0 = no loop support */
+} ir_hal_tx_t;
+
+#ifdef __cplusplus
+}
+#endif
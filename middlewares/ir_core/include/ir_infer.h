@@ -0,0 +1,101 @@
+/*
+ * ir_infer.h — per-capture timing inference for unknown remotes
+ *
+ * Clusters the mark and space durations of one capture independently:
+ *
+ *   1. histogram   durations go into log-spaced buckets (3 mantissa bits,
+ *                  ~12% wide), so the histogram has a fixed small size
+ *   2. breaks      walking the buckets upwards, a new cluster starts where a
+ *                  bucket lies more than IR_INFER_BREAK_PCT above the running
+ *                  mean of the current one (natural breaks)
+ *   3. refine      1D k-means (Lloyd) over the bucket centroids, boundaries at
+ *                  the midpoints between centres, until it settles
+ *
+ * The cluster centres are the capture's canonical timings. When the capture
+ * is a pulse-distance/pulse-width frame (optional leader, symbols of exactly
+ * two kinds, optional trailing mark) the template also holds the inferred
+ * ir_pd_desc_t and the bit sequence, ready for the ir_pd encoder.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ir_rmt_types.h"
+#include "ir_pd.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Most clusters kept per duration kind (marks, spaces)
+ */
+#define IR_INFER_MAX_CLUSTERS 8
+
+/**
+ * @brief Distance above a cluster's mean that starts a new cluster
+ */
+#define IR_INFER_BREAK_PCT    30
+
+/**
+ * @brief Lloyd iterations at most, it usually settles after two
+ */
+#define IR_INFER_MAX_ITER     8
+
+/**
+ * @brief Clusters of one duration kind, ascending
+ */
+typedef struct {
+    uint16_t centre[IR_INFER_MAX_CLUSTERS]; /*!< Canonical duration, in ticks */
+    uint16_t count[IR_INFER_MAX_CLUSTERS];  /*!< Durations assigned to the cluster */
+    uint8_t num;
+} ir_infer_clusters_t;
+
+/**
+ * @brief Timing template of one capture
+ */
+typedef struct {
+    uint32_t resolution_hz;      /*!< Resolution of the capture */
+    ir_infer_clusters_t marks;   /*!< duration0 clusters */
+    ir_infer_clusters_t spaces;  /*!< duration1 clusters, zero end markers excluded */
+    bool pd;                     /*!< The capture is a pulse-distance/pulse-width frame */
+    ir_pd_desc_t desc;           /*!< Inferred protocol if pd; byte_num is bit_num / 8 rounded up, LSB first */
+    uint16_t bit_num;            /*!< Bits in the frame if pd */
+} ir_infer_template_t;
+
+/**
+ * @brief Infer the timing template and bit sequence of a capture
+ *
+ * Levels are ignored (duration0 is the mark), so raw receiver captures work
+ * as-is. Bits are packed in transmission order, the first bit in the LSB of
+ * bits[0], which is the desc's LSB-first order.
+ *
+ * @param[in]  symbols       Captured symbols
+ * @param[in]  symbol_num    Number of symbols
+ * @param[in]  resolution_hz Capture resolution
+ * @param[out] tpl           Template
+ * @param[out] bits          Bit sequence, may be NULL
+ * @param[in]  bits_cap      Capacity of @p bits in bytes; longer frames are not pd
+ * @return false if the capture is empty
+ */
+bool ir_infer(const rmt_symbol_word_t *symbols, size_t symbol_num, uint32_t resolution_hz,
+              ir_infer_template_t *tpl, uint8_t *bits, size_t bits_cap);
+
+/**
+ * @brief Snap every duration to the centre of its cluster
+ *
+ * Zero end markers and levels are kept.
+ *
+ * @param[in]  tpl        Template from ir_infer() on the same capture
+ * @param[in]  input      Captured symbols
+ * @param[out] output     Canonical symbols, may alias @p input
+ * @param[in]  symbol_num Number of symbols
+ */
+void ir_infer_normalize(const ir_infer_template_t *tpl, const rmt_symbol_word_t *input,
+                        rmt_symbol_word_t *output, size_t symbol_num);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,147 @@
+/*
+ * ir_learn.h — consensus learning from repeated presses of one button
+ *
+ * A learn session keeps up to IR_LEARN_MAX_PRESSES captures of the same
+ * button in one caller-provided arena, then merges them into a single
+ * waveform:
+ *
+ *   1. shape      sub-frame k is part of the consensus if more than half of
+ *                 the presses have it with the same symbol count; presses
+ *                 with another count for it (a lost or split symbol) do not
+ *                 take part in it. A held button only adds trailing
+ *                 sub-frames, so the presses still align.
+ *   2. median     every duration (mark, space, sub-frame gap) is the median
+ *                 of the aligned presses, symbol by symbol
+ *   3. outliers   a press with more than IR_LEARN_MAX_MISMATCH_PCT of its
+ *                 durations off the median by more than the tolerance is
+ *                 dropped, and the medians are taken again without it
+ *
+ * The confidence is the share of all collected durations that agree with
+ * the consensus. Time and memory are bounded by the arena and the press
+ * count: O(symbols x presses) work, nothing allocated.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ir_rmt_types.h"
+#include "ir_capture.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Presses kept per session (one bit each in the member masks)
+ */
+#define IR_LEARN_MAX_PRESSES      8
+
+/**
+ * @brief Default tolerance of a duration around the median, percent
+ */
+#define IR_LEARN_TOLERANCE_PCT    25
+
+/**
+ * @brief Smallest tolerance, for short durations where jitter dominates
+ */
+#define IR_LEARN_TOLERANCE_MIN_US 200
+
+/**
+ * @brief Share of a press's durations that may miss the median before the press is dropped
+ */
+#define IR_LEARN_MAX_MISMATCH_PCT 10
+
+/**
+ * @brief ir_learn result codes
+ */
+typedef enum {
+    IR_LEARN_OK = 0,
+    IR_LEARN_ERR_ARG,          /*!< Invalid argument */
+    IR_LEARN_ERR_NO_SPACE,     /*!< Arena, press table or output full */
+    IR_LEARN_ERR_NO_CONSENSUS, /*!< No press collected, or the presses disagree on the first sub-frame */
+} ir_learn_err_t;
+
+/**
+ * @brief Session settings
+ */
+typedef struct {
+    uint32_t resolution_hz;     /*!< Tick rate of the captures */
+    rmt_symbol_word_t *arena;   /*!< Storage for all presses */
+    size_t arena_symbols;
+    uint8_t tolerance_pct;      /*!< 0 = IR_LEARN_TOLERANCE_PCT */
+} ir_learn_config_t;
+
+/**
+ * @brief One collected press
+ */
+typedef struct {
+    uint32_t offset;                           /*!< First symbol in the arena */
+    uint32_t symbol_num;
+    ir_capture_seg_t segs[IR_CAPTURE_MAX_SEGS]; /*!< Offsets relative to the press */
+    uint8_t seg_num;
+} ir_learn_press_t;
+
+typedef struct {
+    ir_learn_config_t cfg;
+    size_t used;                                   /*!< Arena symbols in use */
+    ir_learn_press_t presses[IR_LEARN_MAX_PRESSES];
+    uint8_t press_num;
+} ir_learn_t;
+
+/**
+ * @brief Consensus of a session
+ */
+typedef struct {
+    size_t symbol_num;                          /*!< Symbols written to the output */
+    ir_capture_seg_t segs[IR_CAPTURE_MAX_SEGS]; /*!< Sub-frames of the output */
+    uint8_t seg_num;
+    uint8_t presses;                            /*!< Presses collected */
+    uint8_t used;                               /*!< Presses that agree with the consensus */
+    uint8_t rejected_mask;                      /*!< Bit p set: press p was dropped as an outlier */
+    uint8_t confidence_pct;                     /*!< Collected durations within tolerance of the consensus */
+} ir_learn_result_t;
+
+/**
+ * @brief Start an empty session
+ */
+ir_learn_err_t ir_learn_init(ir_learn_t *l, const ir_learn_config_t *cfg);
+
+/**
+ * @brief Drop the collected presses, keep the arena
+ */
+void ir_learn_reset(ir_learn_t *l);
+
+/**
+ * @brief Copy one press into the session
+ *
+ * @param segs Sub-frames (see ir_capture), or NULL for a single sub-frame
+ * @return IR_LEARN_ERR_NO_SPACE if the arena or the press table is full
+ */
+ir_learn_err_t ir_learn_add(ir_learn_t *l, const rmt_symbol_word_t *symbols, size_t symbol_num,
+                            const ir_capture_seg_t *segs, size_t seg_num);
+
+/**
+ * @brief Presses collected so far
+ */
+static inline size_t ir_learn_press_num(const ir_learn_t *l)
+{
+    return l->press_num;
+}
+
+/**
+ * @brief Merge the collected presses
+ *
+ * Levels are taken from the first aligned press of each sub-frame.
+ *
+ * @param[out] out     Consensus waveform
+ * @param[in]  out_cap Capacity of @p out in symbols
+ * @param[out] res     Sub-frames, counts and confidence
+ */
+ir_learn_err_t ir_learn_consensus(const ir_learn_t *l, rmt_symbol_word_t *out, size_t out_cap,
+                                  ir_learn_result_t *res);
+
+#ifdef __cplusplus
+}
+#endif
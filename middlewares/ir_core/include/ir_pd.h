@@ -0,0 +1,152 @@
+/*
+ * ir_pd.h — descriptor-driven pulse-distance / pulse-width IR protocols
+ *
+ * Most consumer remotes, including the common HVAC families, send a leader
+ * pulse, a run of bits where 0 and 1 differ only in their mark or space
+ * duration, and a trailing mark. An ir_pd_desc_t holds those timings plus
+ * bit order and length, so one encoder/decoder pair covers every such
+ * protocol. A frame that matches a descriptor is stored as its data bytes
+ * instead of its waveform.
+ *
+ * Durations in descriptors are microseconds; ir_pd_symbols() converts them
+ * to RMT symbols once per resolution. Marks are level 1.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ir_rmt_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Longest frame any descriptor may describe, in data bytes
+ */
+#define IR_PD_MAX_BYTES        32
+
+/**
+ * @brief Relative tolerance of ir_pd_decode() on every duration
+ */
+#define IR_PD_TOLERANCE_PCT    25
+
+/**
+ * @brief Absolute tolerance floor of ir_pd_decode(), for short pulses
+ */
+#define IR_PD_TOLERANCE_MIN_US 250
+
+/**
+ * @brief One mark followed by one space
+ */
+typedef struct {
+    uint16_t mark_us;  /*!< Mark (carrier on) duration */
+    uint16_t space_us; /*!< Space (carrier off) duration */
+} ir_pd_pulse_t;
+
+/**
+ * @brief Protocol descriptor
+ */
+typedef struct {
+    const char *name;      /*!< Preset name, for logs */
+    ir_pd_pulse_t leader;  /*!< Leader, mark_us 0 = none */
+    ir_pd_pulse_t zero;    /*!< Logic 0 */
+    ir_pd_pulse_t one;     /*!< Logic 1 */
+    ir_pd_pulse_t trailer; /*!< Trailing mark, mark_us 0 = none; space_us 0 ends the transmission */
+    uint8_t byte_num;      /*!< Data bytes per frame, 0 = any whole number of bytes */
+    bool msb_first;        /*!< Bit order within each byte */
+} ir_pd_desc_t;
+
+/**
+ * @brief A descriptor's timings as RMT symbols at one resolution
+ */
+typedef struct {
+    rmt_symbol_word_t leader;
+    rmt_symbol_word_t zero;
+    rmt_symbol_word_t one;
+    rmt_symbol_word_t trailer;
+} ir_pd_symbols_t;
+
+extern const ir_pd_desc_t ir_pd_nec;           /*!< NEC / NEC extended, 4 bytes */
+extern const ir_pd_desc_t ir_pd_samsung;       /*!< Samsung32 (TVs, some window units), 4 bytes */
+extern const ir_pd_desc_t ir_pd_coolix;        /*!< Midea / Coolix splits, 6 bytes MSB first */
+extern const ir_pd_desc_t ir_pd_toshiba_ac;    /*!< Toshiba splits, 9 bytes MSB first */
+extern const ir_pd_desc_t ir_pd_mitsubishi_ac; /*!< Mitsubishi Electric splits, 18 bytes */
+extern const ir_pd_desc_t ir_pd_daikin;        /*!< Daikin ARC remotes, one section of any length */
+
+/**
+ * @brief Presets tried by ir_pd_identify(), fixed-length ones first
+ */
+extern const ir_pd_desc_t *const ir_pd_presets[];
+extern const size_t ir_pd_preset_num;
+
+/**
+ * @brief Convert a descriptor's timings to RMT symbols
+ *
+ * Durations are clamped to the 15-bit RMT range.
+ *
+ * @param[in]  desc          Protocol
+ * @param[in]  resolution_hz RMT channel resolution
+ * @param[out] out           Leader, bit and trailer symbols
+ */
+void ir_pd_symbols(const ir_pd_desc_t *desc, uint32_t resolution_hz, ir_pd_symbols_t *out);
+
+/**
+ * @brief Number of symbols a frame of @p byte_num bytes expands to
+ */
+size_t ir_pd_symbol_count(const ir_pd_desc_t *desc, size_t byte_num);
+
+/**
+ * @brief Expand data bytes into the frame's RMT symbols
+ *
+ * Reference expansion, the same waveform the RMT pulse-distance encoder
+ * produces.
+ *
+ * @param[in]  desc          Protocol
+ * @param[in]  resolution_hz RMT channel resolution
+ * @param[in]  data          Data bytes
+ * @param[in]  byte_num      Number of data bytes
+ * @param[out] out           Symbols
+ * @param[in]  cap           Capacity of @p out
+ * @return Symbols written, 0 if @p cap is too small
+ */
+size_t ir_pd_expand(const ir_pd_desc_t *desc, uint32_t resolution_hz, const uint8_t *data, size_t byte_num,
+                    rmt_symbol_word_t *out, size_t cap);
+
+/**
+ * @brief Decode one captured frame against a descriptor
+ *
+ * Levels are ignored: duration0 is taken as the mark, duration1 as the
+ * space, so raw (active low) receiver captures decode as-is. Each bit is
+ * the closer of the zero and one pulses and must lie within the tolerance
+ * (IR_PD_TOLERANCE_PCT, at least IR_PD_TOLERANCE_MIN_US). The trailer's
+ * space is not checked.
+ *
+ * @param[in]  desc          Protocol
+ * @param[in]  resolution_hz Capture resolution
+ * @param[in]  symbols       Captured frame
+ * @param[in]  symbol_num    Number of symbols
+ * @param[out] out           Data bytes
+ * @param[in]  cap           Capacity of @p out
+ * @param[out] byte_num      Number of data bytes decoded
+ * @return true if the whole frame matches
+ */
+bool ir_pd_decode(const ir_pd_desc_t *desc, uint32_t resolution_hz, const rmt_symbol_word_t *symbols,
+                  size_t symbol_num, uint8_t *out, size_t cap, size_t *byte_num);
+
+/**
+ * @brief Decode a captured frame against every preset
+ *
+ * Presets with the same timings are told apart by length only, so a frame
+ * is reported as the first match in ir_pd_presets[] order.
+ *
+ * @return Matching preset, or NULL
+ */
+const ir_pd_desc_t *ir_pd_identify(uint32_t resolution_hz, const rmt_symbol_word_t *symbols, size_t symbol_num,
+                                   uint8_t *out, size_t cap, size_t *byte_num);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,41 @@
+/*
+ * ir_rmt_types.h — RMT symbol type shim for ir_core
+ *
+ * On real ESP targets the symbol layout comes straight from the HAL so that
+ * buffers can be handed to the RMT driver without conversion. On the ESP-IDF
+ * linux target and plain host builds the same bit layout is defined here.
+ */
+#pragma once
+
+#include <stdint.h>
+
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
+#if defined(ESP_PLATFORM) && !defined(CONFIG_IDF_TARGET_LINUX)
+#include "hal/rmt_types.h"
+#else
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief RMT symbol, bit-compatible with the ESP-IDF HAL definition
+ */
+typedef union {
+    struct {
+        uint16_t duration0 : 15; /*!< Duration of level0 */
+        uint16_t level0 : 1;     /*!< Level of the first part */
+        uint16_t duration1 : 15; /*!< Duration of level1 */
+        uint16_t level1 : 1;     /*!< Level of the second part */
+    };
+    uint32_t val; /*!< Equivalent unsigned value for the RMT symbol */
+} rmt_symbol_word_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,84 @@
+/*
+ * ir_rx.h — continuous N-buffer IR receive on top of ir_frame_ring
+ *
+ * The receiver always has one ring slot armed. When a frame completes, the
+ * RX-done callback commits it and arms the next free slot before returning,
+ * so the channel is listening again while the task is still parsing. The
+ * channel only goes idle when the task holds every slot; the next release
+ * re-arms it.
+ *
+ * Host only: no firmware binds it. The device receives through
+ * ir_hal_espidf_stream_t (apps/infrared_test), which copies partial-RX chunks
+ * into an ir_frame_ring and drops a whole receive on a chunk sequence gap;
+ * ir_rx_loss_bench measures this receiver, not that path.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include "ir_hal.h"
+#include "ir_frame_ring.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Receiver counters (snapshot)
+ */
+typedef struct {
+    ir_frame_ring_stats_t ring;
+    uint32_t stalls;      /*!< RX-done with no free slot left, channel idle until a release */
+    uint32_t arm_errors;  /*!< HAL refused to start a receive */
+} ir_rx_stats_t;
+
+typedef struct {
+    ir_frame_ring_t ring;
+    ir_hal_rx_t hal;
+    _Atomic bool armed;
+    _Atomic uint32_t stalls;
+    _Atomic uint32_t arm_errors;
+} ir_rx_t;
+
+/**
+ * @brief Reset the ring and arm the first slot
+ *
+ * @return false if the HAL could not start receiving
+ */
+bool ir_rx_start(ir_rx_t *rx, const ir_hal_rx_t *hal);
+
+/**
+ * @brief Report a completed receive (RX-done callback / ISR)
+ *
+ * Commits the armed slot with @p symbol_num symbols and arms the next one.
+ *
+ * @return true if a frame was committed, i.e. the consumer should be woken
+ */
+bool ir_rx_on_done(ir_rx_t *rx, size_t symbol_num);
+
+/**
+ * @brief Oldest received frame, or NULL (consumer task)
+ */
+ir_frame_slot_t *ir_rx_peek(ir_rx_t *rx);
+
+/**
+ * @brief Release the oldest frame, re-arming the channel if it had stalled
+ */
+void ir_rx_release(ir_rx_t *rx);
+
+/**
+ * @brief Whether a receive is currently armed
+ */
+bool ir_rx_is_armed(const ir_rx_t *rx);
+
+/**
+ * @brief Read the counters (any context)
+ */
+void ir_rx_get_stats(const ir_rx_t *rx, ir_rx_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
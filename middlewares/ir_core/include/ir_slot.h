@@ -0,0 +1,180 @@
+/*
+ * ir_slot.h — compact IR slot blob (header + waveform) for persistent storage
+ *
+ * A learned command is stored as a fixed 24-byte header followed by a
+ * payload. All multi-byte fields are little endian.
+ *
+ *   header   magic "IR", version, flags, payload_len, crc16,
+ *            carrier_hz, duty_pct, repeat, repeat_gap_us,
+ *            symbol_num, seg_num, dict_num
+ *   payload  dictionary   dict_num x u16 durations in microseconds
+ *            segments     seg_num x (varint symbol_num, varint gap_us, varint ref)
+ *            waveform     bit-packed index stream (or varints in raw mode)
+ *
+ * Every mark/space duration is replaced by the index of its dictionary
+ * entry, using 2-4 bits per index depending on the dictionary size. The
+ * highest index value is an escape: (ESC, n) repeats the previous symbol
+ * n + 2 times. A sub-frame that is identical to an earlier one is stored
+ * as a reference (ref = earlier index + 1) without waveform bits. Captures
+ * with more than 15 distinct durations (after tolerance merging) fall back
+ * to raw mode: one varint per duration.
+ *
+ * The crc16 (CCITT-FALSE) covers the header, with the crc field zeroed,
+ * and the payload.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ir_rmt_types.h"
+#include "ir_capture.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Blob format version written by ir_slot_encode()
+ */
+#define IR_SLOT_VERSION        1
+
+/**
+ * @brief Header size in bytes
+ */
+#define IR_SLOT_HEADER_SIZE    24
+
+/**
+ * @brief Largest dictionary usable in indexed mode (4-bit indices, one escape)
+ */
+#define IR_SLOT_DICT_MAX       15
+
+#define IR_SLOT_F_LEVEL0_HIGH  (1u << 0) /*!< level0 of every symbol is 1 (level1 is the opposite) */
+#define IR_SLOT_F_RAW          (1u << 1) /*!< Waveform stored as varint durations, no dictionary */
+
+/**
+ * @brief ir_slot result codes
+ */
+typedef enum {
+    IR_SLOT_OK = 0,
+    IR_SLOT_ERR_ARG,      /*!< Invalid argument or waveform the format cannot represent */
+    IR_SLOT_ERR_NO_SPACE, /*!< Output buffer too small */
+    IR_SLOT_ERR_FORMAT,   /*!< Bad magic, length or payload structure */
+    IR_SLOT_ERR_VERSION,  /*!< Unsupported format version */
+    IR_SLOT_ERR_CRC,      /*!< CRC mismatch */
+} ir_slot_err_t;
+
+/**
+ * @brief Transport metadata stored with the waveform (FR-3)
+ */
+typedef struct {
+    uint32_t carrier_hz;    /*!< Carrier frequency, 0 = unmodulated */
+    uint8_t duty_pct;       /*!< Carrier duty cycle, percent */
+    uint8_t repeat;         /*!< Extra transmissions after the first */
+    uint32_t repeat_gap_us; /*!< Idle time between transmissions */
+} ir_slot_meta_t;
+
+/**
+ * @brief Decoded header
+ */
+typedef struct {
+    uint8_t version;
+    uint8_t flags;          /*!< IR_SLOT_F_* */
+    uint16_t payload_len;
+    uint16_t crc;
+    ir_slot_meta_t meta;
+    uint16_t symbol_num;    /*!< Total RMT symbols over all sub-frames */
+    uint8_t seg_num;
+    uint8_t dict_num;
+} ir_slot_header_t;
+
+/**
+ * @brief Encoder settings
+ */
+typedef struct {
+    uint32_t resolution_hz; /*!< Tick rate of the input symbols */
+    uint8_t tolerance_pct;  /*!< Durations within this distance of a dictionary entry share it (0 = exact) */
+} ir_slot_encode_cfg_t;
+
+/**
+ * @brief Encode a waveform into a slot blob
+ *
+ * @param segs Sub-frames (see ir_capture), or NULL for a single sub-frame
+ * @param out_len Blob size on success, or the required size on IR_SLOT_ERR_NO_SPACE
+ */
+ir_slot_err_t ir_slot_encode(const ir_slot_encode_cfg_t *cfg, const ir_slot_meta_t *meta,
+                             const rmt_symbol_word_t *symbols, size_t symbol_num,
+                             const ir_capture_seg_t *segs, size_t seg_num,
+                             uint8_t *out, size_t out_cap, size_t *out_len);
+
+/**
+ * @brief Parse and validate a blob header (magic, version, length, crc)
+ */
+ir_slot_err_t ir_slot_parse_header(const uint8_t *blob, size_t len, ir_slot_header_t *hdr);
+
+/**
+ * @brief Incremental decoder, produces RMT symbols in caller-sized pieces
+ */
+typedef struct {
+    ir_slot_header_t hdr;
+    const uint8_t *blob;
+    size_t len;
+
+    uint16_t dict_ticks[IR_SLOT_DICT_MAX];
+    uint8_t bits;                                /*!< Bits per index (indexed mode) */
+    uint16_t seg_symbols[IR_CAPTURE_MAX_SEGS];
+    uint32_t seg_gap_us[IR_CAPTURE_MAX_SEGS];
+    uint8_t seg_ref[IR_CAPTURE_MAX_SEGS];        /*!< 0 = literal, else index of the literal sub-frame + 1 */
+    size_t seg_start[IR_CAPTURE_MAX_SEGS];       /*!< Stream position where each literal sub-frame begins */
+    size_t wave;                                 /*!< Byte offset of the waveform stream */
+    uint32_t resolution_hz;                      /*!< Output tick rate */
+
+    int seg;                                     /*!< Current sub-frame, -1 before the first */
+    uint32_t seg_left;                           /*!< Symbols left in it */
+    size_t pos;                                  /*!< Read position: bits (indexed) or bytes (raw) from wave */
+    size_t literal_pos;                          /*!< Where the literal stream continues after a ref */
+    uint32_t run_left;                           /*!< Pending repeats of prev */
+    rmt_symbol_word_t prev;
+    bool error;                                  /*!< Stream ran past the blob */
+} ir_slot_reader_t;
+
+/**
+ * @brief Validate @p blob and position the reader before the first sub-frame
+ */
+ir_slot_err_t ir_slot_reader_init(ir_slot_reader_t *r, const uint8_t *blob, size_t len, uint32_t resolution_hz);
+
+/**
+ * @brief Advance to the next sub-frame
+ *
+ * @param[out] gap_us Idle time before it (0 for the first)
+ * @param[out] symbol_num Its length in symbols
+ * @return false when all sub-frames were read
+ */
+bool ir_slot_reader_next_segment(ir_slot_reader_t *r, uint32_t *gap_us, size_t *symbol_num);
+
+/**
+ * @brief Decode up to @p max symbols of the current sub-frame
+ *
+ * @return Symbols written, 0 at the end of the sub-frame
+ */
+size_t ir_slot_read(ir_slot_reader_t *r, rmt_symbol_word_t *out, size_t max);
+
+/**
+ * @brief Decode a whole blob into RMT symbols and sub-frames
+ *
+ * @param segs Optional, receives up to @p seg_cap sub-frames
+ * @param[out] seg_num Optional, number of sub-frames
+ */
+ir_slot_err_t ir_slot_decode(const uint8_t *blob, size_t len, uint32_t resolution_hz,
+                             rmt_symbol_word_t *out, size_t out_cap, size_t *symbol_num,
+                             ir_capture_seg_t *segs, size_t seg_cap, size_t *seg_num);
+
+/**
+ * @brief CRC-16/CCITT-FALSE, chainable (start with 0xFFFF)
+ */
+uint16_t ir_slot_crc16(uint16_t crc, const uint8_t *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,69 @@
+/*
+ * ir_slot_stream.h — TX-ready symbol stream over an ir_slot blob
+ *
+ * Turns the sub-frames of a slot into one continuous RMT transmission: the
+ * idle gap before each sub-frame is folded into the trailing space of the
+ * previous one (replacing its zero end marker) and, when longer than one
+ * symbol half can hold, padded with idle-level symbols. An optional tail gap
+ * after the last sub-frame is emitted the same way, so a hardware loop or a
+ * queue of back-to-back transactions keeps its spacing. Symbols come out in
+ * caller-sized pieces, so an RMT encoder can expand a slot of any length
+ * through a fixed staging buffer.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ir_rmt_types.h"
+#include "ir_slot.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Longest duration one RMT symbol half can hold, in ticks
+ */
+#define IR_SLOT_STREAM_MAX_TICKS 0x7FFFu
+
+/**
+ * @brief One transmission of a slot, the payload of the app's RMT slot encoder
+ */
+typedef struct {
+    const uint8_t *blob;     /*!< ir_slot blob, read in place */
+    size_t len;
+    uint32_t tail_gap_us;    /*!< Idle time appended after the last sub-frame */
+} ir_slot_tx_payload_t;
+
+typedef struct {
+    ir_slot_reader_t reader;
+    uint32_t gap_ticks;      /*!< Idle time still to emit before the current sub-frame */
+    uint32_t tail_gap_ticks; /*!< Idle time after the last sub-frame */
+    bool in_tail;            /*!< Last sub-frame emitted, only the tail gap is left */
+    bool done;               /*!< Every sub-frame was emitted */
+} ir_slot_stream_t;
+
+/**
+ * @brief Validate the payload's blob and position the stream at its first symbol
+ *
+ * The blob is read in place and must stay valid until the stream is done.
+ */
+ir_slot_err_t ir_slot_stream_init(ir_slot_stream_t *st, const ir_slot_tx_payload_t *payload, uint32_t resolution_hz);
+
+/**
+ * @brief Produce up to @p max symbols of the transmission
+ *
+ * @return Symbols written, 0 once the whole slot was emitted
+ */
+size_t ir_slot_stream_fill(ir_slot_stream_t *st, rmt_symbol_word_t *out, size_t max);
+
+/**
+ * @brief Number of symbols ir_slot_stream_fill() produces for @p payload, 0 if the blob is invalid
+ */
+size_t ir_slot_stream_count(const ir_slot_tx_payload_t *payload, uint32_t resolution_hz);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,165 @@
+/*
+ * ir_tx.h — batched IR transmit of slot routines through the TX queue
+ *
+ * A routine is a list of slots, each sent 1 + repeat times with gap_us of
+ * idle after every transmission (power, mode, temperature, ...). The engine
+ * keeps the driver's transaction queue full: a step whose transmission fits
+ * the channel memory is repeated by the hardware (one transaction with
+ * loop_count = repeat), longer ones are queued once per repeat. Gaps are part
+ * of each transmission (ir_slot_tx_payload_t::tail_gap_us), so back-to-back
+ * transactions keep their spacing without the CPU timing anything.
+ *
+ * ir_tx_send() and ir_tx_pump() run in one task; ir_tx_on_done() runs in the
+ * TX-done callback. The routine's callback is called from ir_tx_pump() once
+ * the last transmission has finished.
+ *
+ * Every step is modulated with the carrier stored in its slot. The carrier
+ * last applied is cached, so steps with the same carrier as the previous one
+ * cost nothing; a different one waits until the queue has drained (the
+ * hardware would switch in the middle of a pending transmission), then goes
+ * through ir_hal_tx_ops_t::set_carrier.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include "ir_hal.h"
+#include "ir_slot_stream.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Upper bound for ir_hal_tx_t::queue_depth (payloads in flight)
+ */
+#ifndef IR_TX_QUEUE_MAX
+#define IR_TX_QUEUE_MAX 4
+#endif
+
+/**
+ * @brief One command of a routine
+ */
+typedef struct {
+    const uint8_t *blob;     /*!< ir_slot blob, must stay valid until the routine is done */
+    size_t len;
+    uint8_t repeat;          /*!< Extra transmissions after the first */
+    uint32_t gap_us;         /*!< Idle time after every transmission of this step */
+} ir_tx_step_t;
+
+/**
+ * @brief Routine outcome, passed to the completion callback
+ */
+typedef enum {
+    IR_TX_OK = 0,
+    IR_TX_ERR_SLOT,          /*!< A step's blob is invalid, later steps were skipped */
+    IR_TX_ERR_SUBMIT,        /*!< The HAL refused a transmission, later ones were skipped */
+    IR_TX_ERR_CARRIER,       /*!< The HAL refused a step's carrier, it and later steps were skipped */
+} ir_tx_result_t;
+
+typedef void (*ir_tx_done_cb_t)(void *user, ir_tx_result_t result);
+
+/**
+ * @brief A batch of steps sent back to back
+ */
+typedef struct {
+    const ir_tx_step_t *steps;  /*!< Must stay valid until the routine is done */
+    size_t step_num;
+    ir_tx_done_cb_t on_done;    /*!< Optional */
+    void *user;
+} ir_tx_routine_t;
+
+/**
+ * @brief Engine counters (snapshot)
+ */
+typedef struct {
+    uint32_t routines;       /*!< Routines finished, successfully or not */
+    uint32_t transactions;   /*!< Transmissions handed to the HAL */
+    uint32_t hw_repeats;     /*!< Repeats done by hardware loops */
+    uint32_t sw_repeats;     /*!< Repeats queued as separate transmissions */
+    uint32_t errors;         /*!< Routines that ended with an error */
+    uint32_t carrier_changes; /*!< Carriers applied through the HAL, cache misses */
+} ir_tx_stats_t;
+
+typedef struct {
+    ir_hal_tx_t hal;
+    ir_tx_routine_t routine;
+    bool busy;
+    ir_tx_result_t result;
+
+    size_t next_step;               /*!< Next routine step to plan */
+    ir_slot_tx_payload_t step_payload;
+    uint32_t step_loop;             /*!< loop_count of the current step's transmissions */
+    uint32_t step_sends;            /*!< Transmissions of the current step still to queue */
+    uint32_t step_carrier_hz;       /*!< Carrier of the current step, from its slot header */
+    uint8_t step_duty_pct;
+    bool step_carrier_pending;      /*!< The step's carrier is not applied yet */
+
+    uint32_t carrier_hz;            /*!< Carrier last applied */
+    uint8_t duty_pct;
+    bool carrier_valid;             /*!< carrier_hz/duty_pct reflect the channel */
+
+    ir_slot_tx_payload_t payloads[IR_TX_QUEUE_MAX]; /*!< In-flight payloads, the driver reads them in place */
+    _Atomic uint32_t submitted;     /*!< Written by the task */
+    _Atomic uint32_t completed;     /*!< Written by the TX-done callback */
+
+    ir_tx_stats_t stats;
+} ir_tx_t;
+
+/**
+ * @brief Bind the engine to a TX HAL; the engine must own the channel's completions
+ */
+void ir_tx_init(ir_tx_t *tx, const ir_hal_tx_t *hal);
+
+/**
+ * @brief Start a routine and queue as many transmissions as the driver accepts
+ *
+ * @return false if a routine is still running or @p routine is empty
+ */
+bool ir_tx_send(ir_tx_t *tx, const ir_tx_routine_t *routine);
+
+/**
+ * @brief Report a finished transmission (TX-done callback / ISR)
+ *
+ * @return true if it was one of the engine's, i.e. the task should run ir_tx_pump()
+ */
+bool ir_tx_on_done(ir_tx_t *tx);
+
+/**
+ * @brief Refill the driver queue and finish the routine when everything was sent (task)
+ */
+void ir_tx_pump(ir_tx_t *tx);
+
+/**
+ * @brief Apply a carrier for transmissions made outside the engine (task)
+ *
+ * Call with the channel idle. Goes through the same cache as the routines' steps, so the HAL is only
+ * called if the carrier differs from the one last applied.
+ *
+ * @return false if a routine is running or the HAL refused the carrier
+ */
+bool ir_tx_apply_carrier(ir_tx_t *tx, uint32_t carrier_hz, uint8_t duty_pct);
+
+/**
+ * @brief Whether a routine is running
+ */
+bool ir_tx_busy(const ir_tx_t *tx);
+
+/**
+ * @brief Fill @p step from a blob's stored repeat count and repeat gap
+ *
+ * @return false if the blob header is invalid
+ */
+bool ir_tx_step_from_slot(ir_tx_step_t *step, const uint8_t *blob, size_t len);
+
+/**
+ * @brief Read the counters (task)
+ */
+void ir_tx_get_stats(const ir_tx_t *tx, ir_tx_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,136 @@
+/*
+ * ir_capture.c — streaming assembly of long IR captures
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ir_capture.h"
+
+bool ir_capture_init(ir_capture_t *cap, const ir_capture_config_t *cfg)
+{
+    memset(cap, 0, sizeof(*cap));
+    cap->cfg = *cfg;
+
+    if (cfg->arena != NULL) {
+        cap->arena = cfg->arena;
+        cap->arena_cap = cfg->arena_symbols;
+        return true;
+    }
+
+    size_t initial = IR_CAPTURE_INITIAL_SYMBOLS;
+    if (initial > cfg->max_symbols) {
+        initial = cfg->max_symbols;
+    }
+    cap->heap = true;
+    cap->arena = malloc(initial * sizeof(rmt_symbol_word_t));
+    cap->arena_cap = cap->arena ? initial : 0;
+    return cap->arena != NULL;
+}
+
+void ir_capture_deinit(ir_capture_t *cap)
+{
+    if (cap->heap) {
+        free(cap->arena);
+    }
+    memset(cap, 0, sizeof(*cap));
+}
+
+void ir_capture_reset(ir_capture_t *cap)
+{
+    cap->used = 0;
+    cap->seg_num = 0;
+    cap->seg_open = false;
+    cap->last_end_us = 0;
+    cap->clipped_symbols = 0;
+}
+
+uint32_t ir_capture_duration_us(const ir_capture_t *cap, const rmt_symbol_word_t *symbols, size_t symbol_num)
+{
+    uint64_t ticks = 0;
+    for (size_t i = 0; i < symbol_num; i++) {
+        ticks += symbols[i].duration0 + symbols[i].duration1;
+    }
+    return (uint32_t)(ticks * 1000000u / cap->cfg.resolution_hz);
+}
+
+/**
+ * @brief Make room for @p need more symbols, doubling a heap arena up to max_symbols
+ */
+static size_t capture_reserve(ir_capture_t *cap, size_t need)
+{
+    size_t room = cap->arena_cap - cap->used;
+
+    if (room >= need || !cap->heap || cap->arena_cap >= cap->cfg.max_symbols) {
+        return room < need ? room : need;
+    }
+
+    size_t new_cap = cap->arena_cap ? cap->arena_cap : IR_CAPTURE_INITIAL_SYMBOLS;
+    while (new_cap < cap->used + need && new_cap < cap->cfg.max_symbols) {
+        new_cap *= 2;
+    }
+    if (new_cap > cap->cfg.max_symbols) {
+        new_cap = cap->cfg.max_symbols;
+    }
+
+    rmt_symbol_word_t *grown = realloc(cap->arena, new_cap * sizeof(rmt_symbol_word_t));
+    if (grown != NULL) {
+        cap->arena = grown;
+        cap->arena_cap = new_cap;
+    }
+    room = cap->arena_cap - cap->used;
+    return room < need ? room : need;
+}
+
+ir_capture_status_t ir_capture_push(ir_capture_t *cap, const rmt_symbol_word_t *chunk,
+                                    size_t symbol_num, bool last, uint32_t ts_us)
+{
+    if (!cap->seg_open) {
+        /* First chunk of a receive: back-date its first edge from the hand-over time */
+        uint32_t start_us = ts_us - (last ? cap->cfg.idle_us : 0) - ir_capture_duration_us(cap, chunk, symbol_num);
+        uint32_t gap_us = 0;
+
+        if (cap->seg_num > 0) {
+            gap_us = start_us - cap->last_end_us;
+            if ((int32_t)gap_us < 0) {
+                gap_us = 0; /* timestamp jitter on very short gaps */
+            }
+            if (gap_us >= cap->cfg.frame_gap_us) {
+                return IR_CAPTURE_NEW_FRAME;
+            }
+        }
+        if (cap->seg_num == IR_CAPTURE_MAX_SEGS) {
+            cap->clipped_symbols += (uint32_t)symbol_num;
+            return IR_CAPTURE_CLIPPED;
+        }
+
+        ir_capture_seg_t *seg = &cap->segs[cap->seg_num++];
+        seg->offset = (uint32_t)cap->used;
+        seg->symbol_num = 0;
+        seg->gap_us = gap_us;
+        cap->seg_open = true;
+    }
+
+    ir_capture_seg_t *seg = &cap->segs[cap->seg_num - 1];
+    size_t n = capture_reserve(cap, symbol_num);
+    memcpy(&cap->arena[cap->used], chunk, n * sizeof(rmt_symbol_word_t));
+    cap->used += n;
+    seg->symbol_num += (uint32_t)n;
+
+    if (last) {
+        cap->seg_open = false;
+        cap->last_end_us = ts_us - cap->cfg.idle_us;
+    }
+
+    if (n < symbol_num) {
+        cap->clipped_symbols += (uint32_t)(symbol_num - n);
+        return IR_CAPTURE_CLIPPED;
+    }
+    return IR_CAPTURE_OK;
+}
+
+bool ir_capture_is_complete(const ir_capture_t *cap, uint32_t now_us)
+{
+    return cap->seg_num > 0 && !cap->seg_open &&
+           (uint32_t)(now_us - cap->last_end_us) >= cap->cfg.frame_gap_us;
+}
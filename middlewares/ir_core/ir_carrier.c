@@ -0,0 +1,71 @@
+/*
+ * ir_carrier.c — carrier frequency and duty measurement from unfiltered edges
+ */
+
+#include <string.h>
+
+#include "ir_carrier.h"
+
+void ir_carrier_meter_init(ir_carrier_meter_t *m, uint32_t resolution_hz, uint8_t on_level)
+{
+    memset(m, 0, sizeof(*m));
+    m->resolution_hz = resolution_hz;
+    m->on_level = on_level;
+    m->min_ticks = resolution_hz / IR_CARRIER_MAX_HZ;
+    m->max_ticks = resolution_hz / IR_CARRIER_MIN_HZ;
+    if (m->min_ticks == 0) {
+        m->min_ticks = 1;
+    }
+}
+
+void ir_carrier_meter_push(ir_carrier_meter_t *m, const rmt_symbol_word_t *symbols, size_t symbol_num)
+{
+    for (size_t i = 0; i < symbol_num; i++) {
+        const rmt_symbol_word_t *s = &symbols[i];
+        /* A zero half is the end marker, a long one the gap between marks */
+        if (s->duration0 == 0 || s->duration1 == 0) {
+            continue;
+        }
+        uint32_t period = (uint32_t)s->duration0 + s->duration1;
+        if (period < m->min_ticks || period > m->max_ticks) {
+            continue;
+        }
+        if (m->periods >= IR_CARRIER_MIN_PERIODS) {
+            /* Settled: |period - mean| * 100 > mean * tol, in integers */
+            uint64_t p100 = (uint64_t)period * m->periods * 100u;
+            uint64_t mean100 = m->period_ticks * 100u;
+            uint64_t tol = m->period_ticks * IR_CARRIER_TOLERANCE_PCT;
+            if (p100 + tol < mean100 || p100 > mean100 + tol) {
+                m->rejected++;
+                continue;
+            }
+        }
+        m->period_ticks += period;
+        m->on_ticks += s->level0 == m->on_level ? s->duration0 : s->duration1;
+        m->periods++;
+    }
+}
+
+bool ir_carrier_meter_result(const ir_carrier_meter_t *m, ir_carrier_t *out)
+{
+    if (m->periods < IR_CARRIER_MIN_PERIODS || m->period_ticks == 0) {
+        return false;
+    }
+    uint64_t steps = ((uint64_t)m->resolution_hz * m->periods + m->period_ticks * IR_CARRIER_ROUND_HZ / 2) /
+                     (m->period_ticks * IR_CARRIER_ROUND_HZ);
+    uint32_t duty = (uint32_t)((m->on_ticks * 100u + m->period_ticks / 2) / m->period_ticks);
+
+    out->freq_hz = (uint32_t)steps * IR_CARRIER_ROUND_HZ;
+    out->duty_pct = (uint8_t)(duty < 1 ? 1 : duty > 99 ? 99 : duty);
+    out->periods = m->periods;
+    return true;
+}
+
+bool ir_carrier_measure(const rmt_symbol_word_t *symbols, size_t symbol_num, uint32_t resolution_hz,
+                        uint8_t on_level, ir_carrier_t *out)
+{
+    ir_carrier_meter_t m;
+    ir_carrier_meter_init(&m, resolution_hz, on_level);
+    ir_carrier_meter_push(&m, symbols, symbol_num);
+    return ir_carrier_meter_result(&m, out);
+}
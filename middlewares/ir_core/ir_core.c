@@ -0,0 +1,257 @@
+/*
+ * ir_core.c — platform-agnostic IR waveform utilities
+ *
+ * Classification is table driven: every duration is quantised into a bucket
+ * and mapped to a pulse class through ir_pulse_lut_t, and a (mark, space)
+ * class pair is mapped to a NEC symbol through s_nec_pair. Normalization and
+ * decoding are then two table reads per symbol instead of range-check chains.
+ */
+
+#include <string.h>
+
+#include "ir_core.h"
+
+/**
+ * @brief NEC symbol kinds recognised from a (mark, space) class pair
+ */
+typedef enum {
+    NEC_SYM_NONE = 0,
+    NEC_SYM_ZERO,
+    NEC_SYM_ONE,
+    NEC_SYM_LEAD,
+    NEC_SYM_REPEAT,
+    NEC_SYM__COUNT
+} nec_sym_t;
+
+/**
+ * @brief (duration0 class, duration1 class) -> NEC symbol
+ */
+static const uint8_t s_nec_pair[IR_PULSE__COUNT][IR_PULSE__COUNT] = {
+    [IR_PULSE_SHORT] = {
+        [IR_PULSE_SHORT] = NEC_SYM_ZERO,
+        [IR_PULSE_LONG]  = NEC_SYM_ONE,
+    },
+    [IR_PULSE_LEAD_MARK] = {
+        [IR_PULSE_LEAD_SPACE]   = NEC_SYM_LEAD,
+        [IR_PULSE_REPEAT_SPACE] = NEC_SYM_REPEAT,
+    },
+};
+
+/**
+ * @brief Pulse classes used as canonical (duration0, duration1) per NEC symbol
+ */
+static const uint8_t s_nec_sym_class[NEC_SYM__COUNT][2] = {
+    [NEC_SYM_ZERO]   = { IR_PULSE_SHORT,     IR_PULSE_SHORT },
+    [NEC_SYM_ONE]    = { IR_PULSE_SHORT,     IR_PULSE_LONG },
+    [NEC_SYM_LEAD]   = { IR_PULSE_LEAD_MARK, IR_PULSE_LEAD_SPACE },
+    [NEC_SYM_REPEAT] = { IR_PULSE_LEAD_MARK, IR_PULSE_REPEAT_SPACE },
+};
+
+/**
+ * @brief Canonical duration per class, in microseconds
+ */
+static const uint16_t s_class_us[IR_PULSE__COUNT] = {
+    [IR_PULSE_SHORT]        = NEC_PAYLOAD_ZERO_DURATION_0,
+    [IR_PULSE_LONG]         = NEC_PAYLOAD_ONE_DURATION_1,
+    [IR_PULSE_REPEAT_SPACE] = NEC_REPEAT_CODE_DURATION_1,
+    [IR_PULSE_LEAD_SPACE]   = NEC_LEADING_CODE_DURATION_1,
+    [IR_PULSE_LEAD_MARK]    = NEC_LEADING_CODE_DURATION_0,
+};
+
+/**
+ * @brief Classes whose captured duration survives normalization (canonical is 0)
+ */
+static const uint16_t s_class_keep_mask[IR_PULSE__COUNT] = {
+    [IR_PULSE_END]   = 0x7FFF,
+    [IR_PULSE_OTHER] = 0x7FFF,
+};
+
+static uint32_t us_to_ticks(uint32_t us, uint32_t resolution_hz)
+{
+    uint64_t ticks = (uint64_t)us * resolution_hz / 1000000u;
+    return ticks > 0x7FFFu ? 0x7FFFu : (uint32_t)ticks;
+}
+
+static ir_pulse_class_t classify_us(uint32_t us)
+{
+    /* Logic 1 space and repeat space are closer than two margins; split at the midpoint */
+    const uint32_t long_repeat_split = (NEC_PAYLOAD_ONE_DURATION_1 + NEC_REPEAT_CODE_DURATION_1) / 2;
+
+    if (us == 0) {
+        return IR_PULSE_END;
+    }
+    if (us > NEC_PAYLOAD_ZERO_DURATION_0 - IR_NEC_DECODE_MARGIN &&
+        us < NEC_PAYLOAD_ZERO_DURATION_0 + IR_NEC_DECODE_MARGIN) {
+        return IR_PULSE_SHORT;
+    }
+    if (us > NEC_PAYLOAD_ONE_DURATION_1 - IR_NEC_DECODE_MARGIN && us <= long_repeat_split) {
+        return IR_PULSE_LONG;
+    }
+    if (us > long_repeat_split && us < NEC_REPEAT_CODE_DURATION_1 + IR_NEC_DECODE_MARGIN) {
+        return IR_PULSE_REPEAT_SPACE;
+    }
+    if (us > NEC_LEADING_CODE_DURATION_1 - IR_NEC_DECODE_MARGIN &&
+        us < NEC_LEADING_CODE_DURATION_1 + IR_NEC_DECODE_MARGIN) {
+        return IR_PULSE_LEAD_SPACE;
+    }
+    if (us > NEC_LEADING_CODE_DURATION_0 - IR_NEC_DECODE_MARGIN &&
+        us < NEC_LEADING_CODE_DURATION_0 + IR_NEC_DECODE_MARGIN) {
+        return IR_PULSE_LEAD_MARK;
+    }
+    return IR_PULSE_OTHER;
+}
+
+void ir_pulse_lut_init(ir_pulse_lut_t *lut, uint32_t resolution_hz)
+{
+    memset(lut, 0, sizeof(*lut));
+    lut->resolution_hz = resolution_hz;
+
+    for (int c = 0; c < IR_PULSE__COUNT; c++) {
+        lut->canonical[c] = (uint16_t)us_to_ticks(s_class_us[c], resolution_hz);
+    }
+
+    /* Bucket 0 holds the zero-duration end marker; classify the rest by bucket centre */
+    lut->cls[0] = IR_PULSE_END;
+    for (uint32_t b = 1; b < IR_PULSE_LUT_SIZE; b++) {
+        uint64_t centre = ((uint64_t)b << IR_PULSE_LUT_SHIFT) + (1u << (IR_PULSE_LUT_SHIFT - 1));
+        uint32_t us = (uint32_t)(centre * 1000000u / resolution_hz);
+        ir_pulse_class_t c = classify_us(us);
+        lut->cls[b] = (uint8_t)(c == IR_PULSE_END ? IR_PULSE_OTHER : c);
+    }
+}
+
+/**
+ * @brief Map one symbol to its NEC symbol kind and write the normalized copy
+ *
+ * Works on the packed 32-bit word: bits 0-14 duration0, 15 level0,
+ * 16-30 duration1, 31 level1.
+ */
+static inline nec_sym_t process_symbol(const ir_pulse_lut_t *lut,
+                                       const rmt_symbol_word_t *in,
+                                       rmt_symbol_word_t *out,
+                                       uint32_t level_xor)
+{
+    uint32_t v = in->val;
+    uint32_t c0 = lut->cls[(v & 0x7FFFu) >> IR_PULSE_LUT_SHIFT];
+    uint32_t c1 = lut->cls[(v >> (16 + IR_PULSE_LUT_SHIFT)) & (IR_PULSE_LUT_SIZE - 1)];
+    nec_sym_t kind = (nec_sym_t)s_nec_pair[c0][c1];
+
+    if (kind != NEC_SYM_NONE) {
+        c0 = s_nec_sym_class[kind][0];
+        c1 = s_nec_sym_class[kind][1];
+    }
+    /* Unclassified and end-marker durations keep their captured value */
+    uint32_t keep = 0x80008000u | s_class_keep_mask[c0] | ((uint32_t)s_class_keep_mask[c1] << 16);
+    uint32_t canon = lut->canonical[c0] | ((uint32_t)lut->canonical[c1] << 16);
+    out->val = ((v & keep) | canon) ^ level_xor;
+    return kind;
+}
+
+static void process_frame(const ir_pulse_lut_t *lut,
+                          const rmt_symbol_word_t *input_frame,
+                          rmt_symbol_word_t *output_frame,
+                          size_t symbol_num,
+                          uint32_t level_xor,
+                          ir_nec_decode_t *decode)
+{
+    uint32_t bits = 0;
+    uint32_t bits_ok = 1;
+    nec_sym_t first = NEC_SYM_NONE;
+    size_t i = 0;
+
+    if (symbol_num == 0) {
+        if (decode) {
+            decode->kind = IR_NEC_DECODE_NONE;
+        }
+        return;
+    }
+
+    first = process_symbol(lut, &input_frame[0], &output_frame[0], level_xor);
+
+    /* NEC payload bits (symbols 1..32) */
+    size_t bit_end = symbol_num < 33 ? symbol_num : 33;
+    for (i = 1; i < bit_end; i++) {
+        nec_sym_t kind = process_symbol(lut, &input_frame[i], &output_frame[i], level_xor);
+        bits |= (uint32_t)(kind == NEC_SYM_ONE) << (i - 1);
+        bits_ok &= (kind == NEC_SYM_ONE) | (kind == NEC_SYM_ZERO);
+    }
+    for (; i < symbol_num; i++) {
+        process_symbol(lut, &input_frame[i], &output_frame[i], level_xor);
+    }
+
+    if (!decode) {
+        return;
+    }
+    decode->kind = IR_NEC_DECODE_NONE;
+    if (symbol_num == NEC_FRAME_SYMBOLS && first == NEC_SYM_LEAD && bits_ok) {
+        decode->kind = IR_NEC_DECODE_FRAME;
+        decode->frame.address = (uint16_t)bits;
+        decode->frame.command = (uint16_t)(bits >> 16);
+    } else if (symbol_num == NEC_REPEAT_SYMBOLS && first == NEC_SYM_REPEAT) {
+        decode->kind = IR_NEC_DECODE_REPEAT;
+    }
+}
+
+static inline nec_sym_t classify_symbol(const ir_pulse_lut_t *lut, const rmt_symbol_word_t *s)
+{
+    return (nec_sym_t)s_nec_pair[ir_pulse_classify(lut, s->duration0)][ir_pulse_classify(lut, s->duration1)];
+}
+
+bool nec_parse_frame(const ir_pulse_lut_t *lut, const rmt_symbol_word_t *rmt_nec_symbols, ir_nec_frame_t *out)
+{
+    if (classify_symbol(lut, &rmt_nec_symbols[0]) != NEC_SYM_LEAD) {
+        return false;
+    }
+    uint32_t bits = 0;
+    for (int i = 0; i < 32; i++) {
+        nec_sym_t kind = classify_symbol(lut, &rmt_nec_symbols[1 + i]);
+        if (kind != NEC_SYM_ONE && kind != NEC_SYM_ZERO) {
+            return false;
+        }
+        bits |= (uint32_t)(kind == NEC_SYM_ONE) << i;
+    }
+    if (out) {
+        out->address = (uint16_t)bits;
+        out->command = (uint16_t)(bits >> 16);
+    }
+    return true;
+}
+
+bool nec_parse_frame_repeat(const ir_pulse_lut_t *lut, const rmt_symbol_word_t *rmt_nec_symbols)
+{
+    return classify_symbol(lut, rmt_nec_symbols) == NEC_SYM_REPEAT;
+}
+
+void invert_rmt_levels(const rmt_symbol_word_t *input,
+                       rmt_symbol_word_t *output,
+                       size_t symbol_num)
+{
+    for (size_t i = 0; i < symbol_num; i++) {
+        output[i].level0 = !input[i].level0;
+        output[i].level1 = !input[i].level1;
+        output[i].duration0 = input[i].duration0;
+        output[i].duration1 = input[i].duration1;
+    }
+}
+
+void normalize_rmt_durations(const ir_pulse_lut_t *lut, rmt_symbol_word_t *frame, size_t symbol_num)
+{
+    process_frame(lut, frame, frame, symbol_num, 0, NULL);
+}
+
+void normalize_rmt_frame(const ir_pulse_lut_t *lut,
+                         const rmt_symbol_word_t *input_frame,
+                         rmt_symbol_word_t *output_frame,
+                         size_t symbol_num)
+{
+    process_frame(lut, input_frame, output_frame, symbol_num, 0x80008000u, NULL);
+}
+
+void ir_core_process_frame(const ir_pulse_lut_t *lut,
+                           const rmt_symbol_word_t *input_frame,
+                           rmt_symbol_word_t *output_frame,
+                           size_t symbol_num,
+                           ir_nec_decode_t *decode)
+{
+    process_frame(lut, input_frame, output_frame, symbol_num, 0x80008000u, decode);
+}
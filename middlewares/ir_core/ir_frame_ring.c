@@ -0,0 +1,112 @@
+/*
+ * ir_frame_ring.c — lock-free SPSC ring of RMT RX frame buffers
+ *
+ * head/tail are free-running counters; slot index is counter & (N - 1).
+ * The producer publishes with a release store of head after filling the slot,
+ * the consumer frees a slot with a release store of tail after reading it.
+ */
+
+#include <string.h>
+
+#include "ir_frame_ring.h"
+
+#define RING_MASK (IR_FRAME_RING_SLOTS - 1u)
+
+void ir_frame_ring_init(ir_frame_ring_t *ring)
+{
+    atomic_store_explicit(&ring->head, 0, memory_order_relaxed);
+    atomic_store_explicit(&ring->tail, 0, memory_order_relaxed);
+    atomic_store_explicit(&ring->overruns, 0, memory_order_relaxed);
+    atomic_store_explicit(&ring->committed, 0, memory_order_relaxed);
+    atomic_store_explicit(&ring->truncated, 0, memory_order_relaxed);
+    atomic_store_explicit(&ring->high_water, 0, memory_order_relaxed);
+    for (size_t i = 0; i < IR_FRAME_RING_SLOTS; i++) {
+        ring->slots[i].symbol_num = 0;
+        ring->slots[i].seq = 0;
+        ring->slots[i].flags = 0;
+        ring->slots[i].ts_us = 0;
+    }
+}
+
+ir_frame_slot_t *ir_frame_ring_write_slot(ir_frame_ring_t *ring)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    if ((uint32_t)(head - tail) >= IR_FRAME_RING_SLOTS) {
+        return NULL;
+    }
+    return &ring->slots[head & RING_MASK];
+}
+
+bool ir_frame_ring_commit(ir_frame_ring_t *ring, size_t symbol_num)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    uint32_t pending = head - tail;
+
+    if (pending >= IR_FRAME_RING_SLOTS) {
+        ir_frame_ring_overrun(ring);
+        return false;
+    }
+
+    /* Single producer: plain load/store pairs, relaxed, no read-modify-write needed */
+    ir_frame_slot_t *slot = &ring->slots[head & RING_MASK];
+    if (symbol_num > IR_FRAME_MAX_SYMBOLS) {
+        symbol_num = IR_FRAME_MAX_SYMBOLS;
+        atomic_store_explicit(&ring->truncated, atomic_load_explicit(&ring->truncated, memory_order_relaxed) + 1,
+                              memory_order_relaxed);
+    }
+    uint32_t committed = atomic_load_explicit(&ring->committed, memory_order_relaxed);
+    slot->symbol_num = symbol_num;
+    slot->seq = committed + atomic_load_explicit(&ring->overruns, memory_order_relaxed);
+    atomic_store_explicit(&ring->committed, committed + 1, memory_order_relaxed);
+    if (pending + 1 > atomic_load_explicit(&ring->high_water, memory_order_relaxed)) {
+        atomic_store_explicit(&ring->high_water, pending + 1, memory_order_relaxed);
+    }
+
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return true;
+}
+
+void ir_frame_ring_overrun(ir_frame_ring_t *ring)
+{
+    atomic_fetch_add_explicit(&ring->overruns, 1, memory_order_relaxed);
+}
+
+ir_frame_slot_t *ir_frame_ring_peek(ir_frame_ring_t *ring)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    if (head == tail) {
+        return NULL;
+    }
+    return &ring->slots[tail & RING_MASK];
+}
+
+void ir_frame_ring_release(ir_frame_ring_t *ring)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    if (head != tail) {
+        atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    }
+}
+
+size_t ir_frame_ring_count(const ir_frame_ring_t *ring)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    return (size_t)(uint32_t)(head - tail);
+}
+
+void ir_frame_ring_get_stats(const ir_frame_ring_t *ring, ir_frame_ring_stats_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    out->committed = atomic_load_explicit(&ring->committed, memory_order_relaxed);
+    out->overruns = atomic_load_explicit(&ring->overruns, memory_order_relaxed);
+    out->truncated = atomic_load_explicit(&ring->truncated, memory_order_relaxed);
+    out->high_water = atomic_load_explicit(&ring->high_water, memory_order_relaxed);
+}
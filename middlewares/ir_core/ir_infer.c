@@ -0,0 +1,252 @@
+/*
+ * ir_infer.c — per-capture timing inference for unknown remotes
+ */
+
+#include <string.h>
+
+#include "ir_infer.h"
+
+/**
+ * @brief Histogram buckets: 1..7 exact, then 8 per octave up to 0x7FFF
+ */
+#define IR_INFER_BUCKETS (8 + 12 * 8)
+
+/* Pair table index of a zero (end marker) space */
+#define SPACE_END IR_INFER_MAX_CLUSTERS
+
+/* Shortest bit run reported as a pulse-distance frame */
+#define IR_INFER_MIN_BITS 8
+
+static const char *const s_inferred_name = "inferred";
+
+/* =========================
+ * Clustering
+ * ========================= */
+static unsigned bucket_of(uint32_t d)
+{
+    if (d < 8) {
+        return d;
+    }
+    unsigned msb = 31u - (unsigned)__builtin_clz(d);
+    return 8u + (msb - 3u) * 8u + ((d >> (msb - 3u)) & 7u);
+}
+
+static unsigned nearest(const ir_infer_clusters_t *c, uint32_t d)
+{
+    unsigned k = 0;
+    while (k + 1 < c->num && 2 * d > (uint32_t)c->centre[k] + c->centre[k + 1]) {
+        k++;
+    }
+    return k;
+}
+
+static void cluster_durations(const rmt_symbol_word_t *symbols, size_t symbol_num, bool space,
+                              ir_infer_clusters_t *out)
+{
+    uint16_t count[IR_INFER_BUCKETS] = {0};
+    uint32_t sum[IR_INFER_BUCKETS] = {0};
+
+    for (size_t i = 0; i < symbol_num; i++) {
+        uint32_t d = space ? symbols[i].duration1 : symbols[i].duration0;
+        unsigned b = bucket_of(d);
+        if (d != 0 && count[b] < UINT16_MAX) {
+            count[b]++;
+            sum[b] += d;
+        }
+    }
+
+    /* Natural breaks: a new cluster where a bucket lies well above the current mean */
+    uint32_t c_sum = 0, c_cnt = 0;
+    memset(out, 0, sizeof(*out));
+    for (unsigned b = 0; b < IR_INFER_BUCKETS; b++) {
+        if (count[b] == 0) {
+            continue;
+        }
+        uint32_t mean_b = sum[b] / count[b];
+        if (c_cnt && out->num + 1 < IR_INFER_MAX_CLUSTERS &&
+                mean_b * 100u > c_sum / c_cnt * (100u + IR_INFER_BREAK_PCT)) {
+            out->centre[out->num++] = (uint16_t)(c_sum / c_cnt);
+            c_sum = c_cnt = 0;
+        }
+        c_sum += sum[b];
+        c_cnt += count[b];
+    }
+    if (c_cnt == 0) {
+        return;
+    }
+    out->centre[out->num++] = (uint16_t)(c_sum / c_cnt);
+
+    /* Lloyd refinement over the bucket centroids */
+    for (unsigned it = 0; it < IR_INFER_MAX_ITER; it++) {
+        uint32_t k_sum[IR_INFER_MAX_CLUSTERS] = {0};
+        uint32_t k_cnt[IR_INFER_MAX_CLUSTERS] = {0};
+        bool moved = false;
+
+        for (unsigned b = 0; b < IR_INFER_BUCKETS; b++) {
+            if (count[b]) {
+                unsigned k = nearest(out, sum[b] / count[b]);
+                k_sum[k] += sum[b];
+                k_cnt[k] += count[b];
+            }
+        }
+        unsigned n = 0;
+        for (unsigned k = 0; k < out->num; k++) {
+            if (k_cnt[k] == 0) {
+                moved = true; /* emptied, drop it */
+                continue;
+            }
+            uint16_t c = (uint16_t)(k_sum[k] / k_cnt[k]);
+            moved |= c != out->centre[k] || n != k;
+            out->centre[n] = c;
+            out->count[n] = (uint16_t)(k_cnt[k] > UINT16_MAX ? UINT16_MAX : k_cnt[k]);
+            n++;
+        }
+        out->num = (uint8_t)n;
+        if (!moved) {
+            break;
+        }
+    }
+}
+
+/* =========================
+ * Protocol shape
+ * ========================= */
+static uint16_t ticks_to_us(uint32_t ticks, uint32_t resolution_hz)
+{
+    uint64_t us = ((uint64_t)ticks * 1000000u + resolution_hz / 2) / resolution_hz;
+    return us > UINT16_MAX ? UINT16_MAX : (uint16_t)us;
+}
+
+static unsigned pair_of(const ir_infer_template_t *tpl, const rmt_symbol_word_t *s)
+{
+    unsigned m = nearest(&tpl->marks, s->duration0);
+    unsigned sp = s->duration1 ? nearest(&tpl->spaces, s->duration1) : SPACE_END;
+    return m * (IR_INFER_MAX_CLUSTERS + 1) + sp;
+}
+
+static ir_pd_pulse_t pair_pulse(const ir_infer_template_t *tpl, unsigned pair)
+{
+    unsigned m = pair / (IR_INFER_MAX_CLUSTERS + 1);
+    unsigned sp = pair % (IR_INFER_MAX_CLUSTERS + 1);
+    ir_pd_pulse_t p = {
+        .mark_us = ticks_to_us(tpl->marks.centre[m], tpl->resolution_hz),
+        .space_us = sp == SPACE_END ? 0 : ticks_to_us(tpl->spaces.centre[sp], tpl->resolution_hz),
+    };
+    return p;
+}
+
+static void infer_pd(const rmt_symbol_word_t *symbols, size_t symbol_num, ir_infer_template_t *tpl,
+                     uint8_t *bits, size_t bits_cap)
+{
+    uint16_t pairs[IR_INFER_MAX_CLUSTERS * (IR_INFER_MAX_CLUSTERS + 1)] = {0};
+    const unsigned pair_num = sizeof(pairs) / sizeof(pairs[0]);
+    const unsigned stride = IR_INFER_MAX_CLUSTERS + 1;
+
+    if (symbol_num < 3) {
+        return;
+    }
+    /* The two most common symbols between the first and the last are the bits */
+    for (size_t i = 1; i + 1 < symbol_num; i++) {
+        unsigned p = pair_of(tpl, &symbols[i]);
+        if (pairs[p] < UINT16_MAX) {
+            pairs[p]++;
+        }
+    }
+    unsigned a = pair_num, b = pair_num;
+    uint16_t count_a = 0, count_b = 0;
+    for (unsigned p = 0; p < pair_num; p++) {
+        if (pairs[p] > count_a) {
+            b = a;
+            count_b = count_a;
+            a = p;
+            count_a = pairs[p];
+        } else if (pairs[p] > count_b) {
+            b = p;
+            count_b = pairs[p];
+        }
+    }
+    if (count_b == 0 || (size_t)count_a + count_b != symbol_num - 2 ||
+            a % stride == SPACE_END || b % stride == SPACE_END) {
+        return;
+    }
+
+    /*
+     * The last symbol is a trailing mark, unless it is a bit: either a bit
+     * symbol, or a pulse-width bit whose space is the end marker or gap.
+     */
+    unsigned last = pair_of(tpl, &symbols[symbol_num - 1]);
+    bool pulse_width = a / stride != b / stride;
+    bool trailer = last != a && last != b && !(pulse_width && (last / stride == a / stride || last / stride == b / stride));
+    size_t end = trailer ? symbol_num - 1 : symbol_num;
+
+    unsigned first = pair_of(tpl, &symbols[0]);
+    size_t start = (first == a || first == b) ? 0 : 1;
+    size_t bit_num = end - start;
+    if (bit_num < IR_INFER_MIN_BITS || bit_num > IR_PD_MAX_BYTES * 8u || (bits && bit_num > bits_cap * 8u)) {
+        return;
+    }
+
+    ir_pd_pulse_t pa = pair_pulse(tpl, a), pb = pair_pulse(tpl, b);
+    bool a_is_zero = (uint32_t)pa.mark_us + pa.space_us <= (uint32_t)pb.mark_us + pb.space_us;
+    unsigned one_mark = (a_is_zero ? b : a) / stride;
+    unsigned one = a_is_zero ? b : a;
+
+    memset(&tpl->desc, 0, sizeof(tpl->desc));
+    tpl->desc.name = s_inferred_name;
+    tpl->desc.zero = a_is_zero ? pa : pb;
+    tpl->desc.one = a_is_zero ? pb : pa;
+    if (start) {
+        tpl->desc.leader = pair_pulse(tpl, first);
+    }
+    if (trailer) {
+        tpl->desc.trailer = pair_pulse(tpl, last);
+    }
+    tpl->desc.byte_num = (uint8_t)((bit_num + 7) / 8);
+    tpl->bit_num = (uint16_t)bit_num;
+    tpl->pd = true;
+
+    if (bits) {
+        memset(bits, 0, tpl->desc.byte_num);
+        for (size_t i = 0; i < bit_num; i++) {
+            unsigned p = pair_of(tpl, &symbols[start + i]);
+            if (p == one || (pulse_width && p / stride == one_mark)) {
+                bits[i / 8] |= (uint8_t)(1u << (i % 8));
+            }
+        }
+    }
+}
+
+/* =========================
+ * Public API
+ * ========================= */
+bool ir_infer(const rmt_symbol_word_t *symbols, size_t symbol_num, uint32_t resolution_hz,
+              ir_infer_template_t *tpl, uint8_t *bits, size_t bits_cap)
+{
+    memset(tpl, 0, sizeof(*tpl));
+    tpl->resolution_hz = resolution_hz;
+    if (symbol_num == 0 || resolution_hz == 0) {
+        return false;
+    }
+    cluster_durations(symbols, symbol_num, false, &tpl->marks);
+    cluster_durations(symbols, symbol_num, true, &tpl->spaces);
+    if (tpl->marks.num == 0) {
+        return false;
+    }
+    infer_pd(symbols, symbol_num, tpl, bits, bits_cap);
+    return true;
+}
+
+void ir_infer_normalize(const ir_infer_template_t *tpl, const rmt_symbol_word_t *input,
+                        rmt_symbol_word_t *output, size_t symbol_num)
+{
+    for (size_t i = 0; i < symbol_num; i++) {
+        rmt_symbol_word_t s = input[i];
+        if (s.duration0 && tpl->marks.num) {
+            s.duration0 = tpl->marks.centre[nearest(&tpl->marks, s.duration0)];
+        }
+        if (s.duration1 && tpl->spaces.num) {
+            s.duration1 = tpl->spaces.centre[nearest(&tpl->spaces, s.duration1)];
+        }
+        output[i] = s;
+    }
+}
@@ -0,0 +1,277 @@
+/*
+ * ir_learn.c — consensus learning from repeated presses of one button
+ */
+
+#include <string.h>
+
+#include "ir_learn.h"
+
+/* Aligned presses of one consensus sub-frame */
+typedef struct {
+    uint32_t symbol_num;
+    uint8_t members;     /* bit p: press p has the sub-frame with symbol_num symbols */
+    uint8_t present;     /* bit p: press p has the sub-frame at all */
+} learn_seg_t;
+
+/* =========================
+ * Helpers
+ * ========================= */
+static uint32_t median(uint32_t *v, unsigned n)
+{
+    for (unsigned i = 1; i < n; i++) {
+        uint32_t x = v[i];
+        unsigned j = i;
+        while (j > 0 && v[j - 1] > x) {
+            v[j] = v[j - 1];
+            j--;
+        }
+        v[j] = x;
+    }
+    return n % 2 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2] + 1) / 2;
+}
+
+static bool within(uint32_t d, uint32_t ref, uint32_t tol_pct, uint32_t min_tol)
+{
+    if (d == 0 || ref == 0) {
+        return d == ref; /* end markers only match end markers */
+    }
+    uint32_t tol = ref * tol_pct / 100u;
+    if (tol < min_tol) {
+        tol = min_tol;
+    }
+    return (d > ref ? d - ref : ref - d) <= tol;
+}
+
+static const rmt_symbol_word_t *press_seg(const ir_learn_t *l, unsigned p, unsigned k)
+{
+    const ir_learn_press_t *pr = &l->presses[p];
+    return &l->cfg.arena[pr->offset + pr->segs[k].offset];
+}
+
+/* =========================
+ * Consensus steps
+ * ========================= */
+static uint8_t find_shape(const ir_learn_t *l, learn_seg_t *shape)
+{
+    uint8_t seg_num = 0;
+
+    for (unsigned k = 0; k < IR_CAPTURE_MAX_SEGS; k++) {
+        learn_seg_t best = {0};
+        uint8_t present = 0;
+        for (unsigned p = 0; p < l->press_num; p++) {
+            if (k >= l->presses[p].seg_num) {
+                continue;
+            }
+            present |= (uint8_t)(1u << p);
+            uint32_t n = l->presses[p].segs[k].symbol_num;
+            uint8_t same = 0;
+            for (unsigned q = 0; q < l->press_num; q++) {
+                if (k < l->presses[q].seg_num && l->presses[q].segs[k].symbol_num == n) {
+                    same |= (uint8_t)(1u << q);
+                }
+            }
+            if (__builtin_popcount(same) > __builtin_popcount(best.members)) {
+                best.symbol_num = n;
+                best.members = same;
+            }
+        }
+        /* A majority of all presses, not only of those that reach this far */
+        if ((unsigned)__builtin_popcount(best.members) * 2 <= l->press_num) {
+            break;
+        }
+        best.present = present;
+        shape[seg_num++] = best;
+    }
+    return seg_num;
+}
+
+static void merge_segment(const ir_learn_t *l, unsigned k, const learn_seg_t *seg,
+                          rmt_symbol_word_t *out, uint32_t *gap_us)
+{
+    uint32_t v0[IR_LEARN_MAX_PRESSES], v1[IR_LEARN_MAX_PRESSES], vg[IR_LEARN_MAX_PRESSES];
+    const rmt_symbol_word_t *src[IR_LEARN_MAX_PRESSES];
+    unsigned n = 0;
+
+    for (unsigned p = 0; p < l->press_num; p++) {
+        if (seg->members & (1u << p)) {
+            src[n] = press_seg(l, p, k);
+            vg[n] = l->presses[p].segs[k].gap_us;
+            n++;
+        }
+    }
+    *gap_us = k == 0 ? 0 : median(vg, n);
+    for (uint32_t i = 0; i < seg->symbol_num; i++) {
+        for (unsigned m = 0; m < n; m++) {
+            v0[m] = src[m][i].duration0;
+            v1[m] = src[m][i].duration1;
+        }
+        out[i] = src[0][i];
+        out[i].duration0 = median(v0, n);
+        out[i].duration1 = median(v1, n);
+    }
+}
+
+/* Durations of press p's sub-frame k within tolerance of the consensus, and how many were compared */
+static uint32_t count_matches(const ir_learn_t *l, unsigned p, unsigned k, const learn_seg_t *seg,
+                              const rmt_symbol_word_t *cons, uint32_t cons_gap, uint32_t *compared)
+{
+    const rmt_symbol_word_t *s = press_seg(l, p, k);
+    uint32_t tol_pct = l->cfg.tolerance_pct;
+    uint32_t min_ticks = (uint32_t)((uint64_t)IR_LEARN_TOLERANCE_MIN_US * l->cfg.resolution_hz / 1000000u);
+    uint32_t matched = 0;
+
+    *compared = 0;
+    for (uint32_t i = 0; i < seg->symbol_num; i++) {
+        if (cons[i].duration0) {
+            (*compared)++;
+            matched += within(s[i].duration0, cons[i].duration0, tol_pct, min_ticks);
+        }
+        if (cons[i].duration1) {
+            (*compared)++;
+            matched += within(s[i].duration1, cons[i].duration1, tol_pct, min_ticks);
+        }
+    }
+    if (k > 0) {
+        (*compared)++;
+        matched += within(l->presses[p].segs[k].gap_us, cons_gap, tol_pct, IR_LEARN_TOLERANCE_MIN_US);
+    }
+    return matched;
+}
+
+static void merge_all(const ir_learn_t *l, const learn_seg_t *shape, uint8_t seg_num,
+                      rmt_symbol_word_t *out, ir_learn_result_t *res)
+{
+    size_t off = 0;
+    for (unsigned k = 0; k < seg_num; k++) {
+        res->segs[k].offset = (uint32_t)off;
+        res->segs[k].symbol_num = shape[k].symbol_num;
+        merge_segment(l, k, &shape[k], &out[off], &res->segs[k].gap_us);
+        off += shape[k].symbol_num;
+    }
+    res->seg_num = seg_num;
+    res->symbol_num = off;
+}
+
+/* =========================
+ * Public API
+ * ========================= */
+ir_learn_err_t ir_learn_init(ir_learn_t *l, const ir_learn_config_t *cfg)
+{
+    if (l == NULL || cfg == NULL || cfg->arena == NULL || cfg->arena_symbols == 0 || cfg->resolution_hz == 0) {
+        return IR_LEARN_ERR_ARG;
+    }
+    memset(l, 0, sizeof(*l));
+    l->cfg = *cfg;
+    if (l->cfg.tolerance_pct == 0) {
+        l->cfg.tolerance_pct = IR_LEARN_TOLERANCE_PCT;
+    }
+    return IR_LEARN_OK;
+}
+
+void ir_learn_reset(ir_learn_t *l)
+{
+    l->used = 0;
+    l->press_num = 0;
+}
+
+ir_learn_err_t ir_learn_add(ir_learn_t *l, const rmt_symbol_word_t *symbols, size_t symbol_num,
+                            const ir_capture_seg_t *segs, size_t seg_num)
+{
+    if (symbols == NULL || symbol_num == 0 || (segs != NULL && (seg_num == 0 || seg_num > IR_CAPTURE_MAX_SEGS))) {
+        return IR_LEARN_ERR_ARG;
+    }
+    if (l->press_num == IR_LEARN_MAX_PRESSES || symbol_num > l->cfg.arena_symbols - l->used) {
+        return IR_LEARN_ERR_NO_SPACE;
+    }
+    ir_learn_press_t *pr = &l->presses[l->press_num];
+    if (segs == NULL) {
+        pr->segs[0] = (ir_capture_seg_t){ .offset = 0, .symbol_num = (uint32_t)symbol_num, .gap_us = 0 };
+        pr->seg_num = 1;
+    } else {
+        for (size_t k = 0; k < seg_num; k++) {
+            if (segs[k].offset + segs[k].symbol_num > symbol_num) {
+                return IR_LEARN_ERR_ARG;
+            }
+            pr->segs[k] = segs[k];
+        }
+        pr->seg_num = (uint8_t)seg_num;
+    }
+    pr->offset = (uint32_t)l->used;
+    pr->symbol_num = (uint32_t)symbol_num;
+    memcpy(&l->cfg.arena[l->used], symbols, symbol_num * sizeof(rmt_symbol_word_t));
+    l->used += symbol_num;
+    l->press_num++;
+    return IR_LEARN_OK;
+}
+
+ir_learn_err_t ir_learn_consensus(const ir_learn_t *l, rmt_symbol_word_t *out, size_t out_cap,
+                                  ir_learn_result_t *res)
+{
+    learn_seg_t shape[IR_CAPTURE_MAX_SEGS];
+
+    if (out == NULL || res == NULL) {
+        return IR_LEARN_ERR_ARG;
+    }
+    memset(res, 0, sizeof(*res));
+    res->presses = l->press_num;
+    uint8_t seg_num = l->press_num ? find_shape(l, shape) : 0;
+    if (seg_num == 0) {
+        return IR_LEARN_ERR_NO_CONSENSUS;
+    }
+    size_t total = 0;
+    for (unsigned k = 0; k < seg_num; k++) {
+        total += shape[k].symbol_num;
+    }
+    if (total > out_cap) {
+        return IR_LEARN_ERR_NO_SPACE;
+    }
+    merge_all(l, shape, seg_num, out, res);
+
+    /* Drop presses that disagree with the medians, then merge again without them */
+    uint8_t rejected = 0;
+    for (unsigned p = 0; p < l->press_num; p++) {
+        uint32_t matched = 0, compared = 0;
+        for (unsigned k = 0; k < seg_num; k++) {
+            if (shape[k].members & (1u << p)) {
+                uint32_t c;
+                matched += count_matches(l, p, k, &shape[k], &out[res->segs[k].offset], res->segs[k].gap_us, &c);
+                compared += c;
+            }
+        }
+        if (compared > 0 && (compared - matched) * 100u > compared * IR_LEARN_MAX_MISMATCH_PCT) {
+            rejected |= (uint8_t)(1u << p);
+        }
+    }
+    if (rejected) {
+        for (unsigned k = 0; k < seg_num; k++) {
+            shape[k].members &= (uint8_t)~rejected;
+            if (shape[k].members == 0) {
+                return IR_LEARN_ERR_NO_CONSENSUS; /* the median agreed with nobody */
+            }
+        }
+        merge_all(l, shape, seg_num, out, res);
+    }
+
+    /* Confidence over every press that reached each sub-frame, aligned or not */
+    uint64_t matched = 0, compared = 0;
+    uint8_t used = 0;
+    for (unsigned k = 0; k < seg_num; k++) {
+        const rmt_symbol_word_t *cons = &out[res->segs[k].offset];
+        uint32_t durations;
+        count_matches(l, (unsigned)__builtin_ctz(shape[k].members), k, &shape[k], cons, res->segs[k].gap_us, &durations);
+        for (unsigned p = 0; p < l->press_num; p++) {
+            uint32_t c;
+            if (shape[k].members & (1u << p)) {
+                matched += count_matches(l, p, k, &shape[k], cons, res->segs[k].gap_us, &c);
+                used |= (uint8_t)(1u << p);
+            }
+            if (shape[k].present & (1u << p)) {
+                compared += durations; /* misaligned and dropped presses count as all wrong */
+            }
+        }
+    }
+    res->used = (uint8_t)__builtin_popcount(used);
+    res->rejected_mask = rejected;
+    res->confidence_pct = compared ? (uint8_t)((matched * 100u) / compared) : 0;
+    return IR_LEARN_OK;
+}
@@ -0,0 +1,189 @@
+/*
+ * ir_pd.c — descriptor-driven pulse-distance / pulse-width IR protocols
+ */
+
+#include <string.h>
+
+#include "ir_pd.h"
+
+/* =========================
+ * Presets
+ * ========================= */
+const ir_pd_desc_t ir_pd_nec = {
+    .name = "nec",
+    .leader = { 9000, 4500 }, .zero = { 560, 560 }, .one = { 560, 1690 }, .trailer = { 560, 0 },
+    .byte_num = 4,
+};
+
+const ir_pd_desc_t ir_pd_samsung = {
+    .name = "samsung",
+    .leader = { 4480, 4480 }, .zero = { 560, 560 }, .one = { 560, 1680 }, .trailer = { 560, 0 },
+    .byte_num = 4,
+};
+
+const ir_pd_desc_t ir_pd_coolix = {
+    .name = "coolix",
+    .leader = { 4692, 4416 }, .zero = { 552, 552 }, .one = { 552, 1656 }, .trailer = { 552, 0 },
+    .byte_num = 6, .msb_first = true,
+};
+
+const ir_pd_desc_t ir_pd_toshiba_ac = {
+    .name = "toshiba_ac",
+    .leader = { 4400, 4300 }, .zero = { 580, 490 }, .one = { 580, 1600 }, .trailer = { 580, 0 },
+    .byte_num = 9, .msb_first = true,
+};
+
+const ir_pd_desc_t ir_pd_mitsubishi_ac = {
+    .name = "mitsubishi_ac",
+    .leader = { 3400, 1750 }, .zero = { 450, 420 }, .one = { 450, 1300 }, .trailer = { 440, 0 },
+    .byte_num = 18,
+};
+
+const ir_pd_desc_t ir_pd_daikin = {
+    .name = "daikin",
+    .leader = { 3650, 1623 }, .zero = { 428, 428 }, .one = { 428, 1280 }, .trailer = { 428, 0 },
+    .byte_num = 0,
+};
+
+const ir_pd_desc_t *const ir_pd_presets[] = {
+    &ir_pd_nec,
+    &ir_pd_samsung,
+    &ir_pd_coolix,
+    &ir_pd_toshiba_ac,
+    &ir_pd_mitsubishi_ac,
+    &ir_pd_daikin,
+};
+
+const size_t ir_pd_preset_num = sizeof(ir_pd_presets) / sizeof(ir_pd_presets[0]);
+
+/* =========================
+ * Helpers
+ * ========================= */
+static uint32_t us_to_ticks(uint32_t us, uint32_t resolution_hz)
+{
+    uint64_t ticks = (uint64_t)us * resolution_hz / 1000000u;
+    return ticks > 0x7FFFu ? 0x7FFFu : (uint32_t)ticks;
+}
+
+static rmt_symbol_word_t pulse_symbol(const ir_pd_pulse_t *p, uint32_t resolution_hz)
+{
+    rmt_symbol_word_t s = {
+        .level0 = 1, .duration0 = us_to_ticks(p->mark_us, resolution_hz),
+        .level1 = 0, .duration1 = us_to_ticks(p->space_us, resolution_hz),
+    };
+    return s;
+}
+
+/* Distance of a captured duration from its reference, or UINT32_MAX if outside the tolerance */
+static uint32_t match_err(uint32_t ticks, uint32_t ref_us, uint32_t resolution_hz)
+{
+    uint32_t ref = us_to_ticks(ref_us, resolution_hz);
+    uint32_t tol = ref * IR_PD_TOLERANCE_PCT / 100u;
+    uint32_t tol_min = us_to_ticks(IR_PD_TOLERANCE_MIN_US, resolution_hz);
+    uint32_t err = ticks > ref ? ticks - ref : ref - ticks;
+
+    if (tol < tol_min) {
+        tol = tol_min;
+    }
+    return err <= tol ? err : UINT32_MAX;
+}
+
+static uint32_t pulse_err(const rmt_symbol_word_t *s, const ir_pd_pulse_t *p, uint32_t resolution_hz)
+{
+    uint32_t e0 = match_err(s->duration0, p->mark_us, resolution_hz);
+    uint32_t e1 = match_err(s->duration1, p->space_us, resolution_hz);
+    return (e0 == UINT32_MAX || e1 == UINT32_MAX) ? UINT32_MAX : e0 + e1;
+}
+
+/* =========================
+ * Public API
+ * ========================= */
+void ir_pd_symbols(const ir_pd_desc_t *desc, uint32_t resolution_hz, ir_pd_symbols_t *out)
+{
+    out->leader = pulse_symbol(&desc->leader, resolution_hz);
+    out->zero = pulse_symbol(&desc->zero, resolution_hz);
+    out->one = pulse_symbol(&desc->one, resolution_hz);
+    out->trailer = pulse_symbol(&desc->trailer, resolution_hz);
+}
+
+size_t ir_pd_symbol_count(const ir_pd_desc_t *desc, size_t byte_num)
+{
+    return (desc->leader.mark_us ? 1 : 0) + byte_num * 8 + (desc->trailer.mark_us ? 1 : 0);
+}
+
+size_t ir_pd_expand(const ir_pd_desc_t *desc, uint32_t resolution_hz, const uint8_t *data, size_t byte_num,
+                    rmt_symbol_word_t *out, size_t cap)
+{
+    ir_pd_symbols_t sym;
+    size_t n = 0;
+
+    if (ir_pd_symbol_count(desc, byte_num) > cap) {
+        return 0;
+    }
+    ir_pd_symbols(desc, resolution_hz, &sym);
+    if (desc->leader.mark_us) {
+        out[n++] = sym.leader;
+    }
+    for (size_t i = 0; i < byte_num; i++) {
+        for (int b = 0; b < 8; b++) {
+            int shift = desc->msb_first ? 7 - b : b;
+            out[n++] = (data[i] >> shift) & 1u ? sym.one : sym.zero;
+        }
+    }
+    if (desc->trailer.mark_us) {
+        out[n++] = sym.trailer;
+    }
+    return n;
+}
+
+bool ir_pd_decode(const ir_pd_desc_t *desc, uint32_t resolution_hz, const rmt_symbol_word_t *symbols,
+                  size_t symbol_num, uint8_t *out, size_t cap, size_t *byte_num)
+{
+    size_t pos = 0;
+    size_t end = symbol_num;
+
+    if (desc->leader.mark_us) {
+        if (symbol_num == 0 || pulse_err(&symbols[0], &desc->leader, resolution_hz) == UINT32_MAX) {
+            return false;
+        }
+        pos = 1;
+    }
+    if (desc->trailer.mark_us) {
+        if (end <= pos || match_err(symbols[end - 1].duration0, desc->trailer.mark_us, resolution_hz) == UINT32_MAX) {
+            return false;
+        }
+        end--;
+    }
+
+    size_t bits = end - pos;
+    size_t n = bits / 8;
+    if (bits == 0 || bits % 8 != 0 || n > cap || (desc->byte_num && n != desc->byte_num)) {
+        return false;
+    }
+
+    memset(out, 0, n);
+    for (size_t i = 0; i < bits; i++) {
+        const rmt_symbol_word_t *s = &symbols[pos + i];
+        uint32_t e0 = pulse_err(s, &desc->zero, resolution_hz);
+        uint32_t e1 = pulse_err(s, &desc->one, resolution_hz);
+        if (e0 == UINT32_MAX && e1 == UINT32_MAX) {
+            return false;
+        }
+        if (e1 < e0) {
+            out[i / 8] |= (uint8_t)(desc->msb_first ? 0x80u >> (i % 8) : 1u << (i % 8));
+        }
+    }
+    *byte_num = n;
+    return true;
+}
+
+const ir_pd_desc_t *ir_pd_identify(uint32_t resolution_hz, const rmt_symbol_word_t *symbols, size_t symbol_num,
+                                   uint8_t *out, size_t cap, size_t *byte_num)
+{
+    for (size_t i = 0; i < ir_pd_preset_num; i++) {
+        if (ir_pd_decode(ir_pd_presets[i], resolution_hz, symbols, symbol_num, out, cap, byte_num)) {
+            return ir_pd_presets[i];
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,92 @@
+/*
+ * ir_rx.c — continuous N-buffer IR receive on top of ir_frame_ring
+ *
+ * Arming can race between the RX-done ISR (slot just committed) and the task
+ * (slot just released). `armed` is claimed with a CAS so only one side starts
+ * the receive; a side that finds no free slot clears the flag and re-checks,
+ * since a concurrent release may have happened after its check but before the
+ * releasing side could see the flag cleared.
+ */
+
+#include <string.h>
+
+#include "ir_rx.h"
+
+static void rx_try_arm(ir_rx_t *rx)
+{
+    for (;;) {
+        bool expected = false;
+
+        atomic_thread_fence(memory_order_seq_cst);
+        if (!atomic_compare_exchange_strong(&rx->armed, &expected, true)) {
+            return; /* already receiving */
+        }
+
+        ir_frame_slot_t *slot = ir_frame_ring_write_slot(&rx->ring);
+        if (slot != NULL) {
+            if (!rx->hal.ops->arm(rx->hal.ctx, slot->symbols, IR_FRAME_MAX_SYMBOLS)) {
+                atomic_fetch_add(&rx->arm_errors, 1);
+                atomic_store(&rx->armed, false);
+            }
+            return;
+        }
+
+        atomic_store(&rx->armed, false);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (ir_frame_ring_write_slot(&rx->ring) == NULL) {
+            return; /* the next release re-arms */
+        }
+    }
+}
+
+bool ir_rx_start(ir_rx_t *rx, const ir_hal_rx_t *hal)
+{
+    ir_frame_ring_init(&rx->ring);
+    rx->hal = *hal;
+    atomic_store(&rx->armed, false);
+    atomic_store(&rx->stalls, 0);
+    atomic_store(&rx->arm_errors, 0);
+
+    rx_try_arm(rx);
+    return atomic_load(&rx->armed);
+}
+
+bool ir_rx_on_done(ir_rx_t *rx, size_t symbol_num)
+{
+    ir_frame_slot_t *slot = ir_frame_ring_write_slot(&rx->ring);
+    if (slot != NULL) {
+        slot->flags = IR_FRAME_F_LAST;
+    }
+    bool committed = ir_frame_ring_commit(&rx->ring, symbol_num);
+
+    atomic_store(&rx->armed, false);
+    rx_try_arm(rx);
+    if (!atomic_load(&rx->armed)) {
+        atomic_fetch_add(&rx->stalls, 1);
+    }
+    return committed;
+}
+
+ir_frame_slot_t *ir_rx_peek(ir_rx_t *rx)
+{
+    return ir_frame_ring_peek(&rx->ring);
+}
+
+void ir_rx_release(ir_rx_t *rx)
+{
+    ir_frame_ring_release(&rx->ring);
+    rx_try_arm(rx); /* no-op unless the ISR found the ring full */
+}
+
+bool ir_rx_is_armed(const ir_rx_t *rx)
+{
+    return atomic_load(&rx->armed);
+}
+
+void ir_rx_get_stats(const ir_rx_t *rx, ir_rx_stats_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    ir_frame_ring_get_stats(&rx->ring, &out->ring);
+    out->stalls = atomic_load(&rx->stalls);
+    out->arm_errors = atomic_load(&rx->arm_errors);
+}
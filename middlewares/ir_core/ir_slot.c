@@ -0,0 +1,648 @@
+/*
+ * ir_slot.c — compact IR slot blob (header + waveform) for persistent storage
+ *
+ * Encoding runs in three passes over the waveform: build the duration
+ * dictionary (greedy clustering within tolerance_pct), find sub-frames that
+ * repeat an earlier one, then write the index stream with run-length
+ * escapes. Decoding is a cursor over the stream so the TX path can pull
+ * symbols in RMT-sized pieces without expanding the whole slot.
+ */
+
+#include <string.h>
+
+#include "ir_slot.h"
+
+#define SLOT_MAGIC0 'I'
+#define SLOT_MAGIC1 'R'
+
+/* Header field offsets */
+#define H_MAGIC       0
+#define H_VERSION     2
+#define H_FLAGS       3
+#define H_PAYLOAD_LEN 4
+#define H_CRC         6
+#define H_CARRIER     8
+#define H_DUTY        12
+#define H_REPEAT      13
+#define H_RESERVED    14
+#define H_REPEAT_GAP  16
+#define H_SYMBOL_NUM  20
+#define H_SEG_NUM     22
+#define H_DICT_NUM    23
+
+/* =========================
+ * Byte / bit helpers
+ * ========================= */
+typedef struct {
+    uint8_t *out;
+    size_t cap;
+    size_t pos;       /*!< Bytes written (or needed) */
+    uint32_t acc;     /*!< Bit accumulator */
+    uint8_t acc_bits;
+} slot_writer_t;
+
+static void put_u8(slot_writer_t *w, uint8_t v)
+{
+    if (w->pos < w->cap) {
+        w->out[w->pos] = v;
+    }
+    w->pos++;
+}
+
+static void put_u16(slot_writer_t *w, uint16_t v)
+{
+    put_u8(w, (uint8_t)v);
+    put_u8(w, (uint8_t)(v >> 8));
+}
+
+static void put_varint(slot_writer_t *w, uint32_t v)
+{
+    while (v >= 0x80) {
+        put_u8(w, (uint8_t)(v | 0x80));
+        v >>= 7;
+    }
+    put_u8(w, (uint8_t)v);
+}
+
+static void put_bits(slot_writer_t *w, uint32_t v, uint8_t n)
+{
+    w->acc |= v << w->acc_bits;
+    w->acc_bits += n;
+    while (w->acc_bits >= 8) {
+        put_u8(w, (uint8_t)w->acc);
+        w->acc >>= 8;
+        w->acc_bits -= 8;
+    }
+}
+
+static void flush_bits(slot_writer_t *w)
+{
+    if (w->acc_bits) {
+        put_u8(w, (uint8_t)w->acc);
+        w->acc = 0;
+        w->acc_bits = 0;
+    }
+}
+
+static void wr_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void wr_u32(uint8_t *p, uint32_t v)
+{
+    wr_u16(p, (uint16_t)v);
+    wr_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t rd_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t rd_u32(const uint8_t *p)
+{
+    return rd_u16(p) | ((uint32_t)rd_u16(p + 2) << 16);
+}
+
+static bool get_varint(const uint8_t *buf, size_t len, size_t *pos, uint32_t *v)
+{
+    uint32_t result = 0;
+    for (unsigned shift = 0; shift < 35; shift += 7) {
+        if (*pos >= len) {
+            return false;
+        }
+        uint8_t b = buf[(*pos)++];
+        result |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            *v = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint16_t ir_slot_crc16(uint16_t crc, const uint8_t *data, size_t len)
+{
+    /* Nibble table for polynomial 0x1021 */
+    static const uint16_t s_crc_nibble[16] = {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+        0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    };
+    for (size_t i = 0; i < len; i++) {
+        crc = (uint16_t)((crc << 4) ^ s_crc_nibble[(crc >> 12) ^ (data[i] >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ s_crc_nibble[(crc >> 12) ^ (data[i] & 0x0F)]);
+    }
+    return crc;
+}
+
+/* =========================
+ * Encoder
+ * ========================= */
+typedef struct {
+    uint32_t sum;
+    uint32_t count;
+    uint16_t center;   /*!< First duration seen, then the mean after dict_refine() */
+} slot_cluster_t;
+
+typedef struct {
+    slot_cluster_t c[IR_SLOT_DICT_MAX];
+    uint8_t num;
+    bool overflow;
+} slot_dict_t;
+
+static uint32_t ticks_to_us(uint32_t ticks, uint32_t resolution_hz)
+{
+    return (uint32_t)(((uint64_t)ticks * 1000000u + resolution_hz / 2) / resolution_hz);
+}
+
+static uint16_t us_to_ticks(uint32_t us, uint32_t resolution_hz)
+{
+    uint64_t ticks = ((uint64_t)us * resolution_hz + 500000u) / 1000000u;
+    return ticks > 0x7FFFu ? 0x7FFFu : (uint16_t)ticks;
+}
+
+static bool dict_fits(uint16_t center, uint32_t us, uint8_t tolerance_pct)
+{
+    if (us == 0 || center == 0) {
+        return us == center; /* the end marker never merges */
+    }
+    uint32_t diff = us > center ? us - center : center - us;
+    return diff * 100u <= (uint32_t)center * tolerance_pct;
+}
+
+/* Nearest non-end-marker entry for us > 0, the end-marker entry for 0 */
+static uint8_t dict_index(const slot_dict_t *d, uint32_t us)
+{
+    uint8_t best = 0;
+    uint32_t best_diff = UINT32_MAX;
+    for (uint8_t i = 0; i < d->num; i++) {
+        uint16_t c = d->c[i].center;
+        if ((c == 0) != (us == 0)) {
+            continue;
+        }
+        uint32_t diff = us > c ? us - c : c - us;
+        if (diff < best_diff) {
+            best_diff = diff;
+            best = i;
+        }
+    }
+    return best;
+}
+
+static void dict_add(slot_dict_t *d, uint32_t us, uint8_t tolerance_pct)
+{
+    if (d->num > 0) {
+        uint8_t i = dict_index(d, us);
+        if (dict_fits(d->c[i].center, us, tolerance_pct)) {
+            return;
+        }
+    }
+    if (d->num == IR_SLOT_DICT_MAX) {
+        d->overflow = true;
+        return;
+    }
+    d->c[d->num++] = (slot_cluster_t){ .center = (uint16_t)us };
+}
+
+/*
+ * dict_add() seeds an entry with the first duration outside every existing
+ * window, so seeds sit anywhere inside the jitter band. Re-centre each entry
+ * on the mean of the durations nearest to it (one k-means step).
+ */
+static void dict_refine(slot_dict_t *d, const rmt_symbol_word_t *symbols, size_t symbol_num, uint32_t resolution_hz)
+{
+    slot_cluster_t next[IR_SLOT_DICT_MAX] = {0};
+
+    for (size_t i = 0; i < symbol_num; i++) {
+        uint32_t us[2] = {
+            ticks_to_us(symbols[i].duration0, resolution_hz),
+            ticks_to_us(symbols[i].duration1, resolution_hz),
+        };
+        for (int k = 0; k < 2; k++) {
+            slot_cluster_t *c = &next[dict_index(d, us[k])];
+            c->sum += us[k];
+            c->count++;
+        }
+    }
+    for (uint8_t i = 0; i < d->num; i++) {
+        if (next[i].count) {
+            d->c[i].center = (uint16_t)((next[i].sum + next[i].count / 2) / next[i].count);
+        }
+    }
+}
+
+typedef struct {
+    const ir_slot_encode_cfg_t *cfg;
+    const rmt_symbol_word_t *symbols;
+    slot_dict_t dict;
+    bool raw;
+} slot_enc_t;
+
+/* Dictionary code of one symbol: (index0 << 4) | index1 */
+static uint8_t sym_code(const slot_enc_t *e, size_t i)
+{
+    uint32_t us0 = ticks_to_us(e->symbols[i].duration0, e->cfg->resolution_hz);
+    uint32_t us1 = ticks_to_us(e->symbols[i].duration1, e->cfg->resolution_hz);
+    return (uint8_t)((dict_index(&e->dict, us0) << 4) | dict_index(&e->dict, us1));
+}
+
+static bool seg_equal(const slot_enc_t *e, const ir_capture_seg_t *a, const ir_capture_seg_t *b)
+{
+    if (a->symbol_num != b->symbol_num) {
+        return false;
+    }
+    for (uint32_t i = 0; i < a->symbol_num; i++) {
+        if (e->raw) {
+            if (e->symbols[a->offset + i].val != e->symbols[b->offset + i].val) {
+                return false;
+            }
+        } else if (sym_code(e, a->offset + i) != sym_code(e, b->offset + i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void put_run(slot_writer_t *w, uint8_t bits, uint8_t prev_code, uint32_t run)
+{
+    const uint32_t esc = (1u << bits) - 1;
+    const uint32_t max_run = esc + 2;
+
+    while (run >= 2) {
+        uint32_t n = run < max_run ? run : max_run;
+        put_bits(w, esc | ((n - 2) << bits), (uint8_t)(2 * bits));
+        run -= n;
+    }
+    if (run == 1) {
+        put_bits(w, (uint32_t)(prev_code >> 4) | ((uint32_t)(prev_code & 0x0F) << bits), (uint8_t)(2 * bits));
+    }
+}
+
+static void put_segment_indexed(slot_writer_t *w, const slot_enc_t *e, const ir_capture_seg_t *seg, uint8_t bits)
+{
+    uint8_t prev = 0;
+    uint32_t run = 0;
+
+    for (uint32_t i = 0; i < seg->symbol_num; i++) {
+        uint8_t code = sym_code(e, seg->offset + i);
+        if (i > 0 && code == prev) {
+            run++;
+            continue;
+        }
+        put_run(w, bits, prev, run);
+        run = 0;
+        put_bits(w, (uint32_t)(code >> 4) | ((uint32_t)(code & 0x0F) << bits), (uint8_t)(2 * bits));
+        prev = code;
+    }
+    put_run(w, bits, prev, run);
+}
+
+static void put_segment_raw(slot_writer_t *w, const slot_enc_t *e, const ir_capture_seg_t *seg)
+{
+    for (uint32_t i = 0; i < seg->symbol_num; i++) {
+        const rmt_symbol_word_t *s = &e->symbols[seg->offset + i];
+        put_varint(w, ticks_to_us(s->duration0, e->cfg->resolution_hz));
+        put_varint(w, ticks_to_us(s->duration1, e->cfg->resolution_hz));
+    }
+}
+
+static uint8_t index_bits(uint8_t dict_num)
+{
+    uint8_t bits = 2;
+    while (dict_num > (1u << bits) - 1) {
+        bits++;
+    }
+    return bits;
+}
+
+ir_slot_err_t ir_slot_encode(const ir_slot_encode_cfg_t *cfg, const ir_slot_meta_t *meta,
+                             const rmt_symbol_word_t *symbols, size_t symbol_num,
+                             const ir_capture_seg_t *segs, size_t seg_num,
+                             uint8_t *out, size_t out_cap, size_t *out_len)
+{
+    ir_capture_seg_t whole = { .offset = 0, .symbol_num = (uint32_t)symbol_num, .gap_us = 0 };
+    slot_enc_t e = { .cfg = cfg, .symbols = symbols };
+    uint8_t refs[IR_CAPTURE_MAX_SEGS] = {0};
+
+    if (!cfg || !meta || !symbols || !out_len || cfg->resolution_hz == 0 ||
+            symbol_num == 0 || symbol_num > UINT16_MAX) {
+        return IR_SLOT_ERR_ARG;
+    }
+    if (segs == NULL) {
+        segs = &whole;
+        seg_num = 1;
+    }
+    if (seg_num == 0 || seg_num > IR_CAPTURE_MAX_SEGS) {
+        return IR_SLOT_ERR_ARG;
+    }
+
+    /* One polarity for the whole waveform; durations must fit u16 microseconds */
+    uint32_t level0 = symbols[0].level0;
+    for (size_t i = 0; i < symbol_num; i++) {
+        if (symbols[i].level0 != level0 || symbols[i].level1 == level0) {
+            return IR_SLOT_ERR_ARG;
+        }
+        if (ticks_to_us(symbols[i].duration0, cfg->resolution_hz) > UINT16_MAX ||
+                ticks_to_us(symbols[i].duration1, cfg->resolution_hz) > UINT16_MAX) {
+            return IR_SLOT_ERR_ARG;
+        }
+    }
+    size_t covered = 0;
+    for (size_t s = 0; s < seg_num; s++) {
+        if (segs[s].offset + (size_t)segs[s].symbol_num > symbol_num) {
+            return IR_SLOT_ERR_ARG;
+        }
+        covered += segs[s].symbol_num;
+    }
+    if (covered > UINT16_MAX) {
+        return IR_SLOT_ERR_ARG;
+    }
+
+    for (size_t i = 0; i < symbol_num && !e.dict.overflow; i++) {
+        dict_add(&e.dict, ticks_to_us(symbols[i].duration0, cfg->resolution_hz), cfg->tolerance_pct);
+        dict_add(&e.dict, ticks_to_us(symbols[i].duration1, cfg->resolution_hz), cfg->tolerance_pct);
+    }
+    if (!e.dict.overflow) {
+        dict_refine(&e.dict, symbols, symbol_num, cfg->resolution_hz);
+    }
+    e.raw = e.dict.overflow;
+    uint8_t dict_num = e.raw ? 0 : e.dict.num;
+    uint8_t bits = index_bits(dict_num);
+
+    /* Sub-frames repeating an earlier literal one become references */
+    for (size_t s = 1; s < seg_num; s++) {
+        for (size_t k = 0; k < s; k++) {
+            if (refs[k] == 0 && seg_equal(&e, &segs[s], &segs[k])) {
+                refs[s] = (uint8_t)(k + 1);
+                break;
+            }
+        }
+    }
+
+    slot_writer_t w = { .out = out, .cap = out ? out_cap : 0, .pos = IR_SLOT_HEADER_SIZE };
+    for (uint8_t i = 0; i < dict_num; i++) {
+        put_u16(&w, e.dict.c[i].center);
+    }
+    for (size_t s = 0; s < seg_num; s++) {
+        put_varint(&w, segs[s].symbol_num);
+        put_varint(&w, s == 0 ? 0 : segs[s].gap_us);
+        put_varint(&w, refs[s]);
+    }
+    for (size_t s = 0; s < seg_num; s++) {
+        if (refs[s]) {
+            continue;
+        }
+        if (e.raw) {
+            put_segment_raw(&w, &e, &segs[s]);
+        } else {
+            put_segment_indexed(&w, &e, &segs[s], bits);
+            flush_bits(&w);
+        }
+    }
+
+    *out_len = w.pos;
+    if (w.pos > w.cap || w.pos - IR_SLOT_HEADER_SIZE > UINT16_MAX) {
+        return w.pos > UINT16_MAX + IR_SLOT_HEADER_SIZE ? IR_SLOT_ERR_ARG : IR_SLOT_ERR_NO_SPACE;
+    }
+
+    uint8_t *h = out;
+    memset(h, 0, IR_SLOT_HEADER_SIZE);
+    h[H_MAGIC] = SLOT_MAGIC0;
+    h[H_MAGIC + 1] = SLOT_MAGIC1;
+    h[H_VERSION] = IR_SLOT_VERSION;
+    h[H_FLAGS] = (uint8_t)((level0 ? IR_SLOT_F_LEVEL0_HIGH : 0) | (e.raw ? IR_SLOT_F_RAW : 0));
+    wr_u16(&h[H_PAYLOAD_LEN], (uint16_t)(w.pos - IR_SLOT_HEADER_SIZE));
+    wr_u32(&h[H_CARRIER], meta->carrier_hz);
+    h[H_DUTY] = meta->duty_pct;
+    h[H_REPEAT] = meta->repeat;
+    wr_u32(&h[H_REPEAT_GAP], meta->repeat_gap_us);
+    wr_u16(&h[H_SYMBOL_NUM], (uint16_t)covered);
+    h[H_SEG_NUM] = (uint8_t)seg_num;
+    h[H_DICT_NUM] = dict_num;
+    wr_u16(&h[H_CRC], ir_slot_crc16(0xFFFF, out, w.pos));
+    return IR_SLOT_OK;
+}
+
+/* =========================
+ * Decoder
+ * ========================= */
+ir_slot_err_t ir_slot_parse_header(const uint8_t *blob, size_t len, ir_slot_header_t *hdr)
+{
+    if (!blob || !hdr) {
+        return IR_SLOT_ERR_ARG;
+    }
+    if (len < IR_SLOT_HEADER_SIZE || blob[H_MAGIC] != SLOT_MAGIC0 || blob[H_MAGIC + 1] != SLOT_MAGIC1) {
+        return IR_SLOT_ERR_FORMAT;
+    }
+    if (blob[H_VERSION] != IR_SLOT_VERSION) {
+        return IR_SLOT_ERR_VERSION;
+    }
+
+    hdr->version = blob[H_VERSION];
+    hdr->flags = blob[H_FLAGS];
+    hdr->payload_len = rd_u16(&blob[H_PAYLOAD_LEN]);
+    hdr->crc = rd_u16(&blob[H_CRC]);
+    hdr->meta.carrier_hz = rd_u32(&blob[H_CARRIER]);
+    hdr->meta.duty_pct = blob[H_DUTY];
+    hdr->meta.repeat = blob[H_REPEAT];
+    hdr->meta.repeat_gap_us = rd_u32(&blob[H_REPEAT_GAP]);
+    hdr->symbol_num = rd_u16(&blob[H_SYMBOL_NUM]);
+    hdr->seg_num = blob[H_SEG_NUM];
+    hdr->dict_num = blob[H_DICT_NUM];
+
+    if ((size_t)IR_SLOT_HEADER_SIZE + hdr->payload_len > len ||
+            hdr->seg_num == 0 || hdr->seg_num > IR_CAPTURE_MAX_SEGS || hdr->dict_num > IR_SLOT_DICT_MAX) {
+        return IR_SLOT_ERR_FORMAT;
+    }
+
+    static const uint8_t s_zero_crc[2] = { 0, 0 };
+    uint16_t crc = ir_slot_crc16(0xFFFF, blob, H_CRC);
+    crc = ir_slot_crc16(crc, s_zero_crc, 2);
+    crc = ir_slot_crc16(crc, &blob[H_CRC + 2], IR_SLOT_HEADER_SIZE + hdr->payload_len - (H_CRC + 2));
+    return crc == hdr->crc ? IR_SLOT_OK : IR_SLOT_ERR_CRC;
+}
+
+ir_slot_err_t ir_slot_reader_init(ir_slot_reader_t *r, const uint8_t *blob, size_t len, uint32_t resolution_hz)
+{
+    memset(r, 0, sizeof(*r));
+    if (resolution_hz == 0) {
+        return IR_SLOT_ERR_ARG;
+    }
+    ir_slot_err_t err = ir_slot_parse_header(blob, len, &r->hdr);
+    if (err != IR_SLOT_OK) {
+        return err;
+    }
+
+    r->blob = blob;
+    r->len = IR_SLOT_HEADER_SIZE + r->hdr.payload_len;
+    r->resolution_hz = resolution_hz;
+    r->bits = index_bits(r->hdr.dict_num);
+    r->seg = -1;
+
+    size_t pos = IR_SLOT_HEADER_SIZE;
+    if (pos + 2u * r->hdr.dict_num > r->len) {
+        return IR_SLOT_ERR_FORMAT;
+    }
+    for (uint8_t i = 0; i < r->hdr.dict_num; i++, pos += 2) {
+        r->dict_ticks[i] = us_to_ticks(rd_u16(&blob[pos]), resolution_hz);
+    }
+
+    uint32_t total = 0;
+    for (uint8_t s = 0; s < r->hdr.seg_num; s++) {
+        uint32_t n, gap, ref;
+        if (!get_varint(blob, r->len, &pos, &n) || !get_varint(blob, r->len, &pos, &gap) ||
+                !get_varint(blob, r->len, &pos, &ref) || n > UINT16_MAX || ref > s ||
+                (ref && (r->seg_ref[ref - 1] != 0 || r->seg_symbols[ref - 1] != n))) {
+            return IR_SLOT_ERR_FORMAT;
+        }
+        r->seg_symbols[s] = (uint16_t)n;
+        r->seg_gap_us[s] = gap;
+        r->seg_ref[s] = (uint8_t)ref;
+        total += n;
+    }
+    if (total != r->hdr.symbol_num) {
+        return IR_SLOT_ERR_FORMAT;
+    }
+    r->wave = pos;
+    return IR_SLOT_OK;
+}
+
+bool ir_slot_reader_next_segment(ir_slot_reader_t *r, uint32_t *gap_us, size_t *symbol_num)
+{
+    if (r->seg >= 0 && r->seg_ref[r->seg] == 0) {
+        /* Skip what the caller did not read of a literal sub-frame */
+        rmt_symbol_word_t sink[16];
+        while (ir_slot_read(r, sink, 16) > 0) {
+        }
+        r->literal_pos = r->pos;
+    }
+    if (r->seg + 1 >= r->hdr.seg_num) {
+        return false;
+    }
+
+    r->seg++;
+    r->seg_left = r->seg_symbols[r->seg];
+    r->run_left = 0;
+    if (r->seg_ref[r->seg]) {
+        r->pos = r->seg_start[r->seg_ref[r->seg] - 1];
+    } else {
+        if (!(r->hdr.flags & IR_SLOT_F_RAW)) {
+            r->literal_pos = (r->literal_pos + 7) & ~(size_t)7; /* literal sub-frames are byte aligned */
+        }
+        r->pos = r->literal_pos;
+        r->seg_start[r->seg] = r->pos;
+    }
+    if (gap_us) {
+        *gap_us = r->seg_gap_us[r->seg];
+    }
+    if (symbol_num) {
+        *symbol_num = r->seg_left;
+    }
+    return true;
+}
+
+static uint32_t get_bits(ir_slot_reader_t *r, uint8_t n)
+{
+    uint32_t v = 0;
+    for (uint8_t i = 0; i < n; i++, r->pos++) {
+        size_t byte = r->wave + (r->pos >> 3);
+        if (byte >= r->len) {
+            r->error = true;
+            return 0;
+        }
+        v |= (uint32_t)((r->blob[byte] >> (r->pos & 7)) & 1u) << i;
+    }
+    return v;
+}
+
+static rmt_symbol_word_t make_symbol(const ir_slot_reader_t *r, uint32_t ticks0, uint32_t ticks1)
+{
+    uint32_t level0 = (r->hdr.flags & IR_SLOT_F_LEVEL0_HIGH) ? 1 : 0;
+    rmt_symbol_word_t s = {
+        .duration0 = ticks0, .level0 = level0,
+        .duration1 = ticks1, .level1 = !level0,
+    };
+    return s;
+}
+
+size_t ir_slot_read(ir_slot_reader_t *r, rmt_symbol_word_t *out, size_t max)
+{
+    size_t n = 0;
+    const uint32_t esc = (1u << r->bits) - 1;
+
+    while (n < max && r->seg_left > 0 && !r->error) {
+        if (r->run_left > 0) {
+            out[n++] = r->prev;
+            r->run_left--;
+            r->seg_left--;
+            continue;
+        }
+
+        if (r->hdr.flags & IR_SLOT_F_RAW) {
+            size_t byte = r->wave + r->pos;
+            uint32_t us0, us1;
+            if (!get_varint(r->blob, r->len, &byte, &us0) || !get_varint(r->blob, r->len, &byte, &us1)) {
+                r->error = true;
+                break;
+            }
+            r->pos = byte - r->wave;
+            r->prev = make_symbol(r, us_to_ticks(us0, r->resolution_hz), us_to_ticks(us1, r->resolution_hz));
+        } else {
+            uint32_t i0 = get_bits(r, r->bits);
+            uint32_t i1 = get_bits(r, r->bits);
+            if (i0 == esc) {
+                r->run_left = i1 + 2;
+                continue;
+            }
+            if (i0 >= r->hdr.dict_num || i1 >= r->hdr.dict_num) {
+                r->error = true;
+                break;
+            }
+            r->prev = make_symbol(r, r->dict_ticks[i0], r->dict_ticks[i1]);
+        }
+        out[n++] = r->prev;
+        r->seg_left--;
+    }
+    return n;
+}
+
+ir_slot_err_t ir_slot_decode(const uint8_t *blob, size_t len, uint32_t resolution_hz,
+                             rmt_symbol_word_t *out, size_t out_cap, size_t *symbol_num,
+                             ir_capture_seg_t *segs, size_t seg_cap, size_t *seg_num)
+{
+    ir_slot_reader_t r;
+    ir_slot_err_t err = ir_slot_reader_init(&r, blob, len, resolution_hz);
+    if (err != IR_SLOT_OK) {
+        return err;
+    }
+    if (r.hdr.symbol_num > out_cap) {
+        return IR_SLOT_ERR_NO_SPACE;
+    }
+
+    size_t used = 0;
+    size_t s = 0;
+    uint32_t gap_us;
+    size_t n;
+    while (ir_slot_reader_next_segment(&r, &gap_us, &n)) {
+        if (segs && s < seg_cap) {
+            segs[s] = (ir_capture_seg_t){ .offset = (uint32_t)used, .symbol_num = (uint32_t)n, .gap_us = gap_us };
+        }
+        s++;
+        used += ir_slot_read(&r, &out[used], n);
+        if (r.error) {
+            return IR_SLOT_ERR_FORMAT;
+        }
+    }
+    if (used != r.hdr.symbol_num) {
+        return IR_SLOT_ERR_FORMAT;
+    }
+    if (symbol_num) {
+        *symbol_num = used;
+    }
+    if (seg_num) {
+        *seg_num = s;
+    }
+    return IR_SLOT_OK;
+}
@@ -0,0 +1,96 @@
+/*
+ * ir_slot_stream.c — TX-ready symbol stream over an ir_slot blob
+ */
+
+#include "ir_slot_stream.h"
+
+static uint32_t gap_to_ticks(uint32_t us, uint32_t resolution_hz)
+{
+    return (uint32_t)(((uint64_t)us * resolution_hz + 500000u) / 1000000u);
+}
+
+/*
+ * Move to the next sub-frame; the gap before it becomes pending. After the
+ * last one the tail gap is pending instead, and the stream ends once it was
+ * emitted.
+ */
+static void stream_next_segment(ir_slot_stream_t *st)
+{
+    uint32_t gap_us;
+
+    if (ir_slot_reader_next_segment(&st->reader, &gap_us, NULL)) {
+        st->gap_ticks = gap_to_ticks(gap_us, st->reader.resolution_hz);
+        return;
+    }
+    st->gap_ticks = st->tail_gap_ticks;
+    st->in_tail = true;
+}
+
+ir_slot_err_t ir_slot_stream_init(ir_slot_stream_t *st, const ir_slot_tx_payload_t *payload, uint32_t resolution_hz)
+{
+    ir_slot_err_t err = ir_slot_reader_init(&st->reader, payload->blob, payload->len, resolution_hz);
+    st->gap_ticks = 0;
+    st->tail_gap_ticks = gap_to_ticks(payload->tail_gap_us, resolution_hz);
+    st->in_tail = false;
+    st->done = err != IR_SLOT_OK;
+    if (err == IR_SLOT_OK) {
+        stream_next_segment(st);
+    }
+    return err;
+}
+
+size_t ir_slot_stream_fill(ir_slot_stream_t *st, rmt_symbol_word_t *out, size_t max)
+{
+    size_t n = 0;
+    const uint32_t idle = (st->reader.hdr.flags & IR_SLOT_F_LEVEL0_HIGH) ? 0 : 1;
+
+    while (n < max && !st->done) {
+        if (st->gap_ticks > 0) {
+            /* Both halves non-zero: a zero duration would end the transmission */
+            uint32_t take = st->gap_ticks < 2 * IR_SLOT_STREAM_MAX_TICKS ? st->gap_ticks : 2 * IR_SLOT_STREAM_MAX_TICKS;
+            uint32_t d0 = (take + 1) / 2;
+            uint32_t d1 = take - d0 ? take - d0 : 1;
+            out[n++] = (rmt_symbol_word_t){ .duration0 = d0, .level0 = idle, .duration1 = d1, .level1 = idle };
+            st->gap_ticks -= take;
+            continue;
+        }
+        if (st->in_tail) {
+            st->done = true;
+            break;
+        }
+
+        size_t k = ir_slot_read(&st->reader, &out[n], max - n);
+        n += k;
+        if (st->reader.error) {
+            st->done = true;
+            break;
+        }
+        if (st->reader.seg_left > 0) {
+            continue;
+        }
+
+        stream_next_segment(st);
+        if (n > 0 && out[n - 1].duration1 == 0 && (st->gap_ticks > 0 || !st->in_tail)) {
+            /* The sub-frame's end marker becomes the start of the gap */
+            uint32_t d1 = st->gap_ticks < IR_SLOT_STREAM_MAX_TICKS ? st->gap_ticks : IR_SLOT_STREAM_MAX_TICKS;
+            out[n - 1].duration1 = d1 ? d1 : 1;
+            st->gap_ticks -= d1;
+        }
+    }
+    return n;
+}
+
+size_t ir_slot_stream_count(const ir_slot_tx_payload_t *payload, uint32_t resolution_hz)
+{
+    ir_slot_stream_t st;
+    rmt_symbol_word_t scratch[16];
+    size_t total = 0, n;
+
+    if (ir_slot_stream_init(&st, payload, resolution_hz) != IR_SLOT_OK) {
+        return 0;
+    }
+    while ((n = ir_slot_stream_fill(&st, scratch, 16)) > 0) {
+        total += n;
+    }
+    return st.reader.error ? 0 : total;
+}
@@ -0,0 +1,189 @@
+/*
+ * ir_tx.c — batched IR transmit of slot routines through the TX queue
+ *
+ * submitted/completed are free-running counters, like the frame ring's
+ * head/tail: the task only queues while submitted - completed is below the
+ * queue depth, so the payload slot submitted % IR_TX_QUEUE_MAX is never one
+ * the driver still reads (transmissions complete in order). A completion
+ * with nothing in flight belongs to someone else's transmission and is
+ * ignored.
+ */
+
+#include <string.h>
+
+#include "ir_tx.h"
+
+void ir_tx_init(ir_tx_t *tx, const ir_hal_tx_t *hal)
+{
+    memset(tx, 0, sizeof(*tx));
+    tx->hal = *hal;
+    if (tx->hal.queue_depth == 0 || tx->hal.queue_depth > IR_TX_QUEUE_MAX) {
+        tx->hal.queue_depth = IR_TX_QUEUE_MAX;
+    }
+    atomic_store(&tx->submitted, 0);
+    atomic_store(&tx->completed, 0);
+}
+
+bool ir_tx_send(ir_tx_t *tx, const ir_tx_routine_t *routine)
+{
+    if (tx->busy || routine->steps == NULL || routine->step_num == 0) {
+        return false;
+    }
+    tx->routine = *routine;
+    tx->busy = true;
+    tx->result = IR_TX_OK;
+    tx->next_step = 0;
+    tx->step_sends = 0;
+    ir_tx_pump(tx);
+    return true;
+}
+
+/* Set the carrier through the cache; HAL without carrier control accepts anything */
+static bool tx_set_carrier(ir_tx_t *tx, uint32_t carrier_hz, uint8_t duty_pct)
+{
+    if (tx->carrier_valid && tx->carrier_hz == carrier_hz && tx->duty_pct == duty_pct) {
+        return true;
+    }
+    if (tx->hal.ops->set_carrier != NULL) {
+        if (!tx->hal.ops->set_carrier(tx->hal.ctx, carrier_hz, duty_pct)) {
+            tx->carrier_valid = false; /* unknown what the channel holds now */
+            return false;
+        }
+        tx->stats.carrier_changes++;
+    }
+    tx->carrier_hz = carrier_hz;
+    tx->duty_pct = duty_pct;
+    tx->carrier_valid = true;
+    return true;
+}
+
+/* Plan the next step: hardware loop if the whole transmission fits the channel memory */
+static bool tx_plan_step(ir_tx_t *tx)
+{
+    const ir_tx_step_t *step = &tx->routine.steps[tx->next_step++];
+    ir_slot_header_t hdr;
+
+    if (ir_slot_parse_header(step->blob, step->len, &hdr) != IR_SLOT_OK) {
+        tx->result = IR_TX_ERR_SLOT;
+        return false;
+    }
+    tx->step_carrier_hz = hdr.meta.carrier_hz;
+    tx->step_duty_pct = hdr.meta.duty_pct;
+    tx->step_carrier_pending = true;
+
+    tx->step_payload = (ir_slot_tx_payload_t){ .blob = step->blob, .len = step->len, .tail_gap_us = step->gap_us };
+    size_t symbols = ir_slot_stream_count(&tx->step_payload, tx->hal.resolution_hz);
+    if (symbols == 0) {
+        tx->result = IR_TX_ERR_SLOT;
+        return false;
+    }
+
+    if (step->repeat > 0 && symbols <= tx->hal.loop_max_symbols) {
+        tx->step_loop = step->repeat;
+        tx->step_sends = 1;
+        tx->stats.hw_repeats += step->repeat;
+    } else {
+        tx->step_loop = 0;
+        tx->step_sends = 1u + step->repeat;
+        tx->stats.sw_repeats += step->repeat;
+    }
+    return true;
+}
+
+void ir_tx_pump(ir_tx_t *tx)
+{
+    if (!tx->busy) {
+        return;
+    }
+
+    uint32_t submitted = atomic_load_explicit(&tx->submitted, memory_order_relaxed);
+    while (tx->result == IR_TX_OK) {
+        if (tx->step_sends == 0) {
+            if (tx->next_step == tx->routine.step_num || !tx_plan_step(tx)) {
+                break;
+            }
+        }
+        uint32_t completed = atomic_load_explicit(&tx->completed, memory_order_acquire);
+        if (submitted - completed >= tx->hal.queue_depth) {
+            return; /* queue full, the next completion calls us again */
+        }
+        if (tx->step_carrier_pending) {
+            bool same = tx->carrier_valid && tx->carrier_hz == tx->step_carrier_hz && tx->duty_pct == tx->step_duty_pct;
+            if (!same && submitted != completed) {
+                return; /* drain first, the last completion calls us again */
+            }
+            if (!tx_set_carrier(tx, tx->step_carrier_hz, tx->step_duty_pct)) {
+                tx->result = IR_TX_ERR_CARRIER;
+                break;
+            }
+            tx->step_carrier_pending = false;
+        }
+
+        ir_slot_tx_payload_t *payload = &tx->payloads[submitted % IR_TX_QUEUE_MAX];
+        *payload = tx->step_payload;
+        /* Count it first: the completion may arrive before submit() returns */
+        atomic_store_explicit(&tx->submitted, submitted + 1, memory_order_release);
+        if (!tx->hal.ops->submit(tx->hal.ctx, payload, tx->step_loop)) {
+            atomic_store_explicit(&tx->submitted, submitted, memory_order_release);
+            tx->result = IR_TX_ERR_SUBMIT;
+            break;
+        }
+        submitted++;
+        tx->step_sends--;
+        tx->stats.transactions++;
+    }
+
+    /* Nothing more to queue: done once the last transmission finished */
+    if (atomic_load_explicit(&tx->completed, memory_order_acquire) != submitted) {
+        return;
+    }
+    tx->busy = false;
+    tx->stats.routines++;
+    if (tx->result != IR_TX_OK) {
+        tx->stats.errors++;
+    }
+    if (tx->routine.on_done) {
+        tx->routine.on_done(tx->routine.user, tx->result);
+    }
+}
+
+bool ir_tx_on_done(ir_tx_t *tx)
+{
+    uint32_t completed = atomic_load_explicit(&tx->completed, memory_order_relaxed);
+    if (completed == atomic_load_explicit(&tx->submitted, memory_order_acquire)) {
+        return false;
+    }
+    atomic_store_explicit(&tx->completed, completed + 1, memory_order_release);
+    return true;
+}
+
+bool ir_tx_apply_carrier(ir_tx_t *tx, uint32_t carrier_hz, uint8_t duty_pct)
+{
+    if (tx->busy) {
+        return false;
+    }
+    return tx_set_carrier(tx, carrier_hz, duty_pct);
+}
+
+bool ir_tx_busy(const ir_tx_t *tx)
+{
+    return tx->busy;
+}
+
+bool ir_tx_step_from_slot(ir_tx_step_t *step, const uint8_t *blob, size_t len)
+{
+    ir_slot_header_t hdr;
+    if (ir_slot_parse_header(blob, len, &hdr) != IR_SLOT_OK) {
+        return false;
+    }
+    step->blob = blob;
+    step->len = len;
+    step->repeat = hdr.meta.repeat;
+    step->gap_us = hdr.meta.repeat_gap_us;
+    return true;
+}
+
+void ir_tx_get_stats(const ir_tx_t *tx, ir_tx_stats_t *out)
+{
+    *out = tx->stats;
+}
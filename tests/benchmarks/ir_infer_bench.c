@@ -0,0 +1,279 @@
+/*
+ * ir_infer_bench.c — accuracy and cost of per-capture timing inference
+ *
+ * Usage: ir_infer_bench [-n iterations] [capture.log ...]
+ *
+ * The corpus is every recorded NEC frame plus, per ir_pd preset, a batch of
+ * frames with random data and receiver distortion (marks +80us, spaces
+ * -80us, +-60us jitter), and a 12-bit pulse-width remote. For each family it
+ * reports how many frames were recognised as pulse-distance, how many bit
+ * sequences came out exact, the mean distance of the normalized durations
+ * from the true canonical ones for ir_infer_normalize() and for the legacy
+ * NEC-or-fixed-2-cluster normalization, and ns/frame of both. Exits non-zero
+ * if a bit sequence is wrong.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ir_core.h"
+#include "ir_pd.h"
+#include "ir_infer.h"
+#include "ir_legacy_pipeline.h"
+#include "capture_file.h"
+#include "bench_time.h"
+
+#define INFER_BENCH_RES_HZ     1000000u
+#define INFER_BENCH_ITERATIONS 2000u
+#define INFER_BENCH_FRAMES     16u
+#define INFER_BENCH_MAX_SYMBOLS (IR_PD_MAX_BYTES * 8 + 2)
+
+typedef struct {
+  rmt_symbol_word_t captured[INFER_BENCH_MAX_SYMBOLS];
+  rmt_symbol_word_t truth[INFER_BENCH_MAX_SYMBOLS]; /* canonical waveform */
+  size_t symbol_num;
+  uint8_t bits[IR_PD_MAX_BYTES];                    /* LSB first, transmission order */
+  size_t bit_num;
+} infer_frame_t;
+
+typedef struct {
+  size_t frames;
+  size_t pd;
+  size_t bits_ok;
+  double err_infer_us;  /* sums, divided by durations when printed */
+  double err_legacy_us;
+  size_t durations;
+  double infer_ns;
+  double legacy_ns;
+} infer_result_t;
+
+static infer_frame_t s_frames[INFER_BENCH_FRAMES];
+static rmt_symbol_word_t s_scratch[INFER_BENCH_MAX_SYMBOLS];
+
+/* =========================
+ * Corpus
+ * ========================= */
+static uint32_t next_rand(uint32_t *rng)
+{
+  *rng = *rng * 1103515245u + 12345u;
+  return *rng >> 16;
+}
+
+static void distort(const rmt_symbol_word_t *in, rmt_symbol_word_t *out, size_t n, uint32_t seed)
+{
+  uint32_t rng = seed;
+  for (size_t i = 0; i < n; i++) {
+    int32_t j0 = (int32_t)(next_rand(&rng) % 121u) - 60;
+    int32_t j1 = (int32_t)(next_rand(&rng) % 121u) - 60;
+    out[i] = in[i];
+    out[i].level0 = !in[i].level0;
+    out[i].level1 = !in[i].level1;
+    out[i].duration0 = (uint32_t)((int32_t)in[i].duration0 + 80 + j0);
+    if (in[i].duration1) {
+      out[i].duration1 = (uint32_t)((int32_t)in[i].duration1 - 80 + j1);
+    }
+  }
+}
+
+static void set_bits(infer_frame_t *f, const uint8_t *data, size_t byte_num, int msb_first)
+{
+  memset(f->bits, 0, sizeof(f->bits));
+  for (size_t i = 0; i < byte_num * 8; i++) {
+    unsigned shift = msb_first ? 7 - (unsigned)(i % 8) : (unsigned)(i % 8);
+    if ((data[i / 8] >> shift) & 1u) {
+      f->bits[i / 8] |= (uint8_t)(1u << (i % 8));
+    }
+  }
+  f->bit_num = byte_num * 8;
+}
+
+static size_t build_preset(const ir_pd_desc_t *desc, uint32_t seed)
+{
+  size_t byte_num = desc->byte_num ? desc->byte_num : 19;
+  uint8_t data[IR_PD_MAX_BYTES];
+
+  for (size_t k = 0; k < INFER_BENCH_FRAMES; k++) {
+    infer_frame_t *f = &s_frames[k];
+    uint32_t rng = seed * 131u + (uint32_t)k;
+    for (size_t i = 0; i < byte_num; i++) {
+      data[i] = (uint8_t)next_rand(&rng);
+    }
+    f->symbol_num = ir_pd_expand(desc, INFER_BENCH_RES_HZ, data, byte_num, f->truth, INFER_BENCH_MAX_SYMBOLS);
+    distort(f->truth, f->captured, f->symbol_num, rng);
+    set_bits(f, data, byte_num, desc->msb_first);
+  }
+  return INFER_BENCH_FRAMES;
+}
+
+/* Sony-style: leader 2400/600, bits in the mark (600 / 1200), 600 spaces, gap after the last bit */
+static size_t build_pulse_width(uint32_t seed)
+{
+  for (size_t k = 0; k < INFER_BENCH_FRAMES; k++) {
+    infer_frame_t *f = &s_frames[k];
+    uint32_t rng = seed + (uint32_t)k;
+    uint32_t code = next_rand(&rng) & 0xFFFu;
+    size_t n = 0;
+
+    f->truth[n++] = (rmt_symbol_word_t){ .level0 = 1, .duration0 = 2400, .level1 = 0, .duration1 = 600 };
+    for (int i = 0; i < 12; i++) {
+      f->truth[n++] = (rmt_symbol_word_t){ .level0 = 1, .duration0 = (code >> i) & 1u ? 1200 : 600,
+                                           .level1 = 0, .duration1 = 600 };
+    }
+    f->truth[n - 1].duration1 = 25000;
+    f->symbol_num = n;
+    distort(f->truth, f->captured, n, rng);
+    memset(f->bits, 0, sizeof(f->bits));
+    f->bits[0] = (uint8_t)code;
+    f->bits[1] = (uint8_t)(code >> 8);
+    f->bit_num = 12;
+  }
+  return INFER_BENCH_FRAMES;
+}
+
+/* =========================
+ * Measurement
+ * ========================= */
+static uint32_t abs_diff(uint32_t a, uint32_t b)
+{
+  return a > b ? a - b : b - a;
+}
+
+static void add_error(const infer_frame_t *f, const rmt_symbol_word_t *norm, double *sum)
+{
+  for (size_t i = 0; i < f->symbol_num; i++) {
+    if (f->truth[i].duration0) *sum += abs_diff(norm[i].duration0, f->truth[i].duration0);
+    if (f->truth[i].duration1) *sum += abs_diff(norm[i].duration1, f->truth[i].duration1);
+  }
+}
+
+static int run_family(const infer_frame_t *frames, size_t frame_num, unsigned iterations, infer_result_t *res)
+{
+  ir_infer_template_t tpl;
+  uint8_t bits[IR_PD_MAX_BYTES];
+  int failed = 0;
+
+  memset(res, 0, sizeof(*res));
+  for (size_t k = 0; k < frame_num; k++) {
+    const infer_frame_t *f = &frames[k];
+    res->frames++;
+    ir_infer(f->captured, f->symbol_num, INFER_BENCH_RES_HZ, &tpl, bits, sizeof(bits));
+    if (tpl.pd) {
+      res->pd++;
+      if (tpl.bit_num == f->bit_num && memcmp(bits, f->bits, (f->bit_num + 7) / 8) == 0) {
+        res->bits_ok++;
+      }
+    }
+    ir_infer_normalize(&tpl, f->captured, s_scratch, f->symbol_num);
+    add_error(f, s_scratch, &res->err_infer_us);
+    legacy_normalize_rmt_frame(f->captured, s_scratch, f->symbol_num);
+    add_error(f, s_scratch, &res->err_legacy_us);
+    for (size_t i = 0; i < f->symbol_num; i++) {
+      res->durations += (f->truth[i].duration0 != 0) + (f->truth[i].duration1 != 0);
+    }
+  }
+  failed = res->bits_ok != res->frames;
+
+  uint64_t t0 = bench_now_ns();
+  for (unsigned it = 0; it < iterations; it++) {
+    for (size_t k = 0; k < frame_num; k++) {
+      ir_infer(frames[k].captured, frames[k].symbol_num, INFER_BENCH_RES_HZ, &tpl, bits, sizeof(bits));
+      ir_infer_normalize(&tpl, frames[k].captured, s_scratch, frames[k].symbol_num);
+      bench_sink(s_scratch);
+    }
+  }
+  uint64_t t1 = bench_now_ns();
+  for (unsigned it = 0; it < iterations; it++) {
+    for (size_t k = 0; k < frame_num; k++) {
+      legacy_normalize_rmt_frame(frames[k].captured, s_scratch, frames[k].symbol_num);
+      bench_sink(s_scratch);
+    }
+  }
+  uint64_t t2 = bench_now_ns();
+
+  res->infer_ns = (double)(t1 - t0) / ((double)frame_num * iterations);
+  res->legacy_ns = (double)(t2 - t1) / ((double)frame_num * iterations);
+  return failed;
+}
+
+static void print_row(const char *name, const infer_result_t *r)
+{
+  printf("%-16s frames=%3zu pd=%3zu bits_ok=%3zu err_us infer=%6.1f legacy=%7.1f ns/frame infer=%7.0f legacy=%6.0f\n",
+         name, r->frames, r->pd, r->bits_ok, r->err_infer_us / (double)r->durations,
+         r->err_legacy_us / (double)r->durations, r->infer_ns, r->legacy_ns);
+}
+
+int main(int argc, char **argv)
+{
+  unsigned iterations = INFER_BENCH_ITERATIONS;
+  capture_set_t set = {0};
+  ir_pulse_lut_t lut;
+  infer_result_t r;
+  int argi = 1;
+  int failed = 0;
+
+  if (argc > 2 && strcmp(argv[1], "-n") == 0) {
+    iterations = (unsigned)strtoul(argv[2], NULL, 0);
+    argi = 3;
+  }
+  if (iterations == 0) {
+    fprintf(stderr, "usage: %s [-n iterations] [capture.log ...]\n", argv[0]);
+    return 2;
+  }
+  for (; argi < argc; argi++) {
+    if (capture_file_load(argv[argi], &set) < 0) {
+      fprintf(stderr, "cannot read %s\n", argv[argi]);
+      capture_set_free(&set);
+      return 1;
+    }
+  }
+  ir_pulse_lut_init(&lut, INFER_BENCH_RES_HZ);
+
+  /* Recorded NEC frames, truth from the NEC decoder; in batches of INFER_BENCH_FRAMES */
+  infer_result_t captures = {0};
+  size_t batch = 0;
+  for (size_t i = 0; i <= set.frame_num; i++) {
+    const capture_frame_t *c = i < set.frame_num ? &set.frames[i] : NULL;
+    ir_nec_frame_t nec;
+    if (c && c->symbol_num == NEC_FRAME_SYMBOLS && nec_parse_frame(&lut, c->symbols, &nec)) {
+      infer_frame_t *f = &s_frames[batch++];
+      uint8_t data[4] = { (uint8_t)nec.address, (uint8_t)(nec.address >> 8),
+                          (uint8_t)nec.command, (uint8_t)(nec.command >> 8) };
+      f->symbol_num = ir_pd_expand(&ir_pd_nec, INFER_BENCH_RES_HZ, data, 4, f->truth, INFER_BENCH_MAX_SYMBOLS);
+      memcpy(f->captured, c->symbols, f->symbol_num * sizeof(rmt_symbol_word_t));
+      set_bits(f, data, 4, 0);
+    }
+    if (batch == INFER_BENCH_FRAMES || (c == NULL && batch > 0)) {
+      failed |= run_family(s_frames, batch, iterations, &r);
+      double w_old = (double)captures.frames, w_new = (double)r.frames;
+      captures.infer_ns = (captures.infer_ns * w_old + r.infer_ns * w_new) / (w_old + w_new);
+      captures.legacy_ns = (captures.legacy_ns * w_old + r.legacy_ns * w_new) / (w_old + w_new);
+      captures.frames += r.frames;
+      captures.pd += r.pd;
+      captures.bits_ok += r.bits_ok;
+      captures.err_infer_us += r.err_infer_us;
+      captures.err_legacy_us += r.err_legacy_us;
+      captures.durations += r.durations;
+      batch = 0;
+    }
+  }
+  if (captures.frames > 0) {
+    print_row("captures(nec)", &captures);
+  }
+
+  for (size_t p = 0; p < ir_pd_preset_num; p++) {
+    size_t n = build_preset(ir_pd_presets[p], (uint32_t)p + 1);
+    failed |= run_family(s_frames, n, iterations, &r);
+    print_row(ir_pd_presets[p]->name, &r);
+  }
+  size_t n = build_pulse_width(77);
+  failed |= run_family(s_frames, n, iterations, &r);
+  print_row("pulse_width_12", &r);
+
+  if (failed) {
+    fprintf(stderr, "inferred bit sequence mismatch\n");
+  }
+  capture_set_free(&set);
+  return failed;
+}
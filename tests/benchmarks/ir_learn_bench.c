@@ -0,0 +1,257 @@
+/*
+ * ir_learn_bench.c — quality and cost of consensus learning
+ *
+ * Usage: ir_learn_bench [-n iterations] [capture.log ...]
+ *
+ * Per ir_pd preset and press count, a series of learn sessions: random data,
+ * every press distorted independently (marks +80us, spaces -80us, +-150us
+ * jitter), and one press in six an outlier (a split space, or all spaces
+ * 50% long). Each session is learned from its first press alone, as before,
+ * and from the consensus of all presses. Reports how many learned waveforms
+ * still decode to the sent bytes, the mean distance from the true durations,
+ * the mean confidence and ns per consensus. The recorded NEC frames are
+ * learned in sessions of up to 5 presses of the same button. Exits non-zero
+ * if a consensus of 3+ presses decodes fewer sessions than the first press.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ir_core.h"
+#include "ir_pd.h"
+#include "ir_learn.h"
+#include "capture_file.h"
+#include "bench_time.h"
+
+#define LEARN_BENCH_RES_HZ      1000000u
+#define LEARN_BENCH_ITERATIONS  200u
+#define LEARN_BENCH_SESSIONS    32u
+#define LEARN_BENCH_MAX_SYMBOLS (IR_PD_MAX_BYTES * 8 + 2)
+#define LEARN_BENCH_ARENA       (LEARN_BENCH_MAX_SYMBOLS * IR_LEARN_MAX_PRESSES + IR_LEARN_MAX_PRESSES)
+
+typedef struct {
+  size_t sessions;
+  size_t single_ok;
+  size_t consensus_ok;
+  double err_single_us;    /* sums, divided by durations when printed */
+  double err_consensus_us;
+  size_t durations;
+  double confidence;       /* sum of confidence_pct */
+  double consensus_ns;
+  size_t symbols;          /* per consensus, for ns/symbol */
+} learn_result_t;
+
+static rmt_symbol_word_t s_arena[LEARN_BENCH_ARENA];
+static rmt_symbol_word_t s_truth[LEARN_BENCH_MAX_SYMBOLS];
+static rmt_symbol_word_t s_press[LEARN_BENCH_MAX_SYMBOLS + 1];
+static rmt_symbol_word_t s_out[LEARN_BENCH_MAX_SYMBOLS + 1];
+static ir_learn_t s_learn;
+
+/* =========================
+ * Sessions
+ * ========================= */
+static uint32_t next_rand(uint32_t *rng)
+{
+  *rng = *rng * 1103515245u + 12345u;
+  return *rng >> 16;
+}
+
+static size_t make_press(const rmt_symbol_word_t *truth, size_t n, uint32_t *rng, rmt_symbol_word_t *out)
+{
+  for (size_t i = 0; i < n; i++) {
+    int32_t j0 = (int32_t)(next_rand(rng) % 301u) - 150;
+    int32_t j1 = (int32_t)(next_rand(rng) % 301u) - 150;
+    out[i] = truth[i];
+    out[i].duration0 = (uint32_t)((int32_t)truth[i].duration0 + 80 + j0);
+    if (truth[i].duration1) {
+      out[i].duration1 = (uint32_t)((int32_t)truth[i].duration1 - 80 + j1);
+    }
+  }
+  switch (next_rand(rng) % 12u) {
+  case 0: /* split space */
+    if (n > 12) {
+      memmove(&out[11], &out[10], (n - 10) * sizeof(rmt_symbol_word_t));
+      out[10].duration1 = 200;
+      out[11].duration0 = 150;
+      return n + 1;
+    }
+    break;
+  case 1: /* off-axis: spaces stretched */
+    for (size_t i = 0; i + 1 < n; i++) {
+      out[i].duration1 += out[i].duration1 / 2;
+    }
+    break;
+  default:
+    break;
+  }
+  return n;
+}
+
+static uint32_t abs_diff(uint32_t a, uint32_t b)
+{
+  return a > b ? a - b : b - a;
+}
+
+/* Distance from the true durations; a wrong-length waveform counts 1000us per duration */
+static double wave_error(const rmt_symbol_word_t *wave, size_t wave_num, const rmt_symbol_word_t *truth, size_t n,
+                         size_t *durations)
+{
+  double sum = 0;
+  for (size_t i = 0; i < n; i++) {
+    size_t k = (truth[i].duration0 != 0) + (truth[i].duration1 != 0);
+    *durations += k;
+    if (wave_num != n) {
+      sum += 1000.0 * (double)k;
+      continue;
+    }
+    if (truth[i].duration0) sum += abs_diff(wave[i].duration0, truth[i].duration0);
+    if (truth[i].duration1) sum += abs_diff(wave[i].duration1, truth[i].duration1);
+  }
+  return sum;
+}
+
+static bool decodes(const ir_pd_desc_t *desc, const rmt_symbol_word_t *wave, size_t n,
+                    const uint8_t *data, size_t byte_num)
+{
+  uint8_t bytes[IR_PD_MAX_BYTES];
+  size_t got = 0;
+  return ir_pd_decode(desc, LEARN_BENCH_RES_HZ, wave, n, bytes, sizeof(bytes), &got) &&
+         got == byte_num && memcmp(bytes, data, byte_num) == 0;
+}
+
+static void run_preset(const ir_pd_desc_t *desc, unsigned presses, unsigned iterations, uint32_t seed,
+                       learn_result_t *res)
+{
+  size_t byte_num = desc->byte_num ? desc->byte_num : 19;
+  uint8_t data[IR_PD_MAX_BYTES];
+  ir_learn_result_t lr;
+  uint32_t rng = seed;
+
+  memset(res, 0, sizeof(*res));
+  for (size_t s = 0; s < LEARN_BENCH_SESSIONS; s++) {
+    for (size_t i = 0; i < byte_num; i++) {
+      data[i] = (uint8_t)next_rand(&rng);
+    }
+    size_t n = ir_pd_expand(desc, LEARN_BENCH_RES_HZ, data, byte_num, s_truth, LEARN_BENCH_MAX_SYMBOLS);
+
+    ir_learn_reset(&s_learn);
+    for (unsigned p = 0; p < presses; p++) {
+      size_t pn = make_press(s_truth, n, &rng, s_press);
+      ir_learn_add(&s_learn, s_press, pn, NULL, 0);
+      if (p == 0) {
+        res->single_ok += decodes(desc, s_press, pn, data, byte_num);
+        size_t ignored = 0;
+        res->err_single_us += wave_error(s_press, pn, s_truth, n, &ignored);
+      }
+    }
+    res->sessions++;
+    if (ir_learn_consensus(&s_learn, s_out, LEARN_BENCH_MAX_SYMBOLS + 1, &lr) == IR_LEARN_OK) {
+      res->consensus_ok += decodes(desc, s_out, lr.symbol_num, data, byte_num);
+      res->err_consensus_us += wave_error(s_out, lr.symbol_num, s_truth, n, &res->durations);
+      res->confidence += lr.confidence_pct;
+      res->symbols += n;
+    } else {
+      res->err_consensus_us += wave_error(s_out, 0, s_truth, n, &res->durations);
+    }
+
+    /* Cost of the consensus alone, on the session just built */
+    uint64_t t0 = bench_now_ns();
+    for (unsigned it = 0; it < iterations; it++) {
+      ir_learn_consensus(&s_learn, s_out, LEARN_BENCH_MAX_SYMBOLS + 1, &lr);
+      bench_sink(s_out);
+    }
+    res->consensus_ns += (double)(bench_now_ns() - t0) / iterations;
+  }
+}
+
+static void print_row(const char *name, unsigned presses, const learn_result_t *r)
+{
+  double sessions = (double)r->sessions;
+  printf("%-14s presses=%u sessions=%3zu decode_ok single=%3zu consensus=%3zu err_us single=%7.1f consensus=%7.1f "
+         "confidence=%5.1f%% ns/consensus=%8.0f ns/symbol=%5.1f\n",
+         name, presses, r->sessions, r->single_ok, r->consensus_ok,
+         r->err_single_us / (double)r->durations, r->err_consensus_us / (double)r->durations,
+         r->confidence / sessions, r->consensus_ns / sessions,
+         r->symbols ? r->consensus_ns / (double)r->symbols : 0.0);
+}
+
+int main(int argc, char **argv)
+{
+  static const unsigned press_counts[] = { 1, 3, 5, 8 };
+  unsigned iterations = LEARN_BENCH_ITERATIONS;
+  capture_set_t set = {0};
+  ir_pulse_lut_t lut;
+  learn_result_t r;
+  int argi = 1;
+  int failed = 0;
+
+  if (argc > 2 && strcmp(argv[1], "-n") == 0) {
+    iterations = (unsigned)strtoul(argv[2], NULL, 0);
+    argi = 3;
+  }
+  if (iterations == 0) {
+    fprintf(stderr, "usage: %s [-n iterations] [capture.log ...]\n", argv[0]);
+    return 2;
+  }
+  for (; argi < argc; argi++) {
+    if (capture_file_load(argv[argi], &set) < 0) {
+      fprintf(stderr, "cannot read %s\n", argv[argi]);
+      capture_set_free(&set);
+      return 1;
+    }
+  }
+  ir_pulse_lut_init(&lut, LEARN_BENCH_RES_HZ);
+  ir_learn_config_t cfg = { .resolution_hz = LEARN_BENCH_RES_HZ, .arena = s_arena, .arena_symbols = LEARN_BENCH_ARENA };
+  ir_learn_init(&s_learn, &cfg);
+
+  /* Recorded NEC frames: consecutive presses of the same button form a session */
+  size_t sessions = 0, sessions_ok = 0;
+  ir_nec_frame_t first = {0};
+  for (size_t i = 0; i <= set.frame_num; i++) {
+    const capture_frame_t *c = i < set.frame_num ? &set.frames[i] : NULL;
+    ir_nec_frame_t nec;
+    bool frame = c && c->symbol_num == NEC_FRAME_SYMBOLS && nec_parse_frame(&lut, c->symbols, &nec);
+    if (frame && ir_learn_press_num(&s_learn) > 0 &&
+        nec.address == first.address && nec.command == first.command && ir_learn_press_num(&s_learn) < 5) {
+      ir_learn_add(&s_learn, c->symbols, c->symbol_num, NULL, 0);
+      continue;
+    }
+    if (c != NULL && !frame) {
+      continue; /* repeat codes */
+    }
+    if (ir_learn_press_num(&s_learn) > 0) {
+      ir_learn_result_t lr;
+      ir_nec_frame_t out;
+      sessions++;
+      sessions_ok += ir_learn_consensus(&s_learn, s_out, LEARN_BENCH_MAX_SYMBOLS, &lr) == IR_LEARN_OK &&
+                     nec_parse_frame(&lut, s_out, &out) && out.address == first.address && out.command == first.command;
+    }
+    ir_learn_reset(&s_learn);
+    if (c != NULL) {
+      first = nec;
+      ir_learn_add(&s_learn, c->symbols, c->symbol_num, NULL, 0);
+    }
+  }
+  if (sessions > 0) {
+    printf("captures(nec)  sessions=%zu decode_ok=%zu\n", sessions, sessions_ok);
+    failed |= sessions_ok != sessions;
+  }
+
+  for (size_t p = 0; p < ir_pd_preset_num; p++) {
+    for (size_t k = 0; k < sizeof(press_counts) / sizeof(press_counts[0]); k++) {
+      run_preset(ir_pd_presets[p], press_counts[k], iterations, (uint32_t)(p * 97 + 5), &r);
+      print_row(ir_pd_presets[p]->name, press_counts[k], &r);
+      if (press_counts[k] >= 3 && r.consensus_ok < r.single_ok) {
+        failed = 1;
+      }
+    }
+  }
+
+  if (failed) {
+    fprintf(stderr, "consensus decoded fewer sessions than a single press\n");
+  }
+  capture_set_free(&set);
+  return failed;
+}
@@ -0,0 +1,142 @@
+/*
+ * ir_legacy_pipeline.c — pre-LUT ir_core RX path, kept as benchmark baseline
+ *
+ * Verbatim copy of the abs()-chain normalization and range-check decoder that
+ * the table-driven classifier in ir_core.c replaced.
+ */
+
+#include <stdlib.h>
+
+#include "ir_legacy_pipeline.h"
+
+/**
+ * @brief Check whether a duration is within expected range
+ */
+static inline bool legacy_nec_check_in_range(uint32_t signal_duration, uint32_t spec_duration)
+{
+    return (signal_duration < (spec_duration + IR_NEC_DECODE_MARGIN)) &&
+           (signal_duration > (spec_duration - IR_NEC_DECODE_MARGIN));
+}
+
+/**
+ * @brief Check whether a RMT symbol represents NEC logic zero
+ */
+static bool legacy_nec_parse_logic0(const rmt_symbol_word_t *rmt_nec_symbols)
+{
+    return legacy_nec_check_in_range(rmt_nec_symbols->duration0, NEC_PAYLOAD_ZERO_DURATION_0) &&
+           legacy_nec_check_in_range(rmt_nec_symbols->duration1, NEC_PAYLOAD_ZERO_DURATION_1);
+}
+
+/**
+ * @brief Check whether a RMT symbol represents NEC logic one
+ */
+static bool legacy_nec_parse_logic1(const rmt_symbol_word_t *rmt_nec_symbols)
+{
+    return legacy_nec_check_in_range(rmt_nec_symbols->duration0, NEC_PAYLOAD_ONE_DURATION_0) &&
+           legacy_nec_check_in_range(rmt_nec_symbols->duration1, NEC_PAYLOAD_ONE_DURATION_1);
+}
+
+bool legacy_nec_parse_frame(const rmt_symbol_word_t *rmt_nec_symbols, ir_nec_frame_t *out)
+{
+    const rmt_symbol_word_t *cur = rmt_nec_symbols;
+    uint16_t address = 0;
+    uint16_t command = 0;
+    bool valid_leading_code = legacy_nec_check_in_range(cur->duration0, NEC_LEADING_CODE_DURATION_0) &&
+                              legacy_nec_check_in_range(cur->duration1, NEC_LEADING_CODE_DURATION_1);
+    if (!valid_leading_code) {
+        return false;
+    }
+    cur++;
+    for (int i = 0; i < 16; i++) {
+        if (legacy_nec_parse_logic1(cur)) {
+            address |= 1 << i;
+        } else if (legacy_nec_parse_logic0(cur)) {
+            address &= ~(1 << i);
+        } else {
+            return false;
+        }
+        cur++;
+    }
+    for (int i = 0; i < 16; i++) {
+        if (legacy_nec_parse_logic1(cur)) {
+            command |= 1 << i;
+        } else if (legacy_nec_parse_logic0(cur)) {
+            command &= ~(1 << i);
+        } else {
+            return false;
+        }
+        cur++;
+    }
+    if (out) {
+        out->address = address;
+        out->command = command;
+    }
+    return true;
+}
+
+bool legacy_nec_parse_frame_repeat(const rmt_symbol_word_t *rmt_nec_symbols)
+{
+    return legacy_nec_check_in_range(rmt_nec_symbols->duration0, NEC_REPEAT_CODE_DURATION_0) &&
+           legacy_nec_check_in_range(rmt_nec_symbols->duration1, NEC_REPEAT_CODE_DURATION_1);
+}
+
+void legacy_invert_rmt_levels(const rmt_symbol_word_t *input,
+                       rmt_symbol_word_t *output,
+                       size_t symbol_num)
+{
+    for (size_t i = 0; i < symbol_num; i++) {
+        output[i].level0 = !input[i].level0;
+        output[i].level1 = !input[i].level1;
+        output[i].duration0 = input[i].duration0;
+        output[i].duration1 = input[i].duration1;
+    }
+}
+
+void legacy_normalize_rmt_durations(rmt_symbol_word_t *frame, size_t symbol_num)
+{
+    for (size_t i = 0; i < symbol_num; i++) {
+        uint32_t d0 = frame[i].duration0;
+        uint32_t d1 = frame[i].duration1;
+
+        // Try to match NEC known pulse durations first
+        if (abs((int)d0 - NEC_PAYLOAD_ZERO_DURATION_0) < 200 && abs((int)d1 - NEC_PAYLOAD_ZERO_DURATION_1) < 200) {
+            frame[i].duration0 = NEC_PAYLOAD_ZERO_DURATION_0;
+            frame[i].duration1 = NEC_PAYLOAD_ZERO_DURATION_1;
+        } else if (abs((int)d0 - NEC_PAYLOAD_ONE_DURATION_0) < 200 && abs((int)d1 - NEC_PAYLOAD_ONE_DURATION_1) < 300) {
+            frame[i].duration0 = NEC_PAYLOAD_ONE_DURATION_0;
+            frame[i].duration1 = NEC_PAYLOAD_ONE_DURATION_1;
+        } else if (abs((int)d0 - NEC_LEADING_CODE_DURATION_0) < 1000 && abs((int)d1 - NEC_LEADING_CODE_DURATION_1) < 1000) {
+            frame[i].duration0 = NEC_LEADING_CODE_DURATION_0;
+            frame[i].duration1 = NEC_LEADING_CODE_DURATION_1;
+        } else if (abs((int)d0 - NEC_REPEAT_CODE_DURATION_0) < 1000 && abs((int)d1 - NEC_REPEAT_CODE_DURATION_1) < 1000) {
+            frame[i].duration0 = NEC_REPEAT_CODE_DURATION_0;
+            frame[i].duration1 = NEC_REPEAT_CODE_DURATION_1;
+        } else {
+            // Fallback: crude k-means with 2 clusters (short, long) on the fly
+            static uint32_t short_avg = 560;
+            static uint32_t long_avg = 1690;
+
+            // Normalize duration0
+            if (abs((int)d0 - (int)short_avg) < abs((int)d0 - (int)long_avg)) {
+                frame[i].duration0 = short_avg;
+            } else {
+                frame[i].duration0 = long_avg;
+            }
+
+            // Normalize duration1
+            if (abs((int)d1 - (int)short_avg) < abs((int)d1 - (int)long_avg)) {
+                frame[i].duration1 = short_avg;
+            } else {
+                frame[i].duration1 = long_avg;
+            }
+        }
+    }
+}
+
+void legacy_normalize_rmt_frame(const rmt_symbol_word_t *input_frame,
+                         rmt_symbol_word_t *output_frame,
+                         size_t symbol_num)
+{
+    legacy_invert_rmt_levels(input_frame, output_frame, symbol_num);
+    legacy_normalize_rmt_durations(output_frame, symbol_num);
+}
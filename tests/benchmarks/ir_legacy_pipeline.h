@@ -0,0 +1,17 @@
+/*
+ * ir_legacy_pipeline.h — pre-LUT ir_core RX path, kept as benchmark baseline
+ */
+#ifndef IR_LEGACY_PIPELINE_H
+#define IR_LEGACY_PIPELINE_H
+
+#include "ir_core.h"
+
+bool legacy_nec_parse_frame(const rmt_symbol_word_t *rmt_nec_symbols, ir_nec_frame_t *out);
+bool legacy_nec_parse_frame_repeat(const rmt_symbol_word_t *rmt_nec_symbols);
+void legacy_invert_rmt_levels(const rmt_symbol_word_t *input, rmt_symbol_word_t *output, size_t symbol_num);
+void legacy_normalize_rmt_durations(rmt_symbol_word_t *frame, size_t symbol_num);
+void legacy_normalize_rmt_frame(const rmt_symbol_word_t *input_frame,
+                                rmt_symbol_word_t *output_frame,
+                                size_t symbol_num);
+
+#endif /* IR_LEGACY_PIPELINE_H */
@@ -0,0 +1,171 @@
+/*
+ * ir_replay_bench.c — replay recorded RMT captures through the ir_core RX path
+ *
+ * Usage: ir_replay_bench [-n iterations] capture.log [capture.log ...]
+ *
+ * Each frame goes through the same steps the infrared_test app runs per RX
+ * done event (normalize + NEC decode), once with the pre-LUT abs()-chain code
+ * (ir_legacy_pipeline.c) and once with the table-driven single pass. Reports
+ * decode counts and throughput as frames/sec and ns/symbol for both.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ir_core.h"
+#include "ir_legacy_pipeline.h"
+#include "capture_file.h"
+#include "bench_time.h"
+
+#define REPLAY_DEFAULT_ITERATIONS 200u
+#define REPLAY_RESOLUTION_HZ      1000000u
+#define REPLAY_ROUNDS             5u
+
+typedef struct {
+  size_t frames;
+  size_t nec_frames;
+  size_t nec_repeats;
+  size_t unknown;
+} replay_stats_t;
+
+typedef void (*replay_fn_t)(const capture_frame_t *f, rmt_symbol_word_t *scratch, replay_stats_t *st);
+
+static ir_pulse_lut_t s_lut;
+
+static void replay_frame_legacy(const capture_frame_t *f, rmt_symbol_word_t *scratch, replay_stats_t *st)
+{
+  ir_nec_frame_t nec;
+
+  legacy_normalize_rmt_frame(f->symbols, scratch, f->symbol_num);
+
+  st->frames++;
+  switch (f->symbol_num) {
+  case NEC_FRAME_SYMBOLS:
+    if (legacy_nec_parse_frame(f->symbols, &nec)) {
+      st->nec_frames++;
+      return;
+    }
+    break;
+  case NEC_REPEAT_SYMBOLS:
+    if (legacy_nec_parse_frame_repeat(f->symbols)) {
+      st->nec_repeats++;
+      return;
+    }
+    break;
+  default:
+    break;
+  }
+  st->unknown++;
+}
+
+static void replay_frame_lut(const capture_frame_t *f, rmt_symbol_word_t *scratch, replay_stats_t *st)
+{
+  ir_nec_decode_t dec;
+
+  ir_core_process_frame(&s_lut, f->symbols, scratch, f->symbol_num, &dec);
+
+  st->frames++;
+  switch (dec.kind) {
+  case IR_NEC_DECODE_FRAME:  st->nec_frames++;  break;
+  case IR_NEC_DECODE_REPEAT: st->nec_repeats++; break;
+  default:                   st->unknown++;     break;
+  }
+}
+
+static double run_timed(replay_fn_t fn, const capture_set_t *set, rmt_symbol_word_t *scratch,
+                        unsigned iterations, replay_stats_t *st, double *ns_per_symbol)
+{
+  replay_stats_t timed = {0};
+
+  memset(st, 0, sizeof(*st));
+  for (size_t i = 0; i < set->frame_num; i++) {
+    fn(&set->frames[i], scratch, st); /* decode pass, also warms caches */
+  }
+
+  /* Best of REPLAY_ROUNDS to filter scheduler noise */
+  uint64_t dt = UINT64_MAX;
+  for (unsigned round = 0; round < REPLAY_ROUNDS; round++) {
+    memset(&timed, 0, sizeof(timed));
+    uint64_t t0 = bench_now_ns();
+    for (unsigned it = 0; it < iterations; it++) {
+      for (size_t i = 0; i < set->frame_num; i++) {
+        fn(&set->frames[i], scratch, &timed);
+      }
+      bench_sink(scratch);
+    }
+    uint64_t round_dt = bench_now_ns() - t0;
+    if (round_dt < dt) dt = round_dt;
+  }
+
+  *ns_per_symbol = (double)dt / ((double)set->symbol_total * iterations);
+  return (double)timed.frames * 1e9 / (double)dt;
+}
+
+static void print_row(const char *name, const replay_stats_t *st, double fps, double ns_sym)
+{
+  printf("%-7s nec=%zu repeat=%zu unknown=%zu frames/sec=%.0f ns/symbol=%.2f\n",
+         name, st->nec_frames, st->nec_repeats, st->unknown, fps, ns_sym);
+}
+
+int main(int argc, char **argv)
+{
+  unsigned iterations = REPLAY_DEFAULT_ITERATIONS;
+  capture_set_t set = {0};
+  int argi = 1;
+
+  if (argc > 2 && strcmp(argv[1], "-n") == 0) {
+    iterations = (unsigned)strtoul(argv[2], NULL, 0);
+    argi = 3;
+  }
+  if (argi >= argc || iterations == 0) {
+    fprintf(stderr, "usage: %s [-n iterations] capture.log [capture.log ...]\n", argv[0]);
+    return 2;
+  }
+
+  for (; argi < argc; argi++) {
+    int n = capture_file_load(argv[argi], &set);
+    if (n < 0) {
+      fprintf(stderr, "cannot read %s\n", argv[argi]);
+      capture_set_free(&set);
+      return 1;
+    }
+    printf("loaded %-40s %4d frames\n", argv[argi], n);
+  }
+  if (set.frame_num == 0) {
+    fprintf(stderr, "no frames found\n");
+    return 1;
+  }
+
+  size_t max_symbols = 0;
+  for (size_t i = 0; i < set.frame_num; i++) {
+    if (set.frames[i].symbol_num > max_symbols) max_symbols = set.frames[i].symbol_num;
+  }
+  rmt_symbol_word_t *scratch = malloc(max_symbols * sizeof(*scratch));
+  if (!scratch) {
+    capture_set_free(&set);
+    return 1;
+  }
+
+  ir_pulse_lut_init(&s_lut, REPLAY_RESOLUTION_HZ);
+
+  replay_stats_t legacy, lut;
+  double legacy_ns, lut_ns;
+  double legacy_fps = run_timed(replay_frame_legacy, &set, scratch, iterations, &legacy, &legacy_ns);
+  double lut_fps = run_timed(replay_frame_lut, &set, scratch, iterations, &lut, &lut_ns);
+
+  printf("frames=%zu symbols=%zu iterations=%u\n", set.frame_num, set.symbol_total, iterations);
+  print_row("legacy", &legacy, legacy_fps, legacy_ns);
+  print_row("lut", &lut, lut_fps, lut_ns);
+  printf("speedup=%.2fx\n", legacy_ns / lut_ns);
+
+  int mismatch = legacy.nec_frames != lut.nec_frames || legacy.nec_repeats != lut.nec_repeats;
+  if (mismatch) {
+    fprintf(stderr, "decode mismatch between legacy and lut paths\n");
+  }
+
+  free(scratch);
+  capture_set_free(&set);
+  return (mismatch || lut.unknown == lut.frames) ? 1 : 0;
+}
@@ -0,0 +1,226 @@
+/*
+ * ir_slot_bench.c — storage size and encode/decode cost of ir_slot blobs
+ *
+ * Usage: ir_slot_bench [-n iterations] [capture.log ...]
+ *
+ * Every recorded frame, plus three synthetic minisplit-style waveforms
+ * (single 140-symbol frame, Daikin-style 3 sub-frames, 300-symbol frame with
+ * receiver jitter), is encoded with the default 20% tolerance. Reports the
+ * raw rmt_symbol_word_t size against the blob size, and ns/symbol for
+ * ir_slot_encode() and ir_slot_decode(). Exits non-zero if a decoded
+ * waveform drifts further from the input than the clustering allows.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ir_slot.h"
+#include "capture_file.h"
+#include "bench_time.h"
+
+#define SLOT_BENCH_RES_HZ      1000000u
+#define SLOT_BENCH_TOLERANCE   20u
+#define SLOT_BENCH_ITERATIONS  2000u
+#define SLOT_BENCH_MAX_SYMBOLS 1024u
+#define SLOT_BENCH_BLOB_CAP    4096u
+
+typedef struct {
+  const char *name;
+  const rmt_symbol_word_t *symbols;
+  size_t symbol_num;
+  const ir_capture_seg_t *segs;
+  size_t seg_num;
+} slot_case_t;
+
+static const ir_slot_meta_t s_meta = { .carrier_hz = 38000, .duty_pct = 33 };
+static uint8_t s_blob[SLOT_BENCH_BLOB_CAP];
+static rmt_symbol_word_t s_out[SLOT_BENCH_MAX_SYMBOLS];
+
+/* =========================
+ * Synthetic waveforms
+ * ========================= */
+static rmt_symbol_word_t s_ac_single[140];
+static rmt_symbol_word_t s_ac_daikin[20 + 20 + 152];
+static rmt_symbol_word_t s_ac_jitter[300];
+static const ir_capture_seg_t s_daikin_segs[3] = {
+  { .offset = 0,  .symbol_num = 20,  .gap_us = 0 },
+  { .offset = 20, .symbol_num = 20,  .gap_us = 25000 },
+  { .offset = 40, .symbol_num = 152, .gap_us = 35000 },
+};
+
+static uint32_t next_rand(uint32_t *rng)
+{
+  *rng = *rng * 1103515245u + 12345u;
+  return *rng >> 16;
+}
+
+static void build_ac(rmt_symbol_word_t *out, size_t n, uint32_t seed, uint32_t jitter)
+{
+  uint32_t rng = seed;
+#define AC_US(v) ((v) + (jitter ? next_rand(&rng) % (2 * jitter + 1) - jitter : 0))
+  out[0] = (rmt_symbol_word_t){ .level0 = 0, .duration0 = AC_US(3500), .level1 = 1 };
+  out[0].duration1 = AC_US(1700);
+  for (size_t i = 1; i + 1 < n; i++) {
+    uint32_t bit = next_rand(&rng) & 1u;
+    out[i] = (rmt_symbol_word_t){ .level0 = 0, .duration0 = AC_US(430), .level1 = 1 };
+    out[i].duration1 = AC_US(bit ? 1300 : 430);
+  }
+  out[n - 1] = (rmt_symbol_word_t){ .level0 = 0, .duration0 = AC_US(430), .level1 = 1, .duration1 = 0 };
+#undef AC_US
+}
+
+static void build_synthetic(void)
+{
+  build_ac(s_ac_single, 140, 1, 0);
+  build_ac(s_ac_daikin, 20, 2, 0);
+  memcpy(&s_ac_daikin[20], s_ac_daikin, 20 * sizeof(rmt_symbol_word_t)); /* Daikin repeats its preamble */
+  build_ac(&s_ac_daikin[40], 152, 3, 0);
+  build_ac(s_ac_jitter, 300, 4, 60);
+}
+
+/* =========================
+ * Measurement
+ * ========================= */
+typedef struct {
+  size_t raw_bytes;
+  size_t blob_bytes;
+  double enc_ns_sym;
+  double dec_ns_sym;
+  uint32_t max_err_us;
+} slot_result_t;
+
+static int run_case(const slot_case_t *c, unsigned iterations, slot_result_t *res)
+{
+  ir_slot_encode_cfg_t cfg = { .resolution_hz = SLOT_BENCH_RES_HZ, .tolerance_pct = SLOT_BENCH_TOLERANCE };
+  size_t len = 0, n = 0;
+
+  memset(res, 0, sizeof(*res));
+  if (ir_slot_encode(&cfg, &s_meta, c->symbols, c->symbol_num, c->segs, c->seg_num,
+                     s_blob, sizeof(s_blob), &len) != IR_SLOT_OK ||
+      ir_slot_decode(s_blob, len, SLOT_BENCH_RES_HZ, s_out, SLOT_BENCH_MAX_SYMBOLS, &n,
+                     NULL, 0, NULL) != IR_SLOT_OK) {
+    return -1;
+  }
+
+  size_t covered = 0;
+  for (size_t s = 0; s < (c->segs ? c->seg_num : 1); s++) {
+    const ir_capture_seg_t *seg = c->segs ? &c->segs[s] : NULL;
+    size_t off = seg ? seg->offset : 0;
+    size_t cnt = seg ? seg->symbol_num : c->symbol_num;
+    for (size_t i = 0; i < cnt; i++, covered++) {
+      const rmt_symbol_word_t *a = &c->symbols[off + i];
+      const rmt_symbol_word_t *b = &s_out[covered];
+      uint32_t e0 = a->duration0 > b->duration0 ? a->duration0 - b->duration0 : b->duration0 - a->duration0;
+      uint32_t e1 = a->duration1 > b->duration1 ? a->duration1 - b->duration1 : b->duration1 - a->duration1;
+      /* A duration may sit at the edge of its entry's seed window before re-centring */
+      if (e0 * 100u > b->duration0 * 2 * SLOT_BENCH_TOLERANCE || e1 * 100u > b->duration1 * 2 * SLOT_BENCH_TOLERANCE) {
+        return -1;
+      }
+      if (e0 > res->max_err_us) res->max_err_us = e0;
+      if (e1 > res->max_err_us) res->max_err_us = e1;
+    }
+  }
+  if (covered != n) {
+    return -1;
+  }
+
+  res->raw_bytes = n * sizeof(rmt_symbol_word_t);
+  res->blob_bytes = len;
+
+  uint64_t t0 = bench_now_ns();
+  for (unsigned it = 0; it < iterations; it++) {
+    ir_slot_encode(&cfg, &s_meta, c->symbols, c->symbol_num, c->segs, c->seg_num, s_blob, sizeof(s_blob), &len);
+    bench_sink(s_blob);
+  }
+  uint64_t t1 = bench_now_ns();
+  for (unsigned it = 0; it < iterations; it++) {
+    ir_slot_decode(s_blob, len, SLOT_BENCH_RES_HZ, s_out, SLOT_BENCH_MAX_SYMBOLS, &n, NULL, 0, NULL);
+    bench_sink(s_out);
+  }
+  uint64_t t2 = bench_now_ns();
+
+  res->enc_ns_sym = (double)(t1 - t0) / ((double)n * iterations);
+  res->dec_ns_sym = (double)(t2 - t1) / ((double)n * iterations);
+  return 0;
+}
+
+static void print_row(const char *name, size_t symbols, const slot_result_t *r)
+{
+  printf("%-16s symbols=%5zu raw=%6zuB blob=%5zuB ratio=%5.1f%% max_err=%3uus enc=%6.1fns/sym dec=%5.1fns/sym\n",
+         name, symbols, r->raw_bytes, r->blob_bytes, 100.0 * (double)r->blob_bytes / (double)r->raw_bytes,
+         (unsigned)r->max_err_us, r->enc_ns_sym, r->dec_ns_sym);
+}
+
+/* Adds one case into *sum (ns/symbol weighted by symbols); returns non-zero on mismatch */
+static int accumulate(const slot_case_t *c, unsigned iterations, slot_result_t *sum)
+{
+  slot_result_t r;
+  if (run_case(c, iterations, &r) != 0) {
+    fprintf(stderr, "%s: encode/decode mismatch\n", c->name);
+    return 1;
+  }
+  double w_old = (double)sum->raw_bytes, w_new = (double)r.raw_bytes;
+  sum->enc_ns_sym = (sum->enc_ns_sym * w_old + r.enc_ns_sym * w_new) / (w_old + w_new);
+  sum->dec_ns_sym = (sum->dec_ns_sym * w_old + r.dec_ns_sym * w_new) / (w_old + w_new);
+  sum->raw_bytes += r.raw_bytes;
+  sum->blob_bytes += r.blob_bytes;
+  if (r.max_err_us > sum->max_err_us) sum->max_err_us = r.max_err_us;
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  unsigned iterations = SLOT_BENCH_ITERATIONS;
+  capture_set_t set = {0};
+  int argi = 1;
+  int failed = 0;
+
+  if (argc > 2 && strcmp(argv[1], "-n") == 0) {
+    iterations = (unsigned)strtoul(argv[2], NULL, 0);
+    argi = 3;
+  }
+  if (iterations == 0) {
+    fprintf(stderr, "usage: %s [-n iterations] [capture.log ...]\n", argv[0]);
+    return 2;
+  }
+  for (; argi < argc; argi++) {
+    if (capture_file_load(argv[argi], &set) < 0) {
+      fprintf(stderr, "cannot read %s\n", argv[argi]);
+      capture_set_free(&set);
+      return 1;
+    }
+  }
+
+  build_synthetic();
+  const slot_case_t synthetic[] = {
+    { "ac_single_140", s_ac_single, 140, NULL, 0 },
+    { "ac_daikin_3seg", s_ac_daikin, 192, s_daikin_segs, 3 },
+    { "ac_jitter_300", s_ac_jitter, 300, NULL, 0 },
+  };
+
+  /* Recorded frames are short NEC frames and repeats, reported as one row */
+  slot_result_t captures = {0};
+  char name[32];
+  for (size_t i = 0; i < set.frame_num; i++) {
+    snprintf(name, sizeof(name), "capture_%zu", i);
+    slot_case_t c = { name, set.frames[i].symbols, set.frames[i].symbol_num, NULL, 0 };
+    failed |= accumulate(&c, iterations, &captures);
+  }
+  if (set.frame_num > 0) {
+    snprintf(name, sizeof(name), "captures(%zu)", set.frame_num);
+    print_row(name, set.symbol_total, &captures);
+  }
+  for (size_t i = 0; i < sizeof(synthetic) / sizeof(synthetic[0]); i++) {
+    slot_result_t r = {0};
+    if (accumulate(&synthetic[i], iterations, &r) == 0) {
+      print_row(synthetic[i].name, synthetic[i].symbol_num, &r);
+    } else {
+      failed = 1;
+    }
+  }
+
+  capture_set_free(&set);
+  return failed;
+}
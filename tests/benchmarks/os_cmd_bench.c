@@ -0,0 +1,256 @@
+/*
+ * os_cmd_bench.c — command round trips: os_cmd channel against events
+ *
+ * Usage: os_cmd_bench [-n round_trips]
+ *
+ * One caller thread sends commands one at a time to a target module that
+ * runs in its own thread and answers with the request bytes changed, for a
+ * 4-byte and a 48-byte request (the second is above OS_EVT_INLINE_MAX):
+ *
+ *   channel  os_cmd_alloc / os_cmd_call / os_cmd_release; the target sits
+ *            in os_cmd_recv() and answers in place with os_cmd_respond()
+ *   events   the same exchange emulated on the bus: the request is an event
+ *            carrying a correlation id, the target a deferred subscriber on
+ *            its module's worker, the response a second event. The caller's
+ *            response subscriber matches the id and posts a semaphore;
+ *            three other modules subscribed to the response event run and
+ *            ignore it, as every waiting caller would.
+ *
+ * Reports the round trip p50/p99/max and the RAM one in-flight command
+ * holds: a channel slot with its pool block and queue share, against the
+ * bus queue entries, worker handoff and pool blocks of the emulation plus
+ * the caller's pending record. Exits non-zero if a response is wrong.
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "os_cmd.h"
+#include "os_evt_bus.h"
+#include "bench_time.h"
+
+#define CMD_BENCH_ROUND_TRIPS 20000u
+#define CMD_BENCH_BYSTANDERS  3u
+#define CMD_BENCH_OP_ECHO     1u
+#define CMD_BENCH_OP_QUIT     2u
+
+/* Stand-ins: the event table has no command ids */
+#define CMD_BENCH_REQ_EVT EVT_IR_SEND_STARTED
+#define CMD_BENCH_RSP_EVT EVT_IR_SEND_RESULT
+
+static uint64_t *s_rtt_ns;
+
+static int cmp_u64(const void *a, const void *b)
+{
+  uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+static void make_request(uint8_t *buf, size_t len, uint32_t n)
+{
+  for (size_t i = 0; i < len; i++) {
+    buf[i] = (uint8_t)(n + i);
+  }
+}
+
+static bool check_response(const uint8_t *buf, size_t len, uint32_t n)
+{
+  for (size_t i = 0; i < len; i++) {
+    if (buf[i] != (uint8_t)~(n + i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void report(const char *mode, size_t payload, unsigned n, size_t mem_bytes)
+{
+  qsort(s_rtt_ns, n, sizeof(*s_rtt_ns), cmp_u64);
+  printf("%-7s payload=%2u  rtt p50=%6.2f us  p99=%7.2f us  max=%8.2f us  in-flight=%4u bytes\n", mode,
+         (unsigned)payload, s_rtt_ns[n / 2] / 1000.0, s_rtt_ns[(n * 99) / 100] / 1000.0, s_rtt_ns[n - 1] / 1000.0,
+         (unsigned)mem_bytes);
+}
+
+/* =========================
+ * Channel
+ * ========================= */
+static void *channel_target(void *arg)
+{
+  (void)arg;
+  for (;;) {
+    os_cmd_t *cmd = os_cmd_recv(OS_MOD_IR, OS_CMD_WAIT_FOREVER);
+    if (cmd == NULL) {
+      continue;
+    }
+    uint16_t op = cmd->op;
+    os_cmd_corr_t corr = cmd->corr;
+    for (uint16_t i = 0; i < cmd->len; i++) {
+      cmd->data[i] = (uint8_t)~cmd->data[i];
+    }
+    os_cmd_respond(cmd, corr, OS_OK);
+    if (op == CMD_BENCH_OP_QUIT) {
+      return NULL;
+    }
+  }
+}
+
+static bool bench_channel(size_t payload, unsigned n)
+{
+  pthread_t target;
+  bool ok = true;
+  os_cmd_stats_t stats;
+
+  os_cmd_init();
+  pthread_create(&target, NULL, channel_target, NULL);
+  for (uint32_t i = 0; i < n; i++) {
+    uint64_t t0 = bench_now_ns();
+    os_cmd_t *cmd = os_cmd_alloc(OS_MOD_BLE, OS_MOD_IR, CMD_BENCH_OP_ECHO);
+    make_request(cmd->data, payload, i);
+    cmd->len = (uint16_t)payload;
+    ok &= os_cmd_call(cmd, OS_CMD_WAIT_FOREVER) == OS_OK && check_response(cmd->data, payload, i);
+    os_cmd_release(cmd, cmd->corr);
+    s_rtt_ns[i] = bench_now_ns() - t0;
+  }
+  os_cmd_t *quit = os_cmd_alloc(OS_MOD_BLE, OS_MOD_IR, CMD_BENCH_OP_QUIT);
+  os_cmd_call(quit, OS_CMD_WAIT_FOREVER);
+  os_cmd_release(quit, quit->corr);
+  pthread_join(target, NULL);
+
+  os_cmd_get_stats(&stats);
+  report("channel", payload, n, stats.mem_bytes / OS_CMD_SLOTS);
+  return ok && stats.completed == n + 1u;
+}
+
+/* =========================
+ * Events
+ * ========================= */
+typedef struct {
+  uint32_t corr;
+  uint8_t  data[OS_CMD_DATA_MAX];
+} bus_msg_t;
+
+/* What an emulating caller keeps per command to match the response */
+typedef struct {
+  uint32_t corr;
+  uint8_t *rsp;
+  size_t   len;
+  sem_t    done;
+} bus_pending_t;
+
+static bus_pending_t s_pending;
+static size_t s_payload;
+
+/* Target module, on its worker */
+static void cb_target(const os_evt_t *evt, void *user_ctx)
+{
+  bus_msg_t msg;
+  (void)user_ctx;
+  memcpy(&msg, os_evt_data(evt), evt->len);
+  for (size_t i = 0; i < s_payload; i++) {
+    msg.data[i] = (uint8_t)~msg.data[i];
+  }
+  while (os_evt_bus_publish(OS_MOD_IR, CMD_BENCH_RSP_EVT, &msg, evt->len) != OS_OK) {
+    sched_yield();
+  }
+}
+
+static void cb_caller(const os_evt_t *evt, void *user_ctx)
+{
+  bus_pending_t *p = user_ctx;
+  const uint8_t *msg = os_evt_data(evt); /* inline payloads are not 4-byte aligned */
+  uint32_t corr;
+  memcpy(&corr, msg + offsetof(bus_msg_t, corr), sizeof(corr));
+  if (corr != p->corr) {
+    return;
+  }
+  memcpy(p->rsp, msg + offsetof(bus_msg_t, data), p->len);
+  sem_post(&p->done);
+}
+
+/* Every other subscriber of the response event reads the id and drops it */
+static void cb_bystander(const os_evt_t *evt, void *user_ctx)
+{
+  const uint32_t *mine = user_ctx;
+  uint32_t corr;
+  memcpy(&corr, os_evt_data(evt), sizeof(corr));
+  bench_sink(corr == *mine ? user_ctx : NULL);
+}
+
+static bool bench_events(size_t payload, unsigned n)
+{
+  static uint32_t bystander_corr[CMD_BENCH_BYSTANDERS];
+  uint8_t rsp[OS_CMD_DATA_MAX];
+  bus_msg_t req;
+  bool ok = true;
+  uint16_t len = (uint16_t)(sizeof(req.corr) + payload);
+
+  os_evt_bus_init();
+  s_payload = payload;
+  sem_init(&s_pending.done, 0, 0);
+  os_evt_bus_subscribe_deferred(CMD_BENCH_REQ_EVT, cb_target, NULL, OS_MOD_IR);
+  os_evt_bus_subscribe(CMD_BENCH_RSP_EVT, cb_caller, &s_pending);
+  for (uint32_t i = 0; i < CMD_BENCH_BYSTANDERS; i++) {
+    os_evt_bus_subscribe(CMD_BENCH_RSP_EVT, cb_bystander, &bystander_corr[i]);
+  }
+  os_evt_bus_start_dispatcher(0, 0);
+  os_evt_bus_start_worker(OS_MOD_IR, 0, 0);
+
+  for (uint32_t i = 0; i < n; i++) {
+    uint64_t t0 = bench_now_ns();
+    req.corr = i + 1u;
+    make_request(req.data, payload, i);
+    s_pending.corr = req.corr;
+    s_pending.rsp = rsp;
+    s_pending.len = payload;
+    ok &= os_evt_bus_publish(OS_MOD_BLE, CMD_BENCH_REQ_EVT, &req, len) == OS_OK;
+    sem_wait(&s_pending.done);
+    ok &= check_response(rsp, payload, i);
+    s_rtt_ns[i] = bench_now_ns() - t0;
+  }
+  os_evt_bus_stop_worker(OS_MOD_IR);
+  os_evt_bus_stop_dispatcher();
+  sem_destroy(&s_pending.done);
+
+  /* Request and response queue entries, the worker handoff (event, callback, context, slot, epoch) and the pool */
+  size_t mem = 2u * sizeof(os_evt_t) + sizeof(os_evt_t) + 2u * sizeof(void *) + 8u + sizeof(bus_pending_t);
+  if (len > OS_EVT_INLINE_MAX) {
+    mem += 2u * OS_EVT_BUS_POOL_BLOCK_SIZE;
+  }
+  report("events", payload, n, mem);
+  return ok;
+}
+
+int main(int argc, char **argv)
+{
+  static const size_t payloads[] = { 4u, 48u };
+  unsigned n = CMD_BENCH_ROUND_TRIPS;
+  int failed = 0;
+
+  if (argc > 2 && strcmp(argv[1], "-n") == 0) {
+    n = (unsigned)strtoul(argv[2], NULL, 0);
+  }
+  s_rtt_ns = calloc(n ? n : 1u, sizeof(*s_rtt_ns));
+  if (n == 0 || s_rtt_ns == NULL) {
+    fprintf(stderr, "usage: %s [-n round_trips]\n", argv[0]);
+    return 2;
+  }
+
+  for (size_t i = 0; i < sizeof(payloads) / sizeof(payloads[0]); i++) {
+    if (!bench_channel(payloads[i], n)) {
+      fprintf(stderr, "channel payload=%u: wrong response\n", (unsigned)payloads[i]);
+      failed = 1;
+    }
+    if (!bench_events(payloads[i], n)) {
+      fprintf(stderr, "events payload=%u: wrong response\n", (unsigned)payloads[i]);
+      failed = 1;
+    }
+  }
+  free(s_rtt_ns);
+  return failed;
+}
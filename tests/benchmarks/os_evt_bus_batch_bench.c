@@ -0,0 +1,153 @@
+/*
+ * os_evt_bus_batch_bench.c — batched dispatch against one event per dispatch
+ *
+ * Usage: os_evt_bus_batch_bench [-n events]
+ *
+ * Every run delivers the same events (an IR send result, three subscribers
+ * each) with os_evt_bus_set_batch() at 1 (one critical section per event
+ * plus one per callback before batching; one per event now), 2, 4 and
+ * OS_EVT_BUS_MAX_BATCH:
+ *
+ *   drain       single thread: fill the lane, os_evt_bus_dispatch_all(),
+ *               repeat; only the dispatch side is timed
+ *   dispatcher  the port's dispatcher thread; this thread publishes as fast
+ *               as the lane takes them (yielding when it is full) and waits
+ *               until the last callback ran
+ *
+ * Reports events/s and CPU per event (process CPU time, so the dispatcher
+ * mode counts the publisher too). Exits non-zero if a run loses or repeats
+ * a callback.
+ */
+
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "os_evt_bus.h"
+#include "bench_time.h"
+
+#define BATCH_BENCH_EVENTS  200000u
+#define BATCH_BENCH_FAN_OUT 3u
+
+static void cb_sink(const os_evt_t *evt, void *user_ctx)
+{
+  (void)user_ctx;
+  bench_sink(evt);
+}
+
+static uint32_t delivered(void)
+{
+  os_evt_bus_stats_t stats;
+  os_evt_bus_get_stats(&stats);
+  return stats.delivered;
+}
+
+static uint64_t cpu_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+typedef struct {
+  double events_per_s;
+  double cpu_ns;
+} batch_result_t;
+
+static void setup(uint32_t batch)
+{
+  os_evt_bus_init();
+  os_evt_bus_set_batch(batch);
+  for (uint32_t i = 0; i < BATCH_BENCH_FAN_OUT; i++) {
+    os_evt_bus_subscribe(EVT_IR_SEND_RESULT, cb_sink, NULL);
+  }
+}
+
+static bool run_drain(uint32_t batch, unsigned events, batch_result_t *out)
+{
+  const evt_ir_send_result_t res = { .result = IR_RES_OK };
+  uint64_t wall = 0, cpu = 0;
+
+  setup(batch);
+  for (unsigned sent = 0; sent < events;) {
+    while (sent < events && os_evt_bus_publish(OS_MOD_IR, EVT_IR_SEND_RESULT, &res, sizeof(res)) == OS_OK) {
+      sent++;
+    }
+    uint64_t w0 = bench_now_ns();
+    uint64_t c0 = cpu_now_ns();
+    os_evt_bus_dispatch_all();
+    cpu += cpu_now_ns() - c0;
+    wall += bench_now_ns() - w0;
+  }
+  out->events_per_s = (double)events * 1e9 / (double)wall;
+  out->cpu_ns = (double)cpu / events;
+  return delivered() == events * BATCH_BENCH_FAN_OUT;
+}
+
+static bool run_dispatcher(uint32_t batch, unsigned events, batch_result_t *out)
+{
+  const evt_ir_send_result_t res = { .result = IR_RES_OK };
+
+  setup(batch);
+  if (os_evt_bus_start_dispatcher(0, 0) != OS_OK) {
+    return false;
+  }
+  uint64_t w0 = bench_now_ns();
+  uint64_t c0 = cpu_now_ns();
+  for (unsigned sent = 0; sent < events;) {
+    if (os_evt_bus_publish(OS_MOD_IR, EVT_IR_SEND_RESULT, &res, sizeof(res)) == OS_OK) {
+      sent++;
+    } else {
+      sched_yield();
+    }
+  }
+  while (delivered() < events * BATCH_BENCH_FAN_OUT) {
+    sched_yield();
+  }
+  uint64_t cpu = cpu_now_ns() - c0;
+  uint64_t wall = bench_now_ns() - w0;
+  os_evt_bus_stop_dispatcher();
+
+  out->events_per_s = (double)events * 1e9 / (double)wall;
+  out->cpu_ns = (double)cpu / events;
+  return delivered() == events * BATCH_BENCH_FAN_OUT;
+}
+
+int main(int argc, char **argv)
+{
+  static const uint32_t batches[] = { 1u, 2u, 4u, OS_EVT_BUS_MAX_BATCH };
+  unsigned events = BATCH_BENCH_EVENTS;
+  int failed = 0;
+
+  if (argc > 2 && strcmp(argv[1], "-n") == 0) {
+    events = (unsigned)strtoul(argv[2], NULL, 0);
+  }
+  if (events == 0) {
+    fprintf(stderr, "usage: %s [-n events]\n", argv[0]);
+    return 2;
+  }
+
+  for (int mode = 0; mode < 2; mode++) {
+    const char *name = mode == 0 ? "drain" : "dispatcher";
+    batch_result_t single = { 0 };
+    for (size_t i = 0; i < sizeof(batches) / sizeof(batches[0]); i++) {
+      batch_result_t r;
+      bool ok = mode == 0 ? run_drain(batches[i], events, &r) : run_dispatcher(batches[i], events, &r);
+      if (!ok) {
+        fprintf(stderr, "%s batch=%u: callbacks lost or repeated\n", name, (unsigned)batches[i]);
+        failed = 1;
+        continue;
+      }
+      if (i == 0) {
+        single = r;
+      }
+      printf("%-10s batch=%2u  %9.0f events/s  cpu=%6.1f ns/event  (x%.2f events/s, x%.2f cpu vs batch=1)\n", name,
+             (unsigned)batches[i], r.events_per_s, r.cpu_ns, r.events_per_s / single.events_per_s,
+             r.cpu_ns / single.cpu_ns);
+    }
+  }
+  return failed;
+}
@@ -0,0 +1,258 @@
+/*
+ * os_evt_bus_bench.c — cost of reporting IR results through the event bus
+ *
+ * Usage: os_evt_bus_bench [-n iterations]
+ *
+ *   hot path   what the capture loop pays per NEC frame: the per-symbol
+ *              printf dump it used to do (written to /dev/null) against one
+ *              copy-in publish of an evt_ir_send_result_t
+ *   latency    a thread standing in for the RMT TX-done ISR publishes with
+ *              os_evt_bus_publish_from_isr() and waits for the subscriber;
+ *              completion to callback on the pthread port, p50/p99/max
+ *   throughput publish + dispatch of one event with one subscriber, no threads
+ *   pool       publish + dispatch of a 128-byte payload fanned out to four
+ *              subscribers from a pool block, against a 16-byte inline one,
+ *              and the queue memory for our event mix: every slot sized for
+ *              the largest payload (before) against 16-byte inline slots plus
+ *              the block pool (after)
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+
+#include "ir_core.h"
+#include "os_evt_bus.h"
+#include "bench_time.h"
+
+#define BUS_BENCH_ITERATIONS 20000u
+#define BUS_BENCH_FAN_OUT    4u
+
+static atomic_uint_fast64_t s_sent_ns;
+static atomic_uint s_done;
+static uint64_t *s_latency_ns;
+static uint32_t s_latency_num;
+
+/* =========================
+ * Subscribers
+ * ========================= */
+static void cb_latency(const os_evt_t *evt, void *user_ctx)
+{
+  (void)evt;
+  (void)user_ctx;
+  s_latency_ns[s_latency_num++] = bench_now_ns() - atomic_load(&s_sent_ns);
+  atomic_store_explicit(&s_done, 1, memory_order_release);
+}
+
+static void cb_sink(const os_evt_t *evt, void *user_ctx)
+{
+  (void)user_ctx;
+  bench_sink(evt);
+}
+
+static void cb_sink_data(const os_evt_t *evt, void *user_ctx)
+{
+  (void)user_ctx;
+  bench_sink(os_evt_data(evt));
+}
+
+/* =========================
+ * Measurements
+ * ========================= */
+static void make_nec_frame(rmt_symbol_word_t *symbols)
+{
+  static const uint8_t bits[4] = { 0x01, 0xFE, 0x8B, 0x74 };
+  symbols[0] = (rmt_symbol_word_t){ .level0 = 0, .duration0 = 9000, .level1 = 1, .duration1 = 4500 };
+  for (int i = 0; i < 32; i++) {
+    bool one = (bits[i / 8] >> (i % 8)) & 1;
+    symbols[1 + i] = (rmt_symbol_word_t){ .level0 = 0, .duration0 = 560, .level1 = 1, .duration1 = one ? 1690 : 560 };
+  }
+  symbols[33] = (rmt_symbol_word_t){ .level0 = 0, .duration0 = 560, .level1 = 1, .duration1 = 0 };
+}
+
+static void bench_hot_path(unsigned iterations)
+{
+  rmt_symbol_word_t frame[NEC_FRAME_SYMBOLS];
+  FILE *null_out = fopen("/dev/null", "w");
+  const evt_ir_send_result_t res = { .result = IR_RES_OK };
+
+  make_nec_frame(frame);
+  if (null_out == NULL) {
+    return;
+  }
+  uint64_t t0 = bench_now_ns();
+  for (unsigned it = 0; it < iterations; it++) {
+    fprintf(null_out, "NEC frame start---\r\n");
+    for (size_t i = 0; i < NEC_FRAME_SYMBOLS; i++) {
+      fprintf(null_out, "{%d:%d},{%d:%d}\r\n", frame[i].level0, frame[i].duration0, frame[i].level1, frame[i].duration1);
+    }
+    fflush(null_out); /* the UART console is unbuffered */
+  }
+  double printf_ns = (double)(bench_now_ns() - t0) / iterations;
+  fclose(null_out);
+
+  os_evt_bus_init();
+  os_evt_bus_subscribe(EVT_IR_SEND_RESULT, cb_sink, NULL);
+  t0 = bench_now_ns();
+  for (unsigned it = 0; it < iterations; it++) {
+    os_evt_bus_publish(OS_MOD_IR, EVT_IR_SEND_RESULT, &res, sizeof(res));
+    if ((it & (OS_EVT_BUS_QUEUE_DEPTH - 1)) == OS_EVT_BUS_QUEUE_DEPTH - 1) {
+      uint64_t d0 = bench_now_ns();
+      os_evt_bus_dispatch_all(); /* the dispatcher's share, not the publisher's */
+      t0 += bench_now_ns() - d0;
+    }
+  }
+  double publish_ns = (double)(bench_now_ns() - t0) / iterations;
+
+  printf("hot path       printf dump/frame=%8.0f ns  publish/frame=%6.1f ns  (%.0fx)\n",
+         printf_ns, publish_ns, printf_ns / publish_ns);
+}
+
+static void *isr_thread(void *arg)
+{
+  unsigned iterations = *(unsigned *)arg;
+  const evt_ir_send_result_t res = { .result = IR_RES_OK };
+
+  for (unsigned it = 0; it < iterations; it++) {
+    bool woken = false;
+    atomic_store_explicit(&s_done, 0, memory_order_relaxed);
+    atomic_store(&s_sent_ns, bench_now_ns());
+    os_evt_bus_publish_from_isr(OS_MOD_IR, EVT_IR_SEND_RESULT, &res, sizeof(res), &woken);
+    while (!atomic_load_explicit(&s_done, memory_order_acquire)) {
+      sched_yield();
+    }
+  }
+  return NULL;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+  uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+  return x < y ? -1 : x > y;
+}
+
+static int bench_latency(unsigned iterations)
+{
+  pthread_t th;
+
+  s_latency_ns = calloc(iterations, sizeof(*s_latency_ns));
+  if (s_latency_ns == NULL) {
+    return 1;
+  }
+  s_latency_num = 0;
+  os_evt_bus_init();
+  os_evt_bus_subscribe(EVT_IR_SEND_RESULT, cb_latency, NULL);
+  os_evt_bus_start_dispatcher(0, 0);
+  pthread_create(&th, NULL, isr_thread, &iterations);
+  pthread_join(th, NULL);
+  os_evt_bus_stop_dispatcher();
+
+  qsort(s_latency_ns, s_latency_num, sizeof(*s_latency_ns), cmp_u64);
+  printf("latency        isr->callback p50=%7.1f us  p99=%7.1f us  max=%8.1f us  (%u events)\n",
+         s_latency_ns[s_latency_num / 2] / 1000.0, s_latency_ns[(s_latency_num * 99) / 100] / 1000.0,
+         s_latency_ns[s_latency_num - 1] / 1000.0, s_latency_num);
+  int failed = s_latency_num != iterations;
+  free(s_latency_ns);
+  return failed;
+}
+
+static void bench_throughput(unsigned iterations)
+{
+  const evt_ir_learn_result_t res = { .result = IR_RES_OK, .slot = 1, .presses = 3, .used = 3, .confidence_pct = 95 };
+  os_evt_bus_stats_t stats;
+
+  os_evt_bus_init();
+  os_evt_bus_subscribe(EVT_IR_LEARN_RESULT, cb_sink, NULL);
+  uint64_t t0 = bench_now_ns();
+  for (unsigned it = 0; it < iterations; it++) {
+    os_evt_bus_publish(OS_MOD_IR, EVT_IR_LEARN_RESULT, &res, sizeof(res));
+    os_evt_bus_dispatch_one();
+  }
+  double ns = (double)(bench_now_ns() - t0) / iterations;
+  os_evt_bus_get_stats(&stats);
+  printf("throughput     publish+dispatch=%6.1f ns/event  delivered=%u  queue=%zu bytes (%u lanes x %u x %zu)\n",
+         ns, (unsigned)stats.delivered, (size_t)OS_EVT_BUS_LANES * OS_EVT_BUS_QUEUE_DEPTH * sizeof(os_evt_t),
+         (unsigned)OS_EVT_BUS_LANES, (unsigned)OS_EVT_BUS_QUEUE_DEPTH, sizeof(os_evt_t));
+}
+
+static double publish_dispatch_ns(unsigned iterations, uint16_t len)
+{
+  static uint8_t payload[OS_EVT_BUS_POOL_BLOCK_SIZE];
+
+  os_evt_bus_init();
+  for (uint32_t i = 0; i < BUS_BENCH_FAN_OUT; i++) {
+    os_evt_bus_subscribe(EVT_STORAGE_CORRUPT, cb_sink_data, NULL);
+  }
+  uint64_t t0 = bench_now_ns();
+  for (unsigned it = 0; it < iterations; it++) {
+    payload[0] = (uint8_t)it;
+    os_evt_bus_publish(OS_MOD_STORAGE, EVT_STORAGE_CORRUPT, payload, len);
+    os_evt_bus_dispatch_one();
+  }
+  return (double)(bench_now_ns() - t0) / iterations;
+}
+
+static int bench_pool(unsigned iterations)
+{
+  /* Payloads our modules publish; the last three do not fit the inline envelope */
+  static const struct {
+    const char *name;
+    size_t bytes;
+  } mix[] = {
+    { "ir_send_result", sizeof(evt_ir_send_result_t) },
+    { "ir_learn_result", sizeof(evt_ir_learn_result_t) },
+    { "ir_slot_written", sizeof(evt_ir_slot_written_t) },
+    { "wifi_state", sizeof(evt_wifi_state_changed_t) },
+    { "ir_learn_detail", 48 }, /* CRC, length, carrier, timing and per-press metadata */
+    { "error_detail", 64 },
+    { "ota_chunk", OS_EVT_BUS_POOL_BLOCK_SIZE },
+  };
+  size_t largest = 0;
+  os_evt_bus_stats_t stats;
+
+  for (size_t i = 0; i < sizeof(mix) / sizeof(mix[0]); i++) {
+    largest = mix[i].bytes > largest ? mix[i].bytes : largest;
+  }
+  size_t slots = (size_t)OS_EVT_BUS_LANES * OS_EVT_BUS_QUEUE_DEPTH;
+  size_t header = offsetof(os_evt_t, payload);
+  size_t bloated = (header + largest + 3u) & ~(size_t)3u;
+  size_t before = slots * bloated;
+  size_t pool = (size_t)OS_EVT_BUS_POOL_BLOCKS * (OS_EVT_BUS_POOL_BLOCK_SIZE + 2u); /* data, refcount, free index */
+  size_t after = slots * sizeof(os_evt_t) + pool;
+
+  double inline_ns = publish_dispatch_ns(iterations, OS_EVT_INLINE_MAX);
+  double pool_ns = publish_dispatch_ns(iterations, OS_EVT_BUS_POOL_BLOCK_SIZE);
+  os_evt_bus_get_stats(&stats);
+
+  printf("pool           %u subscribers: inline %u B=%6.1f ns/event  pooled %u B=%6.1f ns/event\n",
+         (unsigned)BUS_BENCH_FAN_OUT, (unsigned)OS_EVT_INLINE_MAX, inline_ns, (unsigned)OS_EVT_BUS_POOL_BLOCK_SIZE,
+         pool_ns);
+  printf("footprint      queue sized for %zu B payloads=%zu bytes (%zu x %zu)  inline+pool=%zu bytes "
+         "(%zu x %zu + %u x %u B blocks)\n",
+         largest, before, slots, bloated, after, slots, sizeof(os_evt_t), (unsigned)OS_EVT_BUS_POOL_BLOCKS,
+         (unsigned)OS_EVT_BUS_POOL_BLOCK_SIZE);
+  return stats.pool_used != 0 || stats.delivered != iterations * BUS_BENCH_FAN_OUT;
+}
+
+int main(int argc, char **argv)
+{
+  unsigned iterations = BUS_BENCH_ITERATIONS;
+
+  if (argc > 2 && strcmp(argv[1], "-n") == 0) {
+    iterations = (unsigned)strtoul(argv[2], NULL, 0);
+  }
+  if (iterations == 0) {
+    fprintf(stderr, "usage: %s [-n iterations]\n", argv[0]);
+    return 2;
+  }
+
+  bench_hot_path(iterations);
+  int failed = bench_latency(iterations);
+  bench_throughput(iterations);
+  failed |= bench_pool(iterations);
+  return failed;
+}
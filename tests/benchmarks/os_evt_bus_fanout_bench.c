@@ -0,0 +1,187 @@
+/*
+ * os_evt_bus_fanout_bench.c — per-id subscriptions against bitmask subscriptions
+ *
+ * Usage: os_evt_bus_fanout_bench [-n rounds]
+ *
+ * Subscribes the module matrix of docs/DESIGN.md ("Evt Table": which module
+ * follows which event) twice on fresh buses:
+ *
+ *   per_id  one os_evt_bus_subscribe() per (module, event) pair
+ *   mask    one os_evt_bus_subscribe_mask() per module
+ *
+ * then publishes every event once per round and dispatches. Reports the
+ * handles and list entries each model needs, the subscription state they
+ * imply, and publish + dispatch time per event. Both must deliver the same
+ * callbacks; the exit status says whether they did.
+ *
+ * Built against its own copy of the bus with OS_EVT_BUS_MAX_HANDLES raised
+ * so the per-id model fits at all (see CMakeLists.txt).
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "os_evt_bus.h"
+#include "bench_time.h"
+
+#define FANOUT_ROUNDS 20000u
+
+typedef enum {
+  MOD_ORCH = 0,
+  MOD_COMMS,   /* BLE / Wi-Fi comms */
+  MOD_POWER,
+  MOD_ERRMGR,  /* error / alert manager */
+  MOD_CMD,
+  MOD_SCHED,
+  MOD_IR,
+  MOD_AUTH,
+  MOD__NUM
+} bench_mod_t;
+
+#define M(mod) (1u << (mod))
+
+/* DESIGN.md "Subscribed by", per event */
+static const uint32_t s_matrix[EVT__MAX] = {
+  [EVT_AUTH_STATE_CHANGED]     = M(MOD_ORCH) | M(MOD_COMMS),
+  [EVT_BLE_CONN_CHANGED]       = M(MOD_ORCH) | M(MOD_POWER) | M(MOD_ERRMGR),
+  [EVT_BLE_SEC_CHANGED]        = M(MOD_ORCH) | M(MOD_CMD),
+  [EVT_WIFI_STATE_CHANGED]     = M(MOD_ORCH) | M(MOD_POWER) | M(MOD_ERRMGR),
+  [EVT_MQTT_STATE_CHANGED]     = M(MOD_ERRMGR) | M(MOD_ORCH),
+  [EVT_TIME_SYNCED]            = M(MOD_SCHED) | M(MOD_ORCH),
+  [EVT_TIME_JUMPED]            = M(MOD_SCHED) | M(MOD_ORCH) | M(MOD_ERRMGR),
+  [EVT_SCHEDULE_TABLE_UPDATED] = M(MOD_SCHED) | M(MOD_ORCH),
+  [EVT_SCHEDULE_DUE]           = M(MOD_IR) | M(MOD_ORCH),
+  [EVT_IR_LEARN_STARTED]       = M(MOD_POWER) | M(MOD_ERRMGR),
+  [EVT_IR_LEARN_RESULT]        = M(MOD_ORCH) | M(MOD_ERRMGR) | M(MOD_CMD),
+  [EVT_IR_SLOT_WRITTEN]        = M(MOD_SCHED) | M(MOD_ERRMGR),
+  [EVT_IR_SEND_STARTED]        = M(MOD_POWER),
+  [EVT_IR_SEND_RESULT]         = M(MOD_ERRMGR) | M(MOD_ORCH),
+  [EVT_STORAGE_CORRUPT]        = M(MOD_ORCH) | M(MOD_ERRMGR),
+  [EVT_STORAGE_FULL]           = M(MOD_ORCH) | M(MOD_ERRMGR),
+  [EVT_FACTORY_RESET_DONE]     = M(MOD_COMMS) | M(MOD_SCHED) | M(MOD_IR) | M(MOD_AUTH),
+  [EVT_POWER_MODE_CHANGED]     = M(MOD_ORCH) | M(MOD_IR) | M(MOD_SCHED) | M(MOD_COMMS),
+  [EVT_BATTERY_STATE]          = M(MOD_ORCH) | M(MOD_ERRMGR),
+  [EVT_OTA_AVAILABLE]          = M(MOD_ORCH) | M(MOD_ERRMGR) | M(MOD_COMMS),
+  [EVT_OTA_START]              = M(MOD_ORCH) | M(MOD_ERRMGR) | M(MOD_COMMS),
+  [EVT_OTA_PROGRESS]           = M(MOD_ORCH) | M(MOD_ERRMGR) | M(MOD_COMMS),
+  [EVT_OTA_DONE]               = M(MOD_ORCH) | M(MOD_ERRMGR) | M(MOD_COMMS),
+  [EVT_CMD_REJECTED]           = M(MOD_ERRMGR) | M(MOD_COMMS),
+  [EVT_WATCHDOG_WARNING]       = M(MOD_ERRMGR) | M(MOD_ORCH),
+  [EVT_HEALTH_TICK]            = M(MOD_ERRMGR) | M(MOD_ORCH),
+};
+
+/* Mirror of the bus's handle record, for the memory estimate */
+typedef struct {
+  os_evt_cb_t cb;
+  void *user_ctx;
+  os_evt_id_t id;
+  uint8_t gen;
+  bool active;
+} bench_handle_t;
+
+typedef struct {
+  const char *name;
+  uint32_t handles;
+  uint32_t entries;       /* list entries in use */
+  size_t table_bytes;     /* lists the model needs, sized for its worst case */
+  double ns_per_event;
+  uint64_t delivered[MOD__NUM];
+} fanout_run_t;
+
+static uint64_t s_calls[MOD__NUM];
+
+static void cb_module(const os_evt_t *evt, void *user_ctx)
+{
+  (void)evt;
+  s_calls[(uintptr_t)user_ctx]++;
+}
+
+static bool subscribe_matrix(bool by_mask, fanout_run_t *run)
+{
+  uint32_t fanout_max = 0;
+
+  for (uint32_t m = 0; m < MOD__NUM; m++) {
+    os_evt_mask_t mask = 0;
+    for (os_evt_id_t id = EVT_NONE + 1; id < EVT__MAX; id++) {
+      if (!(s_matrix[id] & M(m))) {
+        continue;
+      }
+      if (!by_mask) {
+        if (!os_evt_bus_handle_valid(os_evt_bus_subscribe(id, cb_module, (void *)(uintptr_t)m))) {
+          return false;
+        }
+        run->handles++;
+        run->entries++;
+      }
+      mask |= OS_EVT_BIT(id);
+    }
+    if (by_mask && mask != 0) {
+      if (!os_evt_bus_handle_valid(os_evt_bus_subscribe_mask(mask, cb_module, (void *)(uintptr_t)m))) {
+        return false;
+      }
+      run->handles++;
+      run->entries++;
+    }
+  }
+  for (os_evt_id_t id = EVT_NONE + 1; id < EVT__MAX; id++) {
+    uint32_t fanout = (uint32_t)__builtin_popcount(s_matrix[id]);
+    fanout_max = fanout > fanout_max ? fanout : fanout_max;
+  }
+  run->table_bytes = by_mask ? run->entries * (sizeof(uint16_t) + sizeof(os_evt_mask_t))
+                             : (size_t)(EVT__MAX - 1) * fanout_max * sizeof(uint16_t);
+  return true;
+}
+
+static bool run_fanout(bool by_mask, unsigned rounds, fanout_run_t *run)
+{
+  os_evt_bus_init();
+  memset(s_calls, 0, sizeof(s_calls));
+  if (!subscribe_matrix(by_mask, run)) {
+    return false;
+  }
+
+  uint64_t t0 = bench_now_ns();
+  for (unsigned r = 0; r < rounds; r++) {
+    for (os_evt_id_t id = EVT_NONE + 1; id < EVT__MAX; id++) {
+      os_evt_bus_publish(OS_MOD_MONITOR, id, NULL, 0);
+      os_evt_bus_dispatch_one();
+    }
+  }
+  run->ns_per_event = (double)(bench_now_ns() - t0) / ((double)rounds * (EVT__MAX - 1));
+  memcpy(run->delivered, s_calls, sizeof(s_calls));
+  return true;
+}
+
+int main(int argc, char **argv)
+{
+  unsigned rounds = FANOUT_ROUNDS;
+  fanout_run_t runs[2] = { { .name = "per_id" }, { .name = "mask" } };
+
+  if (argc > 2 && strcmp(argv[1], "-n") == 0) {
+    rounds = (unsigned)strtoul(argv[2], NULL, 0);
+  }
+  if (rounds == 0) {
+    fprintf(stderr, "usage: %s [-n rounds]\n", argv[0]);
+    return 2;
+  }
+
+  for (int i = 0; i < 2; i++) {
+    fanout_run_t *run = &runs[i];
+    if (!run_fanout(i == 1, rounds, run)) {
+      fprintf(stderr, "%s: subscription table full\n", run->name);
+      return 1;
+    }
+    size_t state = run->handles * sizeof(bench_handle_t) + run->table_bytes;
+    printf("%-7s handles=%3u entries=%3u  state=%5zu bytes (%u x %zu handle + %zu list)  dispatch=%6.1f ns/event\n",
+           run->name, run->handles, run->entries, state, run->handles, sizeof(bench_handle_t), run->table_bytes,
+           run->ns_per_event);
+  }
+
+  int failed = memcmp(runs[0].delivered, runs[1].delivered, sizeof(runs[0].delivered)) != 0;
+  if (failed) {
+    fprintf(stderr, "per-id and mask subscriptions delivered different callbacks\n");
+  }
+  return failed;
+}
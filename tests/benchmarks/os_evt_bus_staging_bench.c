@@ -0,0 +1,200 @@
+/*
+ * os_evt_bus_staging_bench.c — staged publishes against the single queue
+ *
+ * Usage: os_evt_bus_staging_bench [-n events]
+ *
+ * 1, 2, 4 and 8 publisher threads share the events (an IR send result
+ * carrying publisher and sequence number, one subscriber) and publish as
+ * fast as the bus takes them, yielding on OS_EFULL. A drain thread calls
+ * os_evt_bus_dispatch_all() in a loop instead of the port's dispatcher, so
+ * the numbers show the publish path and not condition variable wakeups.
+ * Each thread count runs twice:
+ *
+ *   queue    os_evt_bus_set_staging(false): every publish takes the bus lock
+ *   staged   os_evt_bus_set_staging(true): publishes go to the thread's
+ *            staging ring, the drain thread merges them under the lock
+ *
+ * Reports events/s, CPU per event (process CPU time, so publishers and
+ * drain thread together) and the OS_EFULL retries. Built against its own
+ * copy of the bus with one staging ring per thread. Exits non-zero if a
+ * run loses an event or delivers a publisher's events out of order.
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "os_evt_bus.h"
+#include "bench_time.h"
+
+#define STAGING_BENCH_EVENTS  200000u
+#define STAGING_BENCH_THREADS 8u
+
+_Static_assert(OS_EVT_BUS_STAGE_RINGS >= STAGING_BENCH_THREADS, "one staging ring per publisher thread");
+
+typedef struct {
+  uint32_t pub;
+  uint32_t seq;
+} staging_payload_t;
+
+typedef struct {
+  uint32_t pub;
+  uint32_t events;
+  uint32_t retries;
+} publisher_t;
+
+static atomic_uint s_received;
+static atomic_uint s_out_of_order;
+static atomic_uint s_ready;
+static atomic_bool s_go;
+static atomic_bool s_stop;
+static uint32_t s_next[STAGING_BENCH_THREADS];
+
+static void cb_check_order(const os_evt_t *evt, void *user_ctx)
+{
+  staging_payload_t p;
+  (void)user_ctx;
+  memcpy(&p, evt->payload, sizeof(p));
+  if (p.pub >= STAGING_BENCH_THREADS || p.seq != s_next[p.pub]) {
+    atomic_fetch_add(&s_out_of_order, 1);
+  } else {
+    s_next[p.pub] = p.seq + 1;
+  }
+  atomic_fetch_add(&s_received, 1);
+}
+
+static void *publisher_thread(void *arg)
+{
+  publisher_t *ctx = arg;
+  staging_payload_t p = { .pub = ctx->pub };
+
+  atomic_fetch_add(&s_ready, 1);
+  while (!atomic_load(&s_go)) {
+    sched_yield();
+  }
+  for (p.seq = 0; p.seq < ctx->events; p.seq++) {
+    while (os_evt_bus_publish(OS_MOD_IR, EVT_IR_SEND_RESULT, &p, sizeof(p)) == OS_EFULL) {
+      ctx->retries++;
+      sched_yield();
+    }
+  }
+  return NULL;
+}
+
+static uint64_t cpu_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void *drain_thread(void *arg)
+{
+  (void)arg;
+  while (!atomic_load(&s_stop)) {
+    if (os_evt_bus_dispatch_all() == 0) {
+      sched_yield();
+    }
+  }
+  return NULL;
+}
+
+typedef struct {
+  double events_per_s;
+  double cpu_ns;
+  uint32_t retries;
+} staging_result_t;
+
+static bool run(bool staging, uint32_t threads, unsigned events, staging_result_t *out)
+{
+  pthread_t th[STAGING_BENCH_THREADS], drain;
+  publisher_t pub[STAGING_BENCH_THREADS];
+  unsigned total = 0;
+
+  os_evt_bus_init();
+  if (os_evt_bus_set_staging(staging) != OS_OK) {
+    return false;
+  }
+  os_evt_bus_subscribe(EVT_IR_SEND_RESULT, cb_check_order, NULL);
+  atomic_store(&s_received, 0);
+  atomic_store(&s_out_of_order, 0);
+  atomic_store(&s_ready, 0);
+  atomic_store(&s_go, false);
+  memset(s_next, 0, sizeof(s_next));
+  atomic_store(&s_stop, false);
+  pthread_create(&drain, NULL, drain_thread, NULL);
+
+  for (uint32_t i = 0; i < threads; i++) {
+    pub[i] = (publisher_t){ .pub = i, .events = events / threads };
+    total += pub[i].events;
+    pthread_create(&th[i], NULL, publisher_thread, &pub[i]);
+  }
+  while (atomic_load(&s_ready) < threads) {
+    sched_yield();
+  }
+  uint64_t w0 = bench_now_ns();
+  uint64_t c0 = cpu_now_ns();
+  atomic_store(&s_go, true);
+  for (uint32_t i = 0; i < threads; i++) {
+    pthread_join(th[i], NULL);
+  }
+  while (atomic_load(&s_received) < total) {
+    sched_yield();
+  }
+  uint64_t cpu = cpu_now_ns() - c0;
+  uint64_t wall = bench_now_ns() - w0;
+  atomic_store(&s_stop, true);
+  pthread_join(drain, NULL);
+
+  out->retries = 0;
+  for (uint32_t i = 0; i < threads; i++) {
+    out->retries += pub[i].retries;
+  }
+  out->events_per_s = (double)total * 1e9 / (double)wall;
+  out->cpu_ns = (double)cpu / total;
+
+  os_evt_bus_stats_t stats;
+  os_evt_bus_get_stats(&stats);
+  return stats.delivered == total && atomic_load(&s_out_of_order) == 0 &&
+         stats.staged == (staging ? total : 0u);
+}
+
+int main(int argc, char **argv)
+{
+  static const uint32_t threads[] = { 1u, 2u, 4u, 8u };
+  unsigned events = STAGING_BENCH_EVENTS;
+  int failed = 0;
+
+  if (argc > 2 && strcmp(argv[1], "-n") == 0) {
+    events = (unsigned)strtoul(argv[2], NULL, 0);
+  }
+  if (events < STAGING_BENCH_THREADS) {
+    fprintf(stderr, "usage: %s [-n events]\n", argv[0]);
+    return 2;
+  }
+
+  for (size_t i = 0; i < sizeof(threads) / sizeof(threads[0]); i++) {
+    staging_result_t r[2];
+    for (int mode = 0; mode < 2; mode++) {
+      if (!run(mode == 1, threads[i], events, &r[mode])) {
+        fprintf(stderr, "%s threads=%u: events lost or reordered\n", mode ? "staged" : "queue",
+                (unsigned)threads[i]);
+        failed = 1;
+      }
+    }
+    for (int mode = 0; mode < 2; mode++) {
+      printf("%-6s threads=%u  %9.0f events/s  cpu=%6.1f ns/event  %7u retries", mode ? "staged" : "queue",
+             (unsigned)threads[i], r[mode].events_per_s, r[mode].cpu_ns, (unsigned)r[mode].retries);
+      if (mode) {
+        printf("  (x%.2f events/s vs queue)", r[1].events_per_s / r[0].events_per_s);
+      }
+      printf("\n");
+    }
+  }
+  return failed;
+}
@@ -0,0 +1,249 @@
+/*
+ * os_evt_bus_storm_bench.c — event bus under a state-event storm
+ *
+ * Usage: os_evt_bus_storm_bench [-n results]
+ *
+ * Runs on a virtual microsecond clock, single threaded, so the numbers are
+ * reproducible: every microsecond the storm publishers run, then the
+ * dispatcher takes one event if its previous callback (DISPATCH_US long) is
+ * over. The storm is OTA progress bursts (1/us for 1 ms of every 5 ms) plus
+ * battery, health tick and Wi-Fi state at steady rates, and command
+ * rejections (1 per 3 us for 2 ms of every 5 ms) in the normal lane; the
+ * results that must get through are an IR send result every 250 us and a
+ * schedule due every 1 ms. Payloads carry their publish time.
+ *
+ * Every run uses the same storm:
+ *   drop_new/fifo      every id FIFO, DROP_NEW when a lane is full, lanes
+ *                      served in arrival order (no priority)
+ *   coalesce/fifo      ids with the table's coalesce flag coalesce, the rest FIFO
+ *   coalesce/strict    plus strict lane priority (OS_EVT_SCHED_STRICT)
+ *   coalesce/weighted  plus weighted lanes (OS_EVT_SCHED_WEIGHTED)
+ *
+ * Reports per lane how many were published, dropped (and merged, for the
+ * whole run), promoted past a higher lane, and the publish -> callback
+ * latency p50/p99/max; for coalesced state the latency is the age of the
+ * value delivered. Exits non-zero if coalescing loses a result or makes
+ * results slower, or if strict priority loses a high-lane event or makes
+ * the high lane slower than arrival order.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "os_evt_bus.h"
+#include "bench_time.h"
+
+#define STORM_RESULTS       2000u
+#define STORM_DISPATCH_US   4u
+#define STORM_RESULT_US     250u
+#define STORM_DUE_US        1000u
+#define STORM_BURST_PERIOD  5000u
+#define STORM_BURST_US      1000u
+#define STORM_CMD_START     2500u
+#define STORM_CMD_US        2000u
+#define STORM_CMD_EVERY     3u
+#define STORM_RUNS          4
+
+typedef struct {
+  uint32_t published_us;
+  uint32_t seq;
+} storm_payload_t;
+
+typedef struct {
+  uint32_t published;
+  uint32_t dropped;
+  uint32_t *latency_us;
+  uint32_t delivered;
+  uint32_t cap;
+} storm_class_t;
+
+typedef struct {
+  const char *name;
+  bool coalesce;
+  os_evt_sched_t sched;
+  storm_class_t lane[OS_EVT_BUS_LANES];
+  os_evt_bus_stats_t stats;
+  double ns_per_op;
+} storm_run_t;
+
+static uint32_t s_now_us;
+
+/* =========================
+ * Storm
+ * ========================= */
+static void cb_record(const os_evt_t *evt, void *user_ctx)
+{
+  storm_class_t *cls = user_ctx;
+  storm_payload_t p;
+  memcpy(&p, evt->payload, sizeof(p));
+  if (cls->delivered < cls->cap) {
+    cls->latency_us[cls->delivered] = s_now_us - p.published_us;
+  }
+  cls->delivered++;
+}
+
+static void publish(storm_run_t *run, os_mod_id_t src, os_evt_id_t id)
+{
+  storm_class_t *cls = &run->lane[os_evt_bus_lane_of(id)];
+  storm_payload_t p = { .published_us = s_now_us, .seq = cls->published + cls->dropped };
+  if (os_evt_bus_publish(src, id, &p, sizeof(p)) == OS_OK) {
+    cls->published++;
+  } else {
+    cls->dropped++;
+  }
+}
+
+static void run_storm(unsigned results, storm_run_t *run)
+{
+  static const os_evt_id_t state_ids[] = { EVT_WIFI_STATE_CHANGED, EVT_BATTERY_STATE, EVT_OTA_PROGRESS, EVT_HEALTH_TICK };
+  static const os_evt_id_t other_ids[] = { EVT_CMD_REJECTED, EVT_IR_SEND_RESULT, EVT_SCHEDULE_DUE };
+  uint32_t duration_us = results * STORM_RESULT_US;
+  uint32_t busy_until = 0;
+  uint64_t ops = 0;
+
+  os_evt_bus_init();
+  os_evt_bus_set_sched(run->sched);
+  for (size_t i = 0; i < sizeof(state_ids) / sizeof(state_ids[0]); i++) {
+    if (!run->coalesce) {
+      os_evt_bus_set_policy(state_ids[i], OS_EVT_POLICY_FIFO);
+    }
+    os_evt_bus_subscribe(state_ids[i], cb_record, &run->lane[os_evt_bus_lane_of(state_ids[i])]);
+  }
+  for (size_t i = 0; i < sizeof(other_ids) / sizeof(other_ids[0]); i++) {
+    os_evt_bus_subscribe(other_ids[i], cb_record, &run->lane[os_evt_bus_lane_of(other_ids[i])]);
+  }
+
+  uint64_t t0 = bench_now_ns();
+  for (s_now_us = 0; s_now_us < duration_us; s_now_us++) {
+    uint32_t t = s_now_us;
+    if (t % STORM_BURST_PERIOD < STORM_BURST_US) {
+      publish(run, OS_MOD_OTA, EVT_OTA_PROGRESS);
+      ops++;
+    }
+    if (t % 50u == 0) {
+      publish(run, OS_MOD_POWER, EVT_BATTERY_STATE);
+      ops++;
+    }
+    if (t % 100u == 7) {
+      publish(run, OS_MOD_MONITOR, EVT_HEALTH_TICK);
+      ops++;
+    }
+    if (t % 500u == 13) {
+      publish(run, OS_MOD_WIFI, EVT_WIFI_STATE_CHANGED);
+      ops++;
+    }
+    if (t % STORM_BURST_PERIOD - STORM_CMD_START < STORM_CMD_US && t % STORM_CMD_EVERY == 0) {
+      publish(run, OS_MOD_CMD, EVT_CMD_REJECTED);
+      ops++;
+    }
+    if (t % STORM_RESULT_US == 3) {
+      publish(run, OS_MOD_IR, EVT_IR_SEND_RESULT);
+      ops++;
+    }
+    if (t % STORM_DUE_US == 500) {
+      publish(run, OS_MOD_SCHED, EVT_SCHEDULE_DUE);
+      ops++;
+    }
+    if (t >= busy_until && os_evt_bus_dispatch_one()) {
+      busy_until = t + STORM_DISPATCH_US;
+      ops++;
+    }
+  }
+  /* Drain what is left, still on the virtual clock */
+  while (os_evt_bus_dispatch_one()) {
+    s_now_us += STORM_DISPATCH_US;
+    ops++;
+  }
+  run->ns_per_op = (double)(bench_now_ns() - t0) / (double)ops;
+
+  os_evt_bus_get_stats(&run->stats);
+}
+
+/* =========================
+ * Report
+ * ========================= */
+static int cmp_u32(const void *a, const void *b)
+{
+  uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+  return x < y ? -1 : x > y;
+}
+
+static uint32_t pct(const storm_class_t *cls, unsigned p)
+{
+  uint32_t n = cls->delivered < cls->cap ? cls->delivered : cls->cap;
+  return n ? cls->latency_us[(n - 1) * p / 100] : 0;
+}
+
+static void print_lane(const storm_run_t *run, uint32_t l)
+{
+  static const char *const lane_names[] = { "high", "normal", "low", "bulk" };
+  const storm_class_t *cls = &run->lane[l];
+  uint32_t n = cls->delivered < cls->cap ? cls->delivered : cls->cap;
+  qsort(cls->latency_us, n, sizeof(*cls->latency_us), cmp_u32);
+  printf("%-17s %-6s published=%7u dropped=%6u promoted=%5u delivered=%7u latency_us p50=%5u p99=%5u max=%5u\n",
+         run->name, l + 1u == OS_EVT_BUS_LANES ? "low" : lane_names[l], cls->published, cls->dropped,
+         run->stats.lane[l].promoted, cls->delivered, pct(cls, 50), pct(cls, 99), pct(cls, 100));
+}
+
+static bool alloc_class(storm_class_t *cls, uint32_t cap)
+{
+  memset(cls, 0, sizeof(*cls));
+  cls->cap = cap;
+  cls->latency_us = calloc(cap, sizeof(*cls->latency_us));
+  return cls->latency_us != NULL;
+}
+
+int main(int argc, char **argv)
+{
+  unsigned results = STORM_RESULTS;
+  storm_run_t runs[STORM_RUNS] = {
+    { .name = "drop_new/fifo", .coalesce = false, .sched = OS_EVT_SCHED_FIFO },
+    { .name = "coalesce/fifo", .coalesce = true, .sched = OS_EVT_SCHED_FIFO },
+    { .name = "coalesce/strict", .coalesce = true, .sched = OS_EVT_SCHED_STRICT },
+    { .name = "coalesce/weighted", .coalesce = true, .sched = OS_EVT_SCHED_WEIGHTED },
+  };
+
+  if (argc > 2 && strcmp(argv[1], "-n") == 0) {
+    results = (unsigned)strtoul(argv[2], NULL, 0);
+  }
+  if (results == 0) {
+    fprintf(stderr, "usage: %s [-n results]\n", argv[0]);
+    return 2;
+  }
+
+  for (int m = 0; m < STORM_RUNS; m++) {
+    storm_run_t *run = &runs[m];
+    for (uint32_t l = 0; l < OS_EVT_BUS_LANES; l++) {
+      if (!alloc_class(&run->lane[l], results * STORM_RESULT_US)) {
+        return 1;
+      }
+    }
+    run_storm(results, run);
+    for (uint32_t l = 0; l < OS_EVT_BUS_LANES; l++) {
+      print_lane(run, l);
+    }
+    printf("%-17s merged=%u  lane high water=%u/%u  %.1f ns per publish/dispatch\n", run->name,
+           run->stats.coalesced, run->stats.high_water, (unsigned)OS_EVT_BUS_QUEUE_DEPTH, run->ns_per_op);
+  }
+
+  const storm_class_t *drop_high = &runs[0].lane[OS_EVT_LANE_HIGH];
+  const storm_class_t *fifo_high = &runs[1].lane[OS_EVT_LANE_HIGH];
+  const storm_class_t *strict_high = &runs[2].lane[OS_EVT_LANE_HIGH];
+  int failed = 0;
+  if (fifo_high->dropped != 0 || pct(fifo_high, 99) > pct(drop_high, 99)) {
+    fprintf(stderr, "coalescing lost or delayed results\n");
+    failed = 1;
+  }
+  if (strict_high->dropped != 0 || pct(strict_high, 99) > pct(fifo_high, 99)) {
+    fprintf(stderr, "strict lanes lost or delayed high-priority events\n");
+    failed = 1;
+  }
+  for (int m = 0; m < STORM_RUNS; m++) {
+    for (uint32_t l = 0; l < OS_EVT_BUS_LANES; l++) {
+      free(runs[m].lane[l].latency_us);
+    }
+  }
+  return failed;
+}
@@ -0,0 +1,194 @@
+/*
+ * os_evt_trace_bench.c — cost of the event bus trace ring, and a sample dump
+ *
+ * Usage: os_evt_trace_bench [-n events] [-o dump.bin]
+ *
+ *   record     os_evt_trace_record() in a loop, and what the port clock
+ *              read (CLOCK_MONOTONIC here, the cycle counter on target)
+ *              accounts for of it
+ *   traffic    the port's dispatcher thread fed by this thread with a mix of
+ *              IR results, coalesced battery/health state, OTA progress
+ *              bursts and a command-rejection flood that overruns its lane.
+ *              The ring is dumped every BENCH_DUMP_EVERY publishes, as a
+ *              host tool polling the UART would; with -o the dumps are
+ *              appended to a file for components/retrofit_os/tools/
+ *              os_evt_trace_decode.py
+ *
+ * Exits non-zero if a dump is malformed.
+ */
+
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "os_evt_bus.h"
+#include "os_evt_trace.h"
+#include "bench_time.h"
+
+#define BENCH_EVENTS     20000u
+#define BENCH_RECORDS    1000000u
+#define BENCH_DUMP_EVERY 48u
+#define BENCH_CB_SPIN_NS 2000u
+
+typedef struct {
+  FILE *out;
+  uint32_t bytes;
+  uint32_t valid;
+  uint32_t last_stamp;
+  bool bad;
+} dump_ctx_t;
+
+static void cb_work(const os_evt_t *evt, void *user_ctx)
+{
+  (void)user_ctx;
+  uint64_t until = bench_now_ns() + BENCH_CB_SPIN_NS;
+  while (bench_now_ns() < until) {
+  }
+  bench_sink(evt);
+}
+
+static void dump_write(const void *data, size_t len, void *user_ctx)
+{
+  dump_ctx_t *ctx = user_ctx;
+  if (ctx->bytes == 0) {
+    os_evt_trace_hdr_t hdr;
+    memcpy(&hdr, data, sizeof(hdr));
+    ctx->bad |= len != sizeof(hdr) || hdr.magic != OS_EVT_TRACE_MAGIC || hdr.rec_size != sizeof(os_evt_trace_rec_t);
+  } else {
+    os_evt_trace_rec_t rec;
+    memcpy(&rec, data, sizeof(rec));
+    ctx->bad |= len != sizeof(rec);
+    /* Valid records come out in claim order */
+    if (rec.stamp != 0) {
+      ctx->bad |= ctx->last_stamp != 0 && rec.stamp <= ctx->last_stamp;
+      ctx->last_stamp = rec.stamp;
+      ctx->valid++;
+    }
+  }
+  ctx->bytes += (uint32_t)len;
+  if (ctx->out != NULL) {
+    fwrite(data, 1, len, ctx->out);
+  }
+}
+
+static void bench_record(void)
+{
+  os_evt_trace_reset();
+  uint64_t t0 = bench_now_ns();
+  for (uint32_t i = 0; i < BENCH_RECORDS; i++) {
+    os_evt_trace_record(OS_EVT_TRACE_PUBLISH, EVT_HEALTH_TICK, OS_MOD_MONITOR, i, 0);
+  }
+  double record_ns = (double)(bench_now_ns() - t0) / BENCH_RECORDS;
+
+  t0 = bench_now_ns();
+  for (uint32_t i = 0; i < BENCH_RECORDS; i++) {
+    bench_sink((void *)(uintptr_t)bench_now_ns());
+  }
+  double clock_ns = (double)(bench_now_ns() - t0) / BENCH_RECORDS;
+
+  printf("record         %5.1f ns/record, of which clock read %5.1f ns; ring %u x %zu B = %zu B\n", record_ns,
+         clock_ns, (unsigned)OS_EVT_TRACE_RECORDS, sizeof(os_evt_trace_rec_t),
+         (size_t)OS_EVT_TRACE_RECORDS * sizeof(os_evt_trace_rec_t));
+}
+
+static void publish_retry(os_mod_id_t src, os_evt_id_t id, const void *payload, uint16_t len)
+{
+  while (os_evt_bus_publish(src, id, payload, len) == OS_EFULL) {
+    sched_yield();
+  }
+}
+
+static int bench_traffic(unsigned events, FILE *out)
+{
+  const evt_ir_send_result_t res = { .result = IR_RES_OK };
+  const evt_cmd_rejected_t rej = { 0 };
+  os_evt_bus_stats_t stats;
+  dump_ctx_t ctx = { .out = out };
+  uint32_t dumps = 0;
+  int failed = 0;
+
+  os_evt_bus_init();
+  for (os_evt_id_t id = EVT_NONE + 1; id < EVT__MAX; id++) {
+    os_evt_bus_subscribe(id, cb_work, NULL);
+  }
+  if (os_evt_bus_start_dispatcher(0, 0) != OS_OK) {
+    return 1;
+  }
+
+  for (unsigned i = 0; i < events; i++) {
+    if (i % 10u == 0) {
+      publish_retry(OS_MOD_IR, EVT_IR_SEND_RESULT, &res, sizeof(res));
+    } else if (i % 500u < 40u) {
+      os_evt_bus_publish(OS_MOD_CMD, EVT_CMD_REJECTED, &rej, sizeof(rej)); /* flood: drops expected */
+    } else if (i % 200u < 20u) {
+      os_evt_publish_ota_progress();
+    } else if (i % 3u == 0) {
+      os_evt_publish_battery_state();
+    } else if (i % 3u == 1) {
+      os_evt_publish_health_tick();
+    } else {
+      publish_retry(OS_MOD_SCHED, EVT_SCHEDULE_TABLE_UPDATED, NULL, 0);
+    }
+    if (i % BENCH_DUMP_EVERY == BENCH_DUMP_EVERY - 1u) {
+      ctx.bytes = 0;
+      ctx.last_stamp = 0;
+      os_evt_trace_dump(dump_write, &ctx);
+      dumps++;
+    }
+    if (i % 8u == 7u && i % 500u >= 40u) {
+      sched_yield(); /* let the dispatcher keep up on a single core, except during the flood */
+    }
+  }
+  /* The dispatcher drains the lanes before it notices the stop */
+  os_evt_bus_stop_dispatcher();
+  os_evt_bus_get_stats(&stats);
+  ctx.bytes = 0;
+  ctx.last_stamp = 0;
+  os_evt_trace_dump(dump_write, &ctx);
+  dumps++;
+
+  printf("traffic        %u publishes: %u accepted (%u merged), %u refused as full (retries included), "
+         "%u dispatched\n", events, (unsigned)stats.published, (unsigned)stats.coalesced, (unsigned)stats.dropped,
+         (unsigned)stats.dispatched);
+  printf("dumps          %u dumps, %u valid records (overlapping dumps repeat records)\n", dumps,
+         (unsigned)ctx.valid);
+  if (ctx.bad) {
+    fprintf(stderr, "malformed trace dump\n");
+    failed = 1;
+  }
+  return failed;
+}
+
+int main(int argc, char **argv)
+{
+  unsigned events = BENCH_EVENTS;
+  const char *out_path = NULL;
+
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (strcmp(argv[i], "-n") == 0) {
+      events = (unsigned)strtoul(argv[i + 1], NULL, 0);
+    } else if (strcmp(argv[i], "-o") == 0) {
+      out_path = argv[i + 1];
+    } else {
+      events = 0;
+    }
+  }
+  if (events == 0) {
+    fprintf(stderr, "usage: %s [-n events] [-o dump.bin]\n", argv[0]);
+    return 2;
+  }
+
+  FILE *out = NULL;
+  if (out_path != NULL && (out = fopen(out_path, "wb")) == NULL) {
+    perror(out_path);
+    return 1;
+  }
+  bench_record();
+  int failed = bench_traffic(events, out);
+  if (out != NULL) {
+    fclose(out);
+  }
+  return failed;
+}
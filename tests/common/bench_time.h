@@ -0,0 +1,23 @@
+/*
+ * bench_time.h — monotonic clock helpers for host benchmarks
+ */
+#ifndef BENCH_TIME_H
+#define BENCH_TIME_H
+
+#include <stdint.h>
+#include <time.h>
+
+static inline uint64_t bench_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* Keeps the optimizer from discarding benchmark results */
+static inline void bench_sink(const void *p)
+{
+  __asm__ __volatile__("" : : "r"(p) : "memory");
+}
+
+#endif /* BENCH_TIME_H */
@@ -0,0 +1,87 @@
+/*
+ * capture_file.c — loader for recorded RMT captures (host only)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "capture_file.h"
+
+static int push_frame(capture_set_t *set, rmt_symbol_word_t *symbols, size_t n)
+{
+  if (set->frame_num == set->frame_cap) {
+    size_t cap = set->frame_cap ? set->frame_cap * 2u : 16u;
+    capture_frame_t *f = realloc(set->frames, cap * sizeof(*f));
+    if (!f) return -1;
+    set->frames = f;
+    set->frame_cap = cap;
+  }
+  set->frames[set->frame_num].symbols = symbols;
+  set->frames[set->frame_num].symbol_num = n;
+  set->frame_num++;
+  set->symbol_total += n;
+  return 0;
+}
+
+int capture_file_load(const char *path, capture_set_t *set)
+{
+  FILE *fp = fopen(path, "r");
+  if (!fp) return -1;
+
+  char line[256];
+  rmt_symbol_word_t *cur = NULL;
+  size_t n = 0, cap = 0;
+  int in_frame = 0;
+  int frames = 0;
+
+  while (fgets(line, sizeof(line), fp)) {
+    if (strstr(line, "frame start---")) {
+      in_frame = 1;
+      cur = NULL;
+      n = cap = 0;
+      continue;
+    }
+    if (!in_frame) continue;
+
+    if (strstr(line, "---") && strstr(line, "frame end")) {
+      in_frame = 0;
+      if (n > 0 && push_frame(set, cur, n) == 0) {
+        frames++;
+      } else {
+        free(cur);
+      }
+      cur = NULL;
+      continue;
+    }
+
+    const char *p = strchr(line, '{');
+    unsigned l0, d0, l1, d1;
+    if (!p || sscanf(p, "{%u:%u},{%u:%u}", &l0, &d0, &l1, &d1) != 4) continue;
+
+    if (n == cap) {
+      cap = cap ? cap * 2u : 64u;
+      rmt_symbol_word_t *s = realloc(cur, cap * sizeof(*s));
+      if (!s) break;
+      cur = s;
+    }
+    cur[n].level0 = l0 & 1u;
+    cur[n].duration0 = d0 & 0x7FFFu;
+    cur[n].level1 = l1 & 1u;
+    cur[n].duration1 = d1 & 0x7FFFu;
+    n++;
+  }
+
+  free(in_frame ? cur : NULL);
+  fclose(fp);
+  return frames;
+}
+
+void capture_set_free(capture_set_t *set)
+{
+  for (size_t i = 0; i < set->frame_num; i++) {
+    free(set->frames[i].symbols);
+  }
+  free(set->frames);
+  memset(set, 0, sizeof(*set));
+}
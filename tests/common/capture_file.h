@@ -0,0 +1,38 @@
+/*
+ * capture_file.h — loader for recorded RMT captures
+ *
+ * Captures are plain `idf.py monitor` logs of the infrared_test app. Every
+ * frame is delimited by the lines the app prints in example_parse_nec_frame():
+ *
+ *   NEC frame start---
+ *   {0:9012},{1:4478}
+ *   ...
+ *   ---NEC frame end: ...
+ *
+ * Any other line (boot log, timestamps, '#' comments) is ignored, so raw
+ * monitor output can be dropped into tests/captures/ as-is.
+ */
+#ifndef CAPTURE_FILE_H
+#define CAPTURE_FILE_H
+
+#include <stddef.h>
+
+#include "ir_rmt_types.h"
+
+typedef struct {
+  rmt_symbol_word_t *symbols;
+  size_t             symbol_num;
+} capture_frame_t;
+
+typedef struct {
+  capture_frame_t *frames;
+  size_t           frame_num;
+  size_t           frame_cap;
+  size_t           symbol_total;
+} capture_set_t;
+
+/* Append every frame found in `path` to `set`; returns frames read or -1 */
+int  capture_file_load(const char *path, capture_set_t *set);
+void capture_set_free(capture_set_t *set);
+
+#endif /* CAPTURE_FILE_H */
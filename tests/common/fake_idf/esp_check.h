@@ -0,0 +1,30 @@
+/*
+ * esp_check.h — host stand-in for the ESP-IDF error-check macros
+ */
+#ifndef FAKE_IDF_ESP_CHECK_H
+#define FAKE_IDF_ESP_CHECK_H
+
+#include <stdio.h>
+
+#include "esp_err.h"
+
+#define ESP_LOGE(tag, fmt, ...) fprintf(stderr, "E (%s) " fmt "\n", tag, ##__VA_ARGS__)
+
+#define ESP_GOTO_ON_FALSE(a, err_code, goto_tag, log_tag, fmt, ...) do { \
+    if (!(a)) {                                                         \
+      ESP_LOGE(log_tag, fmt, ##__VA_ARGS__);                            \
+      ret = (err_code);                                                 \
+      goto goto_tag;                                                    \
+    }                                                                   \
+  } while (0)
+
+#define ESP_GOTO_ON_ERROR(x, goto_tag, log_tag, fmt, ...) do { \
+    esp_err_t err_rc_ = (x);                                   \
+    if (err_rc_ != ESP_OK) {                                   \
+      ESP_LOGE(log_tag, fmt, ##__VA_ARGS__);                   \
+      ret = err_rc_;                                           \
+      goto goto_tag;                                           \
+    }                                                          \
+  } while (0)
+
+#endif /* FAKE_IDF_ESP_CHECK_H */
@@ -0,0 +1,15 @@
+/*
+ * esp_err.h — host stand-in for the ESP-IDF error codes used by app encoders
+ */
+#ifndef FAKE_IDF_ESP_ERR_H
+#define FAKE_IDF_ESP_ERR_H
+
+typedef int esp_err_t;
+
+#define ESP_OK                0
+#define ESP_FAIL              -1
+#define ESP_ERR_NO_MEM        0x101
+#define ESP_ERR_INVALID_ARG   0x102
+#define ESP_ERR_INVALID_STATE 0x103
+
+#endif /* FAKE_IDF_ESP_ERR_H */
@@ -0,0 +1,195 @@
+/*
+ * fake_rmt_tx.c — host model of an RMT TX channel for encoder tests
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "fake_rmt_tx.h"
+
+/* =========================
+ * Copy encoder
+ * ========================= */
+typedef struct {
+  rmt_encoder_t base;
+  size_t        last_symbol_index;
+} fake_copy_encoder_t;
+
+static size_t fake_copy_encode(rmt_encoder_t *encoder, rmt_channel_handle_t channel, const void *primary_data,
+                               size_t data_size, rmt_encode_state_t *ret_state)
+{
+  fake_copy_encoder_t *copy = __containerof(encoder, fake_copy_encoder_t, base);
+  const rmt_symbol_word_t *symbols = primary_data;
+  size_t symbol_num = data_size / sizeof(rmt_symbol_word_t);
+  rmt_encode_state_t state = RMT_ENCODING_RESET;
+
+  size_t free_symbols = channel->mem_symbols - channel->mem_off;
+  size_t left = symbol_num - copy->last_symbol_index;
+  size_t n = left < free_symbols ? left : free_symbols;
+
+  memcpy(&channel->mem[channel->mem_off], &symbols[copy->last_symbol_index], n * sizeof(rmt_symbol_word_t));
+  channel->mem_off += n;
+  copy->last_symbol_index += n;
+
+  if (copy->last_symbol_index == symbol_num) {
+    copy->last_symbol_index = 0;
+    state |= RMT_ENCODING_COMPLETE;
+  }
+  if (channel->mem_off == channel->mem_symbols) {
+    state |= RMT_ENCODING_MEM_FULL;
+  }
+  *ret_state = state;
+  return n;
+}
+
+static esp_err_t fake_copy_reset(rmt_encoder_t *encoder)
+{
+  __containerof(encoder, fake_copy_encoder_t, base)->last_symbol_index = 0;
+  return ESP_OK;
+}
+
+static esp_err_t fake_copy_del(rmt_encoder_t *encoder)
+{
+  free(__containerof(encoder, fake_copy_encoder_t, base));
+  return ESP_OK;
+}
+
+esp_err_t rmt_new_copy_encoder(const rmt_copy_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder)
+{
+  (void)config;
+  fake_copy_encoder_t *copy = calloc(1, sizeof(*copy));
+  if (!copy) {
+    return ESP_ERR_NO_MEM;
+  }
+  copy->base.encode = fake_copy_encode;
+  copy->base.reset = fake_copy_reset;
+  copy->base.del = fake_copy_del;
+  *ret_encoder = &copy->base;
+  return ESP_OK;
+}
+
+/* =========================
+ * Bytes encoder
+ * ========================= */
+typedef struct {
+  rmt_encoder_t     base;
+  rmt_symbol_word_t bit0;
+  rmt_symbol_word_t bit1;
+  bool              msb_first;
+  size_t            last_bit_index;
+} fake_bytes_encoder_t;
+
+static size_t fake_bytes_encode(rmt_encoder_t *encoder, rmt_channel_handle_t channel, const void *primary_data,
+                                size_t data_size, rmt_encode_state_t *ret_state)
+{
+  fake_bytes_encoder_t *bytes = __containerof(encoder, fake_bytes_encoder_t, base);
+  const uint8_t *data = primary_data;
+  size_t bit_num = data_size * 8;
+  size_t n = 0;
+  rmt_encode_state_t state = RMT_ENCODING_RESET;
+
+  while (bytes->last_bit_index < bit_num && channel->mem_off < channel->mem_symbols) {
+    size_t i = bytes->last_bit_index++;
+    unsigned shift = bytes->msb_first ? 7 - (unsigned)(i % 8) : (unsigned)(i % 8);
+    channel->mem[channel->mem_off++] = (data[i / 8] >> shift) & 1u ? bytes->bit1 : bytes->bit0;
+    n++;
+  }
+
+  if (bytes->last_bit_index == bit_num) {
+    bytes->last_bit_index = 0;
+    state |= RMT_ENCODING_COMPLETE;
+  }
+  if (channel->mem_off == channel->mem_symbols) {
+    state |= RMT_ENCODING_MEM_FULL;
+  }
+  *ret_state = state;
+  return n;
+}
+
+static esp_err_t fake_bytes_reset(rmt_encoder_t *encoder)
+{
+  __containerof(encoder, fake_bytes_encoder_t, base)->last_bit_index = 0;
+  return ESP_OK;
+}
+
+static esp_err_t fake_bytes_del(rmt_encoder_t *encoder)
+{
+  free(__containerof(encoder, fake_bytes_encoder_t, base));
+  return ESP_OK;
+}
+
+esp_err_t rmt_new_bytes_encoder(const rmt_bytes_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder)
+{
+  fake_bytes_encoder_t *bytes = calloc(1, sizeof(*bytes));
+  if (!bytes) {
+    return ESP_ERR_NO_MEM;
+  }
+  bytes->base.encode = fake_bytes_encode;
+  bytes->base.reset = fake_bytes_reset;
+  bytes->base.del = fake_bytes_del;
+  bytes->bit0 = config->bit0;
+  bytes->bit1 = config->bit1;
+  bytes->msb_first = config->flags.msb_first;
+  *ret_encoder = &bytes->base;
+  return ESP_OK;
+}
+
+/* =========================
+ * Common
+ * ========================= */
+esp_err_t rmt_del_encoder(rmt_encoder_handle_t encoder)
+{
+  return encoder->del(encoder);
+}
+
+esp_err_t rmt_encoder_reset(rmt_encoder_handle_t encoder)
+{
+  return encoder->reset(encoder);
+}
+
+void *rmt_alloc_encoder_mem(size_t size)
+{
+  return calloc(1, size);
+}
+
+/* =========================
+ * Channel
+ * ========================= */
+void fake_rmt_tx_init(fake_rmt_tx_t *tx, rmt_symbol_word_t *mem, size_t mem_symbols,
+                      rmt_symbol_word_t *out, size_t out_cap)
+{
+  memset(tx, 0, sizeof(*tx));
+  tx->chan.mem = mem;
+  tx->chan.mem_symbols = mem_symbols;
+  tx->out = out;
+  tx->out_cap = out_cap;
+}
+
+static void fake_rmt_tx_flush(fake_rmt_tx_t *tx)
+{
+  for (size_t i = 0; i < tx->chan.mem_off; i++) {
+    if (tx->out_num < tx->out_cap) {
+      tx->out[tx->out_num++] = tx->chan.mem[i];
+    } else {
+      tx->overflow = true;
+    }
+  }
+  tx->chan.mem_off = 0;
+}
+
+bool fake_rmt_tx_run(fake_rmt_tx_t *tx, rmt_encoder_t *encoder, const void *data, size_t data_size)
+{
+  rmt_encode_state_t state = RMT_ENCODING_RESET;
+
+  for (;;) {
+    tx->encode_calls++;
+    tx->encoded += encoder->encode(encoder, &tx->chan, data, data_size, &state);
+    if (state & RMT_ENCODING_COMPLETE) {
+      fake_rmt_tx_flush(tx);
+      return true;
+    }
+    if (!(state & RMT_ENCODING_MEM_FULL)) {
+      return false; /* the driver would wait forever for a refill that never comes */
+    }
+    fake_rmt_tx_flush(tx);
+  }
+}
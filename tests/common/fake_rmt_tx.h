@@ -0,0 +1,41 @@
+/*
+ * fake_rmt_tx.h — host model of an RMT TX channel for encoder tests
+ *
+ * The channel owns mem_block_symbols of "RMT memory". The fake copy encoder
+ * writes into it like the driver's and reports RMT_ENCODING_MEM_FULL when it
+ * fills up; fake_rmt_tx_run() then "transmits" the block (appends it to the
+ * output and empties it) and calls the encoder again, the way the TX-done
+ * interrupt refills a ping-pong half.
+ */
+#ifndef FAKE_RMT_TX_H
+#define FAKE_RMT_TX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "driver/rmt_encoder.h"
+
+struct rmt_channel_t {
+  rmt_symbol_word_t *mem;
+  size_t             mem_symbols;
+  size_t             mem_off;
+};
+
+typedef struct {
+  struct rmt_channel_t chan;
+  rmt_symbol_word_t   *out;         /* transmitted symbols */
+  size_t               out_cap;
+  size_t               out_num;
+  size_t               encode_calls;
+  size_t               encoded;     /* sum of the encoder's return values */
+  bool                 overflow;    /* out_cap was too small */
+} fake_rmt_tx_t;
+
+/* mem and out are caller-owned */
+void fake_rmt_tx_init(fake_rmt_tx_t *tx, rmt_symbol_word_t *mem, size_t mem_symbols,
+                      rmt_symbol_word_t *out, size_t out_cap);
+
+/* One transaction: encode until complete; returns false if the encoder stalls */
+bool fake_rmt_tx_run(fake_rmt_tx_t *tx, rmt_encoder_t *encoder, const void *data, size_t data_size);
+
+#endif /* FAKE_RMT_TX_H */
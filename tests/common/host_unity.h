@@ -0,0 +1,101 @@
+/*
+ * host_unity.h — minimal Unity-compatible assertions for host builds
+ *
+ * Implements the subset of the Unity API used by the on-target test apps so
+ * that the same test bodies compile on a plain host toolchain without
+ * pulling ESP-IDF's unity component. Output follows Unity's summary format
+ * so the pytest log parsing keeps working.
+ */
+#ifndef HOST_UNITY_H
+#define HOST_UNITY_H
+
+#include <setjmp.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef struct {
+  const char *cur_test;
+  unsigned    tests;
+  unsigned    failures;
+  unsigned    ignored;
+  jmp_buf     abort_frame;
+} host_unity_t;
+
+extern host_unity_t g_host_unity;
+
+/* Define once per test executable (the file that holds main()) */
+#define HOST_UNITY_INSTANCE host_unity_t g_host_unity
+
+static inline void host_unity_fail(const char *file, int line, const char *msg)
+{
+  printf("%s:%d:%s:FAIL: %s\n", file, line, g_host_unity.cur_test, msg);
+  g_host_unity.failures++;
+  longjmp(g_host_unity.abort_frame, 1);
+}
+
+#define UNITY_BEGIN() ((void)memset(&g_host_unity, 0, sizeof(g_host_unity)))
+
+#define UNITY_END()                                                          \
+  (printf("\n-----------------------\n%u Tests %u Failures %u Ignored\n%s\n",  \
+          g_host_unity.tests, g_host_unity.failures, g_host_unity.ignored,   \
+          g_host_unity.failures ? "FAIL" : "OK"),                            \
+   (int)g_host_unity.failures)
+
+#define RUN_TEST(fn)                                                         \
+  do {                                                                       \
+    g_host_unity.cur_test = #fn;                                             \
+    g_host_unity.tests++;                                                    \
+    unsigned fails_before_ = g_host_unity.failures;                          \
+    if (setjmp(g_host_unity.abort_frame) == 0) { fn(); }                     \
+    if (g_host_unity.failures == fails_before_) {                            \
+      printf("%s:%d:%s:PASS\n", __FILE__, __LINE__, #fn);                    \
+    }                                                                        \
+  } while (0)
+
+#define TEST_FAIL_MESSAGE(msg) host_unity_fail(__FILE__, __LINE__, (msg))
+
+#define TEST_ASSERT_TRUE_MESSAGE(cond, msg) \
+  do { if (!(cond)) host_unity_fail(__FILE__, __LINE__, (msg)); } while (0)
+#define TEST_ASSERT_TRUE(cond)   TEST_ASSERT_TRUE_MESSAGE((cond), "Expected TRUE: " #cond)
+#define TEST_ASSERT_FALSE(cond)  TEST_ASSERT_TRUE_MESSAGE(!(cond), "Expected FALSE: " #cond)
+#define TEST_ASSERT(cond)        TEST_ASSERT_TRUE(cond)
+#define TEST_ASSERT_NOT_NULL(p)  TEST_ASSERT_TRUE_MESSAGE((p) != NULL, "Expected non-NULL: " #p)
+#define TEST_ASSERT_NULL(p)      TEST_ASSERT_TRUE_MESSAGE((p) == NULL, "Expected NULL: " #p)
+
+#define HOST_UNITY_CMP(exp, act, cast, fmt)                                   \
+  do {                                                                        \
+    cast e_ = (cast)(exp), a_ = (cast)(act);                                  \
+    if (e_ != a_) {                                                           \
+      char m_[128];                                                           \
+      snprintf(m_, sizeof(m_), "Expected " fmt " Was " fmt " (%s)",           \
+               e_, a_, #act);                                                 \
+      host_unity_fail(__FILE__, __LINE__, m_);                                \
+    }                                                                         \
+  } while (0)
+
+#define TEST_ASSERT_EQUAL_INT(e, a)    HOST_UNITY_CMP((e), (a), long long, "%lld")
+#define TEST_ASSERT_EQUAL(e, a)        TEST_ASSERT_EQUAL_INT((e), (a))
+#define TEST_ASSERT_EQUAL_UINT32(e, a) HOST_UNITY_CMP((e), (a), unsigned long long, "%llu")
+#define TEST_ASSERT_EQUAL_UINT16(e, a) TEST_ASSERT_EQUAL_UINT32((uint16_t)(e), (uint16_t)(a))
+#define TEST_ASSERT_EQUAL_UINT8(e, a)  TEST_ASSERT_EQUAL_UINT32((uint8_t)(e), (uint8_t)(a))
+#define TEST_ASSERT_EQUAL_HEX16(e, a)  HOST_UNITY_CMP((uint16_t)(e), (uint16_t)(a), unsigned, "0x%04X")
+#define TEST_ASSERT_EQUAL_HEX32(e, a)  HOST_UNITY_CMP((e), (a), unsigned long, "0x%08lX")
+
+#define TEST_ASSERT_EQUAL_UINT32_MESSAGE(e, a, msg) \
+  TEST_ASSERT_TRUE_MESSAGE((uint32_t)(e) == (uint32_t)(a), (msg))
+
+#define TEST_ASSERT_GREATER_THAN_INT(threshold, actual) \
+  TEST_ASSERT_TRUE_MESSAGE((long long)(actual) > (long long)(threshold), "Expected " #actual " > " #threshold)
+#define TEST_ASSERT_LESS_OR_EQUAL_UINT32(threshold, actual) \
+  TEST_ASSERT_TRUE_MESSAGE((uint32_t)(actual) <= (uint32_t)(threshold), "Expected " #actual " <= " #threshold)
+#define TEST_ASSERT_UINT32_WITHIN(delta, exp, act)                             \
+  TEST_ASSERT_TRUE_MESSAGE(((long long)(act) - (long long)(exp)) <= (long long)(delta) && \
+                           ((long long)(exp) - (long long)(act)) <= (long long)(delta),   \
+                           "Expected " #act " within " #delta " of " #exp)
+
+#define TEST_ASSERT_EQUAL_UINT8_ARRAY(exp, act, n) \
+  TEST_ASSERT_TRUE_MESSAGE(memcmp((exp), (act), (n)) == 0, "Arrays differ: " #act)
+#define TEST_ASSERT_EQUAL_MEMORY(exp, act, n) TEST_ASSERT_EQUAL_UINT8_ARRAY((exp), (act), (n))
+
+#endif /* HOST_UNITY_H */
@@ -0,0 +1,233 @@
+/*
+ * test_ir_capture.c — host unit tests for streaming capture assembly
+ *
+ * Synthetic minisplit-style captures (up to 500 symbols, several sub-frames)
+ * are cut into RMT-sized chunks and timestamped the way the partial-receive
+ * callback would see them.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "host_unity.h"
+#include "ir_capture.h"
+
+HOST_UNITY_INSTANCE;
+
+#define CAP_RES_HZ       1000000u
+#define CAP_IDLE_US      12000u
+#define CAP_FRAME_GAP_US 100000u
+#define CAP_CHUNK        64u
+
+/* =========================
+ * Helpers
+ * ========================= */
+static rmt_symbol_word_t s_wave[600];
+
+/* Daikin-like sub-frame: leader, pulse-distance bits, trailing mark */
+static size_t build_subframe(rmt_symbol_word_t *out, size_t symbol_num, uint32_t seed)
+{
+    out[0] = (rmt_symbol_word_t){ .level0 = 0, .duration0 = 3500, .level1 = 1, .duration1 = 1700 };
+    for (size_t i = 1; i + 1 < symbol_num; i++) {
+        seed = seed * 1103515245u + 12345u;
+        out[i] = (rmt_symbol_word_t){ .level0 = 0, .duration0 = 430, .level1 = 1,
+                                      .duration1 = (seed >> 16) & 1u ? 1300 : 430 };
+    }
+    out[symbol_num - 1] = (rmt_symbol_word_t){ .level0 = 0, .duration0 = 430, .level1 = 1, .duration1 = 0 };
+    return symbol_num;
+}
+
+static uint32_t wave_us(const rmt_symbol_word_t *s, size_t n)
+{
+    uint32_t t = 0;
+    for (size_t i = 0; i < n; i++) {
+        t += s[i].duration0 + s[i].duration1;
+    }
+    return t;
+}
+
+/*
+ * Feed one sub-frame starting at *t_us in CAP_CHUNK pieces; advances *t_us to
+ * its last edge. Returns the first non-OK status, or OK.
+ */
+static ir_capture_status_t feed_subframe(ir_capture_t *cap, const rmt_symbol_word_t *s, size_t n, uint32_t *t_us)
+{
+    ir_capture_status_t result = IR_CAPTURE_OK;
+    for (size_t off = 0; off < n; off += CAP_CHUNK) {
+        size_t len = n - off < CAP_CHUNK ? n - off : CAP_CHUNK;
+        bool last = off + len == n;
+        *t_us += wave_us(&s[off], len);
+        ir_capture_status_t st = ir_capture_push(cap, &s[off], len, last, *t_us + (last ? CAP_IDLE_US : 0));
+        if (st != IR_CAPTURE_OK && result == IR_CAPTURE_OK) {
+            result = st;
+        }
+        if (st == IR_CAPTURE_NEW_FRAME) {
+            break;
+        }
+    }
+    return result;
+}
+
+static ir_capture_config_t heap_cfg(size_t max_symbols)
+{
+    ir_capture_config_t cfg = {
+        .resolution_hz = CAP_RES_HZ,
+        .idle_us = CAP_IDLE_US,
+        .frame_gap_us = CAP_FRAME_GAP_US,
+        .max_symbols = max_symbols,
+    };
+    return cfg;
+}
+
+/* =========================
+ * Test cases
+ * ========================= */
+static void test_500_symbol_frame_assembled(void)
+{
+    ir_capture_t cap;
+    ir_capture_config_t cfg = heap_cfg(1024);
+    uint32_t t = 1000;
+    size_t n;
+
+    build_subframe(s_wave, 500, 1);
+    TEST_ASSERT_TRUE(ir_capture_init(&cap, &cfg));
+    TEST_ASSERT_EQUAL_INT(IR_CAPTURE_OK, feed_subframe(&cap, s_wave, 500, &t));
+
+    const rmt_symbol_word_t *syms = ir_capture_symbols(&cap, &n);
+    TEST_ASSERT_EQUAL_UINT32(500, n);
+    TEST_ASSERT_EQUAL_MEMORY(s_wave, syms, 500 * sizeof(rmt_symbol_word_t));
+    TEST_ASSERT_EQUAL_UINT32(1, cap.seg_num);
+    TEST_ASSERT_EQUAL_UINT32(512, cap.arena_cap); /* grown 128 -> 256 -> 512 */
+    TEST_ASSERT_EQUAL_UINT32(0, cap.clipped_symbols);
+
+    ir_capture_deinit(&cap);
+}
+
+static void test_subframes_and_gaps_recorded(void)
+{
+    static const size_t lens[3] = { 20, 20, 460 };
+    static const uint32_t gaps[3] = { 0, 25000, 35000 };
+    ir_capture_t cap;
+    ir_capture_config_t cfg = heap_cfg(1024);
+    uint32_t t = 5000;
+    size_t off = 0;
+
+    TEST_ASSERT_TRUE(ir_capture_init(&cap, &cfg));
+    for (int i = 0; i < 3; i++) {
+        build_subframe(&s_wave[off], lens[i], (uint32_t)i + 7);
+        t += gaps[i];
+        TEST_ASSERT_EQUAL_INT(IR_CAPTURE_OK, feed_subframe(&cap, &s_wave[off], lens[i], &t));
+        off += lens[i];
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(3, cap.seg_num);
+    TEST_ASSERT_EQUAL_UINT32(500, cap.used);
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL_UINT32(gaps[i], cap.segs[i].gap_us);
+        TEST_ASSERT_EQUAL_UINT32(lens[i], cap.segs[i].symbol_num);
+    }
+    TEST_ASSERT_EQUAL_UINT32(40, cap.segs[2].offset);
+    TEST_ASSERT_EQUAL_MEMORY(s_wave, cap.arena, 500 * sizeof(rmt_symbol_word_t));
+
+    /* Complete only once the line has been idle for frame_gap_us */
+    TEST_ASSERT_FALSE(ir_capture_is_complete(&cap, t + CAP_FRAME_GAP_US - 1));
+    TEST_ASSERT_TRUE(ir_capture_is_complete(&cap, t + CAP_FRAME_GAP_US));
+
+    ir_capture_deinit(&cap);
+}
+
+static void test_long_gap_starts_new_capture(void)
+{
+    ir_capture_t cap;
+    ir_capture_config_t cfg = heap_cfg(1024);
+    uint32_t t = 0xFFFF0000u; /* timestamps wrap during the test */
+
+    build_subframe(s_wave, 100, 3);
+    TEST_ASSERT_TRUE(ir_capture_init(&cap, &cfg));
+    TEST_ASSERT_EQUAL_INT(IR_CAPTURE_OK, feed_subframe(&cap, s_wave, 100, &t));
+
+    t += CAP_FRAME_GAP_US + 5000;
+    uint32_t t_retry = t;
+    TEST_ASSERT_EQUAL_INT(IR_CAPTURE_NEW_FRAME, feed_subframe(&cap, s_wave, 100, &t));
+    TEST_ASSERT_EQUAL_UINT32(100, cap.used); /* rejected chunk not appended */
+
+    ir_capture_reset(&cap);
+    TEST_ASSERT_EQUAL_INT(IR_CAPTURE_OK, feed_subframe(&cap, s_wave, 100, &t_retry));
+    TEST_ASSERT_EQUAL_UINT32(1, cap.seg_num);
+    TEST_ASSERT_EQUAL_UINT32(0, cap.segs[0].gap_us);
+
+    ir_capture_deinit(&cap);
+}
+
+static void test_fixed_arena_is_bounded(void)
+{
+    static rmt_symbol_word_t arena[256];
+    ir_capture_t cap;
+    ir_capture_config_t cfg = heap_cfg(0);
+    uint32_t t = 0;
+
+    cfg.arena = arena;
+    cfg.arena_symbols = 256;
+    build_subframe(s_wave, 500, 9);
+    TEST_ASSERT_TRUE(ir_capture_init(&cap, &cfg));
+    TEST_ASSERT_EQUAL_INT(IR_CAPTURE_CLIPPED, feed_subframe(&cap, s_wave, 500, &t));
+
+    TEST_ASSERT_EQUAL_UINT32(256, cap.used);
+    TEST_ASSERT_EQUAL_UINT32(244, cap.clipped_symbols);
+    TEST_ASSERT_FALSE(cap.seg_open); /* the final chunk still closes the sub-frame */
+    TEST_ASSERT_EQUAL_MEMORY(s_wave, arena, 256 * sizeof(rmt_symbol_word_t));
+
+    ir_capture_deinit(&cap);
+}
+
+static void test_heap_arena_stops_at_max(void)
+{
+    ir_capture_t cap;
+    ir_capture_config_t cfg = heap_cfg(300);
+    uint32_t t = 0;
+
+    build_subframe(s_wave, 500, 11);
+    TEST_ASSERT_TRUE(ir_capture_init(&cap, &cfg));
+    TEST_ASSERT_EQUAL_INT(IR_CAPTURE_CLIPPED, feed_subframe(&cap, s_wave, 500, &t));
+    TEST_ASSERT_EQUAL_UINT32(300, cap.arena_cap);
+    TEST_ASSERT_EQUAL_UINT32(300, cap.used);
+    TEST_ASSERT_EQUAL_UINT32(200, cap.clipped_symbols);
+
+    ir_capture_deinit(&cap);
+}
+
+static void test_segment_table_overflow(void)
+{
+    ir_capture_t cap;
+    ir_capture_config_t cfg = heap_cfg(1024);
+    uint32_t t = 0;
+
+    build_subframe(s_wave, 10, 13);
+    TEST_ASSERT_TRUE(ir_capture_init(&cap, &cfg));
+    for (int i = 0; i < IR_CAPTURE_MAX_SEGS; i++) {
+        t += 20000;
+        TEST_ASSERT_EQUAL_INT(IR_CAPTURE_OK, feed_subframe(&cap, s_wave, 10, &t));
+    }
+    t += 20000;
+    TEST_ASSERT_EQUAL_INT(IR_CAPTURE_CLIPPED, feed_subframe(&cap, s_wave, 10, &t));
+    TEST_ASSERT_EQUAL_UINT32(IR_CAPTURE_MAX_SEGS, cap.seg_num);
+    TEST_ASSERT_EQUAL_UINT32(10, cap.clipped_symbols);
+
+    ir_capture_deinit(&cap);
+}
+
+/* =========================
+ * Unity test runner
+ * ========================= */
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_500_symbol_frame_assembled);
+    RUN_TEST(test_subframes_and_gaps_recorded);
+    RUN_TEST(test_long_gap_starts_new_capture);
+    RUN_TEST(test_fixed_arena_is_bounded);
+    RUN_TEST(test_heap_arena_stops_at_max);
+    RUN_TEST(test_segment_table_overflow);
+    return UNITY_END();
+}
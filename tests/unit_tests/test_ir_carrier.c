@@ -0,0 +1,187 @@
+/*
+ * test_ir_carrier.c — host unit tests for carrier measurement
+ *
+ * The edge streams are synthesized the way an unfiltered receiver on a 10 MHz
+ * RMT channel sees a remote: every mark of an ir_pd waveform is a burst of
+ * carrier periods (active low, one RMT symbol per period, +-1 tick of edge
+ * jitter), and the channel stops receiving at the first space, leaving an
+ * end marker.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "host_unity.h"
+#include "capture_file.h"
+#include "ir_pd.h"
+#include "ir_carrier.h"
+
+HOST_UNITY_INSTANCE;
+
+#define CAR_RES_HZ      10000000u
+#define CAR_ENV_RES_HZ  1000000u
+#define CAR_MAX_SYMBOLS 8192u
+#define CAR_CHUNK       64u
+
+static rmt_symbol_word_t s_env[IR_PD_MAX_BYTES * 8 + 2];
+static rmt_symbol_word_t s_edges[CAR_MAX_SYMBOLS];
+
+/* =========================
+ * Helpers
+ * ========================= */
+static uint32_t s_rng = 1;
+
+static int32_t jitter(void)
+{
+    s_rng = s_rng * 1103515245u + 12345u;
+    return (int32_t)((s_rng >> 16) % 3u) - 1;
+}
+
+/*
+ * One receive per mark of the envelope: the carrier periods of the mark,
+ * the last off phase cut by the end marker. Returns the symbols written.
+ */
+static size_t modulate(const rmt_symbol_word_t *env, size_t env_num, uint32_t carrier_hz, uint8_t duty_pct,
+                       rmt_symbol_word_t *out, size_t cap)
+{
+    double period = (double)CAR_RES_HZ / carrier_hz;
+    double on = period * duty_pct / 100.0;
+    size_t n = 0;
+
+    for (size_t i = 0; i < env_num; i++) {
+        double mark = (double)env[i].duration0 * (CAR_RES_HZ / CAR_ENV_RES_HZ);
+        size_t periods = (size_t)(mark / period + 0.5);
+        double t = 0;
+        for (size_t k = 0; k < periods && n < cap; k++) {
+            /* Edges sit on the ideal grid, rounded to ticks, plus jitter */
+            uint32_t rise = (uint32_t)(t + 0.5);
+            uint32_t fall = (uint32_t)(t + on + 0.5);
+            uint32_t next = (uint32_t)(t + period + 0.5);
+            int32_t d0 = (int32_t)(fall - rise) + jitter();
+            int32_t d1 = (int32_t)(next - fall) + jitter();
+            out[n].level0 = 0;
+            out[n].duration0 = (uint32_t)(d0 > 1 ? d0 : 1);
+            out[n].level1 = 1;
+            out[n].duration1 = k + 1 == periods ? 0 : (uint32_t)(d1 > 1 ? d1 : 1);
+            n++;
+            t += period;
+        }
+    }
+    return n;
+}
+
+static size_t nec_edges(uint32_t carrier_hz, uint8_t duty_pct)
+{
+    static const uint8_t data[4] = { 0x01, 0xFE, 0x8B, 0x74 };
+    size_t env_num = ir_pd_expand(&ir_pd_nec, CAR_ENV_RES_HZ, data, sizeof(data), s_env, sizeof(s_env) / sizeof(s_env[0]));
+    TEST_ASSERT_GREATER_THAN_INT(0, (int)env_num);
+    return modulate(s_env, env_num, carrier_hz, duty_pct, s_edges, CAR_MAX_SYMBOLS);
+}
+
+/* =========================
+ * Test cases
+ * ========================= */
+static void test_measures_common_carriers(void)
+{
+    static const struct {
+        uint32_t hz;
+        uint8_t duty;
+    } carriers[] = {
+        { 36000, 33 }, { 38000, 33 }, { 38000, 50 }, { 40000, 25 }, { 56000, 33 }, { 455000, 50 },
+    };
+
+    for (size_t c = 0; c < sizeof(carriers) / sizeof(carriers[0]); c++) {
+        size_t n = nec_edges(carriers[c].hz, carriers[c].duty);
+        ir_carrier_meter_t m;
+        ir_carrier_t res;
+
+        /* Streamed in partial-receive chunks */
+        ir_carrier_meter_init(&m, CAR_RES_HZ, 0);
+        for (size_t i = 0; i < n; i += CAR_CHUNK) {
+            ir_carrier_meter_push(&m, &s_edges[i], n - i < CAR_CHUNK ? n - i : CAR_CHUNK);
+        }
+        TEST_ASSERT_TRUE(ir_carrier_meter_result(&m, &res));
+
+        uint32_t max_err_hz = carriers[c].hz / 200; /* 0.5% */
+        if (max_err_hz < IR_CARRIER_ROUND_HZ) {
+            max_err_hz = IR_CARRIER_ROUND_HZ;
+        }
+        TEST_ASSERT_UINT32_WITHIN(max_err_hz, carriers[c].hz, res.freq_hz);
+        TEST_ASSERT_UINT32_WITHIN(3, carriers[c].duty, res.duty_pct);
+        TEST_ASSERT_EQUAL_UINT32(0, res.freq_hz % IR_CARRIER_ROUND_HZ);
+        TEST_ASSERT_GREATER_THAN_INT(300, (int)res.periods);
+    }
+}
+
+static void test_active_high_input(void)
+{
+    size_t n = nec_edges(38000, 33);
+    ir_carrier_t res;
+
+    /* Same stream from an active-high receiver: the on phase is level 1 */
+    for (size_t i = 0; i < n; i++) {
+        s_edges[i].level0 = 1;
+        s_edges[i].level1 = 0;
+    }
+    TEST_ASSERT_TRUE(ir_carrier_measure(s_edges, n, CAR_RES_HZ, 1, &res));
+    TEST_ASSERT_EQUAL_UINT32(38000, res.freq_hz);
+    TEST_ASSERT_UINT32_WITHIN(3, 33, res.duty_pct);
+
+    /* Wrong polarity swaps on and off */
+    TEST_ASSERT_TRUE(ir_carrier_measure(s_edges, n, CAR_RES_HZ, 0, &res));
+    TEST_ASSERT_UINT32_WITHIN(3, 67, res.duty_pct);
+}
+
+static void test_glitches_rejected(void)
+{
+    size_t n = nec_edges(40000, 33);
+    ir_carrier_meter_t m;
+    ir_carrier_t res;
+
+    /* Every 10th period after the first few is split by an in-band glitch */
+    for (size_t i = 40; i < n; i += 10) {
+        if (s_edges[i].duration1 != 0) {
+            s_edges[i].duration1 = 20;
+        }
+    }
+    ir_carrier_meter_init(&m, CAR_RES_HZ, 0);
+    ir_carrier_meter_push(&m, s_edges, n);
+    TEST_ASSERT_GREATER_THAN_INT(0, (int)m.rejected);
+    TEST_ASSERT_TRUE(ir_carrier_meter_result(&m, &res));
+    TEST_ASSERT_EQUAL_UINT32(40000, res.freq_hz);
+    TEST_ASSERT_UINT32_WITHIN(3, 33, res.duty_pct);
+}
+
+static void test_no_carrier(void)
+{
+    ir_carrier_t res;
+
+    /* Demodulated captures: every period is far below the carrier band */
+    capture_set_t set = {0};
+    TEST_ASSERT_GREATER_THAN_INT(0, capture_file_load(HOST_CAPTURES_DIR "/nec_remote_a.log", &set));
+    for (size_t i = 0; i < set.frame_num; i++) {
+        TEST_ASSERT_FALSE(ir_carrier_measure(set.frames[i].symbols, set.frames[i].symbol_num, CAR_ENV_RES_HZ, 0, &res));
+    }
+    capture_set_free(&set);
+
+    /* Too few periods to trust */
+    static const rmt_symbol_word_t env[1] = { { .duration0 = 300, .level0 = 1, .duration1 = 0, .level1 = 0 } };
+    size_t n = modulate(env, 1, 38000, 33, s_edges, CAR_MAX_SYMBOLS);
+    TEST_ASSERT_GREATER_THAN_INT((int)n, IR_CARRIER_MIN_PERIODS);
+    TEST_ASSERT_FALSE(ir_carrier_measure(s_edges, n, CAR_RES_HZ, 0, &res));
+    TEST_ASSERT_FALSE(ir_carrier_measure(s_edges, 0, CAR_RES_HZ, 0, &res));
+}
+
+/* =========================
+ * Unity test runner
+ * ========================= */
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_measures_common_carriers);
+    RUN_TEST(test_active_high_input);
+    RUN_TEST(test_glitches_rejected);
+    RUN_TEST(test_no_carrier);
+    return UNITY_END();
+}
@@ -0,0 +1,206 @@
+/*
+ * test_ir_core.c — host unit tests for the ir_core RX pipeline
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "host_unity.h"
+#include "ir_core.h"
+#include "capture_file.h"
+
+HOST_UNITY_INSTANCE;
+
+static ir_pulse_lut_t s_lut;
+
+/* =========================
+ * Helpers
+ * ========================= */
+static rmt_symbol_word_t sym(uint32_t l0, uint32_t d0, uint32_t l1, uint32_t d1)
+{
+    rmt_symbol_word_t s = { .level0 = l0, .duration0 = d0, .level1 = l1, .duration1 = d1 };
+    return s;
+}
+
+/* Build a raw (receiver-level, active low) NEC frame with a fixed skew */
+static size_t build_nec(rmt_symbol_word_t *out, uint16_t addr, uint16_t cmd, int skew)
+{
+    size_t n = 0;
+    out[n++] = sym(0, 9000 + skew, 1, 4500 - skew);
+    for (int i = 0; i < 32; i++) {
+        uint32_t v = (i < 16) ? addr : cmd;
+        bool one = (v >> (i & 15)) & 1u;
+        out[n++] = sym(0, 560 + skew, 1, (one ? 1690 : 560) - skew);
+    }
+    out[n++] = sym(0, 560 + skew, 1, 0);
+    return n;
+}
+
+/* =========================
+ * Test cases
+ * ========================= */
+static void test_invert_levels_keeps_durations(void)
+{
+    rmt_symbol_word_t in[2] = { sym(0, 100, 1, 200), sym(1, 300, 0, 400) };
+    rmt_symbol_word_t out[2];
+
+    invert_rmt_levels(in, out, 2);
+
+    TEST_ASSERT_EQUAL_UINT32(1, out[0].level0);
+    TEST_ASSERT_EQUAL_UINT32(0, out[0].level1);
+    TEST_ASSERT_EQUAL_UINT32(0, out[1].level0);
+    TEST_ASSERT_EQUAL_UINT32(1, out[1].level1);
+    TEST_ASSERT_EQUAL_UINT32(100, out[0].duration0);
+    TEST_ASSERT_EQUAL_UINT32(400, out[1].duration1);
+}
+
+static void test_normalize_snaps_nec_timings(void)
+{
+    rmt_symbol_word_t raw[NEC_FRAME_SYMBOLS];
+    rmt_symbol_word_t norm[NEC_FRAME_SYMBOLS];
+    size_t n = build_nec(raw, 0xFE01, 0x748B, 90);
+
+    normalize_rmt_frame(&s_lut, raw, norm, n);
+
+    TEST_ASSERT_EQUAL_UINT32(1, norm[0].level0);
+    TEST_ASSERT_EQUAL_UINT32(NEC_LEADING_CODE_DURATION_0, norm[0].duration0);
+    TEST_ASSERT_EQUAL_UINT32(NEC_LEADING_CODE_DURATION_1, norm[0].duration1);
+    for (size_t i = 1; i < n - 1; i++) {
+        TEST_ASSERT_EQUAL_UINT32(NEC_PAYLOAD_ZERO_DURATION_0, norm[i].duration0);
+        TEST_ASSERT_TRUE(norm[i].duration1 == NEC_PAYLOAD_ZERO_DURATION_1 ||
+                         norm[i].duration1 == NEC_PAYLOAD_ONE_DURATION_1);
+    }
+}
+
+static void test_nec_parse_frame_decodes(void)
+{
+    rmt_symbol_word_t raw[NEC_FRAME_SYMBOLS];
+    ir_nec_frame_t f = {0};
+    build_nec(raw, 0xFE01, 0x748B, -120);
+
+    TEST_ASSERT_TRUE(nec_parse_frame(&s_lut, raw, &f));
+    TEST_ASSERT_EQUAL_HEX16(0xFE01, f.address);
+    TEST_ASSERT_EQUAL_HEX16(0x748B, f.command);
+}
+
+static void test_nec_parse_frame_rejects_bad_bit(void)
+{
+    rmt_symbol_word_t raw[NEC_FRAME_SYMBOLS];
+    ir_nec_frame_t f = { .address = 0x1234, .command = 0x5678 };
+    build_nec(raw, 0xFE01, 0x748B, 0);
+    raw[10].duration1 = 1100; /* between logic 0 and logic 1 */
+
+    TEST_ASSERT_FALSE(nec_parse_frame(&s_lut, raw, &f));
+    TEST_ASSERT_EQUAL_HEX16(0x1234, f.address); /* untouched on failure */
+}
+
+static void test_nec_parse_repeat(void)
+{
+    rmt_symbol_word_t rep[2] = { sym(0, 9050, 1, 2200), sym(0, 560, 1, 0) };
+    rmt_symbol_word_t lead[2] = { sym(0, 9050, 1, 4500), sym(0, 560, 1, 0) };
+
+    TEST_ASSERT_TRUE(nec_parse_frame_repeat(&s_lut, rep));
+    TEST_ASSERT_FALSE(nec_parse_frame_repeat(&s_lut, lead));
+}
+
+static void test_lut_classes_at_1mhz(void)
+{
+    TEST_ASSERT_EQUAL_INT(IR_PULSE_END, ir_pulse_classify(&s_lut, 0));
+    TEST_ASSERT_EQUAL_INT(IR_PULSE_OTHER, ir_pulse_classify(&s_lut, 100));
+    TEST_ASSERT_EQUAL_INT(IR_PULSE_SHORT, ir_pulse_classify(&s_lut, 560));
+    TEST_ASSERT_EQUAL_INT(IR_PULSE_LONG, ir_pulse_classify(&s_lut, 1690));
+    TEST_ASSERT_EQUAL_INT(IR_PULSE_REPEAT_SPACE, ir_pulse_classify(&s_lut, 2250));
+    TEST_ASSERT_EQUAL_INT(IR_PULSE_LEAD_SPACE, ir_pulse_classify(&s_lut, 4500));
+    TEST_ASSERT_EQUAL_INT(IR_PULSE_LEAD_MARK, ir_pulse_classify(&s_lut, 9000));
+    TEST_ASSERT_EQUAL_INT(IR_PULSE_OTHER, ir_pulse_classify(&s_lut, 20000));
+    TEST_ASSERT_EQUAL_INT(IR_PULSE_OTHER, ir_pulse_classify(&s_lut, 0x7FFF));
+}
+
+static void test_lut_scales_with_resolution(void)
+{
+    ir_pulse_lut_t lut10;
+    ir_pulse_lut_init(&lut10, 10000000); /* 1 tick = 100ns */
+
+    TEST_ASSERT_EQUAL_INT(IR_PULSE_SHORT, ir_pulse_classify(&lut10, 5600));
+    TEST_ASSERT_EQUAL_INT(IR_PULSE_LONG, ir_pulse_classify(&lut10, 16900));
+    TEST_ASSERT_EQUAL_INT(IR_PULSE_OTHER, ir_pulse_classify(&lut10, 560));
+    TEST_ASSERT_EQUAL_UINT32(5600, lut10.canonical[IR_PULSE_SHORT]);
+    TEST_ASSERT_EQUAL_UINT32(0x7FFF, lut10.canonical[IR_PULSE_LEAD_MARK]); /* clamped to 15 bits */
+}
+
+static void test_process_frame_single_pass(void)
+{
+    rmt_symbol_word_t raw[NEC_FRAME_SYMBOLS];
+    rmt_symbol_word_t norm[NEC_FRAME_SYMBOLS];
+    ir_nec_decode_t dec;
+    size_t n = build_nec(raw, 0x7F80, 0xF20D, 150);
+
+    ir_core_process_frame(&s_lut, raw, norm, n, &dec);
+
+    TEST_ASSERT_EQUAL_INT(IR_NEC_DECODE_FRAME, dec.kind);
+    TEST_ASSERT_EQUAL_HEX16(0x7F80, dec.frame.address);
+    TEST_ASSERT_EQUAL_HEX16(0xF20D, dec.frame.command);
+    TEST_ASSERT_EQUAL_UINT32(1, norm[0].level0);
+    TEST_ASSERT_EQUAL_UINT32(NEC_LEADING_CODE_DURATION_1, norm[0].duration1);
+    TEST_ASSERT_EQUAL_UINT32(0, norm[n - 1].duration1); /* end marker kept */
+
+    /* In-place processing of a repeat frame */
+    rmt_symbol_word_t rep[2] = { sym(0, 8900, 1, 2300), sym(0, 560, 1, 0) };
+    ir_core_process_frame(&s_lut, rep, rep, 2, &dec);
+    TEST_ASSERT_EQUAL_INT(IR_NEC_DECODE_REPEAT, dec.kind);
+    TEST_ASSERT_EQUAL_UINT32(NEC_REPEAT_CODE_DURATION_0, rep[0].duration0);
+    TEST_ASSERT_EQUAL_UINT32(NEC_REPEAT_CODE_DURATION_1, rep[0].duration1);
+}
+
+static void test_normalize_keeps_unknown_durations(void)
+{
+    rmt_symbol_word_t s[1] = { sym(1, 3400, 0, 12000) };
+
+    normalize_rmt_durations(&s_lut, s, 1);
+
+    TEST_ASSERT_EQUAL_UINT32(3400, s[0].duration0);
+    TEST_ASSERT_EQUAL_UINT32(12000, s[0].duration1);
+}
+
+static void test_recorded_captures_decode(void)
+{
+    capture_set_t set = {0};
+    TEST_ASSERT_GREATER_THAN_INT(0, capture_file_load(HOST_CAPTURES_DIR "/nec_remote_a.log", &set));
+
+    size_t decoded = 0;
+    for (size_t i = 0; i < set.frame_num; i++) {
+        const capture_frame_t *f = &set.frames[i];
+        ir_nec_frame_t nec;
+        if (f->symbol_num == NEC_FRAME_SYMBOLS && nec_parse_frame(&s_lut, f->symbols, &nec)) {
+            TEST_ASSERT_EQUAL_HEX16(0xFE01, nec.address);
+            decoded++;
+        } else if (f->symbol_num == NEC_REPEAT_SYMBOLS && nec_parse_frame_repeat(&s_lut, f->symbols)) {
+            decoded++;
+        }
+    }
+    size_t total = set.frame_num;
+    capture_set_free(&set);
+    TEST_ASSERT_EQUAL_UINT32(total, decoded);
+}
+
+/* =========================
+ * Unity test runner
+ * ========================= */
+int main(void)
+{
+    ir_pulse_lut_init(&s_lut, 1000000);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_invert_levels_keeps_durations);
+    RUN_TEST(test_normalize_snaps_nec_timings);
+    RUN_TEST(test_nec_parse_frame_decodes);
+    RUN_TEST(test_nec_parse_frame_rejects_bad_bit);
+    RUN_TEST(test_nec_parse_repeat);
+    RUN_TEST(test_lut_classes_at_1mhz);
+    RUN_TEST(test_lut_scales_with_resolution);
+    RUN_TEST(test_process_frame_single_pass);
+    RUN_TEST(test_normalize_keeps_unknown_durations);
+    RUN_TEST(test_recorded_captures_decode);
+    return UNITY_END();
+}
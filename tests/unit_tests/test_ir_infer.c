@@ -0,0 +1,233 @@
+/*
+ * test_ir_infer.c — host unit tests for per-capture timing inference
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_unity.h"
+#include "capture_file.h"
+#include "ir_core.h"
+#include "ir_pd.h"
+#include "ir_infer.h"
+
+HOST_UNITY_INSTANCE;
+
+#define INF_RES_HZ 1000000u
+
+static ir_pulse_lut_t s_lut;
+static rmt_symbol_word_t s_wave[IR_PD_MAX_BYTES * 8 + 2];
+
+/* =========================
+ * Helpers
+ * ========================= */
+static rmt_symbol_word_t sym(uint32_t d0, uint32_t d1)
+{
+    rmt_symbol_word_t s = { .level0 = 0, .duration0 = d0, .level1 = 1, .duration1 = d1 };
+    return s;
+}
+
+/* Receiver view of a reference waveform: marks stretched, spaces shortened, +-60us jitter */
+static void distort(rmt_symbol_word_t *wave, size_t n, uint32_t seed)
+{
+    uint32_t rng = seed;
+    for (size_t i = 0; i < n; i++) {
+        rng = rng * 1103515245u + 12345u;
+        int32_t j0 = (int32_t)((rng >> 16) % 121u) - 60;
+        rng = rng * 1103515245u + 12345u;
+        int32_t j1 = (int32_t)((rng >> 16) % 121u) - 60;
+        wave[i].duration0 = (uint32_t)((int32_t)wave[i].duration0 + 80 + j0);
+        if (wave[i].duration1) {
+            wave[i].duration1 = (uint32_t)((int32_t)wave[i].duration1 - 80 + j1);
+        }
+    }
+}
+
+static uint8_t reverse8(uint8_t v)
+{
+    uint8_t r = 0;
+    for (int i = 0; i < 8; i++) {
+        r = (uint8_t)(r << 1 | ((v >> i) & 1u));
+    }
+    return r;
+}
+
+static bool near_us(uint32_t expect, uint32_t actual)
+{
+    uint32_t err = expect > actual ? expect - actual : actual - expect;
+    return err <= 120 || err * 100 <= expect * 15;
+}
+
+static bool pulse_near(const ir_pd_pulse_t *expect, const ir_pd_pulse_t *actual)
+{
+    return near_us(expect->mark_us, actual->mark_us) && near_us(expect->space_us, actual->space_us);
+}
+
+/* =========================
+ * Test cases
+ * ========================= */
+static void test_recorded_nec_frames(void)
+{
+    capture_set_t set = {0};
+    TEST_ASSERT_GREATER_THAN_INT(0, capture_file_load(HOST_CAPTURES_DIR "/nec_remote_a.log", &set));
+    TEST_ASSERT_GREATER_THAN_INT(0, capture_file_load(HOST_CAPTURES_DIR "/nec_remote_b.log", &set));
+
+    size_t frames = 0;
+    for (size_t i = 0; i < set.frame_num; i++) {
+        const capture_frame_t *f = &set.frames[i];
+        ir_infer_template_t tpl;
+        uint8_t bits[IR_PD_MAX_BYTES];
+        ir_nec_frame_t nec;
+
+        TEST_ASSERT_TRUE(ir_infer(f->symbols, f->symbol_num, INF_RES_HZ, &tpl, bits, sizeof(bits)));
+        if (f->symbol_num != NEC_FRAME_SYMBOLS) {
+            TEST_ASSERT_FALSE(tpl.pd); /* repeat code */
+            continue;
+        }
+        TEST_ASSERT_TRUE(nec_parse_frame(&s_lut, f->symbols, &nec));
+        TEST_ASSERT_TRUE(tpl.pd);
+        TEST_ASSERT_EQUAL_UINT32(32, tpl.bit_num);
+        TEST_ASSERT_TRUE(pulse_near(&ir_pd_nec.leader, &tpl.desc.leader));
+        TEST_ASSERT_TRUE(pulse_near(&ir_pd_nec.zero, &tpl.desc.zero));
+        TEST_ASSERT_TRUE(pulse_near(&ir_pd_nec.one, &tpl.desc.one));
+        uint16_t address = (uint16_t)(bits[0] | bits[1] << 8);
+        uint16_t command = (uint16_t)(bits[2] | bits[3] << 8);
+        TEST_ASSERT_EQUAL_HEX16(nec.address, address);
+        TEST_ASSERT_EQUAL_HEX16(nec.command, command);
+        frames++;
+    }
+    capture_set_free(&set);
+    TEST_ASSERT_GREATER_THAN_INT(0, (int)frames);
+}
+
+static void test_presets_recovered_without_descriptor(void)
+{
+    for (size_t p = 0; p < ir_pd_preset_num; p++) {
+        const ir_pd_desc_t *desc = ir_pd_presets[p];
+        size_t byte_num = desc->byte_num ? desc->byte_num : 19;
+        uint8_t data[IR_PD_MAX_BYTES], bits[IR_PD_MAX_BYTES], again[IR_PD_MAX_BYTES];
+        ir_infer_template_t tpl;
+        uint32_t rng = 99 + (uint32_t)p;
+
+        for (size_t i = 0; i < byte_num; i++) {
+            rng = rng * 1103515245u + 12345u;
+            data[i] = (uint8_t)(rng >> 16);
+        }
+        size_t n = ir_pd_expand(desc, INF_RES_HZ, data, byte_num, s_wave, sizeof(s_wave) / sizeof(s_wave[0]));
+        distort(s_wave, n, (uint32_t)p);
+
+        TEST_ASSERT_TRUE(ir_infer(s_wave, n, INF_RES_HZ, &tpl, bits, sizeof(bits)));
+        TEST_ASSERT_TRUE_MESSAGE(tpl.pd, desc->name);
+        TEST_ASSERT_EQUAL_UINT32(byte_num * 8, tpl.bit_num);
+        TEST_ASSERT_TRUE_MESSAGE(pulse_near(&desc->leader, &tpl.desc.leader), desc->name);
+        TEST_ASSERT_TRUE_MESSAGE(pulse_near(&desc->zero, &tpl.desc.zero), desc->name);
+        TEST_ASSERT_TRUE_MESSAGE(pulse_near(&desc->one, &tpl.desc.one), desc->name);
+        for (size_t i = 0; i < byte_num; i++) {
+            uint8_t expect = desc->msb_first ? reverse8(data[i]) : data[i];
+            TEST_ASSERT_EQUAL_HEX16(expect, bits[i]);
+        }
+
+        /* The inferred descriptor decodes the capture it came from */
+        size_t again_num = 0;
+        TEST_ASSERT_TRUE(ir_pd_decode(&tpl.desc, INF_RES_HZ, s_wave, n, again, sizeof(again), &again_num));
+        TEST_ASSERT_EQUAL_MEMORY(bits, again, byte_num);
+    }
+}
+
+static void test_pulse_width_odd_length(void)
+{
+    /* 12-bit pulse-width frame, marks carry the bits, the last space is a gap */
+    static const uint16_t code = 0x0A95;
+    ir_infer_template_t tpl;
+    uint8_t bits[2];
+    size_t n = 0;
+
+    s_wave[n++] = sym(2400, 600);
+    for (int i = 0; i < 12; i++) {
+        s_wave[n++] = sym((code >> i) & 1u ? 1200 : 600, 600);
+    }
+    s_wave[n - 1].duration1 = 25000;
+    distort(s_wave, n, 5);
+
+    TEST_ASSERT_TRUE(ir_infer(s_wave, n, INF_RES_HZ, &tpl, bits, sizeof(bits)));
+    TEST_ASSERT_TRUE(tpl.pd);
+    TEST_ASSERT_EQUAL_UINT32(12, tpl.bit_num);
+    TEST_ASSERT_EQUAL_UINT32(2, tpl.desc.byte_num);
+    TEST_ASSERT_EQUAL_UINT32(0, tpl.desc.trailer.mark_us);
+    TEST_ASSERT_TRUE(tpl.desc.one.mark_us > tpl.desc.zero.mark_us);
+    uint16_t got = (uint16_t)(bits[0] | bits[1] << 8);
+    TEST_ASSERT_EQUAL_HEX16(code, got);
+}
+
+static void test_normalize_snaps_to_centres(void)
+{
+    ir_infer_template_t tpl;
+    size_t n = ir_pd_expand(&ir_pd_mitsubishi_ac, INF_RES_HZ, (const uint8_t *)"\x23\xCB\x26\x01\x00\x20\x08\x06\x30"
+                            "\x45\x67\x00\x00\x00\x00\x00\x00\x1F", 18, s_wave, sizeof(s_wave) / sizeof(s_wave[0]));
+    distort(s_wave, n, 17);
+
+    TEST_ASSERT_TRUE(ir_infer(s_wave, n, INF_RES_HZ, &tpl, NULL, 0));
+    TEST_ASSERT_EQUAL_UINT32(2, tpl.marks.num);  /* leader, bits (the trailer lands with them) */
+    TEST_ASSERT_EQUAL_UINT32(3, tpl.spaces.num); /* leader, zero, one */
+
+    ir_infer_normalize(&tpl, s_wave, s_wave, n);
+    for (size_t i = 0; i < n; i++) {
+        bool mark_ok = false, space_ok = s_wave[i].duration1 == 0;
+        for (unsigned k = 0; k < tpl.marks.num; k++) {
+            mark_ok |= s_wave[i].duration0 == tpl.marks.centre[k];
+        }
+        for (unsigned k = 0; k < tpl.spaces.num; k++) {
+            space_ok |= s_wave[i].duration1 == tpl.spaces.centre[k];
+        }
+        TEST_ASSERT_TRUE(mark_ok && space_ok);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, s_wave[n - 1].duration1);
+}
+
+static void test_non_pd_shapes(void)
+{
+    ir_infer_template_t tpl;
+    size_t n = 0;
+
+    /* Three kinds of data symbol (Gree-style footer in the middle of the bits) */
+    s_wave[n++] = sym(9000, 4500);
+    for (int i = 0; i < 35; i++) {
+        s_wave[n++] = sym(620, (i % 3) ? 540 : 1600);
+    }
+    s_wave[n++] = sym(620, 20000);
+    for (int i = 0; i < 32; i++) {
+        s_wave[n++] = sym(620, (i % 2) ? 540 : 1600);
+    }
+    s_wave[n++] = sym(620, 0);
+    TEST_ASSERT_TRUE(ir_infer(s_wave, n, INF_RES_HZ, &tpl, NULL, 0));
+    TEST_ASSERT_FALSE(tpl.pd);
+    TEST_ASSERT_EQUAL_UINT32(4, tpl.spaces.num);
+
+    /* Many distinct durations are capped */
+    for (n = 0; n < 16; n++) {
+        s_wave[n] = sym(300u << (n % 7), 200u * (uint32_t)(n + 1) * (uint32_t)(n + 1));
+    }
+    TEST_ASSERT_TRUE(ir_infer(s_wave, n, INF_RES_HZ, &tpl, NULL, 0));
+    TEST_ASSERT_EQUAL_UINT32(7, tpl.marks.num);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(IR_INFER_MAX_CLUSTERS, tpl.spaces.num);
+
+    TEST_ASSERT_FALSE(ir_infer(s_wave, 0, INF_RES_HZ, &tpl, NULL, 0));
+}
+
+/* =========================
+ * Unity test runner
+ * ========================= */
+int main(void)
+{
+    ir_pulse_lut_init(&s_lut, INF_RES_HZ);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_recorded_nec_frames);
+    RUN_TEST(test_presets_recovered_without_descriptor);
+    RUN_TEST(test_pulse_width_odd_length);
+    RUN_TEST(test_normalize_snaps_to_centres);
+    RUN_TEST(test_non_pd_shapes);
+    return UNITY_END();
+}
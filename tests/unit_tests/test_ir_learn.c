@@ -0,0 +1,261 @@
+/*
+ * test_ir_learn.c — host unit tests for consensus learning
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "host_unity.h"
+#include "capture_file.h"
+#include "ir_core.h"
+#include "ir_pd.h"
+#include "ir_learn.h"
+
+HOST_UNITY_INSTANCE;
+
+#define LEARN_RES_HZ   1000000u
+#define LEARN_ARENA    2048u
+#define LEARN_MAX_WAVE (IR_PD_MAX_BYTES * 8 + 2)
+
+static rmt_symbol_word_t s_arena[LEARN_ARENA];
+static rmt_symbol_word_t s_truth[LEARN_MAX_WAVE];
+static rmt_symbol_word_t s_press[LEARN_MAX_WAVE * 4];
+static rmt_symbol_word_t s_out[LEARN_MAX_WAVE * 4];
+static ir_learn_t s_learn;
+static ir_pulse_lut_t s_lut;
+
+/* =========================
+ * Helpers
+ * ========================= */
+static void learn_setup(void)
+{
+    ir_learn_config_t cfg = { .resolution_hz = LEARN_RES_HZ, .arena = s_arena, .arena_symbols = LEARN_ARENA };
+    TEST_ASSERT_EQUAL_INT(IR_LEARN_OK, ir_learn_init(&s_learn, &cfg));
+}
+
+/* Receiver view of a reference waveform: marks +80us, spaces -80us, +-jitter_us */
+static void distort(const rmt_symbol_word_t *in, rmt_symbol_word_t *out, size_t n, uint32_t seed, uint32_t jitter_us)
+{
+    uint32_t rng = seed;
+    for (size_t i = 0; i < n; i++) {
+        rng = rng * 1103515245u + 12345u;
+        int32_t j0 = (int32_t)((rng >> 16) % (2 * jitter_us + 1)) - (int32_t)jitter_us;
+        rng = rng * 1103515245u + 12345u;
+        int32_t j1 = (int32_t)((rng >> 16) % (2 * jitter_us + 1)) - (int32_t)jitter_us;
+        out[i] = in[i];
+        out[i].duration0 = (uint32_t)((int32_t)in[i].duration0 + 80 + j0);
+        if (in[i].duration1) {
+            out[i].duration1 = (uint32_t)((int32_t)in[i].duration1 - 80 + j1);
+        }
+    }
+}
+
+static uint32_t abs_diff(uint32_t a, uint32_t b)
+{
+    return a > b ? a - b : b - a;
+}
+
+/* Largest distance from the skewed reference (marks +80, spaces -80) */
+static uint32_t max_error(const rmt_symbol_word_t *wave, const rmt_symbol_word_t *truth, size_t n)
+{
+    uint32_t worst = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t e0 = abs_diff(wave[i].duration0, truth[i].duration0 + 80);
+        uint32_t e1 = truth[i].duration1 ? abs_diff(wave[i].duration1, truth[i].duration1 - 80) : wave[i].duration1;
+        worst = e0 > worst ? e0 : worst;
+        worst = e1 > worst ? e1 : worst;
+    }
+    return worst;
+}
+
+static size_t mitsubishi_truth(void)
+{
+    static const uint8_t data[18] = { 0x23, 0xCB, 0x26, 0x01, 0x00, 0x20, 0x08, 0x06, 0x30,
+                                      0x45, 0x67, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F };
+    return ir_pd_expand(&ir_pd_mitsubishi_ac, LEARN_RES_HZ, data, sizeof(data), s_truth, LEARN_MAX_WAVE);
+}
+
+/* =========================
+ * Test cases
+ * ========================= */
+static void test_consensus_of_recorded_presses(void)
+{
+    capture_set_t set = {0};
+    ir_nec_frame_t first = {0}, nec;
+    ir_learn_result_t res;
+    size_t added = 0;
+
+    TEST_ASSERT_GREATER_THAN_INT(0, capture_file_load(HOST_CAPTURES_DIR "/nec_remote_a.log", &set));
+    learn_setup();
+    for (size_t i = 0; i < set.frame_num && added < 5; i++) {
+        const capture_frame_t *f = &set.frames[i];
+        if (f->symbol_num != NEC_FRAME_SYMBOLS || !nec_parse_frame(&s_lut, f->symbols, &nec)) {
+            continue;
+        }
+        if (added > 0 && (nec.address != first.address || nec.command != first.command)) {
+            continue; /* another button */
+        }
+        first = nec;
+        TEST_ASSERT_EQUAL_INT(IR_LEARN_OK, ir_learn_add(&s_learn, f->symbols, f->symbol_num, NULL, 0));
+        added++;
+    }
+    capture_set_free(&set);
+    TEST_ASSERT_GREATER_THAN_INT(1, (int)added);
+
+    TEST_ASSERT_EQUAL_INT(IR_LEARN_OK, ir_learn_consensus(&s_learn, s_out, LEARN_MAX_WAVE, &res));
+    TEST_ASSERT_EQUAL_UINT32(NEC_FRAME_SYMBOLS, res.symbol_num);
+    TEST_ASSERT_EQUAL_UINT8(added, res.presses);
+    TEST_ASSERT_EQUAL_UINT8(added, res.used);
+    TEST_ASSERT_GREATER_THAN_INT(95, res.confidence_pct);
+    TEST_ASSERT_TRUE(nec_parse_frame(&s_lut, s_out, &nec));
+    TEST_ASSERT_EQUAL_HEX16(first.address, nec.address);
+    TEST_ASSERT_EQUAL_HEX16(first.command, nec.command);
+}
+
+static void test_median_beats_single_press(void)
+{
+    size_t n = mitsubishi_truth();
+    ir_learn_result_t res;
+    uint32_t worst_single = 0;
+
+    learn_setup();
+    for (uint32_t p = 0; p < 5; p++) {
+        distort(s_truth, s_press, n, 11 + p, 120);
+        uint32_t e = max_error(s_press, s_truth, n);
+        worst_single = e > worst_single ? e : worst_single;
+        TEST_ASSERT_EQUAL_INT(IR_LEARN_OK, ir_learn_add(&s_learn, s_press, n, NULL, 0));
+    }
+    TEST_ASSERT_EQUAL_INT(IR_LEARN_OK, ir_learn_consensus(&s_learn, s_out, LEARN_MAX_WAVE, &res));
+    TEST_ASSERT_EQUAL_UINT32(n, res.symbol_num);
+    TEST_ASSERT_EQUAL_UINT8(5, res.used);
+    TEST_ASSERT_EQUAL_UINT8(0, res.rejected_mask);
+
+    uint32_t consensus = max_error(s_out, s_truth, n);
+    TEST_ASSERT_GREATER_THAN_INT((int)consensus, (int)worst_single);
+    TEST_ASSERT_EQUAL_UINT32(0, s_out[n - 1].duration1); /* end marker kept */
+}
+
+static void test_outliers_rejected(void)
+{
+    size_t n = mitsubishi_truth();
+    ir_learn_result_t res;
+
+    learn_setup();
+    for (uint32_t p = 0; p < 5; p++) {
+        distort(s_truth, s_press, n, 21 + p, 40);
+        if (p == 1) {
+            /* A reflection split one space: one symbol more */
+            memmove(&s_press[41], &s_press[40], (n - 40) * sizeof(rmt_symbol_word_t));
+            s_press[40].duration1 = 200;
+            s_press[41].duration0 = 150;
+            TEST_ASSERT_EQUAL_INT(IR_LEARN_OK, ir_learn_add(&s_learn, s_press, n + 1, NULL, 0));
+            continue;
+        }
+        if (p == 3) {
+            /* Remote held at an angle: every space much too long */
+            for (size_t i = 0; i + 1 < n; i++) {
+                s_press[i].duration1 += s_press[i].duration1 / 2;
+            }
+        }
+        TEST_ASSERT_EQUAL_INT(IR_LEARN_OK, ir_learn_add(&s_learn, s_press, n, NULL, 0));
+    }
+    TEST_ASSERT_EQUAL_INT(IR_LEARN_OK, ir_learn_consensus(&s_learn, s_out, LEARN_MAX_WAVE, &res));
+    TEST_ASSERT_EQUAL_UINT32(n, res.symbol_num);
+    TEST_ASSERT_EQUAL_UINT8(5, res.presses);
+    TEST_ASSERT_EQUAL_UINT8(3, res.used);
+    TEST_ASSERT_EQUAL_UINT8(1u << 3, res.rejected_mask);
+    /* Two of five presses wrong: confidence drops to about 60% */
+    TEST_ASSERT_GREATER_THAN_INT(55, res.confidence_pct);
+    TEST_ASSERT_GREATER_THAN_INT(res.confidence_pct, 70);
+
+    uint8_t bytes[IR_PD_MAX_BYTES];
+    size_t byte_num = 0;
+    TEST_ASSERT_TRUE(ir_pd_decode(&ir_pd_mitsubishi_ac, LEARN_RES_HZ, s_out, n, bytes, sizeof(bytes), &byte_num));
+    uint32_t err = max_error(s_out, s_truth, n);
+    TEST_ASSERT_GREATER_THAN_INT((int)err, 100); /* outliers did not pull the medians */
+}
+
+static void test_held_button_aligns_sub_frames(void)
+{
+    static const uint8_t data[4] = { 0x01, 0xFE, 0x8B, 0x74 };
+    size_t frame = ir_pd_expand(&ir_pd_nec, LEARN_RES_HZ, data, sizeof(data), s_truth, LEARN_MAX_WAVE);
+    const rmt_symbol_word_t repeat[2] = {
+        { .level0 = 1, .duration0 = 9000, .level1 = 0, .duration1 = 2250 },
+        { .level0 = 1, .duration0 = 560, .level1 = 0, .duration1 = 0 },
+    };
+    ir_learn_result_t res;
+
+    learn_setup();
+    /* Frame followed by 1, 2 and 3 repeat codes */
+    for (uint32_t p = 0; p < 3; p++) {
+        ir_capture_seg_t segs[4];
+        size_t n = 0;
+        distort(s_truth, s_press, frame, 31 + p, 40);
+        segs[0] = (ir_capture_seg_t){ .offset = 0, .symbol_num = (uint32_t)frame, .gap_us = 0 };
+        n = frame;
+        for (uint32_t r = 0; r <= p; r++) {
+            distort(repeat, &s_press[n], 2, 41 + p * 4 + r, 40);
+            segs[r + 1] = (ir_capture_seg_t){ .offset = (uint32_t)n, .symbol_num = 2, .gap_us = 40000 + 100 * p };
+            n += 2;
+        }
+        TEST_ASSERT_EQUAL_INT(IR_LEARN_OK, ir_learn_add(&s_learn, s_press, n, segs, p + 2));
+    }
+    TEST_ASSERT_EQUAL_INT(IR_LEARN_OK, ir_learn_consensus(&s_learn, s_out, sizeof(s_out) / sizeof(s_out[0]), &res));
+
+    /* Repeats present in a majority of the presses: the frame and two repeats */
+    TEST_ASSERT_EQUAL_UINT8(3, res.seg_num);
+    TEST_ASSERT_EQUAL_UINT32(frame + 4, res.symbol_num);
+    TEST_ASSERT_EQUAL_UINT32(frame, res.segs[1].offset);
+    TEST_ASSERT_EQUAL_UINT32(40100, res.segs[1].gap_us);
+    TEST_ASSERT_EQUAL_UINT32(40150, res.segs[2].gap_us);
+    TEST_ASSERT_EQUAL_UINT8(3, res.used);
+    TEST_ASSERT_GREATER_THAN_INT(95, res.confidence_pct);
+}
+
+static void test_bounds_and_disagreement(void)
+{
+    size_t n = mitsubishi_truth();
+    ir_learn_result_t res;
+
+    learn_setup();
+    TEST_ASSERT_EQUAL_INT(IR_LEARN_ERR_NO_CONSENSUS, ir_learn_consensus(&s_learn, s_out, LEARN_MAX_WAVE, &res));
+
+    /* Two presses of different length: no majority */
+    TEST_ASSERT_EQUAL_INT(IR_LEARN_OK, ir_learn_add(&s_learn, s_truth, n, NULL, 0));
+    TEST_ASSERT_EQUAL_INT(IR_LEARN_OK, ir_learn_add(&s_learn, s_truth, n - 8, NULL, 0));
+    TEST_ASSERT_EQUAL_INT(IR_LEARN_ERR_NO_CONSENSUS, ir_learn_consensus(&s_learn, s_out, LEARN_MAX_WAVE, &res));
+    TEST_ASSERT_EQUAL_INT(IR_LEARN_OK, ir_learn_add(&s_learn, s_truth, n, NULL, 0));
+    TEST_ASSERT_EQUAL_INT(IR_LEARN_ERR_NO_SPACE, ir_learn_consensus(&s_learn, s_out, n - 1, &res));
+    TEST_ASSERT_EQUAL_INT(IR_LEARN_OK, ir_learn_consensus(&s_learn, s_out, n, &res));
+    TEST_ASSERT_EQUAL_UINT8(2, res.used);
+
+    /* Arena and press table are bounded */
+    ir_learn_config_t small = { .resolution_hz = LEARN_RES_HZ, .arena = s_arena, .arena_symbols = 2 * n + 10 };
+    TEST_ASSERT_EQUAL_INT(IR_LEARN_OK, ir_learn_init(&s_learn, &small));
+    TEST_ASSERT_EQUAL_INT(IR_LEARN_OK, ir_learn_add(&s_learn, s_truth, n, NULL, 0));
+    TEST_ASSERT_EQUAL_INT(IR_LEARN_OK, ir_learn_add(&s_learn, s_truth, n, NULL, 0));
+    TEST_ASSERT_EQUAL_INT(IR_LEARN_ERR_NO_SPACE, ir_learn_add(&s_learn, s_truth, n, NULL, 0));
+    learn_setup();
+    for (size_t p = 0; p < IR_LEARN_MAX_PRESSES; p++) {
+        TEST_ASSERT_EQUAL_INT(IR_LEARN_OK, ir_learn_add(&s_learn, s_truth, 4, NULL, 0));
+    }
+    TEST_ASSERT_EQUAL_INT(IR_LEARN_ERR_NO_SPACE, ir_learn_add(&s_learn, s_truth, 4, NULL, 0));
+    TEST_ASSERT_EQUAL_INT(IR_LEARN_ERR_ARG, ir_learn_add(&s_learn, s_truth, 0, NULL, 0));
+}
+
+/* =========================
+ * Unity test runner
+ * ========================= */
+int main(void)
+{
+    ir_pulse_lut_init(&s_lut, LEARN_RES_HZ);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_consensus_of_recorded_presses);
+    RUN_TEST(test_median_beats_single_press);
+    RUN_TEST(test_outliers_rejected);
+    RUN_TEST(test_held_button_aligns_sub_frames);
+    RUN_TEST(test_bounds_and_disagreement);
+    return UNITY_END();
+}
@@ -0,0 +1,205 @@
+/*
+ * test_ir_pd.c — host unit tests for descriptor-driven pulse-distance protocols
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "host_unity.h"
+#include "capture_file.h"
+#include "ir_core.h"
+#include "ir_pd.h"
+
+HOST_UNITY_INSTANCE;
+
+#define PD_RES_HZ 1000000u
+
+static ir_pulse_lut_t s_lut;
+static rmt_symbol_word_t s_wave[IR_PD_MAX_BYTES * 8 + 2];
+
+/* =========================
+ * Helpers
+ * ========================= */
+typedef struct {
+    const ir_pd_desc_t *desc;
+    uint8_t bytes[IR_PD_MAX_BYTES];
+    size_t byte_num;
+} pd_frame_t;
+
+/* Published frames of each family: the leading bytes are the fixed signature of the protocol */
+static const pd_frame_t s_known[] = {
+    { &ir_pd_nec,           { 0x01, 0xFE, 0x8B, 0x74 }, 4 },
+    { &ir_pd_samsung,       { 0x07, 0x07, 0x02, 0xFD }, 4 },
+    { &ir_pd_coolix,        { 0xB2, 0x4D, 0xBF, 0x40, 0xD0, 0x2F }, 6 },
+    { &ir_pd_toshiba_ac,    { 0xF2, 0x0D, 0x03, 0xFC, 0x01, 0x40, 0x00, 0x00, 0x41 }, 9 },
+    { &ir_pd_mitsubishi_ac, { 0x23, 0xCB, 0x26, 0x01, 0x00, 0x20, 0x08, 0x06, 0x30,
+                              0x45, 0x67, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F }, 18 },
+    { &ir_pd_daikin,        { 0x11, 0xDA, 0x27, 0x00, 0x02, 0x00, 0x00, 0x14 }, 8 },
+    { &ir_pd_daikin,        { 0x11, 0xDA, 0x27, 0x00, 0x00, 0x49, 0x2C, 0x00, 0xA0, 0x00,
+                              0x00, 0x06, 0x60, 0x00, 0x00, 0xC1, 0x80, 0x00, 0x5E }, 19 },
+};
+
+/*
+ * Turn a reference waveform into what the receiver reports: active-low
+ * levels, marks stretched and spaces shortened by the demodulator, plus
+ * jitter.
+ */
+static void to_capture(rmt_symbol_word_t *wave, size_t n, uint32_t seed)
+{
+    uint32_t rng = seed;
+    for (size_t i = 0; i < n; i++) {
+        rng = rng * 1103515245u + 12345u;
+        int32_t j0 = (int32_t)((rng >> 16) % 121u) - 60;
+        rng = rng * 1103515245u + 12345u;
+        int32_t j1 = (int32_t)((rng >> 16) % 121u) - 60;
+        wave[i].level0 = 0;
+        wave[i].level1 = 1;
+        wave[i].duration0 = (uint32_t)((int32_t)wave[i].duration0 + 80 + j0);
+        if (wave[i].duration1) {
+            wave[i].duration1 = (uint32_t)((int32_t)wave[i].duration1 - 80 + j1);
+        }
+    }
+}
+
+/* =========================
+ * Test cases
+ * ========================= */
+static void test_nec_preset_matches_recorded_captures(void)
+{
+    capture_set_t set = {0};
+    TEST_ASSERT_GREATER_THAN_INT(0, capture_file_load(HOST_CAPTURES_DIR "/nec_remote_a.log", &set));
+    TEST_ASSERT_GREATER_THAN_INT(0, capture_file_load(HOST_CAPTURES_DIR "/nec_remote_b.log", &set));
+
+    size_t frames = 0;
+    for (size_t i = 0; i < set.frame_num; i++) {
+        const capture_frame_t *f = &set.frames[i];
+        uint8_t bytes[IR_PD_MAX_BYTES];
+        size_t n = 0;
+        const ir_pd_desc_t *desc = ir_pd_identify(PD_RES_HZ, f->symbols, f->symbol_num, bytes, sizeof(bytes), &n);
+        ir_nec_frame_t nec;
+
+        if (f->symbol_num != NEC_FRAME_SYMBOLS) {
+            TEST_ASSERT_NULL(desc); /* repeat codes carry no data */
+            continue;
+        }
+        TEST_ASSERT_TRUE(nec_parse_frame(&s_lut, f->symbols, &nec));
+        TEST_ASSERT_TRUE(desc == &ir_pd_nec);
+        TEST_ASSERT_EQUAL_UINT32(4, n);
+        uint16_t address = (uint16_t)(bytes[0] | bytes[1] << 8);
+        uint16_t command = (uint16_t)(bytes[2] | bytes[3] << 8);
+        TEST_ASSERT_EQUAL_HEX16(nec.address, address);
+        TEST_ASSERT_EQUAL_HEX16(nec.command, command);
+        frames++;
+    }
+    capture_set_free(&set);
+    TEST_ASSERT_GREATER_THAN_INT(0, (int)frames);
+}
+
+static void test_presets_identify_known_frames(void)
+{
+    for (size_t k = 0; k < sizeof(s_known) / sizeof(s_known[0]); k++) {
+        const pd_frame_t *f = &s_known[k];
+        uint8_t bytes[IR_PD_MAX_BYTES];
+        size_t n = ir_pd_expand(f->desc, PD_RES_HZ, f->bytes, f->byte_num, s_wave, sizeof(s_wave) / sizeof(s_wave[0]));
+        size_t byte_num = 0;
+
+        TEST_ASSERT_EQUAL_UINT32(ir_pd_symbol_count(f->desc, f->byte_num), n);
+        to_capture(s_wave, n, 7 + (uint32_t)k);
+
+        const ir_pd_desc_t *desc = ir_pd_identify(PD_RES_HZ, s_wave, n, bytes, sizeof(bytes), &byte_num);
+        TEST_ASSERT_TRUE_MESSAGE(desc == f->desc, f->desc->name);
+        TEST_ASSERT_EQUAL_UINT32(f->byte_num, byte_num);
+        TEST_ASSERT_EQUAL_MEMORY(f->bytes, bytes, byte_num);
+
+        /* Stored as data bytes instead of one 4-byte symbol per bit */
+        size_t raw_bytes = n * sizeof(rmt_symbol_word_t);
+        TEST_ASSERT_GREATER_THAN_INT((int)(8 * byte_num), (int)raw_bytes);
+    }
+}
+
+static void test_expand_bit_order(void)
+{
+    static const uint8_t data[1] = { 0x01 };
+    ir_pd_symbols_t sym;
+    size_t n;
+
+    ir_pd_symbols(&ir_pd_coolix, PD_RES_HZ, &sym);
+    n = ir_pd_expand(&ir_pd_coolix, PD_RES_HZ, data, 1, s_wave, 10);
+    TEST_ASSERT_EQUAL_UINT32(10, n);
+    TEST_ASSERT_EQUAL_UINT32(sym.zero.duration1, s_wave[1].duration1); /* MSB first */
+    TEST_ASSERT_EQUAL_UINT32(sym.one.duration1, s_wave[8].duration1);
+
+    ir_pd_symbols(&ir_pd_nec, PD_RES_HZ, &sym);
+    n = ir_pd_expand(&ir_pd_nec, PD_RES_HZ, data, 1, s_wave, 10);
+    TEST_ASSERT_EQUAL_UINT32(sym.one.duration1, s_wave[1].duration1); /* LSB first */
+    TEST_ASSERT_EQUAL_UINT32(sym.zero.duration1, s_wave[8].duration1);
+    TEST_ASSERT_EQUAL_UINT32(0, s_wave[9].duration1); /* trailer ends the transmission */
+
+    TEST_ASSERT_EQUAL_UINT32(0, ir_pd_expand(&ir_pd_nec, PD_RES_HZ, data, 1, s_wave, 9));
+}
+
+static void test_pulse_width_descriptor(void)
+{
+    /* Bits differ in their mark, no trailer */
+    static const ir_pd_desc_t pw = {
+        .name = "pw", .leader = { 2400, 600 }, .zero = { 600, 600 }, .one = { 1200, 600 }, .byte_num = 2,
+    };
+    static const uint8_t data[2] = { 0x95, 0x3C };
+    uint8_t bytes[2];
+    size_t byte_num = 0;
+
+    size_t n = ir_pd_expand(&pw, PD_RES_HZ, data, 2, s_wave, 17);
+    TEST_ASSERT_EQUAL_UINT32(17, n);
+    TEST_ASSERT_EQUAL_UINT32(1200, s_wave[1].duration0);
+    to_capture(s_wave, n, 3);
+    TEST_ASSERT_TRUE(ir_pd_decode(&pw, PD_RES_HZ, s_wave, n, bytes, sizeof(bytes), &byte_num));
+    TEST_ASSERT_EQUAL_MEMORY(data, bytes, 2);
+}
+
+static void test_decode_rejects_mismatches(void)
+{
+    const pd_frame_t *f = &s_known[4]; /* Mitsubishi, 18 bytes */
+    uint8_t bytes[IR_PD_MAX_BYTES];
+    size_t byte_num = 0;
+    size_t n = ir_pd_expand(f->desc, PD_RES_HZ, f->bytes, f->byte_num, s_wave, sizeof(s_wave) / sizeof(s_wave[0]));
+
+    TEST_ASSERT_TRUE(ir_pd_decode(f->desc, PD_RES_HZ, s_wave, n, bytes, sizeof(bytes), &byte_num));
+
+    /* Wrong length for a fixed-length preset */
+    TEST_ASSERT_FALSE(ir_pd_decode(f->desc, PD_RES_HZ, s_wave, n - 1, bytes, sizeof(bytes), &byte_num));
+    size_t short_n = ir_pd_expand(f->desc, PD_RES_HZ, f->bytes, 17, s_wave, sizeof(s_wave) / sizeof(s_wave[0]));
+    TEST_ASSERT_FALSE(ir_pd_decode(f->desc, PD_RES_HZ, s_wave, short_n, bytes, sizeof(bytes), &byte_num));
+    n = ir_pd_expand(f->desc, PD_RES_HZ, f->bytes, f->byte_num, s_wave, sizeof(s_wave) / sizeof(s_wave[0]));
+
+    /* Output too small */
+    TEST_ASSERT_FALSE(ir_pd_decode(f->desc, PD_RES_HZ, s_wave, n, bytes, 17, &byte_num));
+
+    /* A space halfway between logic 0 and 1 */
+    rmt_symbol_word_t bit = s_wave[20];
+    s_wave[20].duration1 = 860;
+    TEST_ASSERT_FALSE(ir_pd_decode(f->desc, PD_RES_HZ, s_wave, n, bytes, sizeof(bytes), &byte_num));
+    s_wave[20] = bit;
+
+    /* NEC leader on a Mitsubishi frame */
+    s_wave[0].duration0 = 9000;
+    s_wave[0].duration1 = 4500;
+    TEST_ASSERT_FALSE(ir_pd_decode(f->desc, PD_RES_HZ, s_wave, n, bytes, sizeof(bytes), &byte_num));
+    TEST_ASSERT_NULL(ir_pd_identify(PD_RES_HZ, s_wave, n, bytes, sizeof(bytes), &byte_num));
+}
+
+/* =========================
+ * Unity test runner
+ * ========================= */
+int main(void)
+{
+    ir_pulse_lut_init(&s_lut, PD_RES_HZ);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_nec_preset_matches_recorded_captures);
+    RUN_TEST(test_presets_identify_known_frames);
+    RUN_TEST(test_expand_bit_order);
+    RUN_TEST(test_pulse_width_descriptor);
+    RUN_TEST(test_decode_rejects_mismatches);
+    return UNITY_END();
+}
@@ -0,0 +1,108 @@
+/*
+ * test_ir_pd_encoder.c — host unit tests for the pulse-distance RMT encoder
+ *
+ * rmt_new_ir_pd_encoder() is the app's encoder built against the fake RMT TX
+ * channel and bytes encoder (common/fake_rmt_tx.c); its output must equal
+ * ir_pd_expand() for every preset, whatever the channel memory size.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "host_unity.h"
+#include "ir_pd.h"
+#include "ir_pd_encoder.h"
+#include "fake_rmt_tx.h"
+
+HOST_UNITY_INSTANCE;
+
+#define ENC_RES_HZ    1000000u
+#define ENC_MEM_MAX   64u
+#define ENC_OUT_CAP   (IR_PD_MAX_BYTES * 8 + 2)
+
+static rmt_symbol_word_t s_mem[ENC_MEM_MAX];
+static rmt_symbol_word_t s_out[ENC_OUT_CAP];
+static rmt_symbol_word_t s_expect[ENC_OUT_CAP];
+static uint8_t s_data[IR_PD_MAX_BYTES];
+
+/* =========================
+ * Helpers
+ * ========================= */
+static void fill_data(size_t byte_num, uint32_t seed)
+{
+    for (size_t i = 0; i < byte_num; i++) {
+        seed = seed * 1103515245u + 12345u;
+        s_data[i] = (uint8_t)(seed >> 16);
+    }
+}
+
+static void check_encoder(const ir_pd_desc_t *desc, size_t byte_num, size_t mem_symbols)
+{
+    ir_pd_encoder_config_t cfg = { .resolution = ENC_RES_HZ, .desc = desc };
+    rmt_encoder_handle_t enc = NULL;
+    fake_rmt_tx_t tx;
+
+    TEST_ASSERT_EQUAL_INT(ESP_OK, rmt_new_ir_pd_encoder(&cfg, &enc));
+    size_t n = ir_pd_expand(desc, ENC_RES_HZ, s_data, byte_num, s_expect, ENC_OUT_CAP);
+    TEST_ASSERT_GREATER_THAN_INT(0, (int)n);
+
+    /* Twice through the same encoder: the state must return to the start */
+    for (int pass = 0; pass < 2; pass++) {
+        fake_rmt_tx_init(&tx, s_mem, mem_symbols, s_out, ENC_OUT_CAP);
+        TEST_ASSERT_TRUE(fake_rmt_tx_run(&tx, enc, s_data, byte_num));
+        TEST_ASSERT_FALSE(tx.overflow);
+        TEST_ASSERT_EQUAL_UINT32(n, tx.out_num);
+        TEST_ASSERT_EQUAL_UINT32(n, tx.encoded);
+        TEST_ASSERT_EQUAL_MEMORY(s_expect, s_out, n * sizeof(rmt_symbol_word_t));
+    }
+    rmt_del_encoder(enc);
+}
+
+/* =========================
+ * Test cases
+ * ========================= */
+static void test_presets_match_reference_expansion(void)
+{
+    static const size_t mem_sizes[] = { 1, 2, 7, 48, ENC_MEM_MAX };
+
+    for (size_t p = 0; p < ir_pd_preset_num; p++) {
+        const ir_pd_desc_t *desc = ir_pd_presets[p];
+        size_t byte_num = desc->byte_num ? desc->byte_num : 19;
+        fill_data(byte_num, 11 + (uint32_t)p);
+        for (size_t m = 0; m < sizeof(mem_sizes) / sizeof(mem_sizes[0]); m++) {
+            check_encoder(desc, byte_num, mem_sizes[m]);
+        }
+    }
+}
+
+static void test_descriptor_without_leader_or_trailer(void)
+{
+    static const ir_pd_desc_t bare = {
+        .name = "bare", .zero = { 600, 600 }, .one = { 1200, 600 }, .msb_first = true,
+    };
+    fill_data(3, 5);
+    check_encoder(&bare, 3, 1);
+    check_encoder(&bare, 3, 24); /* data ends exactly at a full block */
+    check_encoder(&bare, 3, ENC_MEM_MAX);
+}
+
+static void test_invalid_config(void)
+{
+    ir_pd_encoder_config_t cfg = { .resolution = ENC_RES_HZ, .desc = NULL };
+    rmt_encoder_handle_t enc = NULL;
+    TEST_ASSERT_EQUAL_INT(ESP_ERR_INVALID_ARG, rmt_new_ir_pd_encoder(&cfg, &enc));
+    TEST_ASSERT_EQUAL_INT(ESP_ERR_INVALID_ARG, rmt_new_ir_pd_encoder(NULL, &enc));
+}
+
+/* =========================
+ * Unity test runner
+ * ========================= */
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_presets_match_reference_expansion);
+    RUN_TEST(test_descriptor_without_leader_or_trailer);
+    RUN_TEST(test_invalid_config);
+    return UNITY_END();
+}
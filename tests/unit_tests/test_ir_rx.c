@@ -0,0 +1,245 @@
+/*
+ * test_ir_rx.c — host unit tests for continuous N-buffer receive
+ *
+ * Runs ir_rx against the ir_sim_rx channel model, next to the old
+ * single-buffer loop (re-arm only after parsing) as a reference.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "host_unity.h"
+#include "ir_core.h"
+#include "ir_rx.h"
+#include "ir_sim_rx.h"
+
+HOST_UNITY_INSTANCE;
+
+#define RX_IDLE_US     12000u  /* signal_range_max_ns of the infrared_test app */
+#define NEC_GAP_US     40500u  /* 108 ms repeat period minus a 67.5 ms frame */
+
+/* =========================
+ * Helpers
+ * ========================= */
+static rmt_symbol_word_t sym(uint32_t l0, uint32_t d0, uint32_t l1, uint32_t d1)
+{
+    rmt_symbol_word_t s = { .level0 = l0, .duration0 = d0, .level1 = l1, .duration1 = d1 };
+    return s;
+}
+
+static size_t build_nec(rmt_symbol_word_t *out, uint16_t addr, uint16_t cmd)
+{
+    size_t n = 0;
+    out[n++] = sym(0, 9000, 1, 4500);
+    for (int i = 0; i < 32; i++) {
+        uint32_t v = (i < 16) ? addr : cmd;
+        out[n++] = sym(0, 560, 1, ((v >> (i & 15)) & 1u) ? 1690 : 560);
+    }
+    out[n++] = sym(0, 560, 1, 0);
+    return n;
+}
+
+/* Continuous receive: ISR commits + re-arms, task parses one frame per wake */
+typedef struct {
+    ir_rx_t rx;
+    uint32_t processed;
+    uint16_t commands[16];
+} ring_harness_t;
+
+static void ring_on_done(void *user, size_t symbol_num)
+{
+    ring_harness_t *h = user;
+    ir_rx_on_done(&h->rx, symbol_num);
+}
+
+static void ring_task_step(void *user)
+{
+    ring_harness_t *h = user;
+    ir_frame_slot_t *f = ir_rx_peek(&h->rx);
+    if (f == NULL) {
+        return;
+    }
+    if (h->processed < 16 && f->symbol_num >= 17) {
+        uint16_t cmd = 0;
+        for (int i = 0; i < 16; i++) {
+            cmd |= (uint16_t)((f->symbols[17 + i].duration1 > 1000) << i);
+        }
+        h->commands[h->processed] = cmd;
+    }
+    h->processed++;
+    ir_rx_release(&h->rx);
+}
+
+/* Previous app loop: one buffer, re-armed after parsing */
+typedef struct {
+    ir_sim_rx_t *sim;
+    rmt_symbol_word_t buf[IR_FRAME_MAX_SYMBOLS];
+    uint32_t processed;
+} legacy_harness_t;
+
+static void legacy_on_done(void *user, size_t symbol_num)
+{
+    (void)user;
+    (void)symbol_num;
+}
+
+static void legacy_task_step(void *user)
+{
+    legacy_harness_t *h = user;
+    h->processed++;
+    h->sim->hal.ops->arm(h->sim->hal.ctx, h->buf, IR_FRAME_MAX_SYMBOLS);
+}
+
+static ir_sim_rx_t s_sim;
+static ring_harness_t s_ring;
+static legacy_harness_t s_legacy;
+static rmt_symbol_word_t s_nec[8][NEC_FRAME_SYMBOLS];
+static ir_sim_frame_t s_frames[8];
+
+static void start_ring(uint32_t process_us)
+{
+    ir_sim_rx_cfg_t cfg = {
+        .idle_us = RX_IDLE_US, .process_us = process_us,
+        .on_done = ring_on_done, .task_step = ring_task_step, .user = &s_ring,
+    };
+    memset(&s_ring, 0, sizeof(s_ring));
+    ir_sim_rx_init(&s_sim, &cfg);
+    TEST_ASSERT_TRUE(ir_rx_start(&s_ring.rx, &s_sim.hal));
+}
+
+static void start_legacy(uint32_t process_us)
+{
+    ir_sim_rx_cfg_t cfg = {
+        .idle_us = RX_IDLE_US, .process_us = process_us,
+        .on_done = legacy_on_done, .task_step = legacy_task_step, .user = &s_legacy,
+    };
+    memset(&s_legacy, 0, sizeof(s_legacy));
+    ir_sim_rx_init(&s_sim, &cfg);
+    s_legacy.sim = &s_sim;
+    TEST_ASSERT_TRUE(s_sim.hal.ops->arm(s_sim.hal.ctx, s_legacy.buf, IR_FRAME_MAX_SYMBOLS));
+}
+
+static size_t build_burst(size_t n, uint32_t gap_us)
+{
+    for (size_t i = 0; i < n; i++) {
+        s_frames[i].symbol_num = build_nec(s_nec[i], 0xFE01, (uint16_t)(0x7400 + i));
+        s_frames[i].symbols = s_nec[i];
+        s_frames[i].gap_us = i == 0 ? 1000 : gap_us;
+    }
+    return n;
+}
+
+/* =========================
+ * Test cases
+ * ========================= */
+static void test_start_arms_first_slot(void)
+{
+    start_ring(1000);
+
+    TEST_ASSERT_TRUE(ir_rx_is_armed(&s_ring.rx));
+    TEST_ASSERT_TRUE(s_sim.armed);
+    TEST_ASSERT_TRUE(s_sim.buf == s_ring.rx.ring.slots[0].symbols);
+    TEST_ASSERT_EQUAL_UINT32(IR_FRAME_MAX_SYMBOLS, s_sim.cap);
+}
+
+static void test_next_slot_armed_from_done_callback(void)
+{
+    start_ring(1000);
+    s_sim.armed = false;      /* channel consumed the buffer */
+    ring_on_done(&s_ring, 0); /* as if slot 0 completed empty */
+
+    TEST_ASSERT_TRUE(ir_rx_is_armed(&s_ring.rx));
+    TEST_ASSERT_TRUE(s_sim.buf == s_ring.rx.ring.slots[1].symbols);
+    TEST_ASSERT_EQUAL_UINT32(1, ir_frame_ring_count(&s_ring.rx.ring));
+}
+
+static void test_back_to_back_frames_not_lost(void)
+{
+    /* 65 ms parse (per-symbol printf at 115200 baud) is longer than the NEC gap */
+    size_t n = build_burst(3, NEC_GAP_US);
+
+    start_legacy(65000);
+    ir_sim_rx_run(&s_sim, s_frames, n);
+    TEST_ASSERT_GREATER_THAN_INT(0, s_sim.frames_missed);
+
+    start_ring(65000);
+    ir_sim_rx_run(&s_sim, s_frames, n);
+    TEST_ASSERT_EQUAL_UINT32(0, s_sim.frames_missed);
+    TEST_ASSERT_EQUAL_UINT32(3, s_ring.processed);
+    for (size_t i = 0; i < n; i++) {
+        TEST_ASSERT_EQUAL_HEX16(0x7400 + i, s_ring.commands[i]);
+    }
+}
+
+static void test_slow_task_stalls_channel(void)
+{
+    ir_rx_stats_t st;
+    size_t n = build_burst(IR_FRAME_RING_SLOTS + 2, 20000);
+
+    /* Task never gets to run within the burst */
+    start_ring(10u * 1000u * 1000u);
+    ir_sim_rx_run(&s_sim, s_frames, n);
+    ir_rx_get_stats(&s_ring.rx, &st);
+    TEST_ASSERT_EQUAL_UINT32(IR_FRAME_RING_SLOTS, st.ring.committed);
+    TEST_ASSERT_EQUAL_UINT32(1, st.stalls);
+    TEST_ASSERT_EQUAL_UINT32(0, st.arm_errors);
+    TEST_ASSERT_EQUAL_UINT32(2, s_sim.frames_missed);
+
+    /* The task drained the ring afterwards and the channel is listening again */
+    TEST_ASSERT_EQUAL_UINT32(IR_FRAME_RING_SLOTS, s_ring.processed);
+    TEST_ASSERT_TRUE(s_sim.armed);
+}
+
+static void test_release_rearms_stalled_channel(void)
+{
+    ir_rx_stats_t st;
+
+    start_ring(1000);
+    for (uint32_t i = 0; i < IR_FRAME_RING_SLOTS; i++) {
+        TEST_ASSERT_TRUE(ir_rx_is_armed(&s_ring.rx));
+        s_sim.armed = false; /* channel consumed the buffer */
+        ring_on_done(&s_ring, NEC_REPEAT_SYMBOLS);
+    }
+    TEST_ASSERT_FALSE(ir_rx_is_armed(&s_ring.rx));
+    TEST_ASSERT_FALSE(s_sim.armed);
+
+    ir_rx_release(&s_ring.rx);
+    TEST_ASSERT_TRUE(ir_rx_is_armed(&s_ring.rx));
+    TEST_ASSERT_TRUE(s_sim.armed);
+    TEST_ASSERT_TRUE(s_sim.buf == s_ring.rx.ring.slots[0].symbols);
+
+    ir_rx_get_stats(&s_ring.rx, &st);
+    TEST_ASSERT_EQUAL_UINT32(1, st.stalls);
+}
+
+static void test_close_frames_merge_into_one_receive(void)
+{
+    rmt_symbol_word_t rep[2] = { sym(0, 9000, 1, 2250), sym(0, 560, 1, 0) };
+    ir_sim_frame_t frames[2] = {
+        { rep, 2, 1000 },
+        { rep, 2, RX_IDLE_US / 2 },
+    };
+
+    start_ring(1000);
+    ir_sim_rx_run(&s_sim, frames, 2);
+
+    TEST_ASSERT_EQUAL_UINT32(1, s_sim.frames_merged);
+    TEST_ASSERT_EQUAL_UINT32(1, s_ring.processed);
+    TEST_ASSERT_EQUAL_UINT32(4, s_ring.rx.ring.slots[0].symbol_num);
+}
+
+/* =========================
+ * Unity test runner
+ * ========================= */
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_start_arms_first_slot);
+    RUN_TEST(test_next_slot_armed_from_done_callback);
+    RUN_TEST(test_back_to_back_frames_not_lost);
+    RUN_TEST(test_slow_task_stalls_channel);
+    RUN_TEST(test_release_rearms_stalled_channel);
+    RUN_TEST(test_close_frames_merge_into_one_receive);
+    return UNITY_END();
+}
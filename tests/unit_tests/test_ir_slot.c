@@ -0,0 +1,292 @@
+/*
+ * test_ir_slot.c — host unit tests for the compact IR slot blob format
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "host_unity.h"
+#include "ir_core.h"
+#include "ir_slot.h"
+
+HOST_UNITY_INSTANCE;
+
+#define SLOT_RES_HZ 1000000u
+
+static const ir_slot_meta_t s_meta = {
+    .carrier_hz = 38000, .duty_pct = 33, .repeat = 2, .repeat_gap_us = 40000,
+};
+
+static rmt_symbol_word_t s_wave[600];
+static rmt_symbol_word_t s_out[600];
+static uint8_t s_blob[4096];
+
+/* =========================
+ * Helpers
+ * ========================= */
+static rmt_symbol_word_t sym(uint32_t l0, uint32_t d0, uint32_t l1, uint32_t d1)
+{
+    rmt_symbol_word_t s = { .level0 = l0, .duration0 = d0, .level1 = l1, .duration1 = d1 };
+    return s;
+}
+
+static size_t build_nec(rmt_symbol_word_t *out, uint16_t addr, uint16_t cmd)
+{
+    size_t n = 0;
+    out[n++] = sym(1, NEC_LEADING_CODE_DURATION_0, 0, NEC_LEADING_CODE_DURATION_1);
+    for (int i = 0; i < 32; i++) {
+        uint32_t v = (i < 16) ? addr : cmd;
+        bool one = (v >> (i & 15)) & 1u;
+        out[n++] = sym(1, NEC_PAYLOAD_ZERO_DURATION_0, 0,
+                       one ? NEC_PAYLOAD_ONE_DURATION_1 : NEC_PAYLOAD_ZERO_DURATION_1);
+    }
+    out[n++] = sym(1, NEC_PAYLOAD_ZERO_DURATION_0, 0, 0);
+    return n;
+}
+
+static uint32_t jitter_us(uint32_t us, uint32_t jitter, uint32_t *rng)
+{
+    if (jitter == 0) {
+        return us;
+    }
+    *rng = *rng * 1103515245u + 12345u;
+    return us + (*rng >> 16) % (2 * jitter + 1) - jitter;
+}
+
+/* Daikin-like sub-frame with receiver jitter of up to +-jitter us */
+static size_t build_ac(rmt_symbol_word_t *out, size_t symbol_num, uint32_t seed, uint32_t jitter)
+{
+    uint32_t rng = seed;
+    out[0] = sym(0, jitter_us(3500, jitter, &rng), 1, jitter_us(1700, jitter, &rng));
+    for (size_t i = 1; i + 1 < symbol_num; i++) {
+        seed = seed * 22695477u + 1u;
+        out[i] = sym(0, jitter_us(430, jitter, &rng), 1, jitter_us((seed >> 16) & 1u ? 1300 : 430, jitter, &rng));
+    }
+    out[symbol_num - 1] = sym(0, jitter_us(430, jitter, &rng), 1, 0);
+    return symbol_num;
+}
+
+static ir_slot_encode_cfg_t enc_cfg(uint8_t tolerance_pct)
+{
+    ir_slot_encode_cfg_t cfg = { .resolution_hz = SLOT_RES_HZ, .tolerance_pct = tolerance_pct };
+    return cfg;
+}
+
+/* =========================
+ * Test cases
+ * ========================= */
+static void test_nec_round_trip_exact(void)
+{
+    ir_slot_encode_cfg_t cfg = enc_cfg(0);
+    ir_slot_header_t hdr;
+    size_t len, n = build_nec(s_wave, 0xFE01, 0x748B);
+    size_t out_n, seg_n;
+
+    TEST_ASSERT_EQUAL_INT(IR_SLOT_OK, ir_slot_encode(&cfg, &s_meta, s_wave, n, NULL, 0, s_blob, sizeof(s_blob), &len));
+    TEST_ASSERT_EQUAL_INT(IR_SLOT_OK, ir_slot_parse_header(s_blob, len, &hdr));
+    TEST_ASSERT_EQUAL_UINT32(38000, hdr.meta.carrier_hz);
+    TEST_ASSERT_EQUAL_UINT32(33, hdr.meta.duty_pct);
+    TEST_ASSERT_EQUAL_UINT32(2, hdr.meta.repeat);
+    TEST_ASSERT_EQUAL_UINT32(40000, hdr.meta.repeat_gap_us);
+    TEST_ASSERT_EQUAL_UINT32(n, hdr.symbol_num);
+    TEST_ASSERT_EQUAL_UINT32(5, hdr.dict_num); /* 9000, 4500, 560, 1690, 0 */
+    TEST_ASSERT_TRUE(hdr.flags & IR_SLOT_F_LEVEL0_HIGH);
+
+    /* 34 symbols x 3 bits x 2 + dict + seg table, vs 136 bytes of raw symbols */
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(IR_SLOT_HEADER_SIZE + 10 + 3 + 26, len);
+
+    TEST_ASSERT_EQUAL_INT(IR_SLOT_OK, ir_slot_decode(s_blob, len, SLOT_RES_HZ, s_out, 600, &out_n, NULL, 0, &seg_n));
+    TEST_ASSERT_EQUAL_UINT32(n, out_n);
+    TEST_ASSERT_EQUAL_UINT32(1, seg_n);
+    TEST_ASSERT_EQUAL_MEMORY(s_wave, s_out, n * sizeof(rmt_symbol_word_t));
+}
+
+static void test_jittered_capture_within_tolerance(void)
+{
+    ir_slot_encode_cfg_t cfg = enc_cfg(20);
+    size_t len, out_n;
+    size_t n = build_ac(s_wave, 300, 5, 60);
+
+    TEST_ASSERT_EQUAL_INT(IR_SLOT_OK, ir_slot_encode(&cfg, &s_meta, s_wave, n, NULL, 0, s_blob, sizeof(s_blob), &len));
+    TEST_ASSERT_EQUAL_INT(IR_SLOT_OK, ir_slot_decode(s_blob, len, SLOT_RES_HZ, s_out, 600, &out_n, NULL, 0, NULL));
+    TEST_ASSERT_EQUAL_UINT32(n, out_n);
+    /* 5 clusters -> 3-bit indices, under a quarter of the raw symbol size */
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(n * sizeof(rmt_symbol_word_t) / 4, len);
+
+    for (size_t i = 0; i < n; i++) {
+        TEST_ASSERT_EQUAL_UINT32(s_wave[i].level0, s_out[i].level0);
+        TEST_ASSERT_UINT32_WITHIN(120, s_wave[i].duration0, s_out[i].duration0);
+        TEST_ASSERT_UINT32_WITHIN(120, s_wave[i].duration1, s_out[i].duration1);
+    }
+}
+
+static void test_repeated_subframe_stored_once(void)
+{
+    ir_capture_seg_t segs[3] = {
+        { .offset = 0,   .symbol_num = 100, .gap_us = 0 },
+        { .offset = 100, .symbol_num = 100, .gap_us = 30000 },
+        { .offset = 200, .symbol_num = 100, .gap_us = 30000 },
+    };
+    ir_capture_seg_t out_segs[IR_CAPTURE_MAX_SEGS];
+    ir_slot_encode_cfg_t cfg = enc_cfg(0);
+    size_t one_len, len, out_n, seg_n;
+
+    build_ac(s_wave, 100, 17, 0);
+    TEST_ASSERT_EQUAL_INT(IR_SLOT_OK, ir_slot_encode(&cfg, &s_meta, s_wave, 100, NULL, 0, s_blob, sizeof(s_blob), &one_len));
+
+    memcpy(&s_wave[100], s_wave, 100 * sizeof(rmt_symbol_word_t));
+    build_ac(&s_wave[200], 100, 18, 0);
+    TEST_ASSERT_EQUAL_INT(IR_SLOT_OK, ir_slot_encode(&cfg, &s_meta, s_wave, 300, segs, 3, s_blob, sizeof(s_blob), &len));
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(2 * one_len - IR_SLOT_HEADER_SIZE + 8, len);
+
+    TEST_ASSERT_EQUAL_INT(IR_SLOT_OK, ir_slot_decode(s_blob, len, SLOT_RES_HZ, s_out, 600, &out_n,
+                                                     out_segs, IR_CAPTURE_MAX_SEGS, &seg_n));
+    TEST_ASSERT_EQUAL_UINT32(300, out_n);
+    TEST_ASSERT_EQUAL_UINT32(3, seg_n);
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL_UINT32(segs[i].offset, out_segs[i].offset);
+        TEST_ASSERT_EQUAL_UINT32(segs[i].symbol_num, out_segs[i].symbol_num);
+        TEST_ASSERT_EQUAL_UINT32(segs[i].gap_us, out_segs[i].gap_us);
+    }
+    TEST_ASSERT_EQUAL_MEMORY(s_wave, s_out, 300 * sizeof(rmt_symbol_word_t));
+}
+
+static void test_runs_are_compressed(void)
+{
+    ir_slot_encode_cfg_t cfg = enc_cfg(0);
+    size_t len, out_n;
+
+    s_wave[0] = sym(0, 3000, 1, 3000);
+    for (size_t i = 1; i < 400; i++) {
+        s_wave[i] = sym(0, 500, 1, 500);
+    }
+    s_wave[400] = sym(0, 500, 1, 0);
+
+    TEST_ASSERT_EQUAL_INT(IR_SLOT_OK, ir_slot_encode(&cfg, &s_meta, s_wave, 401, NULL, 0, s_blob, sizeof(s_blob), &len));
+    /* 399 repeats = 67 escape tokens of at most 6 symbols, 4 bits each */
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(IR_SLOT_HEADER_SIZE + 64, len);
+
+    TEST_ASSERT_EQUAL_INT(IR_SLOT_OK, ir_slot_decode(s_blob, len, SLOT_RES_HZ, s_out, 600, &out_n, NULL, 0, NULL));
+    TEST_ASSERT_EQUAL_UINT32(401, out_n);
+    TEST_ASSERT_EQUAL_MEMORY(s_wave, s_out, 401 * sizeof(rmt_symbol_word_t));
+}
+
+static void test_many_durations_fall_back_to_raw(void)
+{
+    ir_slot_encode_cfg_t cfg = enc_cfg(0);
+    ir_slot_header_t hdr;
+    size_t len, out_n;
+
+    for (size_t i = 0; i < 40; i++) {
+        s_wave[i] = sym(0, 300 + 37 * (uint32_t)i, 1, 20000 - 111 * (uint32_t)i);
+    }
+
+    TEST_ASSERT_EQUAL_INT(IR_SLOT_OK, ir_slot_encode(&cfg, &s_meta, s_wave, 40, NULL, 0, s_blob, sizeof(s_blob), &len));
+    TEST_ASSERT_EQUAL_INT(IR_SLOT_OK, ir_slot_parse_header(s_blob, len, &hdr));
+    TEST_ASSERT_TRUE(hdr.flags & IR_SLOT_F_RAW);
+    TEST_ASSERT_EQUAL_UINT32(0, hdr.dict_num);
+
+    TEST_ASSERT_EQUAL_INT(IR_SLOT_OK, ir_slot_decode(s_blob, len, SLOT_RES_HZ, s_out, 600, &out_n, NULL, 0, NULL));
+    TEST_ASSERT_EQUAL_UINT32(40, out_n);
+    TEST_ASSERT_EQUAL_MEMORY(s_wave, s_out, 40 * sizeof(rmt_symbol_word_t));
+}
+
+static void test_corrupt_blob_rejected(void)
+{
+    ir_slot_encode_cfg_t cfg = enc_cfg(0);
+    ir_slot_header_t hdr;
+    size_t len, n = build_nec(s_wave, 0x00FF, 0x10EF);
+
+    TEST_ASSERT_EQUAL_INT(IR_SLOT_OK, ir_slot_encode(&cfg, &s_meta, s_wave, n, NULL, 0, s_blob, sizeof(s_blob), &len));
+
+    s_blob[len - 1] ^= 0x04;
+    TEST_ASSERT_EQUAL_INT(IR_SLOT_ERR_CRC, ir_slot_parse_header(s_blob, len, &hdr));
+    s_blob[len - 1] ^= 0x04;
+
+    TEST_ASSERT_EQUAL_INT(IR_SLOT_ERR_FORMAT, ir_slot_parse_header(s_blob, len - 1, &hdr));
+    TEST_ASSERT_EQUAL_INT(IR_SLOT_ERR_FORMAT, ir_slot_parse_header(s_blob, 10, &hdr));
+
+    s_blob[2] = IR_SLOT_VERSION + 1;
+    TEST_ASSERT_EQUAL_INT(IR_SLOT_ERR_VERSION, ir_slot_parse_header(s_blob, len, &hdr));
+    s_blob[2] = IR_SLOT_VERSION;
+
+    s_blob[0] = 'X';
+    TEST_ASSERT_EQUAL_INT(IR_SLOT_ERR_FORMAT, ir_slot_parse_header(s_blob, len, &hdr));
+}
+
+static void test_chunked_reader_matches_decode(void)
+{
+    ir_capture_seg_t segs[2] = {
+        { .offset = 0,   .symbol_num = 150, .gap_us = 0 },
+        { .offset = 150, .symbol_num = 250, .gap_us = 25000 },
+    };
+    ir_slot_encode_cfg_t cfg = enc_cfg(10);
+    ir_slot_reader_t r;
+    size_t len, full_n, got = 0;
+    uint32_t gap;
+    size_t seg_len;
+
+    build_ac(s_wave, 150, 21, 30);
+    build_ac(&s_wave[150], 250, 22, 30);
+    TEST_ASSERT_EQUAL_INT(IR_SLOT_OK, ir_slot_encode(&cfg, &s_meta, s_wave, 400, segs, 2, s_blob, sizeof(s_blob), &len));
+    TEST_ASSERT_EQUAL_INT(IR_SLOT_OK, ir_slot_decode(s_blob, len, SLOT_RES_HZ, s_wave, 600, &full_n, NULL, 0, NULL));
+
+    TEST_ASSERT_EQUAL_INT(IR_SLOT_OK, ir_slot_reader_init(&r, s_blob, len, SLOT_RES_HZ));
+    for (int s = 0; ir_slot_reader_next_segment(&r, &gap, &seg_len); s++) {
+        TEST_ASSERT_EQUAL_UINT32(segs[s].gap_us, gap);
+        TEST_ASSERT_EQUAL_UINT32(segs[s].symbol_num, seg_len);
+        size_t k;
+        while ((k = ir_slot_read(&r, &s_out[got], 7)) > 0) { /* odd size splits escape runs */
+            got += k;
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(full_n, got);
+    TEST_ASSERT_EQUAL_MEMORY(s_wave, s_out, got * sizeof(rmt_symbol_word_t));
+}
+
+static void test_resolution_scaling(void)
+{
+    ir_slot_encode_cfg_t cfg = enc_cfg(0);
+    size_t len, out_n, n = build_nec(s_wave, 0xFE01, 0x748B);
+
+    TEST_ASSERT_EQUAL_INT(IR_SLOT_OK, ir_slot_encode(&cfg, &s_meta, s_wave, n, NULL, 0, s_blob, sizeof(s_blob), &len));
+    TEST_ASSERT_EQUAL_INT(IR_SLOT_OK, ir_slot_decode(s_blob, len, 2 * SLOT_RES_HZ, s_out, 600, &out_n, NULL, 0, NULL));
+    TEST_ASSERT_EQUAL_UINT32(2 * NEC_LEADING_CODE_DURATION_0, s_out[0].duration0);
+    TEST_ASSERT_EQUAL_UINT32(2 * NEC_PAYLOAD_ZERO_DURATION_0, s_out[1].duration0);
+}
+
+static void test_small_buffers_report_size(void)
+{
+    ir_slot_encode_cfg_t cfg = enc_cfg(0);
+    size_t len, need, out_n, n = build_nec(s_wave, 0xFE01, 0x748B);
+
+    TEST_ASSERT_EQUAL_INT(IR_SLOT_ERR_NO_SPACE, ir_slot_encode(&cfg, &s_meta, s_wave, n, NULL, 0, s_blob, 16, &need));
+    TEST_ASSERT_EQUAL_INT(IR_SLOT_OK, ir_slot_encode(&cfg, &s_meta, s_wave, n, NULL, 0, s_blob, need, &len));
+    TEST_ASSERT_EQUAL_UINT32(need, len);
+
+    TEST_ASSERT_EQUAL_INT(IR_SLOT_ERR_NO_SPACE, ir_slot_decode(s_blob, len, SLOT_RES_HZ, s_out, n - 1, &out_n, NULL, 0, NULL));
+
+    /* Mixed polarity cannot be represented */
+    s_wave[3].level0 = 0;
+    s_wave[3].level1 = 1;
+    TEST_ASSERT_EQUAL_INT(IR_SLOT_ERR_ARG, ir_slot_encode(&cfg, &s_meta, s_wave, n, NULL, 0, s_blob, sizeof(s_blob), &len));
+}
+
+/* =========================
+ * Unity test runner
+ * ========================= */
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_nec_round_trip_exact);
+    RUN_TEST(test_jittered_capture_within_tolerance);
+    RUN_TEST(test_repeated_subframe_stored_once);
+    RUN_TEST(test_runs_are_compressed);
+    RUN_TEST(test_many_durations_fall_back_to_raw);
+    RUN_TEST(test_corrupt_blob_rejected);
+    RUN_TEST(test_chunked_reader_matches_decode);
+    RUN_TEST(test_resolution_scaling);
+    RUN_TEST(test_small_buffers_report_size);
+    return UNITY_END();
+}
@@ -0,0 +1,278 @@
+/*
+ * test_ir_slot_encoder.c — host unit tests for the streaming ir_slot TX path
+ *
+ * ir_slot_stream is checked directly; rmt_new_ir_slot_encoder() is the app's
+ * encoder built against the fake RMT TX channel (common/fake_rmt_tx.c), which
+ * yields RMT_ENCODING_MEM_FULL every mem_block_symbols like the driver.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "host_unity.h"
+#include "ir_core.h"
+#include "ir_slot.h"
+#include "ir_slot_stream.h"
+#include "ir_slot_encoder.h"
+#include "fake_rmt_tx.h"
+
+HOST_UNITY_INSTANCE;
+
+#define ENC_RES_HZ     1000000u
+#define ENC_MEM_BLOCK  48u
+#define ENC_OUT_CAP    2048u
+
+static const ir_slot_meta_t s_meta = { .carrier_hz = 38000, .duty_pct = 33 };
+
+static rmt_symbol_word_t s_wave[1200];
+static rmt_symbol_word_t s_expect[1200];
+static rmt_symbol_word_t s_mem[ENC_MEM_BLOCK];
+static rmt_symbol_word_t s_out[ENC_OUT_CAP];
+static uint8_t s_blob[4096];
+
+/* =========================
+ * Helpers
+ * ========================= */
+static rmt_symbol_word_t sym(uint32_t l0, uint32_t d0, uint32_t l1, uint32_t d1)
+{
+    rmt_symbol_word_t s = { .level0 = l0, .duration0 = d0, .level1 = l1, .duration1 = d1 };
+    return s;
+}
+
+/* TX-level (active high) pulse-distance frame */
+static size_t build_frame(rmt_symbol_word_t *out, size_t symbol_num, uint32_t seed)
+{
+    out[0] = sym(1, 3500, 0, 1700);
+    for (size_t i = 1; i + 1 < symbol_num; i++) {
+        seed = seed * 1103515245u + 12345u;
+        out[i] = sym(1, 430, 0, (seed >> 16) & 1u ? 1300 : 430);
+    }
+    out[symbol_num - 1] = sym(1, 430, 0, 0);
+    return symbol_num;
+}
+
+static ir_slot_tx_payload_t encode_blob(const ir_capture_seg_t *segs, size_t seg_num, size_t symbol_num)
+{
+    ir_slot_encode_cfg_t cfg = { .resolution_hz = ENC_RES_HZ, .tolerance_pct = 0 };
+    ir_slot_tx_payload_t payload = { .blob = s_blob };
+    ir_slot_err_t err = ir_slot_encode(&cfg, &s_meta, s_wave, symbol_num, segs, seg_num,
+                                       s_blob, sizeof(s_blob), &payload.len);
+    TEST_ASSERT_EQUAL_INT(IR_SLOT_OK, err);
+    return payload;
+}
+
+static uint64_t total_ticks(const rmt_symbol_word_t *s, size_t n)
+{
+    uint64_t t = 0;
+    for (size_t i = 0; i < n; i++) {
+        t += s[i].duration0 + s[i].duration1;
+    }
+    return t;
+}
+
+static rmt_encoder_handle_t new_encoder(void)
+{
+    ir_slot_encoder_config_t cfg = { .resolution = ENC_RES_HZ };
+    rmt_encoder_handle_t enc = NULL;
+    TEST_ASSERT_EQUAL_INT(ESP_OK, rmt_new_ir_slot_encoder(&cfg, &enc));
+    TEST_ASSERT_NOT_NULL(enc);
+    return enc;
+}
+
+/* =========================
+ * Test cases
+ * ========================= */
+static void test_stream_matches_decode_single_frame(void)
+{
+    ir_slot_stream_t st;
+    size_t n = build_frame(s_wave, 140, 1);
+    ir_slot_tx_payload_t pl = encode_blob(NULL, 0, n);
+    size_t got = 0, k;
+
+    TEST_ASSERT_EQUAL_INT(IR_SLOT_OK, ir_slot_stream_init(&st, &pl, ENC_RES_HZ));
+    while ((k = ir_slot_stream_fill(&st, &s_out[got], 5)) > 0) {
+        got += k;
+    }
+    TEST_ASSERT_EQUAL_UINT32(n, got);
+    TEST_ASSERT_EQUAL_MEMORY(s_wave, s_out, n * sizeof(rmt_symbol_word_t));
+    TEST_ASSERT_TRUE(st.done);
+}
+
+static void test_stream_folds_gaps_into_one_transmission(void)
+{
+    ir_capture_seg_t segs[3] = {
+        { .offset = 0,   .symbol_num = 20,  .gap_us = 0 },
+        { .offset = 20,  .symbol_num = 20,  .gap_us = 25000 },
+        { .offset = 40,  .symbol_num = 100, .gap_us = 90000 }, /* > 2 symbol halves */
+    };
+    ir_slot_stream_t st;
+    size_t got = 0, k;
+
+    build_frame(s_wave, 20, 2);
+    memcpy(&s_wave[20], s_wave, 20 * sizeof(rmt_symbol_word_t));
+    build_frame(&s_wave[40], 100, 3);
+    ir_slot_tx_payload_t pl = encode_blob(segs, 3, 140);
+
+    TEST_ASSERT_EQUAL_INT(IR_SLOT_OK, ir_slot_stream_init(&st, &pl, ENC_RES_HZ));
+    while ((k = ir_slot_stream_fill(&st, &s_out[got], 20)) > 0) { /* sub-frame ends on a fill boundary */
+        got += k;
+    }
+
+    /* Same on-air time as the sub-frames plus their gaps */
+    TEST_ASSERT_EQUAL_UINT32(total_ticks(s_wave, 140) + 25000 + 90000, total_ticks(s_out, got));
+    /* Only the final symbol may carry the zero end marker */
+    for (size_t i = 0; i + 1 < got; i++) {
+        TEST_ASSERT_TRUE(s_out[i].duration0 > 0 && s_out[i].duration1 > 0);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, s_out[got - 1].duration1);
+
+    /* First sub-frame unchanged except its end marker, which opens the gap */
+    TEST_ASSERT_EQUAL_MEMORY(s_wave, s_out, 19 * sizeof(rmt_symbol_word_t));
+    TEST_ASSERT_EQUAL_UINT32(25000, s_out[19].duration1);
+    TEST_ASSERT_EQUAL_UINT32(0, s_out[19].level1);
+    TEST_ASSERT_EQUAL_MEMORY(&s_wave[20], &s_out[20], 19 * sizeof(rmt_symbol_word_t));
+
+    /* 90 ms: 32767 in the end marker, the rest as idle-level symbols */
+    TEST_ASSERT_EQUAL_UINT32(IR_SLOT_STREAM_MAX_TICKS, s_out[39].duration1);
+    TEST_ASSERT_EQUAL_UINT32(0, s_out[40].level0);
+    TEST_ASSERT_EQUAL_UINT32(0, s_out[40].level1);
+    TEST_ASSERT_EQUAL_MEMORY(&s_wave[40], &s_out[got - 100], 100 * sizeof(rmt_symbol_word_t));
+}
+
+static void test_stream_tail_gap_and_count(void)
+{
+    ir_slot_stream_t st;
+    size_t n = build_frame(s_wave, 40, 7);
+    ir_slot_tx_payload_t pl = encode_blob(NULL, 0, n);
+    size_t got = 0, k;
+
+    pl.tail_gap_us = 40000;
+    TEST_ASSERT_EQUAL_INT(IR_SLOT_OK, ir_slot_stream_init(&st, &pl, ENC_RES_HZ));
+    while ((k = ir_slot_stream_fill(&st, &s_out[got], 8)) > 0) { /* frame ends on a fill boundary */
+        got += k;
+    }
+
+    /* End marker holds 32767 ticks, one idle symbol the remaining 7233 */
+    TEST_ASSERT_EQUAL_UINT32(n + 1, got);
+    TEST_ASSERT_EQUAL_UINT32(IR_SLOT_STREAM_MAX_TICKS, s_out[n - 1].duration1);
+    uint64_t on_air = total_ticks(s_wave, n) + 40000;
+    TEST_ASSERT_EQUAL_UINT32(on_air, total_ticks(s_out, got));
+    TEST_ASSERT_TRUE(s_out[got - 1].duration1 > 0);
+    TEST_ASSERT_EQUAL_UINT32(got, ir_slot_stream_count(&pl, ENC_RES_HZ));
+
+    pl.tail_gap_us = 0;
+    TEST_ASSERT_EQUAL_UINT32(n, ir_slot_stream_count(&pl, ENC_RES_HZ));
+    s_blob[0] ^= 0xFF;
+    TEST_ASSERT_EQUAL_UINT32(0, ir_slot_stream_count(&pl, ENC_RES_HZ));
+}
+
+static void test_encoder_yields_on_mem_full(void)
+{
+    fake_rmt_tx_t tx;
+    rmt_encoder_handle_t enc = new_encoder();
+    size_t n = build_frame(s_wave, 300, 4);
+    ir_slot_tx_payload_t pl = encode_blob(NULL, 0, n);
+
+    fake_rmt_tx_init(&tx, s_mem, ENC_MEM_BLOCK, s_out, ENC_OUT_CAP);
+    TEST_ASSERT_TRUE(fake_rmt_tx_run(&tx, enc, &pl, sizeof(pl)));
+
+    TEST_ASSERT_EQUAL_UINT32(n, tx.out_num);
+    TEST_ASSERT_EQUAL_UINT32(n, tx.encoded);
+    TEST_ASSERT_EQUAL_UINT32((n + ENC_MEM_BLOCK - 1) / ENC_MEM_BLOCK, tx.encode_calls);
+    TEST_ASSERT_EQUAL_MEMORY(s_wave, s_out, n * sizeof(rmt_symbol_word_t));
+
+    rmt_del_encoder(enc);
+}
+
+static void test_encoder_long_multi_frame_matches_stream(void)
+{
+    ir_capture_seg_t segs[4] = {
+        { .offset = 0,   .symbol_num = 300, .gap_us = 0 },
+        { .offset = 300, .symbol_num = 300, .gap_us = 30000 },
+        { .offset = 600, .symbol_num = 300, .gap_us = 30000 },
+        { .offset = 900, .symbol_num = 300, .gap_us = 30000 },
+    };
+    ir_slot_stream_t st;
+    fake_rmt_tx_t tx;
+    rmt_encoder_handle_t enc = new_encoder();
+    size_t expect_num = 0, k;
+
+    for (int i = 0; i < 4; i++) {
+        build_frame(&s_wave[segs[i].offset], 300, 10 + (uint32_t)i);
+    }
+    ir_slot_tx_payload_t pl = encode_blob(segs, 4, 1200);
+
+    TEST_ASSERT_EQUAL_INT(IR_SLOT_OK, ir_slot_stream_init(&st, &pl, ENC_RES_HZ));
+    while ((k = ir_slot_stream_fill(&st, &s_expect[expect_num], 64)) > 0) {
+        expect_num += k;
+    }
+
+    /* The encoder's only waveform buffer is its staging area */
+    TEST_ASSERT_TRUE(IR_SLOT_ENCODER_STAGE_SYMBOLS * sizeof(rmt_symbol_word_t) < 1200 * sizeof(rmt_symbol_word_t) / 16);
+
+    fake_rmt_tx_init(&tx, s_mem, ENC_MEM_BLOCK, s_out, ENC_OUT_CAP);
+    TEST_ASSERT_TRUE(fake_rmt_tx_run(&tx, enc, &pl, sizeof(pl)));
+    TEST_ASSERT_FALSE(tx.overflow);
+    TEST_ASSERT_EQUAL_UINT32(expect_num, tx.out_num);
+    TEST_ASSERT_EQUAL_MEMORY(s_expect, s_out, expect_num * sizeof(rmt_symbol_word_t));
+
+    /* A second transaction with the same encoder starts from the beginning */
+    fake_rmt_tx_init(&tx, s_mem, ENC_MEM_BLOCK, s_out, ENC_OUT_CAP);
+    TEST_ASSERT_TRUE(fake_rmt_tx_run(&tx, enc, &pl, sizeof(pl)));
+    TEST_ASSERT_EQUAL_UINT32(expect_num, tx.out_num);
+
+    rmt_del_encoder(enc);
+}
+
+static void test_encoder_reset_mid_transaction(void)
+{
+    fake_rmt_tx_t tx;
+    rmt_encoder_handle_t enc = new_encoder();
+    rmt_encode_state_t state;
+    size_t n = build_frame(s_wave, 200, 5);
+    ir_slot_tx_payload_t pl = encode_blob(NULL, 0, n);
+
+    /* First block only, then abort like rmt_disable() does */
+    fake_rmt_tx_init(&tx, s_mem, ENC_MEM_BLOCK, s_out, ENC_OUT_CAP);
+    TEST_ASSERT_EQUAL_UINT32(ENC_MEM_BLOCK, enc->encode(enc, &tx.chan, &pl, sizeof(pl), &state));
+    TEST_ASSERT_TRUE(state & RMT_ENCODING_MEM_FULL);
+    rmt_encoder_reset(enc);
+
+    fake_rmt_tx_init(&tx, s_mem, ENC_MEM_BLOCK, s_out, ENC_OUT_CAP);
+    TEST_ASSERT_TRUE(fake_rmt_tx_run(&tx, enc, &pl, sizeof(pl)));
+    TEST_ASSERT_EQUAL_UINT32(n, tx.out_num);
+    TEST_ASSERT_EQUAL_MEMORY(s_wave, s_out, n * sizeof(rmt_symbol_word_t));
+
+    rmt_del_encoder(enc);
+}
+
+static void test_encoder_invalid_blob_sends_nothing(void)
+{
+    fake_rmt_tx_t tx;
+    rmt_encoder_handle_t enc = new_encoder();
+    ir_slot_tx_payload_t pl = encode_blob(NULL, 0, build_frame(s_wave, 40, 6));
+
+    s_blob[pl.len - 1] ^= 0xFF;
+    fake_rmt_tx_init(&tx, s_mem, ENC_MEM_BLOCK, s_out, ENC_OUT_CAP);
+    TEST_ASSERT_TRUE(fake_rmt_tx_run(&tx, enc, &pl, sizeof(pl)));
+    TEST_ASSERT_EQUAL_UINT32(0, tx.out_num);
+
+    rmt_del_encoder(enc);
+}
+
+/* =========================
+ * Unity test runner
+ * ========================= */
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_stream_matches_decode_single_frame);
+    RUN_TEST(test_stream_folds_gaps_into_one_transmission);
+    RUN_TEST(test_stream_tail_gap_and_count);
+    RUN_TEST(test_encoder_yields_on_mem_full);
+    RUN_TEST(test_encoder_long_multi_frame_matches_stream);
+    RUN_TEST(test_encoder_reset_mid_transaction);
+    RUN_TEST(test_encoder_invalid_blob_sends_nothing);
+    return UNITY_END();
+}
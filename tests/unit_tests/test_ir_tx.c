@@ -0,0 +1,388 @@
+/*
+ * test_ir_tx.c — host unit tests for the batched IR transmit engine
+ *
+ * The fake HAL records every queued transmission and completes them in order
+ * when the test says so, like the RMT TX-done interrupt.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "host_unity.h"
+#include "ir_slot.h"
+#include "ir_tx.h"
+
+HOST_UNITY_INSTANCE;
+
+#define TX_RES_HZ      1000000u
+#define TX_MEM_BLOCK   64u
+#define TX_MAX_RECORDS 32u
+
+/* =========================
+ * Fake TX HAL
+ * ========================= */
+typedef struct {
+    const ir_slot_tx_payload_t *ptr;   /* what the driver would read */
+    ir_slot_tx_payload_t copy;         /* what it was at submit time */
+    uint32_t loop_count;
+} tx_record_t;
+
+typedef struct {
+    tx_record_t rec[TX_MAX_RECORDS];
+    size_t num;
+    size_t done;
+    size_t max_pending;
+    bool fail_next;
+    uint32_t carrier_hz;        /* carrier on the channel */
+    uint8_t duty_pct;
+    size_t carrier_calls;
+    size_t carrier_at[TX_MAX_RECORDS]; /* records before each carrier change */
+    bool fail_carrier;
+} fake_tx_t;
+
+static fake_tx_t s_fake;
+static ir_tx_t s_tx;
+static int s_done_calls;
+static ir_tx_result_t s_done_result;
+
+static bool fake_submit(void *ctx, const ir_slot_tx_payload_t *payload, uint32_t loop_count)
+{
+    fake_tx_t *f = ctx;
+    if (f->fail_next || f->num == TX_MAX_RECORDS) {
+        f->fail_next = false;
+        return false;
+    }
+    f->rec[f->num++] = (tx_record_t){ .ptr = payload, .copy = *payload, .loop_count = loop_count };
+    if (f->num - f->done > f->max_pending) {
+        f->max_pending = f->num - f->done;
+    }
+    return true;
+}
+
+static bool fake_set_carrier(void *ctx, uint32_t carrier_hz, uint8_t duty_pct)
+{
+    fake_tx_t *f = ctx;
+    if (f->fail_carrier) {
+        return false;
+    }
+    /* Never while the hardware still sends with the old one */
+    TEST_ASSERT_EQUAL_UINT32(f->num, f->done);
+    f->carrier_at[f->carrier_calls++] = f->num;
+    f->carrier_hz = carrier_hz;
+    f->duty_pct = duty_pct;
+    return true;
+}
+
+static const ir_hal_tx_ops_t s_fake_ops = { .submit = fake_submit, .set_carrier = fake_set_carrier };
+
+/* Finish the oldest pending transmission, then run the task side */
+static bool fake_complete_one(void)
+{
+    if (s_fake.done == s_fake.num) {
+        return false;
+    }
+    const tx_record_t *r = &s_fake.rec[s_fake.done++];
+    /* The payload must not have been reused while the driver read it */
+    TEST_ASSERT_EQUAL_MEMORY(&r->copy, r->ptr, sizeof(r->copy));
+    if (ir_tx_on_done(&s_tx)) {
+        ir_tx_pump(&s_tx);
+    }
+    return true;
+}
+
+static void on_routine_done(void *user, ir_tx_result_t result)
+{
+    (void)user;
+    s_done_calls++;
+    s_done_result = result;
+}
+
+static void tx_setup(size_t queue_depth, size_t loop_max_symbols)
+{
+    ir_hal_tx_t hal = {
+        .ops = &s_fake_ops, .ctx = &s_fake, .resolution_hz = TX_RES_HZ,
+        .queue_depth = queue_depth, .loop_max_symbols = loop_max_symbols,
+    };
+    memset(&s_fake, 0, sizeof(s_fake));
+    s_done_calls = 0;
+    s_done_result = IR_TX_OK;
+    ir_tx_init(&s_tx, &hal);
+}
+
+/* =========================
+ * Slots
+ * ========================= */
+static uint8_t s_blob_short[3][256];
+static size_t s_len_short[3];
+static uint8_t s_blob_long[2048];
+static size_t s_len_long;
+static uint8_t s_blob_40k[256];
+static size_t s_len_40k;
+
+static size_t make_blob_carrier(uint8_t *out, size_t cap, size_t symbol_num, uint32_t seed, uint8_t repeat, uint32_t gap_us,
+                                uint32_t carrier_hz)
+{
+    static rmt_symbol_word_t wave[400];
+    ir_slot_encode_cfg_t cfg = { .resolution_hz = TX_RES_HZ, .tolerance_pct = 0 };
+    ir_slot_meta_t meta = { .carrier_hz = carrier_hz, .duty_pct = 33, .repeat = repeat, .repeat_gap_us = gap_us };
+    size_t len = 0;
+
+    wave[0] = (rmt_symbol_word_t){ .level0 = 1, .duration0 = 9000, .level1 = 0, .duration1 = 4500 };
+    for (size_t i = 1; i + 1 < symbol_num; i++) {
+        seed = seed * 1103515245u + 12345u;
+        wave[i] = (rmt_symbol_word_t){ .level0 = 1, .duration0 = 560, .level1 = 0,
+                                       .duration1 = (seed >> 16) & 1u ? 1690 : 560 };
+    }
+    wave[symbol_num - 1] = (rmt_symbol_word_t){ .level0 = 1, .duration0 = 560, .level1 = 0, .duration1 = 0 };
+    ir_slot_err_t err = ir_slot_encode(&cfg, &meta, wave, symbol_num, NULL, 0, out, cap, &len);
+    TEST_ASSERT_EQUAL_INT(IR_SLOT_OK, err);
+    return len;
+}
+
+static size_t make_blob(uint8_t *out, size_t cap, size_t symbol_num, uint32_t seed, uint8_t repeat, uint32_t gap_us)
+{
+    return make_blob_carrier(out, cap, symbol_num, seed, repeat, gap_us, 38000);
+}
+
+static void make_slots(void)
+{
+    for (int i = 0; i < 3; i++) {
+        s_len_short[i] = make_blob(s_blob_short[i], sizeof(s_blob_short[i]), 34, 1 + (uint32_t)i, 0, 0);
+    }
+    s_len_long = make_blob(s_blob_long, sizeof(s_blob_long), 300, 9, 2, 40000);
+    s_len_40k = make_blob_carrier(s_blob_40k, sizeof(s_blob_40k), 34, 5, 0, 0, 40000);
+}
+
+/* =========================
+ * Test cases
+ * ========================= */
+static void test_routine_uses_hardware_loops(void)
+{
+    ir_tx_step_t steps[3];
+    for (int i = 0; i < 3; i++) {
+        steps[i] = (ir_tx_step_t){ .blob = s_blob_short[i], .len = s_len_short[i], .repeat = (uint8_t)i, .gap_us = 40000 };
+    }
+    ir_tx_routine_t routine = { .steps = steps, .step_num = 3, .on_done = on_routine_done };
+    ir_tx_stats_t stats;
+
+    tx_setup(4, TX_MEM_BLOCK);
+    TEST_ASSERT_TRUE(ir_tx_send(&s_tx, &routine));
+
+    /* Whole routine queued at once, one transaction per step */
+    TEST_ASSERT_EQUAL_UINT32(3, s_fake.num);
+    for (uint32_t i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL_UINT32(i, s_fake.rec[i].loop_count);
+        TEST_ASSERT_TRUE(s_fake.rec[i].copy.blob == s_blob_short[i]);
+        TEST_ASSERT_EQUAL_UINT32(40000, s_fake.rec[i].copy.tail_gap_us);
+    }
+    TEST_ASSERT_TRUE(ir_tx_busy(&s_tx));
+    TEST_ASSERT_FALSE(ir_tx_send(&s_tx, &routine));
+
+    while (fake_complete_one()) {
+    }
+    TEST_ASSERT_EQUAL_INT(1, s_done_calls);
+    TEST_ASSERT_EQUAL_INT(IR_TX_OK, s_done_result);
+    TEST_ASSERT_FALSE(ir_tx_busy(&s_tx));
+
+    ir_tx_get_stats(&s_tx, &stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.routines);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.transactions);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.hw_repeats);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.sw_repeats);
+}
+
+static void test_long_frame_repeats_in_software(void)
+{
+    ir_tx_step_t step;
+    ir_tx_routine_t routine = { .steps = &step, .step_num = 1, .on_done = on_routine_done };
+    ir_tx_stats_t stats;
+
+    TEST_ASSERT_TRUE(ir_tx_step_from_slot(&step, s_blob_long, s_len_long));
+    TEST_ASSERT_EQUAL_UINT32(2, step.repeat);
+    TEST_ASSERT_EQUAL_UINT32(40000, step.gap_us);
+
+    tx_setup(4, TX_MEM_BLOCK);
+    TEST_ASSERT_TRUE(ir_tx_send(&s_tx, &routine));
+    TEST_ASSERT_EQUAL_UINT32(3, s_fake.num);
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL_UINT32(0, s_fake.rec[i].loop_count);
+        TEST_ASSERT_EQUAL_UINT32(40000, s_fake.rec[i].copy.tail_gap_us);
+    }
+    while (fake_complete_one()) {
+    }
+    TEST_ASSERT_EQUAL_INT(1, s_done_calls);
+
+    ir_tx_get_stats(&s_tx, &stats);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.hw_repeats);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.sw_repeats);
+
+    /* Without loop support short frames go the same way */
+    ir_tx_step_t short_step = { .blob = s_blob_short[0], .len = s_len_short[0], .repeat = 3 };
+    routine.steps = &short_step;
+    tx_setup(4, 0);
+    TEST_ASSERT_TRUE(ir_tx_send(&s_tx, &routine));
+    TEST_ASSERT_EQUAL_UINT32(4, s_fake.num);
+}
+
+static void test_queue_depth_respected(void)
+{
+    ir_tx_step_t steps[6];
+    for (int i = 0; i < 6; i++) {
+        steps[i] = (ir_tx_step_t){ .blob = s_blob_short[i % 3], .len = s_len_short[i % 3], .gap_us = 20000 };
+    }
+    ir_tx_routine_t routine = { .steps = steps, .step_num = 6, .on_done = on_routine_done };
+
+    tx_setup(2, TX_MEM_BLOCK);
+    TEST_ASSERT_TRUE(ir_tx_send(&s_tx, &routine));
+    TEST_ASSERT_EQUAL_UINT32(2, s_fake.num);
+
+    TEST_ASSERT_TRUE(fake_complete_one());
+    TEST_ASSERT_EQUAL_UINT32(3, s_fake.num); /* refilled from the completion */
+    while (fake_complete_one()) {
+        if (s_fake.done < 6) {
+            TEST_ASSERT_EQUAL_INT(0, s_done_calls);
+        }
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(6, s_fake.num);
+    TEST_ASSERT_EQUAL_UINT32(2, s_fake.max_pending);
+    TEST_ASSERT_EQUAL_INT(1, s_done_calls);
+    for (int i = 0; i < 6; i++) {
+        TEST_ASSERT_TRUE(s_fake.rec[i].copy.blob == s_blob_short[i % 3]);
+    }
+}
+
+static void test_invalid_slot_stops_routine(void)
+{
+    static uint8_t bad[64];
+    ir_tx_step_t steps[3] = {
+        { .blob = s_blob_short[0], .len = s_len_short[0] },
+        { .blob = bad, .len = sizeof(bad) },
+        { .blob = s_blob_short[1], .len = s_len_short[1] },
+    };
+    ir_tx_routine_t routine = { .steps = steps, .step_num = 3, .on_done = on_routine_done };
+
+    tx_setup(4, TX_MEM_BLOCK);
+    TEST_ASSERT_TRUE(ir_tx_send(&s_tx, &routine));
+    TEST_ASSERT_EQUAL_UINT32(1, s_fake.num);
+    TEST_ASSERT_EQUAL_INT(0, s_done_calls); /* first step still on air */
+
+    TEST_ASSERT_TRUE(fake_complete_one());
+    TEST_ASSERT_EQUAL_INT(1, s_done_calls);
+    TEST_ASSERT_EQUAL_INT(IR_TX_ERR_SLOT, s_done_result);
+    TEST_ASSERT_FALSE(ir_tx_busy(&s_tx));
+}
+
+static void test_submit_failure_reported(void)
+{
+    ir_tx_step_t steps[2] = {
+        { .blob = s_blob_short[0], .len = s_len_short[0] },
+        { .blob = s_blob_short[1], .len = s_len_short[1] },
+    };
+    ir_tx_routine_t routine = { .steps = steps, .step_num = 2, .on_done = on_routine_done };
+    ir_tx_stats_t stats;
+
+    tx_setup(4, TX_MEM_BLOCK);
+    s_fake.fail_next = true;
+    TEST_ASSERT_TRUE(ir_tx_send(&s_tx, &routine));
+    TEST_ASSERT_EQUAL_UINT32(0, s_fake.num);
+    TEST_ASSERT_EQUAL_INT(1, s_done_calls); /* nothing in flight, finished right away */
+    TEST_ASSERT_EQUAL_INT(IR_TX_ERR_SUBMIT, s_done_result);
+
+    ir_tx_get_stats(&s_tx, &stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.errors);
+
+    /* The engine is usable again */
+    TEST_ASSERT_TRUE(ir_tx_send(&s_tx, &routine));
+    TEST_ASSERT_EQUAL_UINT32(2, s_fake.num);
+}
+
+static void test_foreign_completion_ignored(void)
+{
+    ir_tx_step_t step = { .blob = s_blob_short[0], .len = s_len_short[0] };
+    ir_tx_routine_t routine = { .steps = &step, .step_num = 1, .on_done = on_routine_done };
+
+    tx_setup(4, TX_MEM_BLOCK);
+    TEST_ASSERT_FALSE(ir_tx_on_done(&s_tx)); /* e.g. a direct rmt_transmit() on the same channel */
+
+    TEST_ASSERT_TRUE(ir_tx_send(&s_tx, &routine));
+    TEST_ASSERT_TRUE(fake_complete_one());
+    TEST_ASSERT_EQUAL_INT(1, s_done_calls);
+    TEST_ASSERT_FALSE(ir_tx_on_done(&s_tx));
+}
+
+static void test_carrier_cached_per_step(void)
+{
+    ir_tx_step_t steps[4] = {
+        { .blob = s_blob_short[0], .len = s_len_short[0] },
+        { .blob = s_blob_short[1], .len = s_len_short[1] },
+        { .blob = s_blob_40k, .len = s_len_40k },
+        { .blob = s_blob_short[2], .len = s_len_short[2] },
+    };
+    ir_tx_routine_t routine = { .steps = steps, .step_num = 4, .on_done = on_routine_done };
+    ir_tx_stats_t stats;
+
+    tx_setup(4, TX_MEM_BLOCK);
+    TEST_ASSERT_TRUE(ir_tx_send(&s_tx, &routine));
+
+    /* 38 kHz applied once for the first two steps, the 40 kHz step waits for them */
+    TEST_ASSERT_EQUAL_UINT32(2, s_fake.num);
+    TEST_ASSERT_EQUAL_UINT32(1, s_fake.carrier_calls);
+    TEST_ASSERT_EQUAL_UINT32(38000, s_fake.carrier_hz);
+    TEST_ASSERT_EQUAL_UINT8(33, s_fake.duty_pct);
+    TEST_ASSERT_TRUE(fake_complete_one());
+    TEST_ASSERT_EQUAL_UINT32(2, s_fake.num);
+    TEST_ASSERT_TRUE(fake_complete_one());
+    TEST_ASSERT_EQUAL_UINT32(3, s_fake.num);
+    TEST_ASSERT_EQUAL_UINT32(40000, s_fake.carrier_hz);
+    TEST_ASSERT_TRUE(fake_complete_one()); /* and back to 38 kHz */
+    TEST_ASSERT_EQUAL_UINT32(4, s_fake.num);
+    TEST_ASSERT_EQUAL_UINT32(3, s_fake.carrier_calls);
+    TEST_ASSERT_EQUAL_UINT32(2, s_fake.carrier_at[1]);
+    TEST_ASSERT_EQUAL_UINT32(3, s_fake.carrier_at[2]);
+    while (fake_complete_one()) {
+    }
+    TEST_ASSERT_EQUAL_INT(IR_TX_OK, s_done_result);
+    TEST_ASSERT_EQUAL_UINT32(38000, s_fake.carrier_hz);
+
+    /* Same carrier as the last step: the next routine costs no reconfiguration */
+    routine.step_num = 2;
+    TEST_ASSERT_TRUE(ir_tx_send(&s_tx, &routine));
+    TEST_ASSERT_EQUAL_UINT32(3, s_fake.carrier_calls);
+    while (fake_complete_one()) {
+    }
+    TEST_ASSERT_TRUE(ir_tx_apply_carrier(&s_tx, 38000, 33));
+    TEST_ASSERT_EQUAL_UINT32(3, s_fake.carrier_calls);
+    TEST_ASSERT_TRUE(ir_tx_apply_carrier(&s_tx, 36000, 50));
+    TEST_ASSERT_EQUAL_UINT32(4, s_fake.carrier_calls);
+
+    ir_tx_get_stats(&s_tx, &stats);
+    TEST_ASSERT_EQUAL_UINT32(4, stats.carrier_changes);
+
+    /* A refused carrier ends the routine before its step is sent */
+    size_t sent = s_fake.num;
+    s_fake.fail_carrier = true;
+    TEST_ASSERT_TRUE(ir_tx_send(&s_tx, &routine));
+    TEST_ASSERT_EQUAL_UINT32(sent, s_fake.num);
+    TEST_ASSERT_EQUAL_INT(IR_TX_ERR_CARRIER, s_done_result);
+    TEST_ASSERT_FALSE(ir_tx_busy(&s_tx));
+}
+
+/* =========================
+ * Unity test runner
+ * ========================= */
+int main(void)
+{
+    make_slots();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_routine_uses_hardware_loops);
+    RUN_TEST(test_long_frame_repeats_in_software);
+    RUN_TEST(test_queue_depth_respected);
+    RUN_TEST(test_invalid_slot_stops_routine);
+    RUN_TEST(test_submit_failure_reported);
+    RUN_TEST(test_foreign_completion_ignored);
+    RUN_TEST(test_carrier_cached_per_step);
+    return UNITY_END();
+}
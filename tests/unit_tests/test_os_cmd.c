@@ -0,0 +1,302 @@
+/*
+ * test_os_cmd.c — host unit tests for the command/response channel
+ *
+ * Slot and correlation id handling, the bounded target queue, timeouts,
+ * responses that arrive after the caller gave up, stale ids after a slot
+ * was reused, and round trips between caller threads and a receiving
+ * target thread on the pthread port.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "host_unity.h"
+#include "os_cmd.h"
+
+HOST_UNITY_INSTANCE;
+
+/* =========================
+ * Helpers
+ * ========================= */
+enum {
+    OP_ECHO = 1,
+    OP_FAIL,
+    OP_QUIT,
+};
+
+#define CALLERS          2
+#define CALLS_PER_THREAD 200u
+
+static uint64_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+/* Target module: answers each request in place with its bytes plus one, and one extra byte */
+static void *echo_target(void *arg)
+{
+    (void)arg;
+    for (;;) {
+        os_cmd_t *cmd = os_cmd_recv(OS_MOD_IR, OS_CMD_WAIT_FOREVER);
+        if (cmd == NULL) {
+            continue;
+        }
+        uint16_t op = cmd->op;
+        os_cmd_corr_t corr = cmd->corr;
+        if (op == OP_ECHO) {
+            for (uint16_t i = 0; i < cmd->len; i++) {
+                cmd->data[i]++;
+            }
+            cmd->data[cmd->len++] = 0xA5;
+        }
+        os_cmd_respond(cmd, corr, op == OP_FAIL ? OS_EINVAL : OS_OK);
+        if (op == OP_QUIT) {
+            return NULL;
+        }
+    }
+}
+
+static void *caller(void *arg)
+{
+    uint8_t id = (uint8_t)(uintptr_t)arg;
+    for (uint32_t n = 0; n < CALLS_PER_THREAD; n++) {
+        os_cmd_t *cmd = os_cmd_alloc(OS_MOD_BLE, OS_MOD_IR, OP_ECHO);
+        if (cmd == NULL) {
+            return (void *)1;
+        }
+        os_cmd_corr_t corr = cmd->corr;
+        uint8_t req[3] = { id, (uint8_t)n, (uint8_t)(n >> 8) };
+        memcpy(cmd->data, req, sizeof(req));
+        cmd->len = sizeof(req);
+        if (os_cmd_call(cmd, OS_CMD_WAIT_FOREVER) != OS_OK || cmd->status != OS_OK || cmd->len != 4 ||
+            cmd->data[0] != (uint8_t)(id + 1) || cmd->data[1] != (uint8_t)(n + 1) || cmd->data[3] != 0xA5) {
+            os_cmd_release(cmd, corr);
+            return (void *)1;
+        }
+        if (os_cmd_release(cmd, corr) != OS_OK) {
+            return (void *)1;
+        }
+    }
+    return NULL;
+}
+
+/* =========================
+ * Tests
+ * ========================= */
+static void test_slots_and_correlation(void)
+{
+    os_cmd_t *cmds[OS_CMD_SLOTS];
+    os_cmd_stats_t stats;
+    os_cmd_init();
+
+    TEST_ASSERT_NULL(os_cmd_alloc(OS_MOD_BLE, OS_MOD_NONE, OP_ECHO));
+    TEST_ASSERT_NULL(os_cmd_alloc(OS_MOD_BLE, OS_MOD_MAX, OP_ECHO));
+    for (uint32_t i = 0; i < OS_CMD_SLOTS; i++) {
+        cmds[i] = os_cmd_alloc(OS_MOD_BLE, OS_MOD_IR, OP_ECHO);
+        TEST_ASSERT_NOT_NULL(cmds[i]);
+        TEST_ASSERT_NOT_NULL(cmds[i]->data);
+        TEST_ASSERT_TRUE(cmds[i]->corr != 0);
+        TEST_ASSERT_EQUAL_UINT32(OS_MOD_IR, cmds[i]->target);
+        TEST_ASSERT_EQUAL_UINT32(0, cmds[i]->len);
+        for (uint32_t j = 0; j < i; j++) {
+            TEST_ASSERT_TRUE(cmds[i]->corr != cmds[j]->corr);
+            TEST_ASSERT_TRUE(cmds[i]->data != cmds[j]->data);
+        }
+    }
+    TEST_ASSERT_NULL(os_cmd_alloc(OS_MOD_BLE, OS_MOD_IR, OP_ECHO));
+    os_cmd_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.no_slot);
+    TEST_ASSERT_EQUAL_UINT32(OS_CMD_SLOTS, stats.in_flight);
+    TEST_ASSERT_TRUE(stats.mem_bytes >= OS_CMD_SLOTS * OS_CMD_DATA_MAX);
+
+    /* A reused slot keeps its pool block but gets a new correlation id */
+    os_cmd_corr_t old_corr = cmds[0]->corr;
+    uint8_t *old_data = cmds[0]->data;
+    os_cmd_release(cmds[0], cmds[0]->corr);
+    cmds[0] = os_cmd_alloc(OS_MOD_WIFI, OS_MOD_STORAGE, OP_ECHO);
+    TEST_ASSERT_NOT_NULL(cmds[0]);
+    TEST_ASSERT_TRUE(cmds[0]->data == old_data);
+    TEST_ASSERT_TRUE(cmds[0]->corr != old_corr);
+    TEST_ASSERT_EQUAL_UINT32(old_corr & 0xFFu, cmds[0]->corr & 0xFFu);
+
+    for (uint32_t i = 0; i < OS_CMD_SLOTS; i++) {
+        os_cmd_release(cmds[i], cmds[i]->corr);
+    }
+    os_cmd_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.in_flight);
+    TEST_ASSERT_EQUAL_UINT32(OS_CMD_SLOTS, stats.high_water);
+}
+
+static void test_queue_full_and_abandoned(void)
+{
+    os_cmd_stats_t stats;
+    os_cmd_init();
+
+    /* Nobody receives: each call times out at once and leaves its command queued */
+    for (uint32_t i = 0; i < OS_CMD_QUEUE_DEPTH; i++) {
+        os_cmd_t *cmd = os_cmd_alloc(OS_MOD_BLE, OS_MOD_IR, OP_ECHO);
+        TEST_ASSERT_NOT_NULL(cmd);
+        TEST_ASSERT_EQUAL_INT(OS_ETIMEOUT, os_cmd_call(cmd, 0));
+        os_cmd_release(cmd, cmd->corr);
+    }
+    os_cmd_t *cmd = os_cmd_alloc(OS_MOD_BLE, OS_MOD_IR, OP_ECHO);
+    TEST_ASSERT_EQUAL_INT(OS_EFULL, os_cmd_call(cmd, 0));
+    /* Another target's queue is separate */
+    os_cmd_t *other = os_cmd_alloc(OS_MOD_BLE, OS_MOD_STORAGE, OP_ECHO);
+    TEST_ASSERT_EQUAL_INT(OS_ETIMEOUT, os_cmd_call(other, 0));
+    os_cmd_release(other, other->corr);
+    os_cmd_release(cmd, cmd->corr);
+
+    os_cmd_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(OS_CMD_QUEUE_DEPTH + 1u, stats.calls);
+    TEST_ASSERT_EQUAL_UINT32(OS_CMD_QUEUE_DEPTH + 1u, stats.timeouts);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.full);
+    TEST_ASSERT_EQUAL_UINT32(OS_CMD_QUEUE_DEPTH + 1u, stats.in_flight); /* held by the queues */
+
+    /* The receiver drops what its callers gave up on */
+    TEST_ASSERT_NULL(os_cmd_recv(OS_MOD_IR, 0));
+    TEST_ASSERT_NULL(os_cmd_recv(OS_MOD_STORAGE, 0));
+    os_cmd_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(OS_CMD_QUEUE_DEPTH + 1u, stats.late);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.in_flight);
+}
+
+static void test_late_response(void)
+{
+    os_cmd_stats_t stats;
+    os_cmd_init();
+
+    /* Answered after the caller released it: dropped, slot freed */
+    os_cmd_t *cmd = os_cmd_alloc(OS_MOD_BLE, OS_MOD_IR, OP_ECHO);
+    os_cmd_corr_t corr = cmd->corr;
+    TEST_ASSERT_EQUAL_INT(OS_ETIMEOUT, os_cmd_call(cmd, 0));
+    os_cmd_t *taken = os_cmd_recv(OS_MOD_IR, 0);
+    TEST_ASSERT_TRUE(taken == cmd);
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_cmd_release(cmd, corr));
+    TEST_ASSERT_EQUAL_INT(OS_ESTATE, os_cmd_release(cmd, corr)); /* already abandoned */
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_cmd_respond(taken, corr, OS_OK));
+    TEST_ASSERT_EQUAL_INT(OS_ESTATE, os_cmd_respond(taken, corr, OS_OK));
+    os_cmd_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.late);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.in_flight);
+
+    /* Answered after the timeout but before the release: readable, but the call failed and it counts late */
+    cmd = os_cmd_alloc(OS_MOD_BLE, OS_MOD_IR, OP_ECHO);
+    corr = cmd->corr;
+    TEST_ASSERT_EQUAL_INT(OS_ESTATE, os_cmd_respond(cmd, corr, OS_OK)); /* not taken */
+    TEST_ASSERT_EQUAL_INT(OS_ETIMEOUT, os_cmd_call(cmd, 0));
+    taken = os_cmd_recv(OS_MOD_IR, 0);
+    TEST_ASSERT_TRUE(taken == cmd);
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_cmd_respond(taken, corr, OS_EBUSY));
+    TEST_ASSERT_EQUAL_INT(OS_EBUSY, cmd->status);
+    TEST_ASSERT_EQUAL_INT(OS_ESTATE, os_cmd_call(cmd, 0));
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_cmd_release(cmd, corr));
+    os_cmd_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.late);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.completed);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.timeouts);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.in_flight);
+}
+
+static void test_stale_ids_after_reuse(void)
+{
+    os_cmd_stats_t stats;
+    os_cmd_init();
+
+    /* First use of the slot: timed out, answered, released */
+    os_cmd_t *cmd = os_cmd_alloc(OS_MOD_BLE, OS_MOD_IR, OP_ECHO);
+    os_cmd_corr_t old_corr = cmd->corr;
+    TEST_ASSERT_EQUAL_INT(OS_ETIMEOUT, os_cmd_call(cmd, 0));
+    os_cmd_t *taken = os_cmd_recv(OS_MOD_IR, 0);
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_cmd_respond(taken, old_corr, OS_OK));
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_cmd_release(cmd, old_corr));
+
+    /* Second use of the same slot, taken by the target */
+    os_cmd_t *again = os_cmd_alloc(OS_MOD_WIFI, OS_MOD_IR, OP_ECHO);
+    TEST_ASSERT_TRUE(again == cmd);
+    os_cmd_corr_t new_corr = again->corr;
+    TEST_ASSERT_TRUE(new_corr != old_corr);
+    TEST_ASSERT_EQUAL_INT(OS_ETIMEOUT, os_cmd_call(again, 0));
+    TEST_ASSERT_TRUE(os_cmd_recv(OS_MOD_IR, 0) == again);
+
+    /* A target answering the first use twice, and a caller releasing it twice, hit the new call: refused */
+    TEST_ASSERT_EQUAL_INT(OS_ESTATE, os_cmd_respond(taken, old_corr, OS_EINVAL));
+    TEST_ASSERT_EQUAL_INT(OS_ESTATE, os_cmd_release(cmd, old_corr));
+    TEST_ASSERT_EQUAL_INT(OS_OK, again->status);
+    os_cmd_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.in_flight);
+
+    /* The new call's own ids still work */
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_cmd_respond(again, new_corr, OS_OK));
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_cmd_release(again, new_corr));
+    TEST_ASSERT_EQUAL_INT(OS_EINVAL, os_cmd_release(NULL, new_corr));
+    os_cmd_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.in_flight);
+}
+
+static void test_timeouts_wait(void)
+{
+    os_cmd_init();
+
+    uint64_t t0 = now_ms();
+    TEST_ASSERT_NULL(os_cmd_recv(OS_MOD_IR, 20));
+    TEST_ASSERT_TRUE(now_ms() - t0 >= 19);
+
+    os_cmd_t *cmd = os_cmd_alloc(OS_MOD_BLE, OS_MOD_IR, OP_ECHO);
+    t0 = now_ms();
+    TEST_ASSERT_EQUAL_INT(OS_ETIMEOUT, os_cmd_call(cmd, 20));
+    TEST_ASSERT_TRUE(now_ms() - t0 >= 19);
+    os_cmd_release(cmd, cmd->corr);
+    TEST_ASSERT_NULL(os_cmd_recv(OS_MOD_IR, 0));
+}
+
+static void test_round_trips_between_threads(void)
+{
+    pthread_t target, callers[CALLERS];
+    os_cmd_stats_t stats;
+    os_cmd_init();
+    pthread_create(&target, NULL, echo_target, NULL);
+
+    for (int i = 0; i < CALLERS; i++) {
+        pthread_create(&callers[i], NULL, caller, (void *)(uintptr_t)(i + 1));
+    }
+    for (int i = 0; i < CALLERS; i++) {
+        void *failed;
+        pthread_join(callers[i], &failed);
+        TEST_ASSERT_NULL(failed);
+    }
+
+    os_cmd_t *cmd = os_cmd_alloc(OS_MOD_BLE, OS_MOD_IR, OP_FAIL);
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_cmd_call(cmd, OS_CMD_WAIT_FOREVER));
+    TEST_ASSERT_EQUAL_INT(OS_EINVAL, cmd->status);
+    os_cmd_release(cmd, cmd->corr);
+
+    cmd = os_cmd_alloc(OS_MOD_BLE, OS_MOD_IR, OP_QUIT);
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_cmd_call(cmd, OS_CMD_WAIT_FOREVER));
+    os_cmd_release(cmd, cmd->corr);
+    pthread_join(target, NULL);
+
+    os_cmd_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(CALLERS * CALLS_PER_THREAD + 2u, stats.calls);
+    TEST_ASSERT_EQUAL_UINT32(CALLERS * CALLS_PER_THREAD + 2u, stats.completed);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.timeouts);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.in_flight);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(CALLERS, stats.high_water);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_slots_and_correlation);
+    RUN_TEST(test_queue_full_and_abandoned);
+    RUN_TEST(test_late_response);
+    RUN_TEST(test_stale_ids_after_reuse);
+    RUN_TEST(test_timeouts_wait);
+    RUN_TEST(test_round_trips_between_threads);
+    return UNITY_END();
+}
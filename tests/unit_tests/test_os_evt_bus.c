@@ -0,0 +1,896 @@
+/*
+ * test_os_evt_bus.c — host unit tests for the event bus core and its pthread port
+ *
+ * The cases mirror apps/test_evt_bus on the in-tree bus: payload copy,
+ * pool-backed large payloads, the generated event table and typed wrappers,
+ * DROP_NEW overflow, per-id coalescing, priority lanes (strict with bounded
+ * starvation, weighted), bitmask subscriptions, lazy unsubscribe with
+ * generation checks, list repair, staging rings (contention mode), deferred
+ * subscribers on worker queues and callback budgets, and publishers on their
+ * own threads (standing in for ISRs) feeding the dispatcher thread, with and
+ * without staging.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+#include "host_unity.h"
+#include "os_evt_bus.h"
+
+HOST_UNITY_INSTANCE;
+
+/* =========================
+ * Helpers
+ * ========================= */
+#define RECORD_MAX 64
+
+typedef struct {
+    uint32_t calls;
+    os_evt_t evts[RECORD_MAX];
+} record_ctx_t;
+
+static void cb_record(const os_evt_t *evt, void *user_ctx)
+{
+    record_ctx_t *ctx = user_ctx;
+    if (ctx->calls < RECORD_MAX) {
+        ctx->evts[ctx->calls] = *evt;
+    }
+    ctx->calls++;
+}
+
+static void cb_count(const os_evt_t *evt, void *user_ctx)
+{
+    (void)evt;
+    (*(uint32_t *)user_ctx)++;
+}
+
+typedef struct {
+    os_evt_sub_handle_t self;
+    uint32_t calls;
+} self_unsub_ctx_t;
+
+static void cb_self_unsub(const os_evt_t *evt, void *user_ctx)
+{
+    self_unsub_ctx_t *ctx = user_ctx;
+    (void)evt;
+    ctx->calls++;
+    os_evt_bus_unsubscribe(ctx->self);
+}
+
+/* =========================
+ * Test cases
+ * ========================= */
+static void test_publish_copies_payload_in_order(void)
+{
+    record_ctx_t ctx = {0};
+    os_evt_bus_init();
+
+    os_evt_sub_handle_t h = os_evt_bus_subscribe(EVT_IR_LEARN_RESULT, cb_record, &ctx);
+    TEST_ASSERT_TRUE(os_evt_bus_handle_valid(h));
+
+    for (uint8_t i = 0; i < 3; i++) {
+        evt_ir_learn_result_t res = { .result = IR_RES_OK, .slot = i, .presses = 3, .used = 3, .confidence_pct = 90 };
+        TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_publish(OS_MOD_IR, EVT_IR_LEARN_RESULT, &res, sizeof(res)));
+        memset(&res, 0xEE, sizeof(res)); /* must not reach the subscriber */
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, ctx.calls); /* publish never runs callbacks */
+    TEST_ASSERT_EQUAL_UINT32(3, os_evt_bus_dispatch_all());
+    TEST_ASSERT_FALSE(os_evt_bus_dispatch_one());
+
+    TEST_ASSERT_EQUAL_UINT32(3, ctx.calls);
+    for (uint8_t i = 0; i < 3; i++) {
+        evt_ir_learn_result_t res;
+        TEST_ASSERT_EQUAL_UINT16(EVT_IR_LEARN_RESULT, ctx.evts[i].id);
+        TEST_ASSERT_EQUAL_UINT16(OS_MOD_IR, ctx.evts[i].src);
+        TEST_ASSERT_EQUAL_UINT16(sizeof(res), ctx.evts[i].len);
+        memcpy(&res, ctx.evts[i].payload, sizeof(res));
+        TEST_ASSERT_EQUAL_UINT16(i, res.slot);
+        TEST_ASSERT_EQUAL_UINT8(90, res.confidence_pct);
+    }
+}
+
+static void test_rejects_bad_events(void)
+{
+    uint8_t big[OS_EVT_BUS_POOL_BLOCK_SIZE + 1] = {0};
+    uint32_t calls = 0;
+    os_evt_bus_stats_t stats;
+    os_evt_bus_init();
+
+    TEST_ASSERT_FALSE(os_evt_bus_handle_valid(os_evt_bus_subscribe(EVT_NONE, cb_count, &calls)));
+    TEST_ASSERT_FALSE(os_evt_bus_handle_valid(os_evt_bus_subscribe(EVT__MAX, cb_count, &calls)));
+    TEST_ASSERT_FALSE(os_evt_bus_handle_valid(os_evt_bus_subscribe(EVT_HEALTH_TICK, NULL, NULL)));
+
+    TEST_ASSERT_EQUAL_INT(OS_EINVAL, os_evt_bus_publish(OS_MOD_IR, EVT_IR_SEND_RESULT, big, sizeof(big)));
+    TEST_ASSERT_EQUAL_INT(OS_EINVAL, os_evt_bus_publish(OS_MOD_IR, EVT__MAX, NULL, 0));
+    TEST_ASSERT_EQUAL_INT(OS_EINVAL, os_evt_bus_publish(OS_MOD_IR, EVT_IR_SEND_RESULT, NULL, 4));
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_publish(OS_MOD_IR, EVT_IR_SEND_RESULT, big, OS_EVT_INLINE_MAX));
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_publish(OS_MOD_IR, EVT_IR_SEND_RESULT, big, OS_EVT_BUS_POOL_BLOCK_SIZE));
+
+    os_evt_bus_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.rejected);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.published);
+}
+
+typedef struct {
+    uint32_t calls;
+    const void *data[RECORD_MAX];
+    const void *kept;
+    bool keep;
+} pool_ctx_t;
+
+static void cb_pool(const os_evt_t *evt, void *user_ctx)
+{
+    pool_ctx_t *ctx = user_ctx;
+    const uint8_t *data = os_evt_data(evt);
+    if (ctx->calls < RECORD_MAX && data[evt->len - 1] == (uint8_t)evt->len) {
+        ctx->data[ctx->calls] = data;
+    }
+    ctx->calls++;
+    if (ctx->keep) {
+        ctx->kept = os_evt_bus_payload_retain(evt);
+    }
+}
+
+static void test_pool_payload_fan_out(void)
+{
+    uint8_t detail[100];
+    uint8_t small[4] = { 1, 2, 3, 4 };
+    pool_ctx_t ctx = {0};
+    pool_ctx_t keeper = { .keep = true };
+    os_evt_bus_stats_t stats;
+    os_evt_bus_init();
+    os_evt_bus_subscribe(EVT_STORAGE_CORRUPT, cb_pool, &ctx);
+    os_evt_bus_subscribe(EVT_STORAGE_CORRUPT, cb_pool, &ctx);
+    os_evt_bus_subscribe(EVT_STORAGE_CORRUPT, cb_pool, &keeper);
+
+    for (size_t i = 0; i < sizeof(detail); i++) {
+        detail[i] = (uint8_t)i;
+    }
+    detail[sizeof(detail) - 1] = sizeof(detail);
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_publish(OS_MOD_STORAGE, EVT_STORAGE_CORRUPT, detail, sizeof(detail)));
+    memset(detail, 0, sizeof(detail)); /* copied once at publish */
+    os_evt_bus_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.pool_used);
+
+    /* Every subscriber sees the same block; the one that kept it holds it past dispatch */
+    TEST_ASSERT_EQUAL_UINT32(1, os_evt_bus_dispatch_all());
+    TEST_ASSERT_EQUAL_UINT32(2, ctx.calls);
+    TEST_ASSERT_NOT_NULL(ctx.data[0]);
+    TEST_ASSERT_TRUE(ctx.data[0] == ctx.data[1]);
+    TEST_ASSERT_TRUE(ctx.data[0] == keeper.kept);
+    os_evt_bus_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.pool_used);
+    os_evt_bus_payload_release(keeper.kept);
+    os_evt_bus_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.pool_used);
+
+    /* Inline events cannot be kept */
+    keeper.kept = detail;
+    os_evt_bus_publish(OS_MOD_STORAGE, EVT_STORAGE_CORRUPT, small, sizeof(small));
+    os_evt_bus_dispatch_all();
+    TEST_ASSERT_NULL(keeper.kept);
+
+    /* Pool exhausted: large publishes fail, small ones still go through */
+    for (uint32_t i = 0; i < OS_EVT_BUS_POOL_BLOCKS; i++) {
+        TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_publish(OS_MOD_STORAGE, EVT_STORAGE_CORRUPT, detail, sizeof(detail)));
+    }
+    TEST_ASSERT_EQUAL_INT(OS_ENOMEM, os_evt_bus_publish(OS_MOD_STORAGE, EVT_STORAGE_CORRUPT, detail, sizeof(detail)));
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_publish(OS_MOD_STORAGE, EVT_STORAGE_CORRUPT, small, sizeof(small)));
+
+    /* A coalesced large payload holds one block however often it is replaced */
+    keeper.keep = false;
+    os_evt_bus_dispatch_all();
+    for (uint32_t i = 0; i < 3 * OS_EVT_BUS_POOL_BLOCKS; i++) {
+        TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_publish(OS_MOD_OTA, EVT_OTA_PROGRESS, detail, sizeof(detail)));
+    }
+    os_evt_bus_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.pool_used);
+    TEST_ASSERT_EQUAL_UINT32(1, os_evt_bus_dispatch_all());
+    os_evt_bus_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.pool_used);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.pool_empty);
+    TEST_ASSERT_EQUAL_UINT32(OS_EVT_BUS_POOL_BLOCKS, stats.pool_high_water);
+}
+
+static void test_event_table_typed_wrappers(void)
+{
+    record_ctx_t ctx = {0};
+    os_evt_bus_stats_t stats;
+    os_evt_bus_init();
+
+    TEST_ASSERT_EQUAL_UINT16(sizeof(evt_ir_slot_written_t), os_evt_meta[EVT_IR_SLOT_WRITTEN].payload_len);
+    TEST_ASSERT_EQUAL_UINT16(OS_MOD_IR, os_evt_meta[EVT_IR_SLOT_WRITTEN].src);
+    TEST_ASSERT_EQUAL_UINT16(0, os_evt_meta[EVT_HEALTH_TICK].payload_len);
+    TEST_ASSERT_EQUAL_INT(0, strcmp("ir_slot_written", os_evt_meta[EVT_IR_SLOT_WRITTEN].name));
+    for (os_evt_id_t id = EVT_NONE + 1; id < EVT__MAX; id++) {
+        TEST_ASSERT_NOT_NULL(os_evt_meta[id].name); /* every id has a row */
+        TEST_ASSERT_TRUE(os_evt_meta[id].payload_len <= OS_EVT_INLINE_MAX);
+    }
+
+    TEST_ASSERT_TRUE(os_evt_bus_handle_valid(os_evt_subscribe_ir_slot_written(cb_record, &ctx)));
+    TEST_ASSERT_TRUE(os_evt_bus_handle_valid(os_evt_subscribe_health_tick(cb_record, &ctx)));
+    const evt_ir_slot_written_t written = { .slot = 7, .crc32 = 0xC0FFEEu };
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_publish_ir_slot_written(&written));
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_publish_health_tick());
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_publish_health_tick()); /* coalesced per the table */
+    os_evt_bus_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.coalesced);
+    TEST_ASSERT_EQUAL_UINT32(2, os_evt_bus_dispatch_all());
+
+    evt_ir_slot_written_t got;
+    TEST_ASSERT_EQUAL_UINT16(EVT_IR_SLOT_WRITTEN, ctx.evts[0].id);
+    TEST_ASSERT_EQUAL_UINT16(OS_MOD_IR, ctx.evts[0].src);
+    os_evt_read_ir_slot_written(&ctx.evts[0], &got);
+    TEST_ASSERT_EQUAL_UINT16(7, got.slot);
+    TEST_ASSERT_EQUAL_UINT32(0xC0FFEEu, got.crc32);
+    TEST_ASSERT_EQUAL_UINT16(EVT_HEALTH_TICK, ctx.evts[1].id);
+    TEST_ASSERT_EQUAL_UINT16(OS_MOD_MONITOR, ctx.evts[1].src);
+    TEST_ASSERT_EQUAL_UINT16(0, ctx.evts[1].len);
+}
+
+static void test_queue_overflow_drop_new(void)
+{
+    record_ctx_t ctx = {0};
+    os_evt_bus_stats_t stats;
+    os_evt_bus_init();
+    os_evt_bus_subscribe(EVT_IR_SLOT_WRITTEN, cb_record, &ctx);
+
+    for (uint32_t i = 0; i < OS_EVT_BUS_QUEUE_DEPTH; i++) {
+        TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_publish(OS_MOD_IR, EVT_IR_SLOT_WRITTEN, &i, sizeof(i)));
+    }
+    uint32_t late = 0xDEAD;
+    TEST_ASSERT_EQUAL_INT(OS_EFULL, os_evt_bus_publish(OS_MOD_IR, EVT_IR_SLOT_WRITTEN, &late, sizeof(late)));
+
+    os_evt_bus_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.dropped);
+    TEST_ASSERT_EQUAL_UINT32(OS_EVT_BUS_QUEUE_DEPTH, stats.high_water);
+
+    /* The oldest events survive, the late one is gone */
+    TEST_ASSERT_EQUAL_UINT32(OS_EVT_BUS_QUEUE_DEPTH, os_evt_bus_dispatch_all());
+    uint32_t first, last;
+    memcpy(&first, ctx.evts[0].payload, sizeof(first));
+    memcpy(&last, ctx.evts[OS_EVT_BUS_QUEUE_DEPTH - 1].payload, sizeof(last));
+    TEST_ASSERT_EQUAL_UINT32(0, first);
+    TEST_ASSERT_EQUAL_UINT32(OS_EVT_BUS_QUEUE_DEPTH - 1, last);
+}
+
+static void test_coalesce_keeps_latest_in_place(void)
+{
+    record_ctx_t ctx = {0};
+    os_evt_bus_stats_t stats;
+    os_evt_bus_init();
+    os_evt_bus_set_sched(OS_EVT_SCHED_FIFO); /* arrival order; the two ids are in different lanes */
+    os_evt_bus_subscribe(EVT_OTA_PROGRESS, cb_record, &ctx);
+    os_evt_bus_subscribe(EVT_SCHEDULE_DUE, cb_record, &ctx);
+
+    /* due(1), progress 0..99, due(2): the progress entry keeps its place after due(1) */
+    uint32_t due = 1;
+    os_evt_bus_publish(OS_MOD_SCHED, EVT_SCHEDULE_DUE, &due, sizeof(due));
+    for (uint32_t pct = 0; pct < 100; pct++) {
+        TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_publish(OS_MOD_OTA, EVT_OTA_PROGRESS, &pct, sizeof(pct)));
+    }
+    due = 2;
+    os_evt_bus_publish(OS_MOD_SCHED, EVT_SCHEDULE_DUE, &due, sizeof(due));
+
+    os_evt_bus_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(99, stats.coalesced);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.dropped);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.high_water); /* the FIFO only ever held the two due events */
+    TEST_ASSERT_EQUAL_INT(OS_EBUSY, os_evt_bus_set_policy(EVT_OTA_PROGRESS, OS_EVT_POLICY_FIFO));
+
+    TEST_ASSERT_EQUAL_UINT32(3, os_evt_bus_dispatch_all());
+    uint32_t v[3];
+    for (int i = 0; i < 3; i++) {
+        memcpy(&v[i], ctx.evts[i].payload, sizeof(v[i]));
+    }
+    TEST_ASSERT_EQUAL_UINT16(EVT_SCHEDULE_DUE, ctx.evts[0].id);
+    TEST_ASSERT_EQUAL_UINT32(1, v[0]);
+    TEST_ASSERT_EQUAL_UINT16(EVT_OTA_PROGRESS, ctx.evts[1].id);
+    TEST_ASSERT_EQUAL_UINT32(99, v[1]);
+    TEST_ASSERT_EQUAL_UINT16(EVT_SCHEDULE_DUE, ctx.evts[2].id);
+    TEST_ASSERT_EQUAL_UINT32(2, v[2]);
+
+    /* Coalesced ids are still accepted with the FIFO full */
+    for (uint32_t i = 0; i < OS_EVT_BUS_QUEUE_DEPTH; i++) {
+        os_evt_bus_publish(OS_MOD_SCHED, EVT_SCHEDULE_DUE, &i, sizeof(i));
+    }
+    TEST_ASSERT_EQUAL_INT(OS_EFULL, os_evt_bus_publish(OS_MOD_SCHED, EVT_SCHEDULE_DUE, &due, sizeof(due)));
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_publish(OS_MOD_OTA, EVT_OTA_PROGRESS, &due, sizeof(due)));
+    TEST_ASSERT_EQUAL_UINT32(OS_EVT_BUS_QUEUE_DEPTH + 1, os_evt_bus_dispatch_all());
+
+    /* Back to FIFO once nothing is pending */
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_set_policy(EVT_OTA_PROGRESS, OS_EVT_POLICY_FIFO));
+    os_evt_bus_publish(OS_MOD_OTA, EVT_OTA_PROGRESS, &due, sizeof(due));
+    os_evt_bus_publish(OS_MOD_OTA, EVT_OTA_PROGRESS, &due, sizeof(due));
+    TEST_ASSERT_EQUAL_UINT32(2, os_evt_bus_dispatch_all());
+    TEST_ASSERT_EQUAL_INT(OS_EINVAL, os_evt_bus_set_policy(EVT__MAX, OS_EVT_POLICY_COALESCE));
+}
+
+static void test_lanes_strict_priority(void)
+{
+    record_ctx_t ctx = {0};
+    os_evt_bus_stats_t stats;
+    uint32_t v = 0;
+    uint32_t sum = 0;
+    os_evt_bus_init();
+    os_evt_bus_subscribe(EVT_IR_SLOT_WRITTEN, cb_record, &ctx);
+    os_evt_bus_subscribe(EVT_BATTERY_STATE, cb_record, &ctx);
+    os_evt_bus_subscribe(EVT_SCHEDULE_DUE, cb_record, &ctx);
+
+    TEST_ASSERT_EQUAL_UINT32(OS_EVT_LANE_HIGH, os_evt_bus_lane_of(EVT_SCHEDULE_DUE));
+    TEST_ASSERT_EQUAL_UINT32(OS_EVT_LANE_NORMAL, os_evt_bus_lane_of(EVT_IR_SLOT_WRITTEN));
+    TEST_ASSERT_EQUAL_UINT32(OS_EVT_BUS_LANES - 1, os_evt_bus_lane_of(EVT_OTA_PROGRESS));
+    TEST_ASSERT_EQUAL_INT(OS_EINVAL, os_evt_bus_set_sched((os_evt_sched_t)7));
+
+    /* Published low to high, delivered high to low */
+    os_evt_bus_publish(OS_MOD_POWER, EVT_BATTERY_STATE, &v, sizeof(v));
+    os_evt_bus_publish(OS_MOD_IR, EVT_IR_SLOT_WRITTEN, &v, sizeof(v));
+    os_evt_bus_publish(OS_MOD_SCHED, EVT_SCHEDULE_DUE, &v, sizeof(v));
+    os_evt_bus_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.lane[OS_EVT_LANE_HIGH].depth);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.lane[OS_EVT_LANE_NORMAL].depth);
+    TEST_ASSERT_EQUAL_UINT32(3, os_evt_bus_dispatch_all());
+    TEST_ASSERT_EQUAL_UINT16(EVT_SCHEDULE_DUE, ctx.evts[0].id);
+    TEST_ASSERT_EQUAL_UINT16(EVT_IR_SLOT_WRITTEN, ctx.evts[1].id);
+    TEST_ASSERT_EQUAL_UINT16(EVT_BATTERY_STATE, ctx.evts[2].id);
+
+    /* A high lane that never drains still lets the normal lane through */
+    ctx.calls = 0;
+    os_evt_bus_publish(OS_MOD_IR, EVT_IR_SLOT_WRITTEN, &v, sizeof(v));
+    os_evt_bus_publish(OS_MOD_SCHED, EVT_SCHEDULE_DUE, &v, sizeof(v));
+    for (uint32_t i = 0; i <= OS_EVT_BUS_STARVE_LIMIT; i++) {
+        os_evt_bus_publish(OS_MOD_SCHED, EVT_SCHEDULE_DUE, &i, sizeof(i));
+        TEST_ASSERT_TRUE(os_evt_bus_dispatch_one());
+    }
+    TEST_ASSERT_EQUAL_UINT16(EVT_SCHEDULE_DUE, ctx.evts[OS_EVT_BUS_STARVE_LIMIT - 1].id);
+    TEST_ASSERT_EQUAL_UINT16(EVT_IR_SLOT_WRITTEN, ctx.evts[OS_EVT_BUS_STARVE_LIMIT].id);
+
+    os_evt_bus_dispatch_all();
+    os_evt_bus_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.lane[OS_EVT_LANE_NORMAL].promoted);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.lane[OS_EVT_LANE_NORMAL].dispatched);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.lane[OS_EVT_LANE_HIGH].depth);
+    for (uint32_t l = 0; l < OS_EVT_BUS_LANES; l++) {
+        sum += stats.lane[l].dispatched;
+    }
+    TEST_ASSERT_EQUAL_UINT32(stats.dispatched, sum);
+}
+
+static void test_lanes_weighted_share(void)
+{
+    static const uint32_t weights[] = OS_EVT_BUS_LANE_WEIGHTS;
+    record_ctx_t ctx = {0};
+    uint32_t high = 0;
+    os_evt_bus_stats_t stats;
+    os_evt_bus_init();
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_set_sched(OS_EVT_SCHED_WEIGHTED));
+    os_evt_bus_subscribe(EVT_IR_SLOT_WRITTEN, cb_record, &ctx);
+    os_evt_bus_subscribe(EVT_SCHEDULE_DUE, cb_record, &ctx);
+
+    for (uint32_t i = 0; i < OS_EVT_BUS_QUEUE_DEPTH; i++) {
+        os_evt_bus_publish(OS_MOD_IR, EVT_IR_SLOT_WRITTEN, &i, sizeof(i));
+        os_evt_bus_publish(OS_MOD_SCHED, EVT_SCHEDULE_DUE, &i, sizeof(i));
+    }
+    /* One round: weights[0] high for weights[1] normal */
+    uint32_t round = weights[0] + weights[1];
+    for (uint32_t i = 0; i < round; i++) {
+        TEST_ASSERT_TRUE(os_evt_bus_dispatch_one());
+        high += ctx.evts[i].id == EVT_SCHEDULE_DUE;
+    }
+    TEST_ASSERT_EQUAL_UINT32(weights[0], high);
+
+    TEST_ASSERT_EQUAL_UINT32(2 * OS_EVT_BUS_QUEUE_DEPTH - round, os_evt_bus_dispatch_all());
+    os_evt_bus_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(OS_EVT_BUS_QUEUE_DEPTH, stats.lane[OS_EVT_LANE_HIGH].dispatched);
+    TEST_ASSERT_EQUAL_UINT32(OS_EVT_BUS_QUEUE_DEPTH, stats.lane[OS_EVT_LANE_NORMAL].high_water);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.dropped);
+}
+
+static void test_mask_subscription(void)
+{
+    record_ctx_t per_id = {0};
+    record_ctx_t multi = {0};
+    uint32_t calls = 0;
+    os_evt_bus_stats_t stats;
+    os_evt_bus_init();
+
+    TEST_ASSERT_FALSE(os_evt_bus_handle_valid(os_evt_bus_subscribe_mask(0, cb_count, &calls)));
+    TEST_ASSERT_FALSE(os_evt_bus_handle_valid(os_evt_bus_subscribe_mask(OS_EVT_BIT(EVT_NONE), cb_count, &calls)));
+    TEST_ASSERT_FALSE(os_evt_bus_handle_valid(os_evt_bus_subscribe_mask(OS_EVT_BIT(EVT__MAX), cb_count, &calls)));
+
+    /* One handle follows two ids; per-id subscribers of an id run first */
+    os_evt_sub_handle_t h = os_evt_bus_subscribe_mask(OS_EVT_BIT(EVT_TIME_SYNCED) | OS_EVT_BIT(EVT_TIME_JUMPED),
+                                                      cb_record, &multi);
+    TEST_ASSERT_TRUE(os_evt_bus_handle_valid(h));
+    TEST_ASSERT_EQUAL_UINT16(OS_EVT_MASK_HANDLE_ID, h.id);
+    os_evt_bus_subscribe(EVT_TIME_SYNCED, cb_record, &per_id);
+    os_evt_bus_publish(OS_MOD_CLOCK, EVT_TIME_SYNCED, NULL, 0);
+    os_evt_bus_publish(OS_MOD_CLOCK, EVT_TIME_JUMPED, NULL, 0);
+    os_evt_bus_publish(OS_MOD_CLOCK, EVT_SCHEDULE_TABLE_UPDATED, NULL, 0);
+    TEST_ASSERT_EQUAL_UINT32(3, os_evt_bus_dispatch_all());
+    TEST_ASSERT_EQUAL_UINT32(1, per_id.calls);
+    TEST_ASSERT_EQUAL_UINT32(2, multi.calls);
+    TEST_ASSERT_EQUAL_UINT16(EVT_TIME_JUMPED, multi.evts[0].id); /* lane order: HIGH first */
+    TEST_ASSERT_EQUAL_UINT16(EVT_TIME_SYNCED, multi.evts[1].id);
+
+    /* Unsubscribed: skipped, and its entry is repaired on the next dispatch that matches it */
+    os_evt_bus_unsubscribe(h);
+    os_evt_bus_publish(OS_MOD_CLOCK, EVT_TIME_JUMPED, NULL, 0);
+    os_evt_bus_dispatch_all();
+    TEST_ASSERT_EQUAL_UINT32(2, multi.calls);
+    os_evt_bus_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.healed);
+
+    /* The table is bounded; released entries are reused */
+    os_evt_sub_handle_t all[OS_EVT_BUS_MAX_MASK_SUBS];
+    for (uint32_t i = 0; i < OS_EVT_BUS_MAX_MASK_SUBS; i++) {
+        all[i] = os_evt_bus_subscribe_mask(OS_EVT_BIT(EVT_HEALTH_TICK), cb_count, &calls);
+        TEST_ASSERT_TRUE(os_evt_bus_handle_valid(all[i]));
+    }
+    TEST_ASSERT_FALSE(os_evt_bus_handle_valid(os_evt_bus_subscribe_mask(OS_EVT_BIT(EVT_HEALTH_TICK), cb_count, &calls)));
+    os_evt_bus_unsubscribe(all[0]);
+    TEST_ASSERT_TRUE(os_evt_bus_handle_valid(os_evt_bus_subscribe_mask(OS_EVT_BIT(EVT_OTA_DONE), cb_count, &calls)));
+    os_evt_bus_publish(OS_MOD_MONITOR, EVT_HEALTH_TICK, NULL, 0);
+    os_evt_bus_dispatch_all();
+    TEST_ASSERT_EQUAL_UINT32(OS_EVT_BUS_MAX_MASK_SUBS - 1, calls);
+}
+
+static void test_unsubscribe_semantics(void)
+{
+    self_unsub_ctx_t self = {0};
+    uint32_t queued_calls = 0, new_calls = 0;
+    os_evt_bus_init();
+
+    /* Self-unsubscribe from the callback */
+    self.self = os_evt_bus_subscribe(EVT_TIME_SYNCED, cb_self_unsub, &self);
+    TEST_ASSERT_TRUE(os_evt_bus_handle_valid(self.self));
+    os_evt_bus_publish(OS_MOD_CLOCK, EVT_TIME_SYNCED, NULL, 0);
+    os_evt_bus_publish(OS_MOD_CLOCK, EVT_TIME_SYNCED, NULL, 0);
+    os_evt_bus_dispatch_all();
+    TEST_ASSERT_EQUAL_UINT32(1, self.calls);
+    os_evt_bus_unsubscribe(self.self); /* again: no-op */
+
+    /* Unsubscribed while its event is queued: never called */
+    os_evt_sub_handle_t h = os_evt_bus_subscribe(EVT_SCHEDULE_DUE, cb_count, &queued_calls);
+    os_evt_bus_publish(OS_MOD_SCHED, EVT_SCHEDULE_DUE, NULL, 0);
+    os_evt_bus_unsubscribe(h);
+    os_evt_bus_dispatch_all();
+    TEST_ASSERT_EQUAL_UINT32(0, queued_calls);
+
+    /* A stale handle whose index was reused does not touch the new subscriber */
+    os_evt_sub_handle_t stale = os_evt_bus_subscribe(EVT_TIME_JUMPED, cb_count, &queued_calls);
+    os_evt_bus_unsubscribe(stale);
+    os_evt_sub_handle_t fresh = os_evt_bus_subscribe(EVT_TIME_JUMPED, cb_count, &new_calls);
+    TEST_ASSERT_EQUAL_UINT32(stale.slot & 0xFFu, fresh.slot & 0xFFu);
+    TEST_ASSERT_TRUE(stale.slot != fresh.slot);
+    os_evt_bus_unsubscribe(stale);
+    os_evt_bus_publish(OS_MOD_CLOCK, EVT_TIME_JUMPED, NULL, 0);
+    os_evt_bus_dispatch_all();
+    TEST_ASSERT_EQUAL_UINT32(1, new_calls);
+    TEST_ASSERT_EQUAL_UINT32(0, queued_calls);
+}
+
+static void test_subscription_list_self_heal(void)
+{
+    os_evt_sub_handle_t handles[OS_EVT_BUS_MAX_SUBS_PER_EVT];
+    os_evt_bus_stats_t stats;
+    uint32_t calls = 0;
+    os_evt_bus_init();
+
+    for (uint32_t i = 0; i < OS_EVT_BUS_MAX_SUBS_PER_EVT; i++) {
+        handles[i] = os_evt_bus_subscribe(EVT_BATTERY_STATE, cb_count, &calls);
+        TEST_ASSERT_TRUE(os_evt_bus_handle_valid(handles[i]));
+    }
+    TEST_ASSERT_FALSE(os_evt_bus_handle_valid(os_evt_bus_subscribe(EVT_BATTERY_STATE, cb_count, &calls)));
+
+    for (uint32_t i = 0; i < OS_EVT_BUS_MAX_SUBS_PER_EVT; i++) {
+        os_evt_bus_unsubscribe(handles[i]);
+    }
+    for (uint32_t i = 0; i < OS_EVT_BUS_MAX_SUBS_PER_EVT; i++) {
+        handles[i] = os_evt_bus_subscribe(EVT_BATTERY_STATE, cb_count, &calls);
+        TEST_ASSERT_TRUE(os_evt_bus_handle_valid(handles[i]));
+    }
+    os_evt_bus_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(OS_EVT_BUS_MAX_SUBS_PER_EVT, stats.healed);
+
+    os_evt_bus_publish(OS_MOD_POWER, EVT_BATTERY_STATE, NULL, 0);
+    os_evt_bus_dispatch_all();
+    TEST_ASSERT_EQUAL_UINT32(OS_EVT_BUS_MAX_SUBS_PER_EVT, calls);
+}
+
+/* =========================
+ * Threaded: "ISR" publishers and the dispatcher thread
+ * ========================= */
+#define ISR_THREADS    4
+#define ISR_EVENTS     5000
+
+typedef struct {
+    os_mod_id_t src;
+    uint32_t retries;
+} isr_ctx_t;
+
+static void test_dispatch_batch(void)
+{
+    record_ctx_t rec = {0};
+    uint32_t count = 0, other = 0;
+    self_unsub_ctx_t killer = {0};
+    os_evt_bus_stats_t st;
+    os_evt_bus_init();
+
+    TEST_ASSERT_EQUAL_INT(OS_EINVAL, os_evt_bus_set_batch(0));
+    TEST_ASSERT_EQUAL_INT(OS_EINVAL, os_evt_bus_set_batch(OS_EVT_BUS_MAX_BATCH + 1u));
+
+    /* One batch takes at most max events, in queue order, every subscriber each */
+    os_evt_bus_subscribe(EVT_IR_SEND_STARTED, cb_record, &rec);
+    os_evt_bus_subscribe(EVT_IR_SEND_STARTED, cb_count, &count);
+    for (uint32_t i = 0; i < OS_EVT_BUS_MAX_BATCH + 5u; i++) {
+        TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_publish((os_mod_id_t)(i + 1u), EVT_IR_SEND_STARTED, NULL, 0));
+    }
+    TEST_ASSERT_EQUAL_UINT32(3, os_evt_bus_dispatch_batch(3));
+    TEST_ASSERT_EQUAL_UINT32(3, count);
+    size_t taken = os_evt_bus_dispatch_batch(1000);
+    TEST_ASSERT_EQUAL_UINT32(OS_EVT_BUS_MAX_BATCH, taken);
+    TEST_ASSERT_EQUAL_UINT32(OS_EVT_BUS_MAX_BATCH + 5u - 3u - taken, os_evt_bus_dispatch_batch(1000));
+    TEST_ASSERT_EQUAL_UINT32(0, os_evt_bus_dispatch_batch(1000));
+    TEST_ASSERT_EQUAL_UINT32(OS_EVT_BUS_MAX_BATCH + 5u, rec.calls);
+    for (uint32_t i = 0; i < rec.calls; i++) {
+        TEST_ASSERT_EQUAL_UINT32(i + 1u, rec.evts[i].src);
+    }
+
+    /* A callback unsubscribing a later subscriber mid-batch: it is not called again */
+    os_evt_bus_init();
+    os_evt_bus_subscribe(EVT_TIME_SYNCED, cb_self_unsub, &killer);
+    killer.self = os_evt_bus_subscribe(EVT_TIME_SYNCED, cb_count, &other);
+    os_evt_bus_publish(OS_MOD_CLOCK, EVT_TIME_SYNCED, NULL, 0);
+    os_evt_bus_publish(OS_MOD_CLOCK, EVT_TIME_SYNCED, NULL, 0);
+    TEST_ASSERT_EQUAL_UINT32(2, os_evt_bus_dispatch_batch(OS_EVT_BUS_MAX_BATCH));
+    TEST_ASSERT_EQUAL_UINT32(2, killer.calls);
+    TEST_ASSERT_EQUAL_UINT32(0, other);
+
+    /* dispatch_all drains in batches of the configured size */
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_set_batch(2));
+    for (uint32_t i = 0; i < 5; i++) {
+        os_evt_bus_publish(OS_MOD_CLOCK, EVT_TIME_SYNCED, NULL, 0);
+    }
+    TEST_ASSERT_EQUAL_UINT32(5, os_evt_bus_dispatch_all());
+    os_evt_bus_get_stats(&st);
+    TEST_ASSERT_EQUAL_UINT32(7, st.dispatched);
+    TEST_ASSERT_EQUAL_UINT32(7, st.delivered);
+    TEST_ASSERT_EQUAL_UINT32(7, killer.calls);
+}
+
+static void test_staging_backpressure(void)
+{
+    record_ctx_t ctx = {0};
+    os_evt_bus_stats_t stats;
+    const uint32_t room = OS_EVT_BUS_QUEUE_DEPTH + OS_EVT_BUS_STAGE_DEPTH;
+    os_evt_bus_init();
+    os_evt_bus_subscribe(EVT_IR_SLOT_WRITTEN, cb_record, &ctx);
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_set_staging(true));
+
+    /* Staged publishes reach the lanes when someone merges: here get_stats */
+    for (uint32_t i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_publish(OS_MOD_IR, EVT_IR_SLOT_WRITTEN, &i, sizeof(i)));
+    }
+    os_evt_bus_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.published);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.staged);
+
+    /* A full ring is merged by its publisher; once the lane is full too, the ring holds on and then refuses */
+    for (uint32_t i = 3; i < room; i++) {
+        TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_publish(OS_MOD_IR, EVT_IR_SLOT_WRITTEN, &i, sizeof(i)));
+    }
+    uint32_t late = 0xDEAD;
+    TEST_ASSERT_EQUAL_INT(OS_EFULL, os_evt_bus_publish(OS_MOD_IR, EVT_IR_SLOT_WRITTEN, &late, sizeof(late)));
+    /* Coalesced ids are never refused, even past a full ring */
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_publish_battery_state());
+    os_evt_bus_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.dropped);
+    TEST_ASSERT_TRUE(stats.stage_full >= 2);
+    TEST_ASSERT_EQUAL_UINT32(OS_EVT_BUS_QUEUE_DEPTH, stats.high_water);
+
+    /* Dispatch merges the rest as the lane drains; nothing accepted is lost or reordered */
+    TEST_ASSERT_EQUAL_UINT32(room + 1u, os_evt_bus_dispatch_all());
+    TEST_ASSERT_EQUAL_UINT32(room, ctx.calls);
+    for (uint32_t i = 0; i < room; i++) {
+        uint32_t seq;
+        memcpy(&seq, ctx.evts[i].payload, sizeof(seq));
+        TEST_ASSERT_EQUAL_UINT32(i, seq);
+    }
+    os_evt_bus_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(room + 1u, stats.published);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.lane[os_evt_bus_lane_of(EVT_IR_SLOT_WRITTEN)].depth);
+
+    /* Switching off merges what is left and publishes go straight to the lanes again */
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_publish(OS_MOD_IR, EVT_IR_SLOT_WRITTEN, &late, sizeof(late)));
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_set_staging(false));
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_publish(OS_MOD_IR, EVT_IR_SLOT_WRITTEN, &late, sizeof(late)));
+    os_evt_bus_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(room + 3u, stats.published);
+    TEST_ASSERT_EQUAL_UINT32(room + 1u, stats.staged);
+}
+
+static void test_deferred_subscriber_worker_queue(void)
+{
+    uint8_t detail[100];
+    uint8_t small[4] = { 1, 2, 3, 4 };
+    const evt_ir_send_result_t res = { .result = IR_RES_OK };
+    pool_ctx_t slow = {0};
+    uint32_t fast = 0;
+    os_evt_bus_stats_t stats;
+    os_evt_sub_stats_t sub;
+    os_evt_bus_init();
+
+    os_evt_sub_handle_t h = os_evt_bus_subscribe_deferred(EVT_STORAGE_CORRUPT, cb_pool, &slow, OS_MOD_STORAGE);
+    TEST_ASSERT_TRUE(os_evt_bus_handle_valid(h));
+    os_evt_bus_subscribe(EVT_IR_SEND_RESULT, cb_count, &fast);
+
+    /* The dispatcher only hands the deferred call over; the pool block stays referenced for the worker */
+    for (size_t i = 0; i < sizeof(detail); i++) {
+        detail[i] = (uint8_t)i;
+    }
+    detail[sizeof(detail) - 1] = sizeof(detail);
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_publish(OS_MOD_STORAGE, EVT_STORAGE_CORRUPT, detail, sizeof(detail)));
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_publish_ir_send_result(&res));
+    TEST_ASSERT_EQUAL_UINT32(2, os_evt_bus_dispatch_all());
+    TEST_ASSERT_EQUAL_UINT32(1, fast);
+    TEST_ASSERT_EQUAL_UINT32(0, slow.calls);
+    os_evt_bus_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.deferred);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.delivered);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.pool_used);
+    TEST_ASSERT_EQUAL_UINT32(OS_MOD_STORAGE, (uint32_t)stats.worker[0].owner);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.worker[0].depth);
+
+    TEST_ASSERT_EQUAL_UINT32(0, os_evt_bus_worker_run(OS_MOD_IR)); /* no queue */
+    TEST_ASSERT_EQUAL_UINT32(1, os_evt_bus_worker_run(OS_MOD_STORAGE));
+    TEST_ASSERT_EQUAL_UINT32(1, slow.calls);
+    TEST_ASSERT_NOT_NULL(slow.data[0]);
+    os_evt_bus_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.delivered);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.pool_used);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.worker[0].depth);
+
+    /* A full worker queue drops the handoff, counted per subscriber and bus-wide */
+    for (uint32_t i = 0; i < OS_EVT_BUS_WORKER_DEPTH + 2u; i++) {
+        TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_publish(OS_MOD_STORAGE, EVT_STORAGE_CORRUPT, small, sizeof(small)));
+    }
+    TEST_ASSERT_EQUAL_UINT32(OS_EVT_BUS_WORKER_DEPTH + 2u, os_evt_bus_dispatch_all());
+    os_evt_bus_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.defer_dropped);
+    TEST_ASSERT_EQUAL_UINT32(OS_EVT_BUS_WORKER_DEPTH, stats.worker[0].high_water);
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_get_sub_stats(h, &sub));
+    TEST_ASSERT_EQUAL_UINT32(1u + OS_EVT_BUS_WORKER_DEPTH, sub.deferred);
+    TEST_ASSERT_EQUAL_UINT32(2, sub.dropped);
+    TEST_ASSERT_EQUAL_UINT32(1, sub.calls);
+
+    /* Unsubscribed while queued: the worker takes the handoffs without calling */
+    os_evt_bus_unsubscribe(h);
+    TEST_ASSERT_EQUAL_UINT32(OS_EVT_BUS_WORKER_DEPTH, os_evt_bus_worker_run(OS_MOD_STORAGE));
+    TEST_ASSERT_EQUAL_UINT32(1, slow.calls);
+    TEST_ASSERT_EQUAL_INT(OS_EINVAL, os_evt_bus_get_sub_stats(h, &sub));
+
+    /* One queue per module, OS_EVT_BUS_MAX_WORKERS of them */
+    TEST_ASSERT_FALSE(os_evt_bus_handle_valid(os_evt_bus_subscribe_deferred(EVT_STORAGE_FULL, cb_count, &fast,
+                                                                            OS_MOD_NONE)));
+    for (os_mod_id_t m = OS_MOD_STORAGE; m < OS_MOD_STORAGE + OS_EVT_BUS_MAX_WORKERS; m++) {
+        TEST_ASSERT_TRUE(os_evt_bus_handle_valid(os_evt_bus_subscribe_deferred(EVT_STORAGE_FULL, cb_count, &fast, m)));
+    }
+    TEST_ASSERT_FALSE(os_evt_bus_handle_valid(os_evt_bus_subscribe_deferred(EVT_STORAGE_FULL, cb_count, &fast,
+                                                                            OS_MOD_STORAGE + OS_EVT_BUS_MAX_WORKERS)));
+}
+
+static void cb_sleep_us(const os_evt_t *evt, void *user_ctx)
+{
+    (void)evt;
+    usleep(*(const uint32_t *)user_ctx);
+}
+
+static void test_callback_budget_overrun(void)
+{
+    uint32_t sleep_us = 3000;
+    os_evt_bus_stats_t stats;
+    os_evt_sub_stats_t sub;
+    os_evt_bus_init();
+
+    os_evt_sub_handle_t h = os_evt_bus_subscribe(EVT_STORAGE_FULL, cb_sleep_us, &sleep_us);
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_get_sub_stats(h, &sub));
+    TEST_ASSERT_EQUAL_UINT32(OS_EVT_BUS_CB_BUDGET_US, sub.budget_us);
+
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_set_budget(h, 1000));
+    os_evt_publish_storage_full();
+    os_evt_bus_dispatch_all();
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_get_sub_stats(h, &sub));
+    TEST_ASSERT_EQUAL_UINT32(1, sub.calls);
+    TEST_ASSERT_EQUAL_UINT32(1, sub.overruns);
+    TEST_ASSERT_TRUE(sub.max_us >= sleep_us);
+    os_evt_bus_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.overruns);
+
+    /* Budget 0: timed, not flagged */
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_set_budget(h, 0));
+    os_evt_publish_storage_full();
+    os_evt_bus_dispatch_all();
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_get_sub_stats(h, &sub));
+    TEST_ASSERT_EQUAL_UINT32(2, sub.calls);
+    TEST_ASSERT_EQUAL_UINT32(1, sub.overruns);
+
+    /* Deferred callbacks are timed on the worker */
+    os_evt_sub_handle_t d = os_evt_bus_subscribe_deferred(EVT_STORAGE_FULL, cb_sleep_us, &sleep_us, OS_MOD_STORAGE);
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_set_budget(d, 1000));
+    os_evt_publish_storage_full();
+    os_evt_bus_dispatch_all();
+    TEST_ASSERT_EQUAL_UINT32(1, os_evt_bus_worker_run(OS_MOD_STORAGE));
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_get_sub_stats(d, &sub));
+    TEST_ASSERT_EQUAL_UINT32(1, sub.calls);
+    TEST_ASSERT_EQUAL_UINT32(1, sub.overruns);
+    os_evt_bus_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.overruns);
+
+    os_evt_bus_unsubscribe(h);
+    TEST_ASSERT_EQUAL_INT(OS_EINVAL, os_evt_bus_set_budget(h, 10));
+}
+
+static atomic_bool s_gate_open;
+static atomic_uint s_gate_calls;
+
+static void cb_gate(const os_evt_t *evt, void *user_ctx)
+{
+    (void)evt;
+    (void)user_ctx;
+    while (!atomic_load(&s_gate_open)) {
+        sched_yield();
+    }
+    atomic_fetch_add(&s_gate_calls, 1);
+}
+
+static void cb_atomic_count(const os_evt_t *evt, void *user_ctx)
+{
+    (void)evt;
+    atomic_fetch_add((atomic_uint *)user_ctx, 1);
+}
+
+/* A deferred callback that blocks holds up its own worker only, not the events behind it */
+static void test_blocked_worker_no_head_of_line(void)
+{
+    const evt_ir_send_result_t res = { .result = IR_RES_OK };
+    atomic_uint fast = 0;
+    os_evt_bus_stats_t stats;
+    os_evt_bus_init();
+    atomic_store(&s_gate_open, false);
+    atomic_store(&s_gate_calls, 0);
+    os_evt_bus_subscribe_deferred(EVT_STORAGE_FULL, cb_gate, NULL, OS_MOD_STORAGE);
+    os_evt_bus_subscribe(EVT_IR_SEND_RESULT, cb_atomic_count, &fast);
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_start_dispatcher(0, 0));
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_start_worker(OS_MOD_STORAGE, 0, 0));
+    TEST_ASSERT_EQUAL_INT(OS_ESTATE, os_evt_bus_start_worker(OS_MOD_STORAGE, 0, 0));
+    TEST_ASSERT_EQUAL_INT(OS_EINVAL, os_evt_bus_start_worker(OS_MOD_MAX, 0, 0));
+
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_publish_storage_full());
+    for (uint32_t i = 0; i < 10; i++) {
+        TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_publish_ir_send_result(&res));
+    }
+    while (atomic_load(&fast) < 10) {
+        sched_yield();
+    }
+    unsigned gate_calls = atomic_load(&s_gate_calls);
+    TEST_ASSERT_EQUAL_UINT32(0, gate_calls); /* still blocked */
+
+    atomic_store(&s_gate_open, true);
+    while (atomic_load(&s_gate_calls) < 1) {
+        sched_yield();
+    }
+    os_evt_bus_stop_worker(OS_MOD_STORAGE);
+    os_evt_bus_stop_dispatcher();
+    os_evt_bus_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(11, stats.delivered);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.deferred);
+}
+
+static atomic_uint s_isr_received;
+static uint32_t s_isr_next[OS_MOD_MAX];
+static atomic_uint s_isr_out_of_order;
+
+static void cb_isr_sink(const os_evt_t *evt, void *user_ctx)
+{
+    uint32_t seq;
+    (void)user_ctx;
+    memcpy(&seq, evt->payload, sizeof(seq));
+    if (seq != s_isr_next[evt->src]) {
+        atomic_fetch_add(&s_isr_out_of_order, 1);
+    }
+    s_isr_next[evt->src] = seq + 1;
+    atomic_fetch_add(&s_isr_received, 1);
+}
+
+static void *isr_thread(void *arg)
+{
+    isr_ctx_t *ctx = arg;
+    for (uint32_t seq = 0; seq < ISR_EVENTS; seq++) {
+        bool woken = false;
+        while (os_evt_bus_publish_from_isr(ctx->src, EVT_IR_SEND_RESULT, &seq, sizeof(seq), &woken) == OS_EFULL) {
+            ctx->retries++;
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void run_isr_publishers(bool staging)
+{
+    pthread_t th[ISR_THREADS];
+    isr_ctx_t ctx[ISR_THREADS];
+    os_evt_bus_stats_t stats;
+
+    os_evt_bus_init();
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_set_staging(staging));
+    atomic_store(&s_isr_received, 0);
+    atomic_store(&s_isr_out_of_order, 0);
+    memset(s_isr_next, 0, sizeof(s_isr_next));
+    os_evt_bus_subscribe(EVT_IR_SEND_RESULT, cb_isr_sink, NULL);
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_start_dispatcher(0, 0));
+    TEST_ASSERT_EQUAL_INT(OS_ESTATE, os_evt_bus_start_dispatcher(0, 0));
+
+    for (int i = 0; i < ISR_THREADS; i++) {
+        ctx[i] = (isr_ctx_t){ .src = (os_mod_id_t)(OS_MOD_IR + i), .retries = 0 };
+        TEST_ASSERT_EQUAL_INT(0, pthread_create(&th[i], NULL, isr_thread, &ctx[i]));
+    }
+    for (int i = 0; i < ISR_THREADS; i++) {
+        pthread_join(th[i], NULL);
+    }
+    while (atomic_load(&s_isr_received) < ISR_THREADS * ISR_EVENTS) {
+        sched_yield();
+    }
+    os_evt_bus_stop_dispatcher();
+
+    os_evt_bus_get_stats(&stats);
+    unsigned out_of_order = atomic_load(&s_isr_out_of_order);
+    TEST_ASSERT_EQUAL_UINT32(ISR_THREADS * ISR_EVENTS, stats.published);
+    TEST_ASSERT_EQUAL_UINT32(ISR_THREADS * ISR_EVENTS, stats.delivered);
+    TEST_ASSERT_EQUAL_UINT32(0, out_of_order); /* per publisher FIFO */
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(OS_EVT_BUS_QUEUE_DEPTH, stats.high_water);
+    TEST_ASSERT_EQUAL_UINT32(staging ? ISR_THREADS * ISR_EVENTS : 0, stats.staged);
+}
+
+static void test_isr_publishers_with_dispatcher(void)
+{
+    run_isr_publishers(false);
+}
+
+/* Each thread gets its own staging ring; the merge keeps every publisher's order */
+static void test_staged_publishers_with_dispatcher(void)
+{
+    run_isr_publishers(true);
+}
+
+/* =========================
+ * Unity test runner
+ * ========================= */
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_publish_copies_payload_in_order);
+    RUN_TEST(test_rejects_bad_events);
+    RUN_TEST(test_pool_payload_fan_out);
+    RUN_TEST(test_event_table_typed_wrappers);
+    RUN_TEST(test_queue_overflow_drop_new);
+    RUN_TEST(test_coalesce_keeps_latest_in_place);
+    RUN_TEST(test_lanes_strict_priority);
+    RUN_TEST(test_lanes_weighted_share);
+    RUN_TEST(test_mask_subscription);
+    RUN_TEST(test_unsubscribe_semantics);
+    RUN_TEST(test_subscription_list_self_heal);
+    RUN_TEST(test_dispatch_batch);
+    RUN_TEST(test_staging_backpressure);
+    RUN_TEST(test_deferred_subscriber_worker_queue);
+    RUN_TEST(test_callback_budget_overrun);
+    RUN_TEST(test_blocked_worker_no_head_of_line);
+    RUN_TEST(test_isr_publishers_with_dispatcher);
+    RUN_TEST(test_staged_publishers_with_dispatcher);
+    return UNITY_END();
+}
@@ -0,0 +1,245 @@
+/*
+ * test_os_evt_trace.c — host unit tests for the event bus trace ring
+ *
+ * Checks what the bus records (publish, merge, refusals, dispatch start and
+ * end, paired by the entry's sequence stamp), the dump layout, ring wrap, and
+ * that a dump taken while other threads record never returns a torn record.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "host_unity.h"
+#include "os_evt_bus.h"
+#include "os_evt_trace.h"
+
+HOST_UNITY_INSTANCE;
+
+/* =========================
+ * Helpers
+ * ========================= */
+#define DUMP_MAX (sizeof(os_evt_trace_hdr_t) + OS_EVT_TRACE_RECORDS * sizeof(os_evt_trace_rec_t))
+
+typedef struct {
+    uint8_t buf[DUMP_MAX];
+    size_t len;
+    uint32_t writes;
+} dump_sink_t;
+
+static dump_sink_t s_dump;
+
+static void sink_write(const void *data, size_t len, void *user_ctx)
+{
+    dump_sink_t *sink = user_ctx;
+    if (sink->len + len <= sizeof(sink->buf)) {
+        memcpy(&sink->buf[sink->len], data, len);
+    }
+    sink->len += len;
+    sink->writes++;
+}
+
+static size_t take_dump(os_evt_trace_hdr_t *hdr)
+{
+    memset(&s_dump, 0, sizeof(s_dump));
+    size_t valid = os_evt_trace_dump(sink_write, &s_dump);
+    memcpy(hdr, s_dump.buf, sizeof(*hdr));
+    return valid;
+}
+
+static os_evt_trace_rec_t dump_rec(uint32_t i)
+{
+    os_evt_trace_rec_t rec;
+    memcpy(&rec, &s_dump.buf[sizeof(os_evt_trace_hdr_t) + i * sizeof(rec)], sizeof(rec));
+    return rec;
+}
+
+static void check_rec(uint32_t i, os_evt_trace_type_t type, os_evt_id_t id, uint32_t ref, uint32_t info)
+{
+    os_evt_trace_rec_t rec = dump_rec(i);
+    uint32_t rec_type = rec.type;
+    uint32_t rec_id = rec.id;
+    uint32_t rec_info = rec.info;
+    TEST_ASSERT_EQUAL_UINT32(type, rec_type);
+    TEST_ASSERT_EQUAL_UINT32(id, rec_id);
+    TEST_ASSERT_EQUAL_UINT32(ref, rec.ref);
+    TEST_ASSERT_EQUAL_UINT32(info, rec_info);
+}
+
+static void cb_nop(const os_evt_t *evt, void *user_ctx)
+{
+    (void)evt;
+    (void)user_ctx;
+}
+
+/* =========================
+ * Test cases
+ * ========================= */
+static void test_publish_dispatch_pairs(void)
+{
+    const evt_ir_send_result_t res = { .result = IR_RES_OK };
+    os_evt_trace_hdr_t hdr;
+    os_evt_bus_init();
+    os_evt_subscribe_ir_send_result(cb_nop, NULL);
+    os_evt_subscribe_ir_send_result(cb_nop, NULL);
+
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_publish_ir_send_result(&res));
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_publish_ir_send_result(&res));
+    TEST_ASSERT_EQUAL_UINT32(2, os_evt_bus_dispatch_all());
+
+    TEST_ASSERT_EQUAL_UINT32(6, take_dump(&hdr));
+    TEST_ASSERT_EQUAL_UINT32(OS_EVT_TRACE_MAGIC, hdr.magic);
+    TEST_ASSERT_EQUAL_UINT32(OS_EVT_TRACE_VERSION, hdr.version);
+    TEST_ASSERT_EQUAL_UINT32(sizeof(os_evt_trace_rec_t), hdr.rec_size);
+    TEST_ASSERT_EQUAL_UINT32(1000000000u, hdr.ts_hz);
+    TEST_ASSERT_EQUAL_UINT32(6, hdr.count);
+    TEST_ASSERT_EQUAL_UINT32(0, hdr.lost);
+    TEST_ASSERT_EQUAL_UINT32(7, s_dump.writes);
+    TEST_ASSERT_EQUAL_UINT32(DUMP_MAX - (OS_EVT_TRACE_RECORDS - 6u) * sizeof(os_evt_trace_rec_t), s_dump.len);
+
+    /* Lane depth after each publish, depth left after each pop, callbacks run */
+    check_rec(0, OS_EVT_TRACE_PUBLISH, EVT_IR_SEND_RESULT, 0, 1);
+    check_rec(1, OS_EVT_TRACE_PUBLISH, EVT_IR_SEND_RESULT, 1, 2);
+    check_rec(2, OS_EVT_TRACE_DISPATCH_START, EVT_IR_SEND_RESULT, 0, 1);
+    check_rec(3, OS_EVT_TRACE_DISPATCH_END, EVT_IR_SEND_RESULT, 0, 2);
+    check_rec(4, OS_EVT_TRACE_DISPATCH_START, EVT_IR_SEND_RESULT, 1, 0);
+    check_rec(5, OS_EVT_TRACE_DISPATCH_END, EVT_IR_SEND_RESULT, 1, 2);
+    for (uint32_t i = 0; i < hdr.count; i++) {
+        os_evt_trace_rec_t rec = dump_rec(i);
+        uint32_t src = rec.src;
+        TEST_ASSERT_EQUAL_UINT32(i + 1u, rec.stamp);
+        TEST_ASSERT_EQUAL_UINT32(OS_MOD_IR, src);
+        if (i > 0) {
+            os_evt_trace_rec_t prev = dump_rec(i - 1u);
+            TEST_ASSERT_TRUE((int32_t)(rec.ts - prev.ts) >= 0);
+        }
+    }
+}
+
+static void test_refusals_and_coalesce(void)
+{
+    uint8_t big[OS_EVT_INLINE_MAX + 1u] = { 0 };
+    os_evt_trace_hdr_t hdr;
+    uint32_t n = 0;
+    os_evt_bus_init();
+
+    /* Coalesced: the merge carries the pending entry's stamp */
+    os_evt_publish_battery_state();
+    os_evt_publish_battery_state();
+    /* Rejected before it has a lane */
+    os_evt_bus_publish(OS_MOD_NONE, EVT__MAX, NULL, 0);
+    /* Pool exhausted, then the lane full */
+    for (uint32_t i = 0; i < OS_EVT_BUS_POOL_BLOCKS; i++) {
+        TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_publish(OS_MOD_STORAGE, EVT_STORAGE_CORRUPT, big, sizeof(big)));
+    }
+    TEST_ASSERT_EQUAL_INT(OS_ENOMEM, os_evt_bus_publish(OS_MOD_STORAGE, EVT_STORAGE_CORRUPT, big, sizeof(big)));
+    for (uint32_t i = 0; i < OS_EVT_BUS_QUEUE_DEPTH; i++) {
+        os_evt_bus_publish(OS_MOD_CMD, EVT_IR_SEND_STARTED, NULL, 0);
+    }
+    TEST_ASSERT_EQUAL_INT(OS_EFULL, os_evt_bus_publish(OS_MOD_CMD, EVT_IR_SEND_STARTED, NULL, 0));
+
+    take_dump(&hdr);
+    check_rec(n++, OS_EVT_TRACE_PUBLISH, EVT_BATTERY_STATE, 0, 1);
+    check_rec(n++, OS_EVT_TRACE_COALESCE, EVT_BATTERY_STATE, 0, 1);
+    check_rec(n++, OS_EVT_TRACE_REJECT, (os_evt_id_t)EVT__MAX, 0, 0);
+    n += OS_EVT_BUS_POOL_BLOCKS;
+    check_rec(n++, OS_EVT_TRACE_NOMEM, EVT_STORAGE_CORRUPT, 0, OS_EVT_BUS_POOL_BLOCKS);
+    n += OS_EVT_BUS_QUEUE_DEPTH;
+    check_rec(n++, OS_EVT_TRACE_DROP, EVT_IR_SEND_STARTED, 0, OS_EVT_BUS_QUEUE_DEPTH);
+    TEST_ASSERT_EQUAL_UINT32(n, hdr.count);
+
+    /* A new init forgets the trace */
+    os_evt_bus_init();
+    TEST_ASSERT_EQUAL_UINT32(0, take_dump(&hdr));
+    TEST_ASSERT_EQUAL_UINT32(0, hdr.count);
+}
+
+static void test_ring_wraps_to_latest(void)
+{
+    os_evt_trace_hdr_t hdr;
+    const uint32_t total = OS_EVT_TRACE_RECORDS * 2u + 5u;
+    os_evt_trace_reset();
+
+    for (uint32_t i = 0; i < total; i++) {
+        os_evt_trace_record(OS_EVT_TRACE_PUBLISH, EVT_HEALTH_TICK, OS_MOD_MONITOR, i, 0);
+    }
+    TEST_ASSERT_EQUAL_UINT32(OS_EVT_TRACE_RECORDS, take_dump(&hdr));
+    TEST_ASSERT_EQUAL_UINT32(OS_EVT_TRACE_RECORDS, hdr.count);
+    TEST_ASSERT_EQUAL_UINT32(total - OS_EVT_TRACE_RECORDS, hdr.lost);
+    for (uint32_t i = 0; i < hdr.count; i++) {
+        os_evt_trace_rec_t rec = dump_rec(i);
+        TEST_ASSERT_EQUAL_UINT32(hdr.lost + i, rec.ref);
+        TEST_ASSERT_EQUAL_UINT32(hdr.lost + i + 1u, rec.stamp);
+    }
+}
+
+#define TRACE_WRITERS 3
+#define TRACE_WRITES  20000u
+
+static atomic_bool s_writers_go;
+
+static void *trace_writer(void *arg)
+{
+    uint32_t me = (uint32_t)(uintptr_t)arg;
+    while (!atomic_load(&s_writers_go)) {
+    }
+    /* ref and info both carry the per-writer count: a torn record would mix two writes */
+    for (uint32_t i = 0; i < TRACE_WRITES; i++) {
+        os_evt_trace_record(OS_EVT_TRACE_PUBLISH, me, me, i, i & 0xFFu);
+    }
+    return NULL;
+}
+
+static void test_dump_while_recording(void)
+{
+    pthread_t th[TRACE_WRITERS];
+    uint32_t dumps = 0, valid = 0;
+    os_evt_trace_reset();
+    atomic_store(&s_writers_go, false);
+
+    for (int i = 0; i < TRACE_WRITERS; i++) {
+        pthread_create(&th[i], NULL, trace_writer, (void *)(uintptr_t)(i + 1));
+    }
+    atomic_store(&s_writers_go, true);
+    for (int done = 0; !done; dumps++) {
+        os_evt_trace_hdr_t hdr;
+        uint32_t last_ref[TRACE_WRITERS + 1];
+        bool seen[TRACE_WRITERS + 1] = { false };
+
+        valid += (uint32_t)take_dump(&hdr);
+        done = hdr.count + hdr.lost == TRACE_WRITERS * TRACE_WRITES;
+        for (uint32_t i = 0; i < hdr.count; i++) {
+            os_evt_trace_rec_t rec = dump_rec(i);
+            uint32_t id = rec.id, src = rec.src, type = rec.type, info = rec.info;
+            if (rec.stamp == 0) {
+                continue;
+            }
+            TEST_ASSERT_EQUAL_UINT32(hdr.lost + i + 1u, rec.stamp);
+            TEST_ASSERT_EQUAL_UINT32(OS_EVT_TRACE_PUBLISH, type);
+            TEST_ASSERT_TRUE(id >= 1 && id <= TRACE_WRITERS);
+            TEST_ASSERT_EQUAL_UINT32(id, src);
+            TEST_ASSERT_EQUAL_UINT32(rec.ref & 0xFFu, info);
+            /* Claims of one writer are in its program order */
+            TEST_ASSERT_TRUE(!seen[id] || rec.ref > last_ref[id]);
+            seen[id] = true;
+            last_ref[id] = rec.ref;
+        }
+    }
+    for (int i = 0; i < TRACE_WRITERS; i++) {
+        pthread_join(th[i], NULL);
+    }
+    TEST_ASSERT_TRUE(dumps > 0);
+    TEST_ASSERT_TRUE(valid > 0);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_publish_dispatch_pairs);
+    RUN_TEST(test_refusals_and_coalesce);
+    RUN_TEST(test_ring_wraps_to_latest);
+    RUN_TEST(test_dump_while_recording);
+    return UNITY_END();
+}
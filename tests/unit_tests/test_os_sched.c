@@ -0,0 +1,476 @@
+/*
+ * test_os_sched.c — host unit tests for the next-deadline schedule engine
+ *
+ * The engine runs on a virtual clock: each test passes "now" itself and
+ * records what the arm and due hooks are given. Covers one-shot and
+ * recurring rows, 10k random schedules against a brute-force expansion,
+ * large forward and backward clock jumps, staged table updates, refused
+ * deliveries, and the service on the bus and the pthread port timer.
+ *
+ * Built with OS_SCHED_MAX=10240u (see CMakeLists.txt).
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "host_unity.h"
+#include "os_evt_bus.h"
+#include "os_sched.h"
+
+HOST_UNITY_INSTANCE;
+
+/* =========================
+ * Helpers
+ * ========================= */
+#define T0           1700000000u /* virtual epoch the tests start at */
+#define DAY_S        86400u
+#define MANY         10000u
+#define MANY_HORIZON (3u * DAY_S)
+
+typedef struct {
+    uint32_t id;
+    uint32_t run;
+} fire_t;
+
+static struct {
+    uint32_t armed;
+    uint32_t arm_calls;
+    fire_t  *fires;
+    size_t   n_fires;
+    size_t   cap;
+    uint32_t refuse; /* due calls to refuse with OS_EFULL */
+} s_rec;
+
+static uint32_t s_rng = 0x12345678u;
+
+static uint32_t rng_next(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+static void rec_arm(uint32_t deadline, void *ctx)
+{
+    (void)ctx;
+    s_rec.armed = deadline;
+    s_rec.arm_calls++;
+}
+
+static os_err_t rec_due(uint32_t id, uint32_t run, void *ctx)
+{
+    (void)ctx;
+    if (s_rec.refuse > 0) {
+        s_rec.refuse--;
+        return OS_EFULL;
+    }
+    if (s_rec.n_fires < s_rec.cap) {
+        s_rec.fires[s_rec.n_fires] = (fire_t){ id, run };
+    }
+    s_rec.n_fires++;
+    return OS_OK;
+}
+
+static void rec_reset(size_t cap)
+{
+    free(s_rec.fires);
+    memset(&s_rec, 0, sizeof(s_rec));
+    s_rec.armed = OS_SCHED_NEVER;
+    s_rec.cap = cap;
+    s_rec.fires = calloc(cap, sizeof(fire_t));
+    os_sched_init(rec_arm, rec_due, NULL);
+}
+
+static int cmp_fire(const void *a, const void *b)
+{
+    const fire_t *x = a, *y = b;
+    if (x->run != y->run) {
+        return x->run < y->run ? -1 : 1;
+    }
+    return (x->id > y->id) - (x->id < y->id);
+}
+
+static void set_entry(uint32_t id, uint32_t start, uint32_t period_s, uint32_t last_run)
+{
+    os_sched_entry_t e = { .start = start, .period_s = period_s, .last_run = last_run };
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_sched_set(id, &e));
+}
+
+/* Random rows, a tenth of them one-shot */
+static void set_random(uint32_t n, uint32_t now, uint32_t spread, uint32_t min_period, uint32_t max_period)
+{
+    for (uint32_t id = 0; id < n; id++) {
+        uint32_t period = rng_next() % 10u == 0 ? 0 : min_period + rng_next() % (max_period - min_period + 1u);
+        set_entry(id, now + 1u + rng_next() % spread, period, 0);
+    }
+    TEST_ASSERT_EQUAL_UINT32(n, os_sched_apply(now));
+}
+
+/* =========================
+ * Tests
+ * ========================= */
+static void test_one_shot_and_recurring(void)
+{
+    os_sched_entry_t e;
+    uint32_t next;
+    os_sched_stats_t stats;
+    rec_reset(16);
+
+    TEST_ASSERT_EQUAL_UINT32(OS_SCHED_NEVER, os_sched_next());
+    set_entry(0, T0 + 100u, 0, 0);
+    set_entry(1, T0 + 50u, 60u, 0);
+    TEST_ASSERT_EQUAL_UINT32(OS_SCHED_NEVER, os_sched_next()); /* staged only */
+    TEST_ASSERT_EQUAL_UINT32(2, os_sched_apply(T0));
+    TEST_ASSERT_EQUAL_UINT32(T0 + 50u, s_rec.armed);
+    TEST_ASSERT_EQUAL_UINT32(T0 + 50u, os_sched_next());
+
+    TEST_ASSERT_EQUAL_UINT32(1, os_sched_expire(T0 + 50u));
+    TEST_ASSERT_EQUAL_UINT32(1, s_rec.fires[0].id);
+    TEST_ASSERT_EQUAL_UINT32(T0 + 50u, s_rec.fires[0].run);
+    TEST_ASSERT_EQUAL_UINT32(T0 + 100u, s_rec.armed);
+
+    TEST_ASSERT_EQUAL_UINT32(1, os_sched_expire(T0 + 100u));
+    TEST_ASSERT_EQUAL_UINT32(0, s_rec.fires[1].id);
+    TEST_ASSERT_EQUAL_UINT32(T0 + 110u, s_rec.armed);
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_sched_get(0, &e, &next));
+    TEST_ASSERT_EQUAL_UINT32(T0 + 100u, e.last_run);
+    TEST_ASSERT_EQUAL_UINT32(OS_SCHED_NEVER, next); /* one-shot spent */
+
+    /* The timer may fire late: the run keeps its own epoch */
+    TEST_ASSERT_EQUAL_UINT32(1, os_sched_expire(T0 + 112u));
+    TEST_ASSERT_EQUAL_UINT32(T0 + 110u, s_rec.fires[2].run);
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_sched_get(1, &e, &next));
+    TEST_ASSERT_EQUAL_UINT32(T0 + 110u, e.last_run);
+    TEST_ASSERT_EQUAL_UINT32(T0 + 170u, next);
+
+    /* An early wake-up delivers nothing and re-arms for the same deadline */
+    TEST_ASSERT_EQUAL_UINT32(0, os_sched_expire(T0 + 169u));
+    TEST_ASSERT_EQUAL_UINT32(T0 + 170u, s_rec.armed);
+
+    os_sched_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.active);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.fired);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.skipped);
+}
+
+static void test_many_schedules_deadline_to_deadline(void)
+{
+    os_sched_stats_t stats;
+    rec_reset(0);
+    set_random(MANY, T0, DAY_S, 600u, DAY_S);
+
+    /* Brute force: every run of every row up to the horizon, in delivery order */
+    fire_t *expect = NULL;
+    size_t n_expect = 0, cap = 0;
+    for (uint32_t id = 0; id < MANY; id++) {
+        os_sched_entry_t e;
+        TEST_ASSERT_EQUAL_INT(OS_OK, os_sched_get(id, &e, NULL));
+        for (uint64_t run = e.start; run <= T0 + MANY_HORIZON; run += e.period_s) {
+            if (n_expect == cap) {
+                cap = cap ? 2u * cap : 4096u;
+                expect = realloc(expect, cap * sizeof(fire_t));
+            }
+            expect[n_expect++] = (fire_t){ id, (uint32_t)run };
+            if (e.period_s == 0) {
+                break;
+            }
+        }
+    }
+    qsort(expect, n_expect, sizeof(fire_t), cmp_fire);
+    free(s_rec.fires);
+    s_rec.cap = n_expect;
+    s_rec.fires = calloc(n_expect, sizeof(fire_t));
+    TEST_ASSERT_EQUAL_UINT32(expect[0].run, s_rec.armed);
+
+    /* Jump from deadline to deadline; the timer must always be armed for the next expected run */
+    size_t done = 0;
+    while (s_rec.armed <= T0 + MANY_HORIZON) {
+        size_t fired = os_sched_expire(s_rec.armed);
+        TEST_ASSERT_TRUE(fired > 0);
+        done += fired;
+        TEST_ASSERT_EQUAL_UINT32(done, s_rec.n_fires);
+        if (done < n_expect) {
+            TEST_ASSERT_EQUAL_UINT32(expect[done].run, s_rec.armed);
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(n_expect, s_rec.n_fires);
+    TEST_ASSERT_EQUAL_MEMORY(expect, s_rec.fires, n_expect * sizeof(fire_t));
+
+    os_sched_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(n_expect, stats.fired);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.skipped);
+    /* One recompute per applied row and per delivered run, at most one arm per deadline */
+    TEST_ASSERT_EQUAL_UINT32(MANY + n_expect, stats.recomputed);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(n_expect + 1u, s_rec.arm_calls);
+    free(expect);
+}
+
+static void test_large_time_jumps(void)
+{
+    os_sched_stats_t before, after;
+    uint32_t last[MANY];
+    rec_reset(MANY * 16u);
+    set_random(MANY, T0, DAY_S, 600u, DAY_S);
+    memset(last, 0, sizeof(last));
+
+    /* Forward 10 days: each row due fires its latest run if within grace, the rest are skipped */
+    uint32_t now = T0 + 10u * DAY_S;
+    uint32_t due_rows = 0;
+    for (uint32_t id = 0; id < MANY; id++) {
+        os_sched_entry_t e;
+        uint32_t next;
+        os_sched_get(id, &e, &next);
+        due_rows += next <= now;
+    }
+    os_sched_get_stats(&before);
+    uint32_t arms = s_rec.arm_calls;
+    size_t fired = os_sched_time_jumped(now);
+    os_sched_get_stats(&after);
+    TEST_ASSERT_EQUAL_UINT32(due_rows, after.recomputed - before.recomputed);
+    TEST_ASSERT_EQUAL_UINT32(fired, s_rec.n_fires);
+    TEST_ASSERT_TRUE(after.skipped - before.skipped >= due_rows - fired);
+    TEST_ASSERT_EQUAL_UINT32(arms + 1u, s_rec.arm_calls);
+    TEST_ASSERT_EQUAL_UINT32(os_sched_next(), s_rec.armed);
+    TEST_ASSERT_TRUE(s_rec.armed > now);
+    for (size_t i = 0; i < s_rec.n_fires; i++) {
+        TEST_ASSERT_TRUE(s_rec.fires[i].run <= now && now - s_rec.fires[i].run <= OS_SCHED_GRACE_S);
+        last[s_rec.fires[i].id] = s_rec.fires[i].run;
+    }
+
+    /* Back 10 days: deadlines are absolute, so nothing is recomputed; only the timer moves */
+    os_sched_get_stats(&before);
+    arms = s_rec.arm_calls;
+    uint32_t head = os_sched_next();
+    TEST_ASSERT_EQUAL_UINT32(0, os_sched_time_jumped(T0));
+    os_sched_get_stats(&after);
+    TEST_ASSERT_EQUAL_UINT32(0, after.recomputed - before.recomputed);
+    TEST_ASSERT_EQUAL_UINT32(arms + 1u, s_rec.arm_calls);
+    TEST_ASSERT_EQUAL_UINT32(head, s_rec.armed);
+
+    /* Forward again past the first jump and on for a day: every row's runs keep increasing */
+    size_t seen = s_rec.n_fires;
+    os_sched_time_jumped(now);
+    TEST_ASSERT_EQUAL_UINT32(seen, s_rec.n_fires); /* already delivered up to now */
+    while (s_rec.armed <= now + DAY_S) {
+        os_sched_expire(s_rec.armed);
+    }
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(s_rec.cap, s_rec.n_fires);
+    for (size_t i = seen; i < s_rec.n_fires; i++) {
+        TEST_ASSERT_TRUE(s_rec.fires[i].run > last[s_rec.fires[i].id]);
+        TEST_ASSERT_TRUE(s_rec.fires[i].run > now);
+        last[s_rec.fires[i].id] = s_rec.fires[i].run;
+    }
+}
+
+static void test_grace_and_last_run_guard(void)
+{
+    os_sched_entry_t e;
+    uint32_t next;
+    os_sched_stats_t stats;
+    rec_reset(16);
+
+    set_entry(0, T0 + 100u, 0, 0);
+    set_entry(1, T0 + 100u, 0, 0);
+    os_sched_apply(T0);
+    os_sched_time_jumped(T0 + 100u + OS_SCHED_GRACE_S);
+    TEST_ASSERT_EQUAL_UINT32(2, s_rec.n_fires);
+    rec_reset(16);
+    set_entry(0, T0 + 100u, 0, 0);
+    os_sched_apply(T0);
+    os_sched_time_jumped(T0 + 101u + OS_SCHED_GRACE_S);
+    TEST_ASSERT_EQUAL_UINT32(0, s_rec.n_fires);
+    os_sched_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.skipped);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.active);
+
+    /* Missed runs of a recurring row: only the latest fires */
+    set_entry(2, T0 + 100u, 10u, 0);
+    os_sched_apply(T0);
+    os_sched_time_jumped(T0 + 145u);
+    TEST_ASSERT_EQUAL_UINT32(1, s_rec.n_fires);
+    TEST_ASSERT_EQUAL_UINT32(T0 + 140u, s_rec.fires[0].run);
+    os_sched_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1u + 4u, stats.skipped);
+
+    /* A restored last_run is never repeated, even with the clock behind it */
+    set_entry(3, T0 + 100u, 500u, T0 + 1100u);
+    os_sched_apply(T0 + 200u);
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_sched_get(3, &e, &next));
+    TEST_ASSERT_EQUAL_UINT32(T0 + 1600u, next);
+    set_entry(4, T0 + 100u, 0, T0 + 100u);
+    os_sched_apply(T0);
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_sched_get(4, &e, &next));
+    TEST_ASSERT_EQUAL_UINT32(OS_SCHED_NEVER, next);
+}
+
+static void test_apply_already_due(void)
+{
+    os_sched_entry_t e;
+    uint32_t next;
+    os_sched_stats_t stats;
+    rec_reset(16);
+
+    /* A one-shot applied 5 s after its start is within grace: it fires at once with its own epoch */
+    set_entry(0, T0, 0, 0);
+    /* Applied past the grace window: skipped and counted, not silently dropped */
+    set_entry(1, T0 - OS_SCHED_GRACE_S - 1u, 0, 0);
+    /* A recurring row that missed runs: the latest, 5 s old, fires; the one before is skipped */
+    set_entry(2, T0 - 600u, 300u, T0 - 600u);
+    TEST_ASSERT_EQUAL_UINT32(3, os_sched_apply(T0 + 5u));
+
+    TEST_ASSERT_EQUAL_UINT32(2, s_rec.n_fires);
+    TEST_ASSERT_EQUAL_UINT32(2, s_rec.fires[0].id); /* earliest due first: T0 - 300 */
+    TEST_ASSERT_EQUAL_UINT32(T0, s_rec.fires[0].run);
+    TEST_ASSERT_EQUAL_UINT32(0, s_rec.fires[1].id);
+    TEST_ASSERT_EQUAL_UINT32(T0, s_rec.fires[1].run);
+    os_sched_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.fired);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.skipped);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.active);
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_sched_get(1, &e, &next));
+    TEST_ASSERT_EQUAL_UINT32(T0 - OS_SCHED_GRACE_S - 1u, e.last_run);
+    TEST_ASSERT_EQUAL_UINT32(OS_SCHED_NEVER, next);
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_sched_get(2, &e, &next));
+    TEST_ASSERT_EQUAL_UINT32(T0 + 300u, next);
+    TEST_ASSERT_EQUAL_UINT32(T0 + 300u, s_rec.armed);
+
+    /* The same rows reached through expire give the same result */
+    rec_reset(16);
+    set_entry(0, T0, 0, 0);
+    os_sched_apply(T0 - 10u);
+    TEST_ASSERT_EQUAL_UINT32(1, os_sched_expire(T0 + 5u));
+    TEST_ASSERT_EQUAL_UINT32(T0, s_rec.fires[0].run);
+}
+
+static void test_table_updates(void)
+{
+    os_sched_entry_t e = { .start = T0 + 10u, .period_s = 60u, .last_run = 0 };
+    os_sched_stats_t before, after;
+    uint32_t next;
+    rec_reset(16);
+    set_random(100, T0, 1000u, 60u, 3600u);
+
+    TEST_ASSERT_EQUAL_INT(OS_EINVAL, os_sched_set(OS_SCHED_MAX, &e));
+    TEST_ASSERT_EQUAL_INT(OS_EINVAL, os_sched_set(0, NULL));
+    TEST_ASSERT_EQUAL_INT(OS_EINVAL, os_sched_remove(OS_SCHED_MAX));
+    e.start = 0;
+    TEST_ASSERT_EQUAL_INT(OS_EINVAL, os_sched_set(0, &e));
+    e.start = T0 + 10u;
+
+    /* Two changes and a removal, one row staged twice: three rows recomputed */
+    os_sched_get_stats(&before);
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_sched_set(7, &e));
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_sched_set(50, &e));
+    e.start = T0 + 1u; /* no random row is earlier */
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_sched_set(50, &e));
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_sched_remove(99));
+    TEST_ASSERT_EQUAL_UINT32(3, os_sched_apply(T0));
+    os_sched_get_stats(&after);
+    TEST_ASSERT_EQUAL_UINT32(3, after.recomputed - before.recomputed);
+    TEST_ASSERT_EQUAL_UINT32(99, after.active);
+    TEST_ASSERT_EQUAL_INT(OS_ESTATE, os_sched_get(99, &e, &next));
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_sched_get(50, &e, &next));
+    TEST_ASSERT_EQUAL_UINT32(T0 + 1u, next);
+    TEST_ASSERT_EQUAL_UINT32(T0 + 1u, s_rec.armed);
+
+    /* Nothing staged: nothing recomputed, the timer left alone */
+    uint32_t arms = s_rec.arm_calls;
+    TEST_ASSERT_EQUAL_UINT32(0, os_sched_apply(T0));
+    TEST_ASSERT_EQUAL_UINT32(arms, s_rec.arm_calls);
+
+    /* Removing the head re-arms for the new head */
+    os_sched_remove(50);
+    os_sched_apply(T0);
+    TEST_ASSERT_EQUAL_UINT32(os_sched_next(), s_rec.armed);
+    TEST_ASSERT_TRUE(s_rec.armed > T0);
+}
+
+static void test_refused_delivery_retries(void)
+{
+    os_sched_stats_t stats;
+    rec_reset(16);
+    set_entry(0, T0 + 100u, 0, 0);
+    set_entry(1, T0 + 100u, 0, 0);
+    os_sched_apply(T0);
+
+    s_rec.refuse = 1;
+    TEST_ASSERT_EQUAL_UINT32(0, os_sched_expire(T0 + 100u));
+    TEST_ASSERT_EQUAL_UINT32(T0 + 100u + OS_SCHED_RETRY_S, s_rec.armed);
+    TEST_ASSERT_EQUAL_UINT32(0, s_rec.n_fires);
+    TEST_ASSERT_EQUAL_UINT32(2, os_sched_expire(T0 + 100u + OS_SCHED_RETRY_S));
+    TEST_ASSERT_EQUAL_UINT32(T0 + 100u, s_rec.fires[0].run);
+    TEST_ASSERT_EQUAL_UINT32(OS_SCHED_NEVER, s_rec.armed);
+    os_sched_get_stats(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.retries);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.fired);
+}
+
+static uint32_t s_due_ids[4];
+static uint32_t s_due_count;
+
+static void cb_schedule_due(const os_evt_t *evt, void *user_ctx)
+{
+    evt_schedule_due_t due;
+    (void)user_ctx;
+    os_evt_read_schedule_due(evt, &due);
+    if (s_due_count < 4u) {
+        s_due_ids[s_due_count] = due.schedule_id;
+    }
+    s_due_count++;
+}
+
+static void test_default_hook_publishes(void)
+{
+    s_due_count = 0;
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_init());
+    TEST_ASSERT_TRUE(os_evt_bus_handle_valid(os_evt_subscribe_schedule_due(cb_schedule_due, NULL)));
+    os_sched_init(rec_arm, NULL, NULL);
+    set_entry(3, T0 + 1u, 0, 0);
+    set_entry(9, T0 + 1u, 0, 0);
+    os_sched_apply(T0);
+    TEST_ASSERT_EQUAL_UINT32(2, os_sched_expire(T0 + 1u));
+    TEST_ASSERT_EQUAL_UINT32(2, os_evt_bus_dispatch_all());
+    TEST_ASSERT_EQUAL_UINT32(2, s_due_count);
+    TEST_ASSERT_EQUAL_UINT32(3, s_due_ids[0]);
+    TEST_ASSERT_EQUAL_UINT32(9, s_due_ids[1]);
+}
+
+static void test_service_on_port_timer(void)
+{
+    s_due_count = 0;
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_bus_init());
+    TEST_ASSERT_TRUE(os_evt_bus_handle_valid(os_evt_subscribe_schedule_due(cb_schedule_due, NULL)));
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_sched_start());
+
+    /* Due one second from now on the real clock; applied through the bus */
+    set_entry(5, (uint32_t)time(NULL) + 1u, 0, 0);
+    TEST_ASSERT_EQUAL_INT(OS_OK, os_evt_publish_schedule_table_updated());
+    for (int i = 0; i < 300 && s_due_count == 0; i++) {
+        os_evt_bus_dispatch_all();
+        struct timespec ts = { 0, 10000000L };
+        nanosleep(&ts, NULL);
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, s_due_count);
+    TEST_ASSERT_EQUAL_UINT32(5, s_due_ids[0]);
+    TEST_ASSERT_EQUAL_UINT32(OS_SCHED_NEVER, os_sched_next());
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_one_shot_and_recurring);
+    RUN_TEST(test_many_schedules_deadline_to_deadline);
+    RUN_TEST(test_large_time_jumps);
+    RUN_TEST(test_grace_and_last_run_guard);
+    RUN_TEST(test_apply_already_due);
+    RUN_TEST(test_table_updates);
+    RUN_TEST(test_refused_delivery_retries);
+    RUN_TEST(test_default_hook_publishes);
+    RUN_TEST(test_service_on_port_timer);
+    free(s_rec.fires);
+    return UNITY_END();
+}